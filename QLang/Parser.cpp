@@ -19,6 +19,15 @@ Parser::Parser(const std::vector<Token> &tokens,
 #endif
 }
 
+Parser::Parser(std::vector<Token> &&tokens,
+               std::shared_ptr<QErrorCollector> errorCollector)
+    : m_Tokens(std::move(tokens)), m_ErrorCollector(errorCollector) {
+#if QLANG_DEBUG
+  std::cout << "[DEBUG] Parser created with " << m_Tokens.size()
+            << " tokens and error collector" << std::endl;
+#endif
+}
+
 void Parser::ReportError(const std::string &message, QErrorSeverity severity) {
   if (m_ErrorCollector) {
     Token current = Peek();
@@ -41,11 +50,15 @@ void Parser::RecoverToNextStatement() {
 
     switch (Peek().type) {
     case TokenType::T_CLASS:
+    case TokenType::T_STRUCT:
     case TokenType::T_METHOD:
     case TokenType::T_IF:
     case TokenType::T_WHILE:
     case TokenType::T_FOR:
     case TokenType::T_RETURN:
+    case TokenType::T_YIELD:
+    case TokenType::T_WAIT:
+    case TokenType::T_WAITUNTIL:
     case TokenType::T_END:
       return;
     default:
@@ -61,11 +74,46 @@ Parser::~Parser() {
 #endif
 }
 
+// FNV-1a over token types and text. Positions are left out, so moving code
+// around does not change the hash.
+static uint64_t HashTokens(const std::vector<Token> &tokens, int begin,
+                           int end, uint64_t hash = 14695981039346656037ull) {
+  auto mix = [&hash](uint8_t byte) {
+    hash ^= byte;
+    hash *= 1099511628211ull;
+  };
+  for (int i = std::max(begin, 0);
+       i < end && i < static_cast<int>(tokens.size()); ++i) {
+    mix(static_cast<uint8_t>(tokens[i].type));
+    for (char c : tokens[i].Text()) {
+      mix(static_cast<uint8_t>(c));
+    }
+    mix(0xFF); // Token separator
+  }
+  return hash;
+}
+
 std::shared_ptr<QProgram> Parser::Parse() {
 #if QLANG_DEBUG
   std::cout << "[DEBUG] Parse() called - starting parse" << std::endl;
 #endif
-  return ParseProgram();
+  m_BodyRanges.clear();
+  DemoteContextualKeywords();
+  auto program = ParseProgram();
+  if (program) {
+    // Everything except method bodies: classes, members, signatures, enums,
+    // imports and top-level code
+    uint64_t shape = 14695981039346656037ull;
+    int next = 0;
+    for (const auto &range : m_BodyRanges) {
+      shape = HashTokens(m_Tokens, next, range.first, shape);
+      next = range.second;
+    }
+    shape = HashTokens(m_Tokens, next, static_cast<int>(m_Tokens.size()),
+                       shape);
+    program->SetShapeHash(shape);
+  }
+  return program;
 }
 
 std::shared_ptr<QProgram> Parser::ParseProgram() {
@@ -73,7 +121,7 @@ std::shared_ptr<QProgram> Parser::ParseProgram() {
   std::cout << "[DEBUG] ParseProgram() - creating QProgram node" << std::endl;
 #endif
 
-  auto program = std::make_shared<QProgram>();
+  auto program = m_Arena->Make<QProgram>();
 
   // Parse imports and classes at program level
   while (!IsAtEnd()) {
@@ -98,10 +146,10 @@ std::shared_ptr<QProgram> Parser::ParseProgram() {
       // Expect module name (identifier)
       if (Check(TokenType::T_IDENTIFIER)) {
         Token moduleToken = Advance();
-        program->AddImport(moduleToken.value);
+        program->AddImport(moduleToken.Text());
 #if QLANG_DEBUG
         std::cout << "[DEBUG] ParseProgram() - parsed import: "
-                  << moduleToken.value << std::endl;
+                  << moduleToken.Text() << std::endl;
 #endif
       } else {
         ReportError("Expected module name after 'import'");
@@ -125,6 +173,16 @@ std::shared_ptr<QProgram> Parser::ParseProgram() {
       } else {
         ReportError("Expected 'class' after 'static'");
       }
+    } else if (current.type == TokenType::T_STRUCT) {
+      // struct Name ... end - value class, same body as a class
+      auto cls = ParseClass();
+      if (cls) {
+        cls->SetValueType(true);
+        m_ClassNames.insert(cls->GetName());
+        program->AddClass(cls);
+        std::cout << "[DEBUG] Parser: Parsed struct '" << cls->GetName() << "'"
+                  << std::endl;
+      }
     } else if (current.type == TokenType::T_CLASS) {
       auto cls = ParseClass();
       if (cls) {
@@ -147,7 +205,7 @@ std::shared_ptr<QProgram> Parser::ParseProgram() {
         Advance(); // consume 'class'
         if (Check(TokenType::T_IDENTIFIER)) {
           Token classNameToken = Advance();
-          std::string className = classNameToken.value;
+          std::string className = classNameToken.Text();
           m_ClassNames.insert(className);
           m_ForwardDeclaredClasses.insert(className);
           program->AddForwardDecl(className);
@@ -198,7 +256,7 @@ void Parser::ParseCode(std::shared_ptr<QCode> code) {
   while (!IsAtEnd()) {
     Token current = Peek();
 #if QLANG_DEBUG
-    std::cout << "[DEBUG] ParseCode() - current token: " << current.value
+    std::cout << "[DEBUG] ParseCode() - current token: " << current.Text()
               << " at line " << current.line << std::endl;
 #endif
 
@@ -242,6 +300,15 @@ void Parser::ParseCode(std::shared_ptr<QCode> code) {
         code->AddNode(returnStmt);
       }
     }
+    // Check for coroutine suspension (yield / wait / waitUntil)
+    else if (current.type == TokenType::T_YIELD ||
+             current.type == TokenType::T_WAIT ||
+             current.type == TokenType::T_WAITUNTIL) {
+      auto yieldStmt = ParseYield();
+      if (yieldStmt) {
+        code->AddNode(yieldStmt);
+      }
+    }
     // Check for enum definition (can appear anywhere in file)
     else if (current.type == TokenType::T_ENUM) {
       auto enumDef = ParseEnum();
@@ -259,11 +326,11 @@ void Parser::ParseCode(std::shared_ptr<QCode> code) {
       if (Check(TokenType::T_SCOPE)) {
         Advance(); // consume '::'
         if (Check(TokenType::T_IDENTIFIER)) {
-          std::string methodName = Peek().value;
+          std::string methodName = Peek().Text();
           Advance(); // consume method name
 
           // Create a special method call node for super
-          auto superCall = std::make_shared<QMethodCall>("super", methodName);
+          auto superCall = m_Arena->Make<QMethodCall>("super", methodName);
 
           // Parse parameters if any
           if (Check(TokenType::T_LPAREN)) {
@@ -297,7 +364,7 @@ void Parser::ParseCode(std::shared_ptr<QCode> code) {
       }
       // Check for class instance declaration (ClassName instanceName = new ...)
     } else if (current.type == TokenType::T_IDENTIFIER &&
-               IsClassName(current.value)) {
+               IsClassName(current.Text())) {
       auto instanceDecl = ParseInstanceDecl();
       if (instanceDecl) {
         code->AddNode(instanceDecl);
@@ -335,7 +402,7 @@ void Parser::ParseCode(std::shared_ptr<QCode> code) {
           if (methodCall) {
             code->AddNode(methodCall);
           }
-        } else if (Check(TokenType::T_OPERATOR) && Peek().value == "=") {
+        } else if (Check(TokenType::T_OPERATOR) && Peek().Text() == "=") {
           // It's a member assignment - restore and parse properly
           m_Current = savedPos;
           auto memberAssign = ParseMemberAssign();
@@ -356,14 +423,14 @@ void Parser::ParseCode(std::shared_ptr<QCode> code) {
         if (assign) {
           code->AddNode(assign);
         }
-      } else if (next.type == TokenType::T_OPERATOR && next.value == "=") {
+      } else if (next.type == TokenType::T_OPERATOR && next.Text() == "=") {
         // Simple variable assignment: var = value;
         auto assign = ParseAssign();
         if (assign) {
           code->AddNode(assign);
         }
       } else if (next.type == TokenType::T_OPERATOR &&
-                 (next.value == "++" || next.value == "--")) {
+                 (next.Text() == "++" || next.Text() == "--")) {
         // Increment or decrement: var++ or var--
         auto increment = ParseIncrement();
         if (increment) {
@@ -398,7 +465,7 @@ void Parser::ParseCode(std::shared_ptr<QCode> code) {
       Advance(); // Skip newlines
     } else {
       // Report error for unexpected tokens
-      ReportError("Unexpected token '" + current.value + "'");
+      ReportError("Unexpected token '" + current.Text() + "'");
       Advance();
     }
   } // End while
@@ -411,13 +478,13 @@ void Parser::ParseCode(std::shared_ptr<QCode> code) {
 std::shared_ptr<QStatement> Parser::ParseStatement() {
   Token identifier = Peek();
 #if QLANG_DEBUG
-  std::cout << "Parsing " << identifier.value << std::endl;
+  std::cout << "Parsing " << identifier.Text() << std::endl;
 #endif
 
   // Consume the identifier
   Advance();
 
-  auto statement = std::make_shared<QStatement>(identifier.value);
+  auto statement = m_Arena->Make<QStatement>(identifier.Text());
 
   // Check for parameters - look for '('
   if (Check(TokenType::T_LPAREN)) {
@@ -432,7 +499,7 @@ std::shared_ptr<QStatement> Parser::ParseStatement() {
     // If we parsed an identifier as a statement (and it wasn't a variable
     // decl), it must be a function call.
     ReportError("Expected '(' after function or method name '" +
-                identifier.value + "'");
+                identifier.Text() + "'");
   }
 
   // Consume end of line if present
@@ -451,7 +518,7 @@ std::shared_ptr<QParameters> Parser::ParseParameters() {
   std::cout << "[DEBUG] ParseParameters() - starting" << std::endl;
 #endif
 
-  auto params = std::make_shared<QParameters>();
+  auto params = m_Arena->Make<QParameters>();
 
   // Consume '('
   if (Check(TokenType::T_LPAREN)) {
@@ -529,7 +596,7 @@ std::shared_ptr<QExpression> Parser::ParseExpression() {
   std::cout << "[DEBUG] ParseExpression() - starting" << std::endl;
 #endif
 
-  auto expr = std::make_shared<QExpression>();
+  auto expr = m_Arena->Make<QExpression>();
   int parenDepth = 0;
 
   // Collect tokens until we hit ',' or ')' (at depth 0) or ';' or EOF
@@ -595,33 +662,29 @@ Token Parser::Consume(TokenType type, const std::string &message) {
 }
 
 // Helper methods
-Token Parser::Peek() const {
+const Token &Parser::Peek() const {
   if (m_Current >= m_Tokens.size()) {
-    Token eof;
-    eof.type = TokenType::T_EOF;
-    eof.value = "";
-    eof.line = -1;
-    eof.column = -1;
+    static const Token eof{TokenType::T_EOF, 0, 0, -1, -1};
     return eof;
   }
   return m_Tokens[m_Current];
 }
 
-Token Parser::Previous() const {
+const Token &Parser::Previous() const {
   if (m_Current <= 0) {
     return m_Tokens[0];
   }
   return m_Tokens[m_Current - 1];
 }
 
-Token Parser::PeekNext() const {
+const Token &Parser::PeekNext() const {
   if (m_Current + 1 >= m_Tokens.size()) {
     return m_Tokens.back(); // Return EOF
   }
   return m_Tokens[m_Current + 1];
 }
 
-Token Parser::Advance() {
+const Token &Parser::Advance() {
   if (!IsAtEnd()) {
     m_Current++;
   }
@@ -652,7 +715,55 @@ bool Parser::IsTypeToken(TokenType type) const {
          type == TokenType::T_SHORT || type == TokenType::T_STRING_TYPE ||
          type == TokenType::T_BOOL || type == TokenType::T_CPTR ||
          type == TokenType::T_IPTR || type == TokenType::T_FPTR ||
-         type == TokenType::T_BYTE || type == TokenType::T_BPTR;
+         type == TokenType::T_BYTE || type == TokenType::T_BPTR ||
+         type == TokenType::T_VEC2 || type == TokenType::T_VEC3 ||
+         type == TokenType::T_VEC4 || type == TokenType::T_MAT4;
+}
+
+void Parser::DemoteContextualKeywords() {
+  // These became keywords after scripts had used them as names. Names follow
+  // a '.', '::' or a type, or are assigned to; a coroutine statement starts
+  // a line, and a vector type is followed by a name, its constructor
+  // arguments or the rest of a generic argument list.
+  static const std::set<std::string> assignments = {"=",  "+=", "-=", "*=",
+                                                    "/=", "++", "--"};
+  for (size_t i = 0; i < m_Tokens.size(); ++i) {
+    Token &token = m_Tokens[i];
+    bool vector = token.type == TokenType::T_VEC2 ||
+                  token.type == TokenType::T_VEC3 ||
+                  token.type == TokenType::T_VEC4 ||
+                  token.type == TokenType::T_MAT4;
+    bool coroutine = token.type == TokenType::T_YIELD ||
+                     token.type == TokenType::T_WAIT ||
+                     token.type == TokenType::T_WAITUNTIL;
+    if (!vector && !coroutine)
+      continue;
+
+    TokenType previous =
+        i > 0 ? m_Tokens[i - 1].type : TokenType::T_END_OF_LINE;
+    TokenType next =
+        i + 1 < m_Tokens.size() ? m_Tokens[i + 1].type : TokenType::T_EOF;
+
+    bool name = previous == TokenType::T_DOT ||
+                previous == TokenType::T_SCOPE || IsTypeToken(previous) ||
+                previous == TokenType::T_VOID ||
+                (next == TokenType::T_OPERATOR &&
+                 assignments.count(m_Tokens[i + 1].Text()));
+    if (coroutine) {
+      name = name || previous != TokenType::T_END_OF_LINE ||
+             (token.type != TokenType::T_YIELD &&
+              next != TokenType::T_LPAREN);
+    } else {
+      name = name || (next != TokenType::T_IDENTIFIER &&
+                      next != TokenType::T_LPAREN &&
+                      next != TokenType::T_GREATER &&
+                      next != TokenType::T_COMMA);
+    }
+
+    if (name) {
+      token.type = TokenType::T_IDENTIFIER;
+    }
+  }
 }
 
 std::shared_ptr<QVariableDecl> Parser::ParseVariableDecl() {
@@ -664,7 +775,7 @@ std::shared_ptr<QVariableDecl> Parser::ParseVariableDecl() {
   // Get the type token
   Token typeToken = Advance();
 #if QLANG_DEBUG
-  std::cout << "[DEBUG] ParseVariableDecl() - type: " << typeToken.value
+  std::cout << "[DEBUG] ParseVariableDecl() - type: " << typeToken.Text()
             << std::endl;
 #endif
 
@@ -678,7 +789,7 @@ std::shared_ptr<QVariableDecl> Parser::ParseVariableDecl() {
     Advance();                    // consume '<'
     while (!IsAtEnd() && !Check(TokenType::T_GREATER)) {
       if (Check(TokenType::T_IDENTIFIER) || IsTypeToken(Peek().type)) {
-        typeParams.push_back(Peek().value);
+        typeParams.push_back(Peek().Text());
         Advance();
       } else {
         ReportError("Expected type parameter");
@@ -697,25 +808,25 @@ std::shared_ptr<QVariableDecl> Parser::ParseVariableDecl() {
     // This catches "i2f Val" where "i2f" is type, "Val" is name.
     // But if we have "i2f" alone, Peek() might be EOL or EOF.
     ReportError("Expected variable name (identifier) after type '" +
-                typeToken.value + "'");
+                typeToken.Text() + "'");
     return nullptr;
   }
 
   Token nameToken = Advance();
 #if QLANG_DEBUG
-  std::cout << "[DEBUG] ParseVariableDecl() - name: " << nameToken.value
+  std::cout << "[DEBUG] ParseVariableDecl() - name: " << nameToken.Text()
             << std::endl;
 #endif
 
-  auto varDecl = std::make_shared<QVariableDecl>(
-      typeToken.type, nameToken.value, typeToken.value);
+  auto varDecl = m_Arena->Make<QVariableDecl>(
+      typeToken.type, nameToken.Text(), typeToken.Text());
   varDecl->SetTypeParameters(typeParams);
 
   // Register this variable as declared
-  m_DeclaredVariables.insert(nameToken.value);
+  m_DeclaredVariables.insert(nameToken.Text());
 
   // Check for initializer (= expression)
-  if (Check(TokenType::T_OPERATOR) && Peek().value == "=") {
+  if (Check(TokenType::T_OPERATOR) && Peek().Text() == "=") {
     Advance(); // consume '='
 #if QLANG_DEBUG
     std::cout << "[DEBUG] ParseVariableDecl() - parsing initializer"
@@ -748,7 +859,7 @@ std::shared_ptr<QClass> Parser::ParseClass() {
   std::cout << "[DEBUG] ParseClass() - parsing class definition" << std::endl;
 #endif
 
-  // Consume 'class' keyword
+  // Consume 'class' (or 'struct') keyword
   Advance();
 
   // Expect class name (identifier)
@@ -760,22 +871,22 @@ std::shared_ptr<QClass> Parser::ParseClass() {
 
   Token nameToken = Advance();
 #if QLANG_DEBUG
-  std::cout << "[DEBUG] ParseClass() - class name: " << nameToken.value
+  std::cout << "[DEBUG] ParseClass() - class name: " << nameToken.Text()
             << std::endl;
 #endif
 
   // Register class name immediately so self-referential members (e.g. Node
   // next) works
-  m_ClassNames.insert(nameToken.value);
+  m_ClassNames.insert(nameToken.Text());
 
   // Set current context header (Class Name)
   std::string previousContext = m_CurrentContext;
-  m_CurrentContext = nameToken.value;
+  m_CurrentContext = nameToken.Text();
 
   // Clear class member tracking for this class
   m_ClassMemberVariables.clear();
 
-  auto cls = std::make_shared<QClass>(nameToken.value);
+  auto cls = m_Arena->Make<QClass>(nameToken.Text());
 
   // Check for inheritance syntax: class Name(ParentClass)
   if (Check(TokenType::T_LPAREN)) {
@@ -791,9 +902,9 @@ std::shared_ptr<QClass> Parser::ParseClass() {
 
       // Defer parent class validation to runtime (CreateInstance time)
       // This allows child classes to be defined before parent classes
-      cls->SetParentClass(parentToken.value);
+      cls->SetParentClass(parentToken.Text());
 #if QLANG_DEBUG
-      std::cout << "[DEBUG] ParseClass() - parent class: " << parentToken.value
+      std::cout << "[DEBUG] ParseClass() - parent class: " << parentToken.Text()
                 << std::endl;
 #endif
     }
@@ -823,9 +934,9 @@ std::shared_ptr<QClass> Parser::ParseClass() {
         break;
       }
       Token typeParam = Advance();
-      typeParams.push_back(typeParam.value);
+      typeParams.push_back(typeParam.Text());
 #if QLANG_DEBUG
-      std::cout << "[DEBUG] ParseClass() - type parameter: " << typeParam.value
+      std::cout << "[DEBUG] ParseClass() - type parameter: " << typeParam.Text()
                 << std::endl;
 #endif
 
@@ -873,11 +984,11 @@ std::shared_ptr<QClass> Parser::ParseClass() {
       // Parse generic type parameter members (T, K, V, etc.)
     } else if (current.type == TokenType::T_IDENTIFIER &&
                std::find(m_CurrentTypeParams.begin(), m_CurrentTypeParams.end(),
-                         current.value) != m_CurrentTypeParams.end()) {
+                         current.Text()) != m_CurrentTypeParams.end()) {
       // This is a generic type parameter used as a member type
 #if QLANG_DEBUG
       std::cout << "[DEBUG] ParseClass() - parsing generic type member: "
-                << current.value << std::endl;
+                << current.Text() << std::endl;
 #endif
       auto member = ParseVariableDecl();
       if (member) {
@@ -888,13 +999,13 @@ std::shared_ptr<QClass> Parser::ParseClass() {
       // Parse class-type member variables (ClassName varName = new ...)
       // Parse class-type member variables (ClassName varName = new ...)
     } else if (current.type == TokenType::T_IDENTIFIER &&
-               (IsClassName(current.value) ||
+               (IsClassName(current.Text()) ||
                 PeekNext().type == TokenType::T_IDENTIFIER ||
                 PeekNext().type == TokenType::T_LESS)) {
       // This is a class-type member declaration
 #if QLANG_DEBUG
       std::cout << "[DEBUG] ParseClass() - parsing class-type member: "
-                << current.value << std::endl;
+                << current.Text() << std::endl;
 #endif
       auto member = ParseClassTypeMember();
       if (member) {
@@ -907,7 +1018,7 @@ std::shared_ptr<QClass> Parser::ParseClass() {
     } else {
       // Skip unknown tokens inside class
 #if QLANG_DEBUG
-      std::cout << "[DEBUG] ParseClass() - skipping token: " << current.value
+      std::cout << "[DEBUG] ParseClass() - skipping token: " << current.Text()
                 << std::endl;
 #endif
       Advance();
@@ -948,11 +1059,11 @@ std::shared_ptr<QEnum> Parser::ParseEnum() {
 
   Token nameToken = Advance();
 #if QLANG_DEBUG
-  std::cout << "[DEBUG] ParseEnum() - enum name: " << nameToken.value
+  std::cout << "[DEBUG] ParseEnum() - enum name: " << nameToken.Text()
             << std::endl;
 #endif
 
-  auto enumDef = std::make_shared<QEnum>(nameToken.value);
+  auto enumDef = m_Arena->Make<QEnum>(nameToken.Text());
 
   // Skip optional newline after enum name
   while (Check(TokenType::T_END_OF_LINE)) {
@@ -966,14 +1077,14 @@ std::shared_ptr<QEnum> Parser::ParseEnum() {
     Token current = Peek();
 
     if (current.type == TokenType::T_IDENTIFIER) {
-      std::string valueName = current.value;
+      std::string valueName = current.Text();
       Advance(); // consume value name
 
       // Check for explicit value assignment: ValueName = IntValue
-      if (Check(TokenType::T_OPERATOR) && Peek().value == "=") {
+      if (Check(TokenType::T_OPERATOR) && Peek().Text() == "=") {
         Advance(); // consume '='
         if (Check(TokenType::T_INTEGER)) {
-          int explicitValue = std::stoi(Peek().value);
+          int explicitValue = std::stoi(Peek().Text());
           enumDef->AddValueWithInt(valueName, explicitValue);
 #if QLANG_DEBUG
           std::cout << "[DEBUG] ParseEnum() - added value: " << valueName
@@ -1001,7 +1112,7 @@ std::shared_ptr<QEnum> Parser::ParseEnum() {
     } else if (current.type == TokenType::T_END) {
       break;
     } else {
-      ReportError("Unexpected token in enum: '" + current.value + "'");
+      ReportError("Unexpected token in enum: '" + current.Text() + "'");
       Advance();
     }
   }
@@ -1031,7 +1142,7 @@ std::shared_ptr<QMethod> Parser::ParseMethod() {
 
   if (Check(TokenType::T_VOID) || IsTypeToken(typeToken.type)) {
     returnType = typeToken.type;
-    returnTypeName = typeToken.value;
+    returnTypeName = typeToken.Text();
     Advance();
 #if QLANG_DEBUG
     std::cout << "[DEBUG] ParseMethod() - return type: " << returnTypeName
@@ -1041,7 +1152,7 @@ std::shared_ptr<QMethod> Parser::ParseMethod() {
              PeekNext().type == TokenType::T_IDENTIFIER) {
     // Return type is a class name (identifier)
     returnType = typeToken.type;
-    returnTypeName = typeToken.value;
+    returnTypeName = typeToken.Text();
     Advance();
 #if QLANG_DEBUG
     std::cout << "[DEBUG] ParseMethod() - class return type: " << returnTypeName
@@ -1057,15 +1168,15 @@ std::shared_ptr<QMethod> Parser::ParseMethod() {
 
   Token nameToken = Advance();
 #if QLANG_DEBUG
-  std::cout << "[DEBUG] ParseMethod() - method name: " << nameToken.value
+  std::cout << "[DEBUG] ParseMethod() - method name: " << nameToken.Text()
             << std::endl;
 #endif
 
-  auto method = std::make_shared<QMethod>(nameToken.value);
+  auto method = m_Arena->Make<QMethod>(nameToken.Text());
   method->SetReturnType(returnType, returnTypeName);
 
   // Context Management
-  std::string methodName = nameToken.value;
+  std::string methodName = nameToken.Text();
   std::string fullContext = m_CurrentContext.empty()
                                 ? methodName
                                 : m_CurrentContext + "." + methodName;
@@ -1088,11 +1199,11 @@ std::shared_ptr<QMethod> Parser::ParseMethod() {
       if (IsTypeToken(Peek().type) || Peek().type == TokenType::T_IDENTIFIER) {
         Token typeToken = Advance(); // consume type
         TokenType paramType = typeToken.type;
-        std::string paramTypeName = typeToken.value;
+        std::string paramTypeName = typeToken.Text();
 
         // Expect parameter name
         if (Check(TokenType::T_IDENTIFIER)) {
-          std::string paramName = Peek().value;
+          std::string paramName = Peek().Text();
           Advance(); // consume name
 
           method->AddParameter(paramType, paramName, paramTypeName);
@@ -1142,7 +1253,10 @@ std::shared_ptr<QMethod> Parser::ParseMethod() {
   }
 
   // Parse method body until 'end'
+  int bodyStart = m_Current;
   ParseCode(method->GetBody());
+  method->SetBodyHash(HashTokens(m_Tokens, bodyStart, m_Current));
+  m_BodyRanges.push_back({bodyStart, m_Current});
 
   // Consume 'end' keyword for method
   if (Check(TokenType::T_END)) {
@@ -1179,7 +1293,7 @@ std::shared_ptr<QInstanceDecl> Parser::ParseInstanceDecl() {
   // Get class name
   Token classNameToken = Advance();
 #if QLANG_DEBUG
-  std::cout << "[DEBUG] ParseInstanceDecl() - class: " << classNameToken.value
+  std::cout << "[DEBUG] ParseInstanceDecl() - class: " << classNameToken.Text()
             << std::endl;
 #endif
 
@@ -1195,9 +1309,9 @@ std::shared_ptr<QInstanceDecl> Parser::ParseInstanceDecl() {
     while (!IsAtEnd() && !Check(TokenType::T_GREATER)) {
       // Get the type name (could be identifier or type keyword)
       Token typeArg = Advance();
-      typeArgs.push_back(typeArg.value);
+      typeArgs.push_back(typeArg.Text());
 #if QLANG_DEBUG
-      std::cout << "[DEBUG] ParseInstanceDecl() - type arg: " << typeArg.value
+      std::cout << "[DEBUG] ParseInstanceDecl() - type arg: " << typeArg.Text()
                 << std::endl;
 #endif
 
@@ -1222,14 +1336,14 @@ std::shared_ptr<QInstanceDecl> Parser::ParseInstanceDecl() {
   Token instanceNameToken = Advance();
 #if QLANG_DEBUG
   std::cout << "[DEBUG] ParseInstanceDecl() - instance: "
-            << instanceNameToken.value << std::endl;
+            << instanceNameToken.Text() << std::endl;
 #endif
 
-  auto instanceDecl = std::make_shared<QInstanceDecl>(classNameToken.value,
-                                                      instanceNameToken.value);
+  auto instanceDecl = m_Arena->Make<QInstanceDecl>(classNameToken.Text(),
+                                                      instanceNameToken.Text());
 
   // Register this instance as a declared variable
-  m_DeclaredVariables.insert(instanceNameToken.value);
+  m_DeclaredVariables.insert(instanceNameToken.Text());
 
   // Set type arguments if any
   if (!typeArgs.empty()) {
@@ -1248,7 +1362,7 @@ std::shared_ptr<QInstanceDecl> Parser::ParseInstanceDecl() {
   }
 
   // Expect '=' for initialization
-  if (!Check(TokenType::T_OPERATOR) || Peek().value != "=") {
+  if (!Check(TokenType::T_OPERATOR) || Peek().Text() != "=") {
     ReportError("expected '=' or ';'");
     return nullptr;
   }
@@ -1262,7 +1376,7 @@ std::shared_ptr<QInstanceDecl> Parser::ParseInstanceDecl() {
 
     // Expect constructor class name (should match)
     if (!Check(TokenType::T_IDENTIFIER) ||
-        Peek().value != classNameToken.value) {
+        Peek().Text() != classNameToken.Text()) {
       ReportError("constructor class name doesn't match");
       // Still continue for flexibility
     }
@@ -1322,13 +1436,13 @@ std::shared_ptr<QMethodCall> Parser::ParseMethodCall() {
   // Get first identifier (instance name)
   Token firstToken = Advance();
 #if QLANG_DEBUG
-  std::cout << "[DEBUG] ParseMethodCall() - first: " << firstToken.value
+  std::cout << "[DEBUG] ParseMethodCall() - first: " << firstToken.Text()
             << std::endl;
 #endif
 
   // Build the path by consuming .identifier patterns
   std::vector<std::string> pathParts;
-  pathParts.push_back(firstToken.value);
+  pathParts.push_back(firstToken.Text());
 
   while (Check(TokenType::T_DOT)) {
     Advance(); // consume '.'
@@ -1339,9 +1453,9 @@ std::shared_ptr<QMethodCall> Parser::ParseMethodCall() {
     }
 
     Token next = Advance();
-    pathParts.push_back(next.value);
+    pathParts.push_back(next.Text());
 #if QLANG_DEBUG
-    std::cout << "[DEBUG] ParseMethodCall() - path part: " << next.value
+    std::cout << "[DEBUG] ParseMethodCall() - path part: " << next.Text()
               << std::endl;
 #endif
   }
@@ -1369,7 +1483,7 @@ std::shared_ptr<QMethodCall> Parser::ParseMethodCall() {
             << ", method: " << methodName << std::endl;
 #endif
 
-  auto methodCall = std::make_shared<QMethodCall>(instancePath, methodName);
+  auto methodCall = m_Arena->Make<QMethodCall>(instancePath, methodName);
 
   // Parse arguments if present
   if (Check(TokenType::T_LPAREN)) {
@@ -1398,7 +1512,7 @@ std::shared_ptr<QMemberAssign> Parser::ParseMemberAssign() {
   Token instanceNameToken = Advance();
 #if QLANG_DEBUG
   std::cout << "[DEBUG] ParseMemberAssign() - instance: "
-            << instanceNameToken.value << std::endl;
+            << instanceNameToken.Text() << std::endl;
 #endif
 
   // Expect '.'
@@ -1417,10 +1531,10 @@ std::shared_ptr<QMemberAssign> Parser::ParseMemberAssign() {
   // Build full member path by consuming .identifier patterns
   std::string memberPath;
   Token memberNameToken = Advance();
-  memberPath = memberNameToken.value;
+  memberPath = memberNameToken.Text();
 #if QLANG_DEBUG
-  std::cout << "[DEBUG] ParseMemberAssign() - member: " << memberNameToken.value
-            << std::endl;
+  std::cout << "[DEBUG] ParseMemberAssign() - member: "
+            << memberNameToken.Text() << std::endl;
 #endif
 
   // Continue consuming .identifier patterns until we hit '='
@@ -1431,23 +1545,23 @@ std::shared_ptr<QMemberAssign> Parser::ParseMemberAssign() {
       return nullptr;
     }
     Token nextMember = Advance();
-    memberPath += "." + nextMember.value;
+    memberPath += "." + nextMember.Text();
 #if QLANG_DEBUG
     std::cout << "[DEBUG] ParseMemberAssign() - chained member: "
-              << nextMember.value << std::endl;
+              << nextMember.Text() << std::endl;
 #endif
   }
 
 #if QLANG_DEBUG
   std::cout << "[DEBUG] ParseMemberAssign() - full path: "
-            << instanceNameToken.value << "." << memberPath << std::endl;
+            << instanceNameToken.Text() << "." << memberPath << std::endl;
 #endif
 
   auto memberAssign =
-      std::make_shared<QMemberAssign>(instanceNameToken.value, memberPath);
+      m_Arena->Make<QMemberAssign>(instanceNameToken.Text(), memberPath);
 
   // Expect '='
-  if (!Check(TokenType::T_OPERATOR) || Peek().value != "=") {
+  if (!Check(TokenType::T_OPERATOR) || Peek().Text() != "=") {
     ReportError("expected '='");
     return nullptr;
   }
@@ -1482,7 +1596,7 @@ std::shared_ptr<QVariableDecl> Parser::ParseClassTypeMember() {
 
   // Get class type name (e.g., "other")
   Token classTypeToken = Advance();
-  std::string classTypeName = classTypeToken.value;
+  std::string classTypeName = classTypeToken.Text();
 #if QLANG_DEBUG
   std::cout << "[DEBUG] ParseClassTypeMember() - class type: " << classTypeName
             << std::endl;
@@ -1494,7 +1608,7 @@ std::shared_ptr<QVariableDecl> Parser::ParseClassTypeMember() {
     Advance();                    // consume '<'
     while (!IsAtEnd() && !Check(TokenType::T_GREATER)) {
       if (Check(TokenType::T_IDENTIFIER) || IsTypeToken(Peek().type)) {
-        typeParams.push_back(Peek().value);
+        typeParams.push_back(Peek().Text());
         Advance();
       } else {
         ReportError("Expected type parameter");
@@ -1515,7 +1629,7 @@ std::shared_ptr<QVariableDecl> Parser::ParseClassTypeMember() {
   }
 
   Token memberNameToken = Advance();
-  std::string memberName = memberNameToken.value;
+  std::string memberName = memberNameToken.Text();
 #if QLANG_DEBUG
   std::cout << "[DEBUG] ParseClassTypeMember() - member name: " << memberName
             << std::endl;
@@ -1523,12 +1637,12 @@ std::shared_ptr<QVariableDecl> Parser::ParseClassTypeMember() {
 
   // Create variable declaration with T_IDENTIFIER type, but include the
   // classTypeName
-  auto member = std::make_shared<QVariableDecl>(TokenType::T_IDENTIFIER,
+  auto member = m_Arena->Make<QVariableDecl>(TokenType::T_IDENTIFIER,
                                                 memberName, classTypeName);
   member->SetTypeParameters(typeParams);
 
   // Expect '=' for initialization
-  if (Check(TokenType::T_OPERATOR) && Peek().value == "=") {
+  if (Check(TokenType::T_OPERATOR) && Peek().Text() == "=") {
     Advance(); // consume '='
 
     // Parse the initializer expression (new ClassName())
@@ -1563,7 +1677,7 @@ std::shared_ptr<QReturn> Parser::ParseReturn() {
   // Consume 'return' keyword
   Advance();
 
-  auto returnStmt = std::make_shared<QReturn>();
+  auto returnStmt = m_Arena->Make<QReturn>();
 
   // Parse optional expression (if not immediately at semicolon)
   if (!Check(TokenType::T_END_OF_LINE) && !Check(TokenType::T_EOF) &&
@@ -1587,6 +1701,49 @@ std::shared_ptr<QReturn> Parser::ParseReturn() {
   return returnStmt;
 }
 
+std::shared_ptr<QYield> Parser::ParseYield() {
+#if QLANG_DEBUG
+  std::cout << "[DEBUG] ParseYield() - parsing suspension point" << std::endl;
+#endif
+
+  Token keyword = Advance(); // Consume 'yield', 'wait' or 'waitUntil'
+
+  QYield::Kind kind = QYield::Kind::Frame;
+  if (keyword.type == TokenType::T_WAIT) {
+    kind = QYield::Kind::Seconds;
+  } else if (keyword.type == TokenType::T_WAITUNTIL) {
+    kind = QYield::Kind::Until;
+  }
+  auto yieldStmt = m_Arena->Make<QYield>(kind);
+
+  // wait and waitUntil take one argument in parentheses
+  if (kind != QYield::Kind::Frame) {
+    if (!Check(TokenType::T_LPAREN)) {
+      ReportError("expected '(' after '" + keyword.Text() + "'");
+      return nullptr;
+    }
+    Advance(); // consume '('
+    auto expr = ParseExpression();
+    if (!expr || expr->GetElements().empty()) {
+      ReportError("expected expression in '" + keyword.Text() + "'");
+      return nullptr;
+    }
+    yieldStmt->SetExpression(expr);
+    if (Check(TokenType::T_RPAREN)) {
+      Advance(); // consume ')'
+    } else {
+      ReportError("expected ')' after '" + keyword.Text() + "' argument");
+    }
+  }
+
+  // Consume semicolon
+  if (Check(TokenType::T_END_OF_LINE)) {
+    Advance();
+  }
+
+  return yieldStmt;
+}
+
 std::shared_ptr<QAssign> Parser::ParseAssign() {
 #if QLANG_DEBUG
   std::cout << "[DEBUG] ParseAssign() - parsing assignment" << std::endl;
@@ -1595,11 +1752,11 @@ std::shared_ptr<QAssign> Parser::ParseAssign() {
   // Get variable name
   Token nameToken = Advance();
 #if QLANG_DEBUG
-  std::cout << "[DEBUG] ParseAssign() - variable: " << nameToken.value
+  std::cout << "[DEBUG] ParseAssign() - variable: " << nameToken.Text()
             << std::endl;
 #endif
 
-  auto assign = std::make_shared<QAssign>(nameToken.value);
+  auto assign = m_Arena->Make<QAssign>(nameToken.Text());
 
   // Check for index expression: var[expr] = value
   if (Check(TokenType::T_LBRACKET)) {
@@ -1610,7 +1767,7 @@ std::shared_ptr<QAssign> Parser::ParseAssign() {
 #endif
 
     // Parse index expression until we hit ']'
-    auto indexExpr = std::make_shared<QExpression>();
+    auto indexExpr = m_Arena->Make<QExpression>();
     int bracketDepth = 1;
     while (!IsAtEnd() && bracketDepth > 0) {
       Token current = Peek();
@@ -1637,7 +1794,7 @@ std::shared_ptr<QAssign> Parser::ParseAssign() {
   }
 
   // Expect '='
-  if (!Check(TokenType::T_OPERATOR) || Peek().value != "=") {
+  if (!Check(TokenType::T_OPERATOR) || Peek().Text() != "=") {
     ReportError("expected '='");
     return nullptr;
   }
@@ -1645,12 +1802,12 @@ std::shared_ptr<QAssign> Parser::ParseAssign() {
 
   // Check if variable is declared (local variables or class members)
   bool isDeclared =
-      m_DeclaredVariables.find(nameToken.value) != m_DeclaredVariables.end() ||
-      m_ClassMemberVariables.find(nameToken.value) !=
+      m_DeclaredVariables.find(nameToken.Text()) != m_DeclaredVariables.end() ||
+      m_ClassMemberVariables.find(nameToken.Text()) !=
           m_ClassMemberVariables.end();
 
   if (!isDeclared) {
-    ReportError("Undeclared variable '" + nameToken.value + "'",
+    ReportError("Undeclared variable '" + nameToken.Text() + "'",
                 QErrorSeverity::Warning);
   }
 
@@ -1665,7 +1822,7 @@ std::shared_ptr<QAssign> Parser::ParseAssign() {
     std::vector<std::shared_ptr<QExpression>> initExprs;
     while (!IsAtEnd() && !Check(TokenType::T_RBRACE)) {
       // Parse each element as an expression until comma or }
-      auto elemExpr = std::make_shared<QExpression>();
+      auto elemExpr = m_Arena->Make<QExpression>();
       while (!IsAtEnd() && !Check(TokenType::T_COMMA) &&
              !Check(TokenType::T_RBRACE)) {
         Token current = Peek();
@@ -1713,7 +1870,7 @@ std::shared_ptr<QIf> Parser::ParseIf() {
 #endif
   Advance(); // consume 'if'
 
-  auto ifNode = std::make_shared<QIf>();
+  auto ifNode = m_Arena->Make<QIf>();
 
   // Parse condition
   auto condition = ParseExpression();
@@ -1723,7 +1880,7 @@ std::shared_ptr<QIf> Parser::ParseIf() {
   }
 
   // Parse 'then' block
-  auto thenBlock = std::make_shared<QCode>();
+  auto thenBlock = m_Arena->Make<QCode>();
   ParseCode(thenBlock);
   ifNode->SetIf(condition, thenBlock);
 
@@ -1735,7 +1892,7 @@ std::shared_ptr<QIf> Parser::ParseIf() {
     Advance(); // consume 'elseif'
 
     auto elseIfCond = ParseExpression();
-    auto elseIfBlock = std::make_shared<QCode>();
+    auto elseIfBlock = m_Arena->Make<QCode>();
     ParseCode(elseIfBlock);
 
     ifNode->AddElseIf(elseIfCond, elseIfBlock);
@@ -1747,7 +1904,7 @@ std::shared_ptr<QIf> Parser::ParseIf() {
 #endif
     Advance(); // consume 'else'
 
-    auto elseBlock = std::make_shared<QCode>();
+    auto elseBlock = m_Arena->Make<QCode>();
     ParseCode(elseBlock);
     ifNode->SetElse(elseBlock);
   }
@@ -1771,8 +1928,12 @@ std::shared_ptr<QFor> Parser::ParseFor() {
   if (IsTypeToken(current.type)) {
     // Check if this is a valid for loop type (only numeric types allowed)
     if (current.type == TokenType::T_BOOL ||
-        current.type == TokenType::T_STRING_TYPE) {
-      std::cerr << "[ERROR] ParseFor() - Illegal for type: " << current.value
+        current.type == TokenType::T_STRING_TYPE ||
+        current.type == TokenType::T_VEC2 ||
+        current.type == TokenType::T_VEC3 ||
+        current.type == TokenType::T_VEC4 ||
+        current.type == TokenType::T_MAT4) {
+      std::cerr << "[ERROR] ParseFor() - Illegal for type: " << current.Text()
                 << std::endl;
       return nullptr;
     }
@@ -1780,7 +1941,7 @@ std::shared_ptr<QFor> Parser::ParseFor() {
     hasType = true;
     Advance(); // Consume type
 #if QLANG_DEBUG
-    std::cout << "[DEBUG] ParseFor() - type declared: " << current.value
+    std::cout << "[DEBUG] ParseFor() - type declared: " << current.Text()
               << std::endl;
 #endif
   }
@@ -1792,10 +1953,10 @@ std::shared_ptr<QFor> Parser::ParseFor() {
   }
 
   Token varToken = Advance();
-  auto forNode = std::make_shared<QFor>(varToken.value);
+  auto forNode = m_Arena->Make<QFor>(varToken.Text());
 
   // Register the for loop variable as declared
-  m_DeclaredVariables.insert(varToken.value);
+  m_DeclaredVariables.insert(varToken.Text());
 
   // Set the type if one was declared
   if (hasType) {
@@ -1803,7 +1964,7 @@ std::shared_ptr<QFor> Parser::ParseFor() {
   }
 
   // Expect '='
-  if (!Check(TokenType::T_OPERATOR) || Peek().value != "=") {
+  if (!Check(TokenType::T_OPERATOR) || Peek().Text() != "=") {
     std::cerr << "[ERROR] ParseFor() - expected '='" << std::endl;
     return nullptr;
   }
@@ -1835,7 +1996,7 @@ std::shared_ptr<QFor> Parser::ParseFor() {
 #if QLANG_DEBUG
   std::cout << "[DEBUG] ParseFor() - parsing body" << std::endl;
 #endif
-  auto body = std::make_shared<QCode>();
+  auto body = m_Arena->Make<QCode>();
   ParseCode(body);
   forNode->SetBody(body);
 
@@ -1867,14 +2028,14 @@ std::shared_ptr<QWhile> Parser::ParseWhile() {
     return nullptr;
   }
 
-  auto whileNode = std::make_shared<QWhile>();
+  auto whileNode = m_Arena->Make<QWhile>();
   whileNode->SetCondition(condition);
 
   // Parse body
 #if QLANG_DEBUG
   std::cout << "[DEBUG] ParseWhile() - parsing body" << std::endl;
 #endif
-  auto body = std::make_shared<QCode>();
+  auto body = m_Arena->Make<QCode>();
   ParseCode(body);
   whileNode->SetBody(body);
 
@@ -1899,7 +2060,7 @@ std::shared_ptr<QIncrement> Parser::ParseIncrement() {
 
   // Get variable name
   Token varToken = Advance();
-  std::string varName = varToken.value;
+  std::string varName = varToken.Text();
 
 #if QLANG_DEBUG
   std::cout << "[DEBUG] ParseIncrement() - variable: " << varName << std::endl;
@@ -1912,14 +2073,14 @@ std::shared_ptr<QIncrement> Parser::ParseIncrement() {
   }
 
   Token opToken = Advance();
-  bool isIncrement = (opToken.value == "++");
+  bool isIncrement = (opToken.Text() == "++");
 
 #if QLANG_DEBUG
-  std::cout << "[DEBUG] ParseIncrement() - operator: " << opToken.value
+  std::cout << "[DEBUG] ParseIncrement() - operator: " << opToken.Text()
             << std::endl;
 #endif
 
-  auto incrementNode = std::make_shared<QIncrement>(varName, isIncrement);
+  auto incrementNode = m_Arena->Make<QIncrement>(varName, isIncrement);
 
   // Consume optional semicolon
   if (Check(TokenType::T_END_OF_LINE)) {
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "QAssign.h"
+#include "QAstArena.h"
 #include "QClass.h"
 #include "QEnum.h"
 #include "QError.h"
@@ -18,6 +19,7 @@
 #include "QStatement.h"
 #include "QVariableDecl.h"
 #include "QWhile.h"
+#include "QYield.h"
 #include "Tokenizer.h"
 #include <memory>
 #include <set>
@@ -30,6 +32,9 @@ public:
   Parser(const std::vector<Token> &tokens);
   Parser(const std::vector<Token> &tokens,
          std::shared_ptr<QErrorCollector> errorCollector);
+  // Take ownership of the tokens instead of copying them
+  Parser(std::vector<Token> &&tokens,
+         std::shared_ptr<QErrorCollector> errorCollector);
   ~Parser();
 
   std::shared_ptr<QProgram> Parse();
@@ -42,6 +47,9 @@ public:
     return m_ErrorCollector && m_ErrorCollector->HasErrors();
   }
 
+  // Arena holding this parse's AST nodes
+  std::shared_ptr<QAstArena> GetArena() const { return m_Arena; }
+
   // Register external class names (e.g., from engine classes)
   void RegisterKnownClasses(const std::set<std::string> &classNames) {
     m_ClassNames.insert(classNames.begin(), classNames.end());
@@ -64,6 +72,9 @@ private:
   std::vector<std::string>
       m_CurrentTypeParams; // Track current generic parameters (T, K, V)
   std::shared_ptr<QErrorCollector> m_ErrorCollector;
+  std::shared_ptr<QAstArena> m_Arena = QAstArena::Create();
+  // Token ranges of method bodies, left out of the program's shape hash
+  std::vector<std::pair<int, int>> m_BodyRanges;
 
   // Context tracking for error reporting
   std::string m_CurrentContext;
@@ -88,6 +99,7 @@ private:
   std::shared_ptr<QAssign> ParseAssign();
   std::shared_ptr<QVariableDecl> ParseClassTypeMember();
   std::shared_ptr<QReturn> ParseReturn();
+  std::shared_ptr<QYield> ParseYield();
   std::shared_ptr<QIf> ParseIf();
   std::shared_ptr<QFor> ParseFor();
   std::shared_ptr<QWhile> ParseWhile();
@@ -96,14 +108,19 @@ private:
   std::shared_ptr<QExpression> ParseExpression();
 
   // Helper methods
-  Token Peek() const;
-  Token PeekNext() const; // Look ahead one more token
-  Token Previous() const;
-  Token Advance();
+  // Token accessors return references into m_Tokens (no string copies)
+  const Token &Peek() const;
+  const Token &PeekNext() const; // Look ahead one more token
+  const Token &Previous() const;
+  const Token &Advance();
   bool IsAtEnd() const;
   bool Check(TokenType type) const;
   Token Consume(TokenType type, const std::string &message);
   bool Match(TokenType type);
   bool IsTypeToken(TokenType type) const;
   bool IsClassName(const std::string &name) const;
+
+  // Turn vec2/vec3/vec4/mat4, yield, wait and waitUntil back into
+  // identifiers wherever they do not start their construct
+  void DemoteContextualKeywords();
 };
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+
+// Tables exported by a QLang native library. QJitRunner::CompileLibrary
+// emits them as LLVM constants and QNativeLibrary::Load reads them,
+// so the layouts below must match the IR types built there. Plain C data: the
+// loader needs no LLVM to read them.
+
+// Bump on any change to the structs below
+constexpr uint32_t QAotVersion = 1;
+
+// The one data symbol the loader looks up (a QAotManifest)
+constexpr const char *QAotManifestSymbol = "__qlang_aot_manifest";
+
+struct QAotMember {
+  const char *name;
+  uint64_t offset;
+  uint64_t size;
+  int32_t typeToken;
+  const char *typeName; // Class name for class members, else empty
+};
+
+struct QAotClass {
+  const char *name;
+  uint64_t size;
+  const char *constructorName;
+  uint32_t isStatic;
+  uint32_t memberCount;
+  const QAotMember *members;
+  void *staticInstance; // Storage in the library, for static classes
+};
+
+// A function the library calls but does not define (natives, runtime).
+// The loader stores its address in 'slot' before any script code runs.
+struct QAotImport {
+  const char *name;
+  void **slot;
+};
+
+struct QAotManifest {
+  uint32_t version; // QAotVersion
+  uint32_t classCount;
+  const QAotClass *classes;
+  uint32_t importCount;
+  const QAotImport *imports;
+};
@@ -6,6 +6,8 @@
 #include <memory>
 #include <string>
 
+class QFrameLayout;
+
 // QAssign - represents a variable assignment (e.g., val = 5; or ptr[idx] = 5;)
 class QAssign : public QNode {
 public:
@@ -16,7 +18,7 @@ public:
   }
 
   std::string GetName() const override { return "Assign"; }
-  std::string GetVariableName() const { return m_VariableName; }
+  const std::string &GetVariableName() const { return m_VariableName; }
 
   void SetValueExpression(std::shared_ptr<QExpression> expr) {
     m_ValueExpression = expr;
@@ -56,6 +58,16 @@ public:
 
   bool HasArrayInitializer() const { return !m_ArrayInitializer.empty(); }
 
+  // Frame slot of the variable, resolved by QRunner before the code runs
+  // (-1 for a frame of another layout)
+  int GetResolvedSlot(const std::shared_ptr<QFrameLayout> &layout) const {
+    return layout == m_SlotLayout ? m_Slot : -1;
+  }
+  void SetResolvedSlot(std::shared_ptr<QFrameLayout> layout, int slot) {
+    m_SlotLayout = std::move(layout);
+    m_Slot = slot;
+  }
+
   void Print(int indent = 0) const override {
     PrintIndent(indent);
     std::cout << "Assign: " << m_VariableName;
@@ -63,7 +75,7 @@ public:
       std::cout << "[";
       const auto &idxElems = m_IndexExpression->GetElements();
       for (const auto &e : idxElems) {
-        std::cout << e.value << " ";
+        std::cout << e.Text() << " ";
       }
       std::cout << "]";
     }
@@ -73,7 +85,7 @@ public:
     } else if (m_ValueExpression) {
       const auto &elems = m_ValueExpression->GetElements();
       for (const auto &e : elems) {
-        std::cout << e.value << " ";
+        std::cout << e.Text() << " ";
       }
     }
     std::cout << std::endl;
@@ -84,4 +96,6 @@ private:
   std::shared_ptr<QExpression> m_ValueExpression;
   std::shared_ptr<QExpression> m_IndexExpression; // For ptr[index] = value
   std::vector<std::shared_ptr<QExpression>> m_ArrayInitializer; // For {1,2,3}
+  std::shared_ptr<QFrameLayout> m_SlotLayout;
+  int m_Slot = -1;
 };
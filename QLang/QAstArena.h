@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+
+// QAstArena - bump allocator for the AST nodes of one compile
+//
+// Parser creates one arena per Parse() and allocates every node (and its
+// shared_ptr control block) from it with Make<T>(). Nodes keep the arena
+// alive through their allocator, so the AST can outlive the Parser and be
+// handed to QRunner/QJitRunner as before; the arena's blocks are released
+// together once the last node of that compile is destroyed.
+//
+// An arena belongs to one Parser, so allocation is not synchronized.
+class QAstArena : public std::enable_shared_from_this<QAstArena> {
+public:
+  static std::shared_ptr<QAstArena> Create() {
+    return std::shared_ptr<QAstArena>(new QAstArena());
+  }
+
+  QAstArena(const QAstArena &) = delete;
+  QAstArena &operator=(const QAstArena &) = delete;
+
+  template <typename T, typename... Args>
+  std::shared_ptr<T> Make(Args &&...args);
+
+  void *Allocate(size_t bytes, size_t alignment) {
+    m_BytesUsed += bytes;
+    return m_Resource.allocate(bytes, alignment);
+  }
+
+  size_t GetBytesUsed() const { return m_BytesUsed; }
+
+private:
+  static constexpr size_t InitialBlockBytes = 16 * 1024;
+
+  QAstArena() : m_Resource(InitialBlockBytes) {}
+
+  std::pmr::monotonic_buffer_resource m_Resource;
+  size_t m_BytesUsed = 0;
+};
+
+// Allocator that places objects in a QAstArena. Deallocation is a no-op;
+// memory returns with the arena.
+template <typename T> class QArenaAllocator {
+public:
+  using value_type = T;
+
+  explicit QArenaAllocator(std::shared_ptr<QAstArena> arena)
+      : m_Arena(std::move(arena)) {}
+
+  template <typename U>
+  QArenaAllocator(const QArenaAllocator<U> &other) : m_Arena(other.m_Arena) {}
+
+  T *allocate(size_t count) {
+    return static_cast<T *>(m_Arena->Allocate(count * sizeof(T), alignof(T)));
+  }
+
+  void deallocate(T *, size_t) {}
+
+  template <typename U> bool operator==(const QArenaAllocator<U> &other) const {
+    return m_Arena == other.m_Arena;
+  }
+  template <typename U> bool operator!=(const QArenaAllocator<U> &other) const {
+    return m_Arena != other.m_Arena;
+  }
+
+private:
+  template <typename U> friend class QArenaAllocator;
+  std::shared_ptr<QAstArena> m_Arena;
+};
+
+template <typename T, typename... Args>
+std::shared_ptr<T> QAstArena::Make(Args &&...args) {
+  return std::allocate_shared<T>(QArenaAllocator<T>(shared_from_this()),
+                                 std::forward<Args>(args)...);
+}
@@ -0,0 +1,124 @@
+#pragma once
+
+#include "QContext.h"
+#include "Tokenizer.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Register bytecode for QRunner expressions
+//
+// An expression is compiled once (operator precedence, unary minus and member
+// access folding resolved) into a flat list of three-address instructions.
+// Operands live in the constant pool, in frame slots (variables the current
+// frame layout knows) or in the token table (other variables, member chains,
+// calls and 'new', which go through QRunner::TokenToValue). Register i holds
+// the i-th entry of the RPN value stack, so the register count is the maximum
+// stack depth.
+
+// Opcodes - order must match the dispatch table in QRunner::RunExprCode
+enum class QOp : uint8_t {
+  LoadConst, // r[dst] = constants[operand]
+  LoadVar,   // r[dst] = variable named by tokens[operand]
+  LoadSlot,  // r[dst] = frame slot operand (name lookup of tokens[a] if the
+             //          frame has another layout or the slot is unassigned)
+  EvalToken, // r[dst] = TokenToValue(tokens[operand])
+  Add,       // r[dst] = r[a] + r[b]
+  Sub,
+  Mul,
+  Div,
+  Eq,
+  Ne,
+  Lt,
+  Gt,
+  Le,
+  Ge,
+  And,
+  Or,
+  Generic, // r[dst] = ApplyOperator(r[a], operators[operand], r[b])
+  Return,  // return r[a]
+  Count
+};
+
+struct QInstr {
+  QOp op = QOp::Return;
+  uint16_t dst = 0;
+  uint16_t a = 0;
+  uint16_t b = 0;
+  uint32_t operand = 0;
+};
+
+struct QExprCode {
+  std::vector<QInstr> code;
+  std::vector<QValue> constants;
+  std::vector<Token> tokens;
+  std::vector<std::string> operators;
+  std::shared_ptr<QFrameLayout> layout; // Layout LoadSlot was resolved against
+  uint16_t registerCount = 0;
+  bool valid = false; // False: evaluate through the RPN interpreter instead
+
+  // Expressions up to this depth run on the VM's stack-allocated registers
+  static constexpr uint16_t InlineRegisters = 16;
+
+  // Map a binary operator to its opcode (Generic if it has no fast path)
+  static QOp OpcodeFor(const std::string &op) {
+    if (op == "+")
+      return QOp::Add;
+    if (op == "-")
+      return QOp::Sub;
+    if (op == "*")
+      return QOp::Mul;
+    if (op == "/")
+      return QOp::Div;
+    if (op == "==")
+      return QOp::Eq;
+    if (op == "!=")
+      return QOp::Ne;
+    if (op == "<")
+      return QOp::Lt;
+    if (op == ">")
+      return QOp::Gt;
+    if (op == "<=")
+      return QOp::Le;
+    if (op == ">=")
+      return QOp::Ge;
+    if (op == "&&")
+      return QOp::And;
+    if (op == "||")
+      return QOp::Or;
+    return QOp::Generic;
+  }
+
+  // Operator text for an opcode (used when a fast path does not apply)
+  static const char *OperatorText(QOp op) {
+    switch (op) {
+    case QOp::Add:
+      return "+";
+    case QOp::Sub:
+      return "-";
+    case QOp::Mul:
+      return "*";
+    case QOp::Div:
+      return "/";
+    case QOp::Eq:
+      return "==";
+    case QOp::Ne:
+      return "!=";
+    case QOp::Lt:
+      return "<";
+    case QOp::Gt:
+      return ">";
+    case QOp::Le:
+      return "<=";
+    case QOp::Ge:
+      return ">=";
+    case QOp::And:
+      return "&&";
+    case QOp::Or:
+      return "||";
+    default:
+      return "";
+    }
+  }
+};
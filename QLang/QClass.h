@@ -9,6 +9,8 @@
 #include <string>
 #include <vector>
 
+class QFrameLayout;
+
 // QClass - represents a class definition with instance variables and methods
 class QClass : public QActionNode {
 public:
@@ -73,6 +75,19 @@ public:
   void SetStatic(bool isStatic) { m_IsStatic = isStatic; }
   bool IsStatic() const { return m_IsStatic; }
 
+  // Value class ('struct'): small math types whose methods are always
+  // inlined, so temporaries they return never reach the heap
+  void SetValueType(bool isValue) { m_IsValueType = isValue; }
+  bool IsValueType() const { return m_IsValueType; }
+
+  // Slots of the instance members (inherited ones first), see QClassInstance
+  std::shared_ptr<QFrameLayout> GetMemberLayout() const {
+    return m_MemberLayout;
+  }
+  void SetMemberLayout(std::shared_ptr<QFrameLayout> layout) {
+    m_MemberLayout = std::move(layout);
+  }
+
   void CheckForErrors(std::shared_ptr<QErrorCollector> collector) override {
     for (const auto &member : m_Members) {
       if (member)
@@ -89,7 +104,7 @@ public:
     if (m_IsStatic) {
       std::cout << "Static ";
     }
-    std::cout << "Class: " << m_Name;
+    std::cout << (m_IsValueType ? "Struct: " : "Class: ") << m_Name;
     if (HasParent()) {
       std::cout << " extends " << m_ParentClassName;
     }
@@ -125,4 +140,6 @@ private:
   std::vector<std::shared_ptr<QVariableDecl>> m_Members;
   std::vector<std::shared_ptr<QMethod>> m_Methods;
   bool m_IsStatic = false; // True if this is a static class (singleton)
+  bool m_IsValueType = false; // True if declared with 'struct'
+  std::shared_ptr<QFrameLayout> m_MemberLayout;
 };
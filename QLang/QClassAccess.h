@@ -0,0 +1,18 @@
+#pragma once
+
+#include <set>
+#include <string>
+
+// What the methods of one class touch beyond their own instance, recorded by
+// QJitRunner while compiling (and stored in .qm files). The engine uses it to
+// decide whether the class may update in the parallel phase, see
+// QJitRunner::IsParallelSafe.
+struct QClassAccess {
+  std::set<std::string> natives; // Natives called
+  std::set<std::string> classes; // Classes whose methods run on other instances
+  // Classes whose methods run only on objects the calling method allocated
+  // itself (see QLocalConstants::IsLocalAllocation)
+  std::set<std::string> localClasses;
+  bool writesShared = false; // Assigns members of other instances or statics
+  bool writesSelf = false;   // Assigns its own members outside constructors
+};
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "QClass.h"
+#include "QContext.h"
 #include "QVariableDecl.h"
 #include "Tokenizer.h"
 #include <cstdint>
@@ -16,14 +17,25 @@ using QInstanceValue = std::variant<std::monostate, bool, int32_t, int64_t,
                                     float, double, std::string, void *>;
 
 // QClassInstance - represents a runtime instance of a QClass
+// Members live in slots of the class's member layout; a member holding a
+// class instance is a nested instance.
 class QClassInstance {
 public:
   QClassInstance(std::shared_ptr<QClass> classDef)
-      : m_ClassDef(classDef), m_ClassName(classDef->GetName()) {
+      : m_ClassDef(classDef), m_ClassName(classDef->GetName()),
+        m_Layout(classDef->GetMemberLayout()) {
 #if QLANG_DEBUG
     std::cout << "[DEBUG] QClassInstance created for class: " << m_ClassName
               << std::endl;
 #endif
+    if (!m_Layout) {
+      // Not resolved by a runner yet: the class's own members only
+      m_Layout = std::make_shared<QFrameLayout>("members:" + m_ClassName);
+      for (const auto &member : classDef->GetMembers()) {
+        m_Layout->Add(member->GetName());
+      }
+      classDef->SetMemberLayout(m_Layout);
+    }
     InitializeMembers();
   }
 
@@ -33,9 +45,42 @@ public:
   // Get the class definition
   std::shared_ptr<QClass> GetClassDef() const { return m_ClassDef; }
 
+  // ========== Slots ==========
+
+  const std::shared_ptr<QFrameLayout> &GetMemberLayout() const {
+    return m_Layout;
+  }
+
+  // Value of a member slot, nullptr if it was never set
+  const QValue *GetMemberSlot(uint32_t slot) const {
+    return slot < m_Values.assigned.size() && m_Values.assigned[slot]
+               ? &m_Values.slots[slot]
+               : nullptr;
+  }
+
+  void SetMemberSlot(uint32_t slot, QValue value) {
+    if (slot >= m_Values.slots.size()) {
+      m_Values.Resize(m_Layout->Size());
+    }
+    m_Values.slots[slot] = std::move(value);
+    m_Values.assigned[slot] = true;
+  }
+
+  // Visit every member that is set, nested instances included
+  template <typename Fn> void ForEachMember(Fn &&fn) const {
+    for (size_t slot = 0; slot < m_Values.assigned.size(); ++slot) {
+      if (m_Values.assigned[slot])
+        fn(m_Layout->GetSlotName(static_cast<uint32_t>(slot)),
+           m_Values.slots[slot]);
+    }
+  }
+
+  // ========== Members by name ==========
+
   // Set a member variable value
   void SetMember(const std::string &name, const QInstanceValue &value) {
-    m_Members[name] = value;
+    SetMemberSlot(m_Layout->Add(name),
+                  std::visit([](const auto &v) -> QValue { return v; }, value));
 #if QLANG_DEBUG
     std::cout << "[DEBUG] QClassInstance(" << m_ClassName
               << ") - set member: " << name << std::endl;
@@ -44,9 +89,9 @@ public:
 
   // Get a member variable value
   QInstanceValue GetMember(const std::string &name) const {
-    auto it = m_Members.find(name);
-    if (it != m_Members.end()) {
-      return it->second;
+    const QValue *value = FindMember(name);
+    if (value && !IsInstance(*value)) {
+      return ToInstanceValue(*value);
     }
     std::cerr << "[ERROR] QClassInstance(" << m_ClassName << ") - member '"
               << name << "' not found!" << std::endl;
@@ -55,25 +100,24 @@ public:
 
   // Check if a member exists (including nested instances)
   bool HasMember(const std::string &name) const {
-    return m_Members.find(name) != m_Members.end() ||
-           m_NestedInstances.find(name) != m_NestedInstances.end();
+    return FindMember(name) != nullptr;
   }
 
-  // Get all members (for debugging)
-  const std::unordered_map<std::string, QInstanceValue> &GetMembers() const {
-    return m_Members;
+  // Get all members that are not nested instances
+  std::vector<std::pair<std::string, QInstanceValue>> GetMembers() const {
+    std::vector<std::pair<std::string, QInstanceValue>> members;
+    ForEachMember([&](const std::string &name, const QValue &value) {
+      if (!IsInstance(value))
+        members.emplace_back(name, ToInstanceValue(value));
+    });
+    return members;
   }
 
   // Set a nested class instance member
   void SetNestedInstance(const std::string &name,
                          std::shared_ptr<QClassInstance> instance) {
-    m_NestedInstances[name] = instance;
-
-    // Remove from primitive members if it was shadowing/occupying the name
-    auto it = m_Members.find(name);
-    if (it != m_Members.end()) {
-      m_Members.erase(it);
-    }
+    // Replaces a primitive value of the same name
+    SetMemberSlot(m_Layout->Add(name), std::move(instance));
 
 #if QLANG_DEBUG
     std::cout << "[DEBUG] QClassInstance(" << m_ClassName
@@ -84,22 +128,36 @@ public:
   // Get a nested class instance member
   std::shared_ptr<QClassInstance>
   GetNestedInstance(const std::string &name) const {
-    auto it = m_NestedInstances.find(name);
-    if (it != m_NestedInstances.end()) {
-      return it->second;
+    const QValue *value = FindMember(name);
+    if (value && IsInstance(*value)) {
+      return std::get<std::shared_ptr<QClassInstance>>(*value);
     }
     return nullptr;
   }
 
   // Check if a nested instance exists
   bool HasNestedInstance(const std::string &name) const {
-    return m_NestedInstances.find(name) != m_NestedInstances.end();
+    const QValue *value = FindMember(name);
+    return value && IsInstance(*value);
+  }
+
+  // Get all nested instances
+  std::vector<std::pair<std::string, std::shared_ptr<QClassInstance>>>
+  GetNestedInstances() const {
+    std::vector<std::pair<std::string, std::shared_ptr<QClassInstance>>>
+        nested;
+    ForEachMember([&](const std::string &name, const QValue &value) {
+      if (IsInstance(value))
+        nested.emplace_back(
+            name, std::get<std::shared_ptr<QClassInstance>>(value));
+    });
+    return nested;
   }
 
   // Get all nested instance names
   std::vector<std::string> GetNestedInstanceNames() const {
     std::vector<std::string> names;
-    for (const auto &[name, instance] : m_NestedInstances) {
+    for (const auto &[name, instance] : GetNestedInstances()) {
       names.push_back(name);
     }
     return names;
@@ -108,16 +166,16 @@ public:
   // Clone this instance (deep copy of members)
   std::shared_ptr<QClassInstance> Clone() const {
     auto newInst = std::make_shared<QClassInstance>(m_ClassDef);
+    newInst->m_Layout = m_Layout;
+    newInst->m_Values = m_Values;
 
-    // Copy members
-    for (const auto &[name, val] : m_Members) {
-      newInst->SetMember(name, val);
-    }
-
-    // Copy nested instances (recursive clone)
-    for (const auto &[name, inst] : m_NestedInstances) {
-      if (inst) {
-        newInst->SetNestedInstance(name, inst->Clone());
+    // Nested instances are cloned too (recursive)
+    for (auto &value : newInst->m_Values.slots) {
+      if (IsInstance(value)) {
+        auto &inst = std::get<std::shared_ptr<QClassInstance>>(value);
+        if (inst) {
+          inst = inst->Clone();
+        }
       }
     }
 
@@ -127,7 +185,7 @@ public:
   // Print the instance (for debugging)
   void Print() const {
     std::cout << "Instance of " << m_ClassName << " {" << std::endl;
-    for (const auto &[name, value] : m_Members) {
+    for (const auto &[name, value] : GetMembers()) {
       std::cout << "  " << name << " = ";
       std::visit(
           [](auto &&arg) {
@@ -169,12 +227,34 @@ public:
 private:
   std::shared_ptr<QClass> m_ClassDef;
   std::string m_ClassName;
-  std::unordered_map<std::string, QInstanceValue> m_Members;
-  std::unordered_map<std::string, std::shared_ptr<QClassInstance>>
-      m_NestedInstances;
+  std::shared_ptr<QFrameLayout> m_Layout; // Shared by the class's instances
+  QFrame m_Values;
   std::unordered_map<std::string, std::string>
       m_TypeMapping; // Generic type mapping
 
+  const QValue *FindMember(const std::string &name) const {
+    int slot = m_Layout->Find(name);
+    return slot >= 0 ? GetMemberSlot(static_cast<uint32_t>(slot)) : nullptr;
+  }
+
+  static bool IsInstance(const QValue &value) {
+    return std::holds_alternative<std::shared_ptr<QClassInstance>>(value);
+  }
+
+  // Nested instances have no QInstanceValue form
+  static QInstanceValue ToInstanceValue(const QValue &value) {
+    return std::visit(
+        [](const auto &v) -> QInstanceValue {
+          using T = std::decay_t<decltype(v)>;
+          if constexpr (std::is_same_v<T, std::shared_ptr<QClassInstance>>) {
+            return std::monostate{};
+          } else {
+            return v;
+          }
+        },
+        value);
+  }
+
   // Initialize member variables with default values from class definition
   void InitializeMembers() {
 #if QLANG_DEBUG
@@ -215,7 +295,7 @@ private:
         break;
       }
 
-      m_Members[memberName] = defaultVal;
+      SetMember(memberName, defaultVal);
 #if QLANG_DEBUG
       std::cout << "[DEBUG] QClassInstance - initialized member: " << memberName
                 << std::endl;
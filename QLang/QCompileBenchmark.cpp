@@ -0,0 +1,129 @@
+#include "QCompileBenchmark.h"
+#include "Parser.h"
+#include "QValidator.h"
+#include "Tokenizer.h"
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <set>
+#include <sstream>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double ElapsedMs(Clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(Clock::now() - start)
+      .count();
+}
+
+} // namespace
+
+double QCompileBenchmarkResult::TokensPerSecond() const {
+  double seconds = TotalMs() / 1000.0;
+  return seconds > 0.0 ? static_cast<double>(tokens) * iterations / seconds
+                       : 0.0;
+}
+
+double QCompileBenchmarkResult::LinesPerSecond() const {
+  double seconds = TotalMs() / 1000.0;
+  return seconds > 0.0 ? static_cast<double>(lines) * iterations / seconds
+                       : 0.0;
+}
+
+QCompileBenchmarkResult
+QCompileBenchmark::Run(const std::vector<std::string> &files, int iterations) {
+  QCompileBenchmarkResult result;
+  result.iterations = std::max(iterations, 1);
+
+  std::vector<std::string> sources;
+  for (const auto &file : files) {
+    std::ifstream in(file, std::ios::binary);
+    if (!in) {
+      std::cerr << "[ERROR] QCompileBenchmark: cannot read " << file
+                << std::endl;
+      continue;
+    }
+    std::stringstream buffer;
+    buffer << in.rdbuf();
+    sources.push_back(buffer.str());
+
+    const std::string &source = sources.back();
+    result.bytes += source.size();
+    result.lines += std::count(source.begin(), source.end(), '\n') + 1;
+  }
+  result.files = sources.size();
+
+  for (int iteration = 0; iteration < result.iterations; ++iteration) {
+    auto errors = std::make_shared<QErrorCollector>();
+    std::vector<std::shared_ptr<QProgram>> programs;
+    size_t tokens = 0;
+    size_t astBytes = 0;
+
+    for (const auto &source : sources) {
+      auto start = Clock::now();
+      Tokenizer tokenizer(source, true, errors);
+      tokenizer.Tokenize();
+      tokens += tokenizer.GetTokens().size();
+      result.tokenizeMs += ElapsedMs(start);
+
+      start = Clock::now();
+      Parser parser(tokenizer.TakeTokens(), errors);
+      programs.push_back(parser.Parse());
+      astBytes += parser.GetArena()->GetBytesUsed();
+      result.parseMs += ElapsedMs(start);
+    }
+
+    std::set<std::string> classNames;
+    for (const auto &program : programs) {
+      for (const auto &cls : program->GetClasses()) {
+        classNames.insert(cls->GetName());
+      }
+    }
+
+    auto start = Clock::now();
+    for (const auto &program : programs) {
+      QValidator validator(errors);
+      validator.RegisterKnownClasses(classNames);
+      validator.Validate(program);
+    }
+    result.validateMs += ElapsedMs(start);
+
+    result.tokens = tokens;
+    result.astBytes = astBytes;
+    result.errors = static_cast<size_t>(errors->GetErrorCount());
+  }
+
+  return result;
+}
+
+QCompileBenchmarkResult
+QCompileBenchmark::RunDirectory(const std::string &directory, int iterations) {
+  std::vector<std::string> files;
+  std::error_code ec;
+  for (const auto &entry :
+       std::filesystem::recursive_directory_iterator(directory, ec)) {
+    if (entry.is_regular_file() && entry.path().extension() == ".q") {
+      files.push_back(entry.path().string());
+    }
+  }
+  std::sort(files.begin(), files.end());
+  return Run(files, iterations);
+}
+
+void QCompileBenchmark::Print(const QCompileBenchmarkResult &result,
+                              std::ostream &out) {
+  double perIteration = result.iterations > 0 ? result.iterations : 1;
+  out << "QCompileBenchmark: " << result.files << " files, " << result.lines
+      << " lines, " << result.tokens << " tokens, " << result.bytes
+      << " bytes x " << result.iterations << " iterations" << std::endl;
+  out << "  tokenize " << result.tokenizeMs / perIteration << " ms, parse "
+      << result.parseMs / perIteration << " ms, validate "
+      << result.validateMs / perIteration << " ms (per iteration)"
+      << std::endl;
+  out << "  " << static_cast<size_t>(result.TokensPerSecond())
+      << " tokens/s, " << static_cast<size_t>(result.LinesPerSecond())
+      << " lines/s, AST arena " << result.astBytes / 1024 << " KB, "
+      << result.errors << " errors" << std::endl;
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Timings for the front end (Tokenizer -> Parser -> QValidator) over a set of
+// scripts, summed over all iterations
+struct QCompileBenchmarkResult {
+  size_t files = 0;
+  size_t lines = 0; // Per iteration
+  size_t bytes = 0;
+  size_t tokens = 0;
+  size_t astBytes = 0; // Arena bytes per iteration
+  size_t errors = 0;   // Reported by the last iteration
+  int iterations = 0;
+  double tokenizeMs = 0.0;
+  double parseMs = 0.0;
+  double validateMs = 0.0;
+
+  double TotalMs() const { return tokenizeMs + parseMs + validateMs; }
+  double TokensPerSecond() const;
+  double LinesPerSecond() const;
+};
+
+// QCompileBenchmark - measures script front-end throughput
+//
+// Sources are read once up front, so only tokenizing, parsing and validation
+// are timed. Each file is compiled on its own, as QJitRunner::CompileScript
+// does; classes declared by any of the files are registered with the
+// validator so cross-file references resolve.
+class QCompileBenchmark {
+public:
+  static QCompileBenchmarkResult Run(const std::vector<std::string> &files,
+                                     int iterations = 5);
+
+  // All *.q files below a directory
+  static QCompileBenchmarkResult RunDirectory(const std::string &directory,
+                                              int iterations = 5);
+
+  static void Print(const QCompileBenchmarkResult &result,
+                    std::ostream &out = std::cout);
+};
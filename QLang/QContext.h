@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <functional>
 #include <iostream>
 #include <memory>
@@ -80,13 +81,141 @@ inline std::string ValueToString(const QValue &value) {
   return "unknown";
 }
 
+// QFrameLayout - maps variable names to frame slots
+// One layout is shared by every activation of a method (resolved from its
+// parameters, members and locals before it first runs); names that only
+// appear at runtime are appended, so the layout only ever grows.
+// Instance members use layouts too: a derived class's layout starts with a
+// copy of its parent's, so the parent's slots index both.
+class QFrameLayout {
+public:
+  // A frame slot that mirrors an instance member slot
+  struct MemberBinding {
+    uint32_t frameSlot;
+    uint32_t memberSlot;
+  };
+
+  explicit QFrameLayout(const std::string &name = "root") : m_Name(name) {}
+
+  QFrameLayout(const std::string &name,
+               std::shared_ptr<const QFrameLayout> base)
+      : m_Name(name), m_Base(std::move(base)) {
+    if (m_Base) {
+      m_Slots = m_Base->m_Slots;
+      m_Names = m_Base->m_Names;
+    }
+  }
+
+  const std::string &GetName() const { return m_Name; }
+
+  // Slot of a name, or -1 if the layout does not have it
+  int Find(const std::string &name) const {
+    auto it = m_Slots.find(name);
+    return it != m_Slots.end() ? static_cast<int>(it->second) : -1;
+  }
+
+  // Slot of a name, adding it if needed
+  uint32_t Add(const std::string &name) {
+    auto it = m_Slots.find(name);
+    if (it != m_Slots.end())
+      return it->second;
+    uint32_t slot = static_cast<uint32_t>(m_Names.size());
+    m_Slots.emplace(name, slot);
+    m_Names.push_back(name);
+    return slot;
+  }
+
+  const std::string &GetSlotName(uint32_t slot) const { return m_Names[slot]; }
+  size_t Size() const { return m_Names.size(); }
+
+  // True if this is the layout, or starts with a copy of it
+  bool Extends(const QFrameLayout *layout) const {
+    for (const QFrameLayout *l = this; l; l = l->m_Base.get()) {
+      if (l == layout)
+        return true;
+    }
+    return false;
+  }
+
+  // Method frames: the member layout the bindings index and how many of its
+  // slots they cover (later slots were added at runtime and go by name)
+  void BindMembers(std::shared_ptr<const QFrameLayout> members,
+                   std::vector<MemberBinding> bindings) {
+    m_BoundMemberCount = members ? members->Size() : 0;
+    m_MemberLayout = std::move(members);
+    m_MemberBindings = std::move(bindings);
+  }
+  const QFrameLayout *GetMemberLayout() const { return m_MemberLayout.get(); }
+  const std::vector<MemberBinding> &GetMemberBindings() const {
+    return m_MemberBindings;
+  }
+  size_t GetBoundMemberCount() const { return m_BoundMemberCount; }
+
+private:
+  std::string m_Name;
+  std::unordered_map<std::string, uint32_t> m_Slots;
+  std::vector<std::string> m_Names;
+  std::shared_ptr<const QFrameLayout> m_Base;
+  std::shared_ptr<const QFrameLayout> m_MemberLayout;
+  std::vector<MemberBinding> m_MemberBindings;
+  size_t m_BoundMemberCount = 0;
+};
+
+// QFrame - slot storage of one context; a slot only counts as a variable
+// once it has been assigned
+struct QFrame {
+  std::vector<QValue> slots;
+  std::vector<bool> assigned;
+
+  void Resize(size_t size) {
+    slots.resize(size);
+    assigned.resize(size, false);
+  }
+};
+
+// QFramePool - recycles frames between method calls
+// Per thread, as runners are not shared between threads.
+class QFramePool {
+public:
+  static QFrame Acquire(size_t size) {
+    auto &free = FreeList();
+    QFrame frame;
+    if (!free.empty()) {
+      frame = std::move(free.back());
+      free.pop_back();
+    }
+    frame.Resize(size);
+    return frame;
+  }
+
+  static void Release(QFrame &&frame) {
+    auto &free = FreeList();
+    if (free.size() >= MaxPooled)
+      return;
+    // Drops strings/instances now, keeps the capacity
+    frame.slots.clear();
+    frame.assigned.clear();
+    free.push_back(std::move(frame));
+  }
+
+private:
+  static constexpr size_t MaxPooled = 64;
+
+  static std::vector<QFrame> &FreeList() {
+    thread_local std::vector<QFrame> free;
+    return free;
+  }
+};
+
 // QContext - manages variable scopes for program execution
 // Supports nested contexts for method calls (local scope -> member scope ->
 // parent scope)
 class QContext {
 public:
   // Create a root context (no parent)
-  QContext(const std::string &name = "root") : m_Name(name), m_Parent(nullptr) {
+  QContext(const std::string &name = "root")
+      : m_Name(name), m_Parent(nullptr),
+        m_Layout(std::make_shared<QFrameLayout>(name)) {
 #if QLANG_DEBUG
     std::cout << "[DEBUG] QContext created: " << name << std::endl;
 #endif
@@ -94,7 +223,14 @@ public:
 
   // Create a child context with a parent
   QContext(const std::string &name, std::shared_ptr<QContext> parent)
-      : m_Name(name), m_Parent(parent) {
+      : QContext(name, parent, std::make_shared<QFrameLayout>(name)) {}
+
+  // Create a child context whose variables live in slots of a shared layout
+  // (method frames); the slot storage comes from QFramePool
+  QContext(const std::string &name, std::shared_ptr<QContext> parent,
+           std::shared_ptr<QFrameLayout> layout)
+      : m_Name(name), m_Parent(parent), m_Layout(std::move(layout)),
+        m_Frame(QFramePool::Acquire(m_Layout->Size())) {
 #if QLANG_DEBUG
     std::cout << "[DEBUG] QContext created: " << name
               << " (parent: " << parent->GetName() << ")" << std::endl;
@@ -102,21 +238,70 @@ public:
   }
 
   ~QContext() {
+    QFramePool::Release(std::move(m_Frame));
 #if QLANG_DEBUG
     std::cout << "[DEBUG] QContext destroyed: " << m_Name << std::endl;
 #endif
   }
 
+  QContext(const QContext &) = delete;
+  QContext &operator=(const QContext &) = delete;
+
   const std::string &GetName() const { return m_Name; }
 
   // Get all variables in this context only
-  const std::unordered_map<std::string, QValue> &GetAllVariables() const {
-    return m_Variables;
+  std::unordered_map<std::string, QValue> GetAllVariables() const {
+    std::unordered_map<std::string, QValue> variables;
+    ForEachVariable([&](const std::string &name, const QValue &value) {
+      variables.emplace(name, value);
+    });
+    return variables;
+  }
+
+  // Visit the variables of this context only (no copies)
+  template <typename Fn> void ForEachVariable(Fn &&fn) const {
+    for (size_t slot = 0; slot < m_Frame.assigned.size(); ++slot) {
+      if (m_Frame.assigned[slot])
+        fn(m_Layout->GetSlotName(static_cast<uint32_t>(slot)),
+           m_Frame.slots[slot]);
+    }
+  }
+
+  // ========== Slots ==========
+
+  const std::shared_ptr<QFrameLayout> &GetLayout() const { return m_Layout; }
+
+  // Value in a slot of this context, nullptr if it was never assigned
+  const QValue *GetSlot(uint32_t slot) const {
+    return slot < m_Frame.assigned.size() && m_Frame.assigned[slot]
+               ? &m_Frame.slots[slot]
+               : nullptr;
+  }
+
+  // By value: a temporary string or instance moves into the slot
+  void SetSlot(uint32_t slot, QValue value) {
+    if (slot >= m_Frame.slots.size()) {
+      m_Frame.Resize(m_Layout->Size()); // The layout grew after frame creation
+    }
+    m_Frame.slots[slot] = std::move(value);
+    m_Frame.assigned[slot] = true;
+  }
+
+  // Find a variable without copying it - searches parent contexts too
+  const QValue *FindVariable(const std::string &name) const {
+    for (const QContext *ctx = this; ctx; ctx = ctx->m_Parent.get()) {
+      int slot = ctx->m_Layout->Find(name);
+      if (slot >= 0) {
+        if (const QValue *value = ctx->GetSlot(static_cast<uint32_t>(slot)))
+          return value;
+      }
+    }
+    return nullptr;
   }
 
   // Set a variable in this context
   void SetVariable(const std::string &name, const QValue &value) {
-    m_Variables[name] = value;
+    SetSlot(m_Layout->Add(name), value);
 #if QLANG_DEBUG
     std::cout << "[DEBUG] QContext(" << m_Name << ") - set variable: " << name
               << " = " << ValueToString(value) << " ("
@@ -126,14 +311,15 @@ public:
 
   // Get a variable - searches this context first, then parent contexts
   QValue GetVariable(const std::string &name) const {
-    auto it = m_Variables.find(name);
-    if (it != m_Variables.end()) {
+    int slot = m_Layout->Find(name);
+    if (const QValue *value =
+            slot >= 0 ? GetSlot(static_cast<uint32_t>(slot)) : nullptr) {
 #if QLANG_DEBUG
       std::cout << "[DEBUG] QContext(" << m_Name
                 << ") - found variable: " << name << " = "
-                << ValueToString(it->second) << std::endl;
+                << ValueToString(*value) << std::endl;
 #endif
-      return it->second;
+      return *value;
     }
 
     // Search parent context
@@ -154,16 +340,13 @@ public:
 
   // Check if a variable exists in this context (not parents)
   bool HasLocalVariable(const std::string &name) const {
-    return m_Variables.find(name) != m_Variables.end();
+    int slot = m_Layout->Find(name);
+    return slot >= 0 && GetSlot(static_cast<uint32_t>(slot));
   }
 
   // Check if a variable exists in this context or any parent
   bool HasVariable(const std::string &name) const {
-    if (HasLocalVariable(name))
-      return true;
-    if (m_Parent)
-      return m_Parent->HasVariable(name);
-    return false;
+    return FindVariable(name) != nullptr;
   }
 
   // ========== Native Function Support ==========
@@ -237,10 +420,10 @@ public:
   void PrintVariables(int indent = 0) const {
     std::string indentStr(indent * 2, ' ');
     std::cout << indentStr << "Context: " << m_Name << " {" << std::endl;
-    for (const auto &[name, value] : m_Variables) {
+    ForEachVariable([&](const std::string &name, const QValue &value) {
       std::cout << indentStr << "  " << name << " = " << ValueToString(value)
                 << " (" << GetValueTypeName(value) << ")" << std::endl;
-    }
+    });
     std::cout << indentStr << "  Functions: ";
     for (const auto &[name, func] : m_Functions) {
       std::cout << name << " ";
@@ -257,6 +440,9 @@ public:
 private:
   std::string m_Name;
   std::shared_ptr<QContext> m_Parent;
-  std::unordered_map<std::string, QValue> m_Variables;
+
+  // Variables: names resolve to slots of m_Frame through the layout
+  std::shared_ptr<QFrameLayout> m_Layout;
+  QFrame m_Frame;
   std::unordered_map<std::string, QNativeFunc> m_Functions;
 };
@@ -0,0 +1,138 @@
+#include "QCoroutineScheduler.h"
+#include "QHeap.h"
+#include <algorithm>
+#include <cmath>
+
+QCoroutineScheduler &QCoroutineScheduler::Get() {
+  static QCoroutineScheduler scheduler;
+  return scheduler;
+}
+
+uint64_t QCoroutineScheduler::SlotOf(double time) const {
+  return static_cast<uint64_t>(std::floor(time / SlotSeconds));
+}
+
+void QCoroutineScheduler::Resume(void *frame) {
+  // Switch-resumed coroutine frames start with the resume function
+  using ResumeFn = void (*)(void *);
+  ResumeFn resume = *static_cast<ResumeFn *>(frame);
+  resume(frame);
+}
+
+void QCoroutineScheduler::ScheduleNextFrame(void *frame, void *owner) {
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  QHeap::Get().AddRoot(frame);
+  m_NextFrame.push_back({frame, owner, m_Time});
+  ++m_Suspended;
+}
+
+void QCoroutineScheduler::ScheduleAfter(void *frame, void *owner,
+                                        float seconds) {
+  if (!(seconds > 0.0f)) {
+    ScheduleNextFrame(frame, owner);
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  QHeap::Get().AddRoot(frame);
+  double deadline = m_Time + seconds;
+  uint64_t slot = std::max(SlotOf(deadline), m_NextSlot);
+  m_Wheel[slot % WheelSlots].push_back({frame, owner, deadline});
+  ++m_Suspended;
+}
+
+void QCoroutineScheduler::Tick(float dt) {
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Time += dt;
+    m_Due.clear();
+    m_Due.swap(m_NextFrame);
+
+    // Visit the slots passed since the last tick (a long frame visits each
+    // slot once). The current slot is visited again next tick, as it may
+    // still hold waits that end later within it.
+    uint64_t current = SlotOf(m_Time);
+    uint64_t last = std::min(current, m_NextSlot + WheelSlots - 1);
+    for (uint64_t slot = m_NextSlot; slot <= last; ++slot) {
+      auto &bucket = m_Wheel[slot % WheelSlots];
+      for (size_t i = 0; i < bucket.size();) {
+        if (bucket[i].deadline <= m_Time) {
+          m_Due.push_back(bucket[i]);
+          bucket[i] = bucket.back();
+          bucket.pop_back();
+        } else {
+          ++i;
+        }
+      }
+    }
+    m_NextSlot = current;
+    m_Suspended -= m_Due.size();
+  }
+
+  // Resumed without the lock: coroutines schedule themselves again (or
+  // cancel others) from in here
+  for (size_t i = 0; i < m_Due.size(); ++i) {
+    void *frame = m_Due[i].frame;
+    if (!frame)
+      continue; // Cancelled by an earlier coroutine this tick
+    QHeap::Get().RemoveRoot(frame);
+    Resume(frame);
+  }
+  m_Due.clear();
+}
+
+void QCoroutineScheduler::DropLocked(Entry &entry) {
+  QHeap::Get().RemoveRoot(entry.frame);
+  entry.frame = nullptr;
+}
+
+void QCoroutineScheduler::Cancel(void *owner) {
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  auto cancel = [this, owner](std::vector<Entry> &entries) {
+    auto removed = std::remove_if(
+        entries.begin(), entries.end(), [this, owner](Entry &entry) {
+          if (entry.owner != owner)
+            return false;
+          DropLocked(entry);
+          --m_Suspended;
+          return true;
+        });
+    entries.erase(removed, entries.end());
+  };
+  cancel(m_NextFrame);
+  for (auto &bucket : m_Wheel) {
+    cancel(bucket);
+  }
+
+  // Due this tick but not resumed yet
+  for (auto &entry : m_Due) {
+    if (entry.frame && entry.owner == owner) {
+      DropLocked(entry);
+    }
+  }
+}
+
+void QCoroutineScheduler::Clear() {
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  for (auto &entry : m_NextFrame) {
+    DropLocked(entry);
+  }
+  m_NextFrame.clear();
+  for (auto &bucket : m_Wheel) {
+    for (auto &entry : bucket) {
+      DropLocked(entry);
+    }
+    bucket.clear();
+  }
+  for (auto &entry : m_Due) {
+    if (entry.frame) {
+      DropLocked(entry);
+    }
+  }
+  m_Suspended = 0;
+}
+
+size_t QCoroutineScheduler::GetSuspendedCount() const {
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  return m_Suspended;
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+// QCoroutineScheduler - resumes suspended QLang coroutines
+//
+// A method using yield / wait / waitUntil is compiled as an LLVM coroutine
+// (switch-resumed ABI). At each suspension point the coroutine registers its
+// frame here (ScheduleNextFrame / ScheduleAfter) and returns to its caller;
+// Tick resumes it later. Timed waits go into a timer wheel, so a frame only
+// visits the slots that came due, and idle coroutines cost nothing.
+//
+// Frames are QHeap objects. While suspended a frame is a heap root, which
+// keeps its 'this' and the objects its locals reference alive; once it has
+// been resumed and finishes, nothing references it and the next collection
+// reclaims it.
+class QCoroutineScheduler {
+public:
+  static QCoroutineScheduler &Get();
+
+  QCoroutineScheduler(const QCoroutineScheduler &) = delete;
+  QCoroutineScheduler &operator=(const QCoroutineScheduler &) = delete;
+
+  // Called by script code right before it suspends. 'owner' is the 'this'
+  // of the coroutine method (see Cancel). Thread-safe.
+  void ScheduleNextFrame(void *frame, void *owner);
+  void ScheduleAfter(void *frame, void *owner, float seconds);
+
+  // Advance time and resume every coroutine that is due. Call once per frame
+  // on the main thread while no script code is on the stack.
+  void Tick(float dt);
+
+  // Drop the coroutines of one script instance without resuming them, e.g.
+  // when it is destroyed or rebound to newly compiled code
+  void Cancel(void *owner);
+
+  // Drop every suspended coroutine (scene stop)
+  void Clear();
+
+  size_t GetSuspendedCount() const;
+
+private:
+  QCoroutineScheduler() = default;
+
+  struct Entry {
+    void *frame = nullptr;
+    void *owner = nullptr;
+    double deadline = 0.0;
+  };
+
+  // 256 slots of 1/64 s: waits up to 4 s land in their slot directly; longer
+  // ones stay in their slot for extra turns of the wheel
+  static constexpr size_t WheelSlots = 256;
+  static constexpr double SlotSeconds = 1.0 / 64.0;
+
+  uint64_t SlotOf(double time) const;
+  static void Resume(void *frame);
+  void DropLocked(Entry &entry);
+
+  mutable std::mutex m_Mutex;
+  double m_Time = 0.0;
+  uint64_t m_NextSlot = 0; // First wheel tick not yet processed
+  std::vector<Entry> m_Wheel[WheelSlots];
+  std::vector<Entry> m_NextFrame;
+  std::vector<Entry> m_Due; // Reused by Tick
+  size_t m_Suspended = 0;
+};
@@ -5,8 +5,12 @@
 #include "Tokenizer.h"
 #include <cstdint>
 #include <iostream>
+#include <memory>
 #include <vector>
 
+class QFrameLayout;
+struct QExprCode;
+
 // QExpression - a list of expression elements (tokens)
 class QExpression : public QActionNode {
 public:
@@ -20,14 +24,35 @@ public:
 
   void AddElement(const Token &token) {
     m_Elements.push_back(token);
+    m_Code.reset();
 #if QLANG_DEBUG
-    std::cout << "[DEBUG] QExpression - added element: " << token.value
+    std::cout << "[DEBUG] QExpression - added element: " << token.Text()
               << std::endl;
 #endif
   }
 
   const std::vector<Token> &GetElements() const { return m_Elements; }
 
+  // Bytecode compiled by QRunner on first evaluation
+  std::shared_ptr<const QExprCode> GetCompiledCode() const { return m_Code; }
+  void SetCompiledCode(std::shared_ptr<const QExprCode> code) const {
+    m_Code = std::move(code);
+  }
+
+  // Frame slots resolved by QRunner before the code runs: per element, the
+  // slot in 'layout' of the local, parameter or member it names (-1 if
+  // none). The bytecode loads those variables straight from the frame.
+  const std::shared_ptr<QFrameLayout> &GetResolvedLayout() const {
+    return m_SlotLayout;
+  }
+  const std::vector<int> &GetResolvedSlots() const { return m_Slots; }
+  void SetResolvedSlots(std::shared_ptr<QFrameLayout> layout,
+                        std::vector<int> slots) {
+    m_SlotLayout = std::move(layout);
+    m_Slots = std::move(slots);
+    m_Code.reset();
+  }
+
   void CheckForErrors(std::shared_ptr<QErrorCollector> collector) override {
     if (m_Elements.empty())
       return;
@@ -55,7 +80,7 @@ public:
             collector->ReportError(QErrorSeverity::Error,
                                    "Expected operator between values",
                                    token.line, token.column,
-                                   static_cast<int>(token.value.length()));
+                                   static_cast<int>(token.Text().length()));
           }
         }
       }
@@ -64,13 +89,13 @@ public:
         // Check for operator at the end
         if (i == m_Elements.size() - 1) {
           // Unary Postfix IS allowed at end? e.g. i++
-          bool isPostfix = (token.value == "++" || token.value == "--");
+          bool isPostfix = (token.Text() == "++" || token.Text() == "--");
           if (!isPostfix) {
             collector->ReportError(QErrorSeverity::Error,
                                    "Expression cannot end with operator '" +
-                                       token.value + "'",
+                                       token.Text() + "'",
                                    token.line, token.column,
-                                   static_cast<int>(token.value.length()));
+                                   static_cast<int>(token.Text().length()));
           }
         }
 
@@ -80,29 +105,29 @@ public:
             (m_Elements[i - 1].type == TokenType::T_LPAREN);
 
         if (requiresUnary) {
-          bool isUnary = (token.value == "!" || token.value == "-");
+          bool isUnary = (token.Text() == "!" || token.Text() == "-");
           // Prefix ++/-- also allowed? C++ allows ++i.
           // Let's assume yes.
-          if (token.value == "++" || token.value == "--")
+          if (token.Text() == "++" || token.Text() == "--")
             isUnary = true;
 
           if (!isUnary) {
             if (i == 0) {
               collector->ReportError(QErrorSeverity::Error,
                                      "Expression cannot start with operator '" +
-                                         token.value + "'",
+                                         token.Text() + "'",
                                      token.line, token.column,
-                                     static_cast<int>(token.value.length()));
+                                     static_cast<int>(token.Text().length()));
             } else {
               collector->ReportError(
                   QErrorSeverity::Error,
-                  "Unexpected operator '" + token.value + "'", token.line,
-                  token.column, static_cast<int>(token.value.length()));
+                  "Unexpected operator '" + token.Text() + "'", token.line,
+                  token.column, static_cast<int>(token.Text().length()));
             }
           }
         } else {
           // Operator follows a value (Binary or Postfix)
-          bool isPostfix = (token.value == "++" || token.value == "--");
+          bool isPostfix = (token.Text() == "++" || token.Text() == "--");
           if (isPostfix) {
             // If postfix, NEXT token cannot be a Value.
             // e.g. i++ 100
@@ -112,7 +137,7 @@ public:
                 collector->ReportError(
                     QErrorSeverity::Error,
                     "Unexpected value after postfix operator", next.line,
-                    next.column, static_cast<int>(next.value.length()));
+                    next.column, static_cast<int>(next.Text().length()));
               }
             }
           }
@@ -125,7 +150,7 @@ public:
     PrintIndent(indent);
     std::cout << "Expression: ";
     for (size_t i = 0; i < m_Elements.size(); i++) {
-      std::cout << m_Elements[i].value;
+      std::cout << m_Elements[i].Text();
       if (i < m_Elements.size() - 1)
         std::cout << " ";
     }
@@ -134,4 +159,7 @@ public:
 
 private:
   std::vector<Token> m_Elements;
+  mutable std::shared_ptr<const QExprCode> m_Code;
+  std::shared_ptr<QFrameLayout> m_SlotLayout;
+  std::vector<int> m_Slots;
 };
@@ -0,0 +1,329 @@
+#include "QHeap.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+
+QHeap &QHeap::Get() {
+  static QHeap *instance = new QHeap(); // Never destroyed, see ~QHeap
+  return *instance;
+}
+
+// ========== Spans ==========
+
+QHeap::Span *QHeap::CreateSpan(SpanKind kind, size_t size) {
+  char *memory = static_cast<char *>(malloc(size));
+  if (!memory)
+    return nullptr;
+
+  auto span = std::make_unique<Span>();
+  span->kind = kind;
+  span->base = memory;
+  span->size = size;
+  span->marks.assign(1, 0);
+
+  uintptr_t base = reinterpret_cast<uintptr_t>(memory);
+  m_MinAddress = std::min(m_MinAddress, base);
+  m_MaxAddress = std::max(m_MaxAddress, base + size);
+
+  Span *raw = span.get();
+  m_Spans.emplace(base, std::move(span));
+  return raw;
+}
+
+void QHeap::DestroySpan(Span *span) {
+  char *memory = span->base;
+  m_Spans.erase(reinterpret_cast<uintptr_t>(memory));
+  free(memory);
+}
+
+QHeap::Span *QHeap::FindSpan(uintptr_t address) const {
+  if (address < m_MinAddress || address >= m_MaxAddress)
+    return nullptr;
+  auto it = m_Spans.upper_bound(address);
+  if (it == m_Spans.begin())
+    return nullptr;
+  --it;
+  Span *span = it->second.get();
+  return address < it->first + span->size ? span : nullptr;
+}
+
+// ========== Allocation ==========
+
+void QHeap::RefillPool(size_t sizeClass) {
+  size_t blockSize = (sizeClass + 1) * PoolGranularity;
+  Span *span = CreateSpan(SpanKind::Pool, SpanBytes);
+  if (!span)
+    return;
+
+  size_t blocks = SpanBytes / blockSize;
+  span->blockSize = blockSize;
+  span->used.assign(blocks, 0);
+  span->marks.assign(blocks, 0);
+
+  // Thread the blocks onto the free list, lowest address first
+  for (size_t i = blocks; i-- > 0;) {
+    void *block = span->base + i * blockSize;
+    *static_cast<void **>(block) = m_FreeLists[sizeClass];
+    m_FreeLists[sizeClass] = block;
+  }
+}
+
+void *QHeap::AllocObject(size_t size) {
+  if (size == 0)
+    size = 1;
+
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  void *block = nullptr;
+  size_t blockSize = 0;
+
+  if (size <= MaxPoolSize) {
+    size_t sizeClass = (size - 1) / PoolGranularity;
+    if (!m_FreeLists[sizeClass])
+      RefillPool(sizeClass);
+    block = m_FreeLists[sizeClass];
+    if (!block)
+      return nullptr;
+    m_FreeLists[sizeClass] = *static_cast<void **>(block);
+
+    Span *span = FindSpan(reinterpret_cast<uintptr_t>(block));
+    blockSize = span->blockSize;
+    span->used[(static_cast<char *>(block) - span->base) / blockSize] = 1;
+  } else {
+    Span *span = CreateSpan(SpanKind::Large, size);
+    if (!span)
+      return nullptr;
+    block = span->base;
+    blockSize = size;
+  }
+
+  memset(block, 0, blockSize);
+  ++m_LiveObjects;
+  m_LiveBytes += blockSize;
+  ++m_Frame.objectAllocs;
+  m_Frame.objectBytes += blockSize;
+  return block;
+}
+
+char *QHeap::AllocString(size_t size) {
+  if (size == 0)
+    size = 1;
+
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  ++m_Frame.stringAllocs;
+  m_Frame.stringBytes += size;
+
+  // Oversized strings get a chunk of their own
+  if (size > SpanBytes) {
+    Span *span = CreateSpan(SpanKind::Arena, size);
+    if (!span)
+      return nullptr;
+    span->arenaUsed = size;
+    m_ArenaChunks.push_back(span);
+    return span->base;
+  }
+
+  if (!m_CurrentArena || m_CurrentArena->arenaUsed + size > SpanBytes) {
+    // Prefer a chunk the last collection emptied
+    m_CurrentArena = nullptr;
+    for (Span *chunk : m_ArenaChunks) {
+      if (chunk->arenaUsed == 0 && chunk->size == SpanBytes) {
+        m_CurrentArena = chunk;
+        break;
+      }
+    }
+    if (!m_CurrentArena) {
+      m_CurrentArena = CreateSpan(SpanKind::Arena, SpanBytes);
+      if (!m_CurrentArena)
+        return nullptr;
+      m_ArenaChunks.push_back(m_CurrentArena);
+    }
+  }
+
+  char *result = m_CurrentArena->base + m_CurrentArena->arenaUsed;
+  m_CurrentArena->arenaUsed += size;
+  return result;
+}
+
+bool QHeap::Owns(const void *ptr) const {
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  return FindSpan(reinterpret_cast<uintptr_t>(ptr)) != nullptr;
+}
+
+// ========== Roots ==========
+
+void QHeap::AddRoot(const void *ptr, size_t size) {
+  if (!ptr)
+    return;
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  Root &root = m_Roots[ptr];
+  root.size = std::max(root.size, size);
+  ++root.count;
+}
+
+void QHeap::RemoveRoot(const void *ptr) {
+  if (!ptr)
+    return;
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  auto it = m_Roots.find(ptr);
+  if (it != m_Roots.end() && --it->second.count <= 0) {
+    m_Roots.erase(it);
+  }
+}
+
+// ========== Mark & Sweep ==========
+
+void QHeap::MarkAddress(
+    uintptr_t address,
+    std::vector<std::pair<const char *, size_t>> &worklist) {
+  Span *span = FindSpan(address);
+  if (!span)
+    return;
+
+  switch (span->kind) {
+  case SpanKind::Pool: {
+    size_t index = (address - reinterpret_cast<uintptr_t>(span->base)) /
+                   span->blockSize;
+    if (index >= span->used.size() || !span->used[index] ||
+        span->marks[index])
+      return;
+    span->marks[index] = 1;
+    worklist.emplace_back(span->base + index * span->blockSize,
+                          span->blockSize);
+    break;
+  }
+  case SpanKind::Large:
+    if (!span->marks[0]) {
+      span->marks[0] = 1;
+      worklist.emplace_back(span->base, span->size);
+    }
+    break;
+  case SpanKind::Arena:
+    span->marks[0] = 1; // Strings hold no pointers
+    break;
+  }
+}
+
+void QHeap::MarkFrom(std::vector<std::pair<const char *, size_t>> &worklist) {
+  while (!worklist.empty()) {
+    auto [begin, size] = worklist.back();
+    worklist.pop_back();
+
+    // Conservative: every aligned word may be a pointer
+    const char *end = begin + size - (size % sizeof(uintptr_t));
+    for (const char *word = begin; word < end; word += sizeof(uintptr_t)) {
+      uintptr_t value;
+      memcpy(&value, word, sizeof(value));
+      MarkAddress(value, worklist);
+    }
+  }
+}
+
+void QHeap::CollectLocked() {
+  auto start = std::chrono::steady_clock::now();
+
+  std::vector<std::pair<const char *, size_t>> worklist;
+  for (const auto &[ptr, root] : m_Roots) {
+    uintptr_t address = reinterpret_cast<uintptr_t>(ptr);
+    if (FindSpan(address)) {
+      MarkAddress(address, worklist); // Scanned with its block size
+    } else if (root.size > 0) {
+      // Unmanaged root memory (static instances): scan it directly
+      worklist.emplace_back(static_cast<const char *>(ptr), root.size);
+    }
+  }
+  MarkFrom(worklist);
+
+  size_t collectedObjects = 0;
+  size_t collectedBytes = 0;
+  std::vector<Span *> deadSpans;
+  size_t idleArenaChunks = 0;
+
+  for (auto &[base, owned] : m_Spans) {
+    Span *span = owned.get();
+    switch (span->kind) {
+    case SpanKind::Pool: {
+      size_t sizeClass = span->blockSize / PoolGranularity - 1;
+      for (size_t i = 0; i < span->used.size(); ++i) {
+        if (span->used[i] && !span->marks[i]) {
+          span->used[i] = 0;
+          void *block = span->base + i * span->blockSize;
+          *static_cast<void **>(block) = m_FreeLists[sizeClass];
+          m_FreeLists[sizeClass] = block;
+          ++collectedObjects;
+          collectedBytes += span->blockSize;
+        }
+        span->marks[i] = 0;
+      }
+      break;
+    }
+    case SpanKind::Large:
+      if (!span->marks[0]) {
+        deadSpans.push_back(span);
+        ++collectedObjects;
+        collectedBytes += span->size;
+      }
+      span->marks[0] = 0;
+      break;
+    case SpanKind::Arena:
+      if (!span->marks[0]) {
+        // Nothing points into this chunk: reuse it (or drop extras)
+        span->arenaUsed = 0;
+        if (span->size != SpanBytes || ++idleArenaChunks > MaxIdleArenaChunks)
+          deadSpans.push_back(span);
+      }
+      span->marks[0] = 0;
+      break;
+    }
+  }
+
+  for (Span *span : deadSpans) {
+    if (span->kind == SpanKind::Arena) {
+      m_ArenaChunks.erase(
+          std::find(m_ArenaChunks.begin(), m_ArenaChunks.end(), span));
+      if (m_CurrentArena == span)
+        m_CurrentArena = nullptr;
+    }
+    DestroySpan(span);
+  }
+
+  m_LiveObjects -= collectedObjects;
+  m_LiveBytes -= collectedBytes;
+  m_Frame.collected = true;
+  m_Frame.collectedObjects += collectedObjects;
+  m_Frame.collectedBytes += collectedBytes;
+  m_Frame.collectMs += std::chrono::duration<double, std::milli>(
+                           std::chrono::steady_clock::now() - start)
+                           .count();
+}
+
+void QHeap::Collect() {
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  CollectLocked();
+}
+
+void QHeap::EndFrame() {
+  std::lock_guard<std::mutex> lock(m_Mutex);
+
+  // Garbage only appears by overwriting references, which is picked up with
+  // the next frame that allocates
+  bool allocated = m_Frame.objectAllocs > 0 || m_Frame.stringAllocs > 0;
+  if (m_CollectionEnabled && allocated)
+    CollectLocked();
+
+  m_Frame.liveObjects = m_LiveObjects;
+  m_Frame.liveBytes = m_LiveBytes;
+  m_Frame.arenaBytes = 0;
+  for (const Span *chunk : m_ArenaChunks) {
+    m_Frame.arenaBytes += chunk->arenaUsed;
+  }
+
+  m_LastFrame = m_Frame;
+  m_Frame = QHeapFrameStats();
+  m_Frame.frame = m_LastFrame.frame + 1;
+}
+
+QHeapFrameStats QHeap::GetLastFrameStats() const {
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  return m_LastFrame;
+}
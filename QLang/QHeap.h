@@ -0,0 +1,134 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+// Allocation statistics for one frame, reported by QHeap::EndFrame
+struct QHeapFrameStats {
+  uint64_t frame = 0;
+  size_t objectAllocs = 0; // Instances/arrays allocated this frame
+  size_t objectBytes = 0;
+  size_t stringAllocs = 0; // Strings allocated this frame (arena)
+  size_t stringBytes = 0;
+  bool collected = false;      // False if nothing was allocated
+  size_t collectedObjects = 0; // Reclaimed at the end of this frame
+  size_t collectedBytes = 0;
+  size_t liveObjects = 0; // After collection
+  size_t liveBytes = 0;
+  size_t arenaBytes = 0; // String bytes still held by referenced chunks
+  double collectMs = 0.0;
+};
+
+// QHeap - managed memory for everything JIT code allocates
+//
+// - Objects ('new' instances and arrays) come from size-class pools (16..256
+//   bytes in 16 byte steps); larger blocks are allocated individually. All
+//   object memory is zeroed.
+// - Strings (concatenation, ToString) are bump-allocated from arena chunks.
+//   Strings hold no pointers, so chunks are never scanned; a chunk is reset
+//   as a whole once nothing references any string in it.
+// - Reclamation is a conservative mark-sweep. Roots are the instances the
+//   host holds (every QJClassInstance, i.e. ScriptPair instances and static
+//   class wrappers) and static class memory. Any pointer-sized word inside a
+//   reachable block that points into the heap keeps its target alive.
+//
+// Collection runs only from EndFrame(), which the host calls once per frame
+// while no script code is on the stack.
+class QHeap {
+public:
+  static QHeap &Get();
+
+  QHeap(const QHeap &) = delete;
+  QHeap &operator=(const QHeap &) = delete;
+
+  // Zeroed object memory
+  void *AllocObject(size_t size);
+
+  // Uninitialized string memory (size includes the terminator)
+  char *AllocString(size_t size);
+
+  // Keep a block (and everything it references) alive. Managed blocks are
+  // scanned with their own size; unmanaged memory is scanned for 'size'
+  // bytes (0 = not scanned).
+  // Roots are counted, so the same pointer may be added more than once.
+  void AddRoot(const void *ptr, size_t size = 0);
+  void RemoveRoot(const void *ptr);
+
+  // True if ptr points into a managed object or string
+  bool Owns(const void *ptr) const;
+
+  // Collect (if anything was allocated since the last one) and finish the
+  // frame's statistics
+  void EndFrame();
+
+  // Unconditional collection
+  void Collect();
+
+  // Collection can be turned off, e.g. while a host keeps raw script
+  // pointers across frames
+  void SetCollectionEnabled(bool enabled) { m_CollectionEnabled = enabled; }
+  bool IsCollectionEnabled() const { return m_CollectionEnabled; }
+
+  QHeapFrameStats GetLastFrameStats() const;
+
+private:
+  QHeap() = default;
+  ~QHeap() = default; // Memory is left to the OS (static destruction order)
+
+  enum class SpanKind : uint8_t { Pool, Large, Arena };
+
+  // A contiguous range of heap memory
+  struct Span {
+    SpanKind kind = SpanKind::Pool;
+    char *base = nullptr;
+    size_t size = 0;
+    size_t blockSize = 0;       // Pool: size class
+    std::vector<uint8_t> used;  // Pool: per block
+    std::vector<uint8_t> marks; // Pool: per block, otherwise one entry
+    size_t arenaUsed = 0;       // Arena: bump offset
+  };
+
+  struct Root {
+    size_t size = 0;
+    int count = 0;
+  };
+
+  static constexpr size_t PoolGranularity = 16;
+  static constexpr size_t MaxPoolSize = 256;
+  static constexpr size_t SizeClassCount = MaxPoolSize / PoolGranularity;
+  static constexpr size_t SpanBytes = 64 * 1024;
+  static constexpr size_t MaxIdleArenaChunks = 4;
+
+  Span *CreateSpan(SpanKind kind, size_t size);
+  void DestroySpan(Span *span);
+  Span *FindSpan(uintptr_t address) const;
+  void RefillPool(size_t sizeClass);
+  void MarkFrom(std::vector<std::pair<const char *, size_t>> &worklist);
+  void MarkAddress(uintptr_t address,
+                   std::vector<std::pair<const char *, size_t>> &worklist);
+  void CollectLocked();
+
+  mutable std::mutex m_Mutex;
+  std::map<uintptr_t, std::unique_ptr<Span>> m_Spans; // By base address
+  uintptr_t m_MinAddress = UINTPTR_MAX;
+  uintptr_t m_MaxAddress = 0;
+
+  // Pools: intrusive free lists (first word of a free block is the next one)
+  void *m_FreeLists[SizeClassCount] = {};
+
+  std::vector<Span *> m_ArenaChunks;
+  Span *m_CurrentArena = nullptr;
+
+  std::unordered_map<const void *, Root> m_Roots;
+
+  bool m_CollectionEnabled = true;
+  QHeapFrameStats m_Frame; // Being accumulated
+  QHeapFrameStats m_LastFrame;
+  size_t m_LiveObjects = 0;
+  size_t m_LiveBytes = 0;
+};
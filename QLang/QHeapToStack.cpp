@@ -0,0 +1,125 @@
+#include "QHeapToStack.h"
+#include <algorithm>
+#include <llvm/IR/Constants.h>
+#include <llvm/IR/IRBuilder.h>
+#include <llvm/IR/Instructions.h>
+#include <llvm/IR/IntrinsicInst.h>
+#include <llvm/IR/Module.h>
+#include <vector>
+
+static bool IsCallTo(const llvm::Instruction *inst, llvm::StringRef name) {
+  auto *call = llvm::dyn_cast<llvm::CallInst>(inst);
+  if (!call)
+    return false;
+  const llvm::Function *callee = call->getCalledFunction();
+  return callee && callee->getName() == name;
+}
+
+// Walks every (transitive) use of 'allocation'. Returns false if the pointer
+// may outlive the function; collects free() calls that need to go as well.
+static bool DoesNotEscape(llvm::Instruction *allocation,
+                          std::vector<llvm::CallInst *> &frees) {
+  std::vector<llvm::Value *> worklist{allocation};
+  std::vector<llvm::Value *> visited;
+
+  while (!worklist.empty()) {
+    llvm::Value *pointer = worklist.back();
+    worklist.pop_back();
+    if (std::find(visited.begin(), visited.end(), pointer) != visited.end())
+      continue;
+    visited.push_back(pointer);
+
+    for (llvm::Use &use : pointer->uses()) {
+      auto *user = llvm::dyn_cast<llvm::Instruction>(use.getUser());
+      if (!user)
+        return false;
+
+      if (llvm::isa<llvm::LoadInst>(user) || llvm::isa<llvm::ICmpInst>(user))
+        continue;
+
+      if (auto *store = llvm::dyn_cast<llvm::StoreInst>(user)) {
+        // Writing into the object is fine; writing the pointer itself is not
+        if (store->getValueOperand() == pointer)
+          return false;
+        continue;
+      }
+
+      if (llvm::isa<llvm::GetElementPtrInst>(user) ||
+          llvm::isa<llvm::BitCastInst>(user)) {
+        worklist.push_back(user);
+        continue;
+      }
+
+      if (auto *call = llvm::dyn_cast<llvm::CallInst>(user)) {
+        if (IsCallTo(call, "free")) {
+          frees.push_back(call);
+          continue;
+        }
+        if (call->isLifetimeStartOrEnd() || llvm::isa<llvm::MemIntrinsic>(call))
+          continue;
+        // Constructors that were not inlined are usually inferred nocapture
+        if (call->isArgOperand(&use) &&
+            call->doesNotCapture(call->getArgOperandNo(&use)))
+          continue;
+        return false;
+      }
+
+      // ret, phi, select, ptrtoint, ...
+      return false;
+    }
+  }
+  return true;
+}
+
+llvm::PreservedAnalyses
+QHeapToStackPass::run(llvm::Function &function,
+                      llvm::FunctionAnalysisManager &) {
+  std::vector<llvm::CallInst *> candidates;
+  for (llvm::BasicBlock &block : function) {
+    for (llvm::Instruction &inst : block) {
+      if (!IsCallTo(&inst, "qlang_alloc") && !IsCallTo(&inst, "malloc"))
+        continue;
+      auto *call = llvm::cast<llvm::CallInst>(&inst);
+      auto *size = llvm::dyn_cast<llvm::ConstantInt>(call->getArgOperand(0));
+      if (size && size->getZExtValue() > 0 &&
+          size->getZExtValue() <= MaxStackBytes)
+        candidates.push_back(call);
+    }
+  }
+
+  bool changed = false;
+  llvm::BasicBlock &entry = function.getEntryBlock();
+  for (llvm::CallInst *call : candidates) {
+    std::vector<llvm::CallInst *> frees;
+    if (!DoesNotEscape(call, frees))
+      continue;
+
+    // One slot per allocation site. A site inside a loop reuses its slot on
+    // every iteration: without escaping, the previous object is unreachable.
+    uint64_t bytes =
+        llvm::cast<llvm::ConstantInt>(call->getArgOperand(0))->getZExtValue();
+    llvm::IRBuilder<> entryBuilder(&entry, entry.getFirstInsertionPt());
+    llvm::AllocaInst *slot = entryBuilder.CreateAlloca(
+        llvm::ArrayType::get(entryBuilder.getInt8Ty(), bytes), nullptr,
+        call->getName() + ".stack");
+    slot->setAlignment(llvm::Align(16)); // malloc's guarantee
+
+    // qlang_alloc hands out zeroed memory; SROA drops the fill for fields
+    // that are overwritten anyway
+    llvm::IRBuilder<> builder(call);
+    builder.CreateMemSet(slot, builder.getInt8(0), bytes, llvm::Align(16));
+    llvm::Value *pointer = builder.CreatePointerCast(slot, call->getType());
+    call->replaceAllUsesWith(pointer);
+    call->eraseFromParent();
+    for (llvm::CallInst *freeCall : frees) {
+      freeCall->eraseFromParent();
+    }
+    changed = true;
+  }
+
+  if (!changed)
+    return llvm::PreservedAnalyses::all();
+  llvm::PreservedAnalyses preserved;
+  preserved.preserveSet<llvm::CFGAnalyses>();
+  return preserved;
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <llvm/IR/PassManager.h>
+
+// Escape analysis for 'new': turns heap allocations (qlang_alloc, malloc)
+// whose result never leaves the function into stack allocations.
+//
+// QLang lowers every 'new' to a QHeap allocation. Once small methods such as
+// Vec3.Plus are inlined, the temporaries they return are only read field by
+// field in the caller; those allocations become allocas, which SROA then
+// splits into registers.
+//
+// A pointer escapes if it is returned, stored into memory, merged through a
+// phi/select, converted to an integer, or passed to a call that may capture
+// it. Run after inlining (see QJitProgram::Optimize).
+class QHeapToStackPass : public llvm::PassInfoMixin<QHeapToStackPass> {
+public:
+  // Larger allocations stay on the heap
+  static constexpr uint64_t MaxStackBytes = 256;
+
+  llvm::PreservedAnalyses run(llvm::Function &function,
+                              llvm::FunctionAnalysisManager &analyses);
+};
@@ -1,33 +1,104 @@
 #include "QJClassInstance.h"
+#include "QHeap.h"
 #include "QJitProgram.h"
+#include "Tokenizer.h"
+#include <algorithm>
 #include <iostream>
 
+// ============================================================================
+// QJClassLayout
+// ============================================================================
+
+QJClassLayout::QJClassLayout(std::string className, uint64_t size,
+                             std::vector<QJMember> members)
+    : m_ClassName(std::move(className)), m_Size(size),
+      m_Members(std::move(members)) {
+  std::stable_sort(m_Members.begin(), m_Members.end(),
+                   [](const QJMember &a, const QJMember &b) {
+                     return a.info.offset < b.info.offset;
+                   });
+  m_Index.reserve(m_Members.size());
+  for (size_t i = 0; i < m_Members.size(); i++) {
+    m_Members[i].valueType = ValueTypeFor(m_Members[i].info);
+    m_Index.emplace(m_Members[i].name, i);
+  }
+}
+
+const QJMember *QJClassLayout::FindMember(const std::string &name) const {
+  auto it = m_Index.find(name);
+  return it != m_Index.end() ? &m_Members[it->second] : nullptr;
+}
+
+QJValue::Type QJClassLayout::ValueTypeFor(const MemberInfo &info) {
+  switch (static_cast<TokenType>(info.typeToken)) {
+  case TokenType::T_INT32:
+    return QJValue::Type::Int32;
+  case TokenType::T_INT64:
+    return QJValue::Type::Int64;
+  case TokenType::T_FLOAT32:
+    return QJValue::Type::Float32;
+  case TokenType::T_FLOAT64:
+    return QJValue::Type::Float64;
+  case TokenType::T_BOOL:
+    return QJValue::Type::Bool;
+  case TokenType::T_STRING_TYPE:
+    return QJValue::Type::CStr;
+  case TokenType::T_CPTR:
+  case TokenType::T_IPTR:
+  case TokenType::T_FPTR:
+  case TokenType::T_BPTR:
+    return QJValue::Type::Ptr;
+  case TokenType::T_IDENTIFIER:
+    // Class references are pointers; value classes are embedded
+    return info.size == sizeof(void *) ? QJValue::Type::Ptr
+                                       : QJValue::Type::Null;
+  default:
+    return QJValue::Type::Null;
+  }
+}
+
+// ============================================================================
+// QJClassInstance
+// ============================================================================
+
 QJClassInstance::QJClassInstance(const std::string &className,
                                  void *instancePtr)
-    : m_ClassName(className), m_InstancePtr(instancePtr) {
+    : m_InstancePtr(instancePtr) {
 
-  // Auto-populate members from the running program registry if available
+  // Share the layout from the running program registry if available
   if (QJitProgram::Instance()) {
-    auto classInfo = QJitProgram::Instance()->GetClassInfo(className);
-    if (classInfo) {
-      m_Members = classInfo->members;
-    } else {
+    m_Layout = QJitProgram::Instance()->GetClassLayout(className);
+    if (!m_Layout) {
       // Warning: Class info not found, instance might not support member access
       std::cerr << "[WARNING] QJClassInstance: Class '" << className
                 << "' not found in registry (ptr=" << instancePtr << ")"
                 << std::endl;
     }
   }
+  if (!m_Layout) {
+    m_Layout = std::make_shared<QJClassLayout>(className, 0,
+                                               std::vector<QJMember>());
+  }
+
+  QHeap::Get().AddRoot(m_InstancePtr, static_cast<size_t>(m_Layout->GetSize()));
+}
+
+QJClassInstance::QJClassInstance(std::shared_ptr<const QJClassLayout> layout,
+                                 void *instancePtr)
+    : m_Layout(std::move(layout)), m_InstancePtr(instancePtr) {
+  QHeap::Get().AddRoot(m_InstancePtr, static_cast<size_t>(m_Layout->GetSize()));
 }
 
+QJClassInstance::~QJClassInstance() { QHeap::Get().RemoveRoot(m_InstancePtr); }
+
 template <typename T>
 T QJClassInstance::GetMember(const std::string &name) const {
-  auto it = m_Members.find(name);
-  if (it == m_Members.end() || !m_InstancePtr) {
+  const QJMember *member = m_Layout->FindMember(name);
+  if (!member || !m_InstancePtr) {
     return T{}; // Return default if member not found
   }
 
-  const MemberInfo &info = it->second;
+  const MemberInfo &info = member->info;
   char *ptr = static_cast<char *>(m_InstancePtr) + info.offset;
 
   T result{};
@@ -44,12 +115,12 @@ template bool QJClassInstance::GetMember<bool>(const std::string &) const;
 template void *QJClassInstance::GetMember<void *>(const std::string &) const;
 
 std::string QJClassInstance::GetStringMember(const std::string &name) const {
-  auto it = m_Members.find(name);
-  if (it == m_Members.end() || !m_InstancePtr) {
+  const QJMember *member = m_Layout->FindMember(name);
+  if (!member || !m_InstancePtr) {
     return "";
   }
 
-  const MemberInfo &info = it->second;
+  const MemberInfo &info = member->info;
   char *ptr = static_cast<char *>(m_InstancePtr) + info.offset;
 
   // String is stored as char* pointer
@@ -59,12 +130,12 @@ std::string QJClassInstance::GetStringMember(const std::string &name) const {
 
 template <typename T>
 void QJClassInstance::SetMember(const std::string &name, T value) {
-  auto it = m_Members.find(name);
-  if (it == m_Members.end() || !m_InstancePtr) {
+  const QJMember *member = m_Layout->FindMember(name);
+  if (!member || !m_InstancePtr) {
     return;
   }
 
-  const MemberInfo &info = it->second;
+  const MemberInfo &info = member->info;
   char *ptr = static_cast<char *>(m_InstancePtr) + info.offset;
 
   memcpy(ptr, &value, sizeof(T));
@@ -80,12 +151,12 @@ template void QJClassInstance::SetMember<void *>(const std::string &, void *);
 
 void QJClassInstance::SetStringMember(const std::string &name,
                                       const char *value) {
-  auto it = m_Members.find(name);
-  if (it == m_Members.end() || !m_InstancePtr) {
+  const QJMember *member = m_Layout->FindMember(name);
+  if (!member || !m_InstancePtr) {
     return;
   }
 
-  const MemberInfo &info = it->second;
+  const MemberInfo &info = member->info;
   char *ptr = static_cast<char *>(m_InstancePtr) + info.offset;
 
   // Store the pointer directly
@@ -93,12 +164,12 @@ void QJClassInstance::SetStringMember(const std::string &name,
 }
 
 void *QJClassInstance::GetPtrMember(const std::string &name) const {
-  auto it = m_Members.find(name);
-  if (it == m_Members.end() || !m_InstancePtr) {
+  const QJMember *member = m_Layout->FindMember(name);
+  if (!member || !m_InstancePtr) {
     return nullptr;
   }
 
-  const MemberInfo &info = it->second;
+  const MemberInfo &info = member->info;
   char *ptr = static_cast<char *>(m_InstancePtr) + info.offset;
 
   // Return the stored pointer
@@ -106,14 +177,126 @@ void *QJClassInstance::GetPtrMember(const std::string &name) const {
 }
 
 void QJClassInstance::SetPtrMember(const std::string &name, void *value) {
-  auto it = m_Members.find(name);
-  if (it == m_Members.end() || !m_InstancePtr) {
+  const QJMember *member = m_Layout->FindMember(name);
+  if (!member || !m_InstancePtr) {
     return;
   }
 
-  const MemberInfo &info = it->second;
+  const MemberInfo &info = member->info;
   char *ptr = static_cast<char *>(m_InstancePtr) + info.offset;
 
   // Store the pointer
   *reinterpret_cast<void **>(ptr) = value;
 }
+
+std::vector<QJValue> QJClassInstance::SnapshotMembers() const {
+  std::vector<QJValue> values;
+  SnapshotMembers(values);
+  return values;
+}
+
+void QJClassInstance::SnapshotMembers(std::vector<QJValue> &values) const {
+  const auto &members = m_Layout->GetMembers();
+  values.assign(members.size(), QJValue());
+  if (!m_InstancePtr) {
+    return;
+  }
+
+  const char *base = static_cast<const char *>(m_InstancePtr);
+  for (size_t i = 0; i < members.size(); i++) {
+    const char *ptr = base + members[i].info.offset;
+    QJValue &value = values[i];
+    value.type = members[i].valueType;
+    switch (value.type) {
+    case QJValue::Type::Int32:
+      memcpy(&value.data.i32, ptr, sizeof(int32_t));
+      break;
+    case QJValue::Type::Int64:
+      memcpy(&value.data.i64, ptr, sizeof(int64_t));
+      break;
+    case QJValue::Type::Float32:
+      memcpy(&value.data.f32, ptr, sizeof(float));
+      break;
+    case QJValue::Type::Float64:
+      memcpy(&value.data.f64, ptr, sizeof(double));
+      break;
+    case QJValue::Type::Bool:
+      value.data.b = *ptr != 0;
+      break;
+    case QJValue::Type::Ptr:
+      memcpy(&value.data.ptr, ptr, sizeof(void *));
+      break;
+    case QJValue::Type::CStr:
+      memcpy(&value.data.cstr, ptr, sizeof(const char *));
+      break;
+    default:
+      break;
+    }
+  }
+}
+
+size_t QJClassInstance::CopyMembersFrom(
+    const QJClassInstance &other, const std::set<std::string> &changedClasses,
+    const std::unordered_map<const void *, void *> &relocated) {
+  if (!m_InstancePtr || !other.m_InstancePtr) {
+    return 0;
+  }
+
+  size_t copied = 0;
+  char *base = static_cast<char *>(m_InstancePtr);
+  const char *otherBase = static_cast<const char *>(other.m_InstancePtr);
+  for (const auto &member : m_Layout->GetMembers()) {
+    const QJMember *source = other.m_Layout->FindMember(member.name);
+    if (!source || source->info.size != member.info.size ||
+        source->info.typeToken != member.info.typeToken ||
+        source->info.typeName != member.info.typeName) {
+      continue;
+    }
+
+    if (!member.info.typeName.empty() &&
+        changedClasses.count(member.info.typeName)) {
+      if (member.valueType != QJValue::Type::Ptr)
+        continue;
+      const void *old = nullptr;
+      memcpy(&old, otherBase + source->info.offset, sizeof(void *));
+      auto movedIt = relocated.find(old);
+      if (movedIt == relocated.end())
+        continue;
+      memcpy(base + member.info.offset, &movedIt->second, sizeof(void *));
+      copied++;
+      continue;
+    }
+
+    memcpy(base + member.info.offset, otherBase + source->info.offset,
+           member.info.size);
+    copied++;
+  }
+  return copied;
+}
+
+size_t QJClassInstance::RelocateReferences(
+    const std::set<std::string> &changedClasses,
+    const std::unordered_map<const void *, void *> &relocated) {
+  if (!m_InstancePtr || changedClasses.empty()) {
+    return 0;
+  }
+
+  size_t changed = 0;
+  char *base = static_cast<char *>(m_InstancePtr);
+  for (const auto &member : m_Layout->GetMembers()) {
+    if (member.valueType != QJValue::Type::Ptr ||
+        member.info.typeName.empty() ||
+        !changedClasses.count(member.info.typeName)) {
+      continue;
+    }
+    const void *old = nullptr;
+    memcpy(&old, base + member.info.offset, sizeof(void *));
+    if (!old)
+      continue;
+    auto movedIt = relocated.find(old);
+    void *target = movedIt != relocated.end() ? movedIt->second : nullptr;
+    memcpy(base + member.info.offset, &target, sizeof(void *));
+    changed++;
+  }
+  return changed;
+}
@@ -2,8 +2,14 @@
 
 #include <cstdint>
 #include <cstring>
+#include <memory>
+#include <set>
 #include <string>
+#include <type_traits>
 #include <unordered_map>
+#include <vector>
+
+#include "QJValue.h"
 
 // Stores runtime information about a class member for get/set access
 struct MemberInfo {
@@ -13,17 +19,102 @@ struct MemberInfo {
   std::string typeName; // Type name for class members
 };
 
+// One member of a QJClassLayout
+struct QJMember {
+  std::string name;
+  MemberInfo info;
+  QJValue::Type valueType = QJValue::Type::Null; // Null for embedded structs
+};
+
+// Typed handle to one member: resolve it once from the layout, then read and
+// write instances of that class without any name lookup. Invalid if the
+// member does not exist or its size does not match T.
+template <typename T> class QJMemberAccessor {
+  static_assert(std::is_trivially_copyable<T>::value,
+                "QJMemberAccessor needs a trivially copyable type");
+
+public:
+  QJMemberAccessor() = default;
+  explicit QJMemberAccessor(size_t offset) : m_Offset(offset) {}
+
+  bool IsValid() const { return m_Offset != Invalid; }
+  size_t GetOffset() const { return m_Offset; }
+
+  T Get(const void *instancePtr) const {
+    T result{};
+    if (IsValid() && instancePtr) {
+      memcpy(&result, static_cast<const char *>(instancePtr) + m_Offset,
+             sizeof(T));
+    }
+    return result;
+  }
+
+  void Set(void *instancePtr, const T &value) const {
+    if (IsValid() && instancePtr) {
+      memcpy(static_cast<char *>(instancePtr) + m_Offset, &value, sizeof(T));
+    }
+  }
+
+private:
+  static constexpr size_t Invalid = static_cast<size_t>(-1);
+  size_t m_Offset = Invalid;
+};
+
+// QJClassLayout - immutable member layout of one compiled class
+//
+// Built once per class by QJitProgram and shared by every QJClassInstance of
+// that class, so an instance only carries a pointer to it. Members are kept
+// in offset order.
+class QJClassLayout {
+public:
+  QJClassLayout(std::string className, uint64_t size,
+                std::vector<QJMember> members);
+
+  const std::string &GetClassName() const { return m_ClassName; }
+  uint64_t GetSize() const { return m_Size; }
+  const std::vector<QJMember> &GetMembers() const { return m_Members; }
+
+  // nullptr if the class has no such member
+  const QJMember *FindMember(const std::string &name) const;
+
+  template <typename T>
+  QJMemberAccessor<T> GetAccessor(const std::string &name) const {
+    const QJMember *member = FindMember(name);
+    if (!member || member->info.size != sizeof(T)) {
+      return QJMemberAccessor<T>();
+    }
+    return QJMemberAccessor<T>(member->info.offset);
+  }
+
+  // QJValue kind used for a member's type in snapshots
+  static QJValue::Type ValueTypeFor(const MemberInfo &info);
+
+private:
+  std::string m_ClassName;
+  uint64_t m_Size = 0;
+  std::vector<QJMember> m_Members;
+  std::unordered_map<std::string, size_t> m_Index; // Name -> m_Members
+};
+
 // Holds a runtime instance of a QLang class created by QJitRunner
 // Provides access to member variables and methods
 class QJClassInstance {
 public:
-  // Constructor looks up member info from QJitProgram::Instance() if available
+  // Constructor looks up the class layout from QJitProgram::Instance() if
+  // available. The instance is a QHeap root for as long as this wrapper
+  // exists.
   QJClassInstance(const std::string &className, void *instancePtr);
 
-  ~QJClassInstance() = default;
+  QJClassInstance(std::shared_ptr<const QJClassLayout> layout,
+                  void *instancePtr);
+
+  ~QJClassInstance();
+
+  QJClassInstance(const QJClassInstance &) = delete;
+  QJClassInstance &operator=(const QJClassInstance &) = delete;
 
   // Get the class name
-  const std::string &GetClassName() const { return m_ClassName; }
+  const std::string &GetClassName() const { return m_Layout->GetClassName(); }
 
   // Get the raw pointer to the instance memory
   void *GetInstancePtr() const { return m_InstancePtr; }
@@ -31,18 +122,19 @@ public:
   // Check if the instance is valid
   bool IsValid() const { return m_InstancePtr != nullptr; }
 
-  // Register member info for runtime access (called by QJitProgram)
-  void RegisterMember(const std::string &name, const MemberInfo &info) {
-    m_Members[name] = info;
+  // Shared layout of this instance's class
+  const std::shared_ptr<const QJClassLayout> &GetLayout() const {
+    return m_Layout;
   }
 
   // Check if a member exists
   bool HasMember(const std::string &name) const {
-    return m_Members.find(name) != m_Members.end();
+    return m_Layout->FindMember(name) != nullptr;
   }
 
   // Get a member value by name
   // Usage: int32_t age = instance->GetMember<int32_t>("age");
+  // Looks the name up on every call; use GetAccessor on hot paths.
   template <typename T> T GetMember(const std::string &name) const;
 
   // Get string member (special case - stored as char*)
@@ -61,13 +153,44 @@ public:
   // Set cptr member (void* pointer)
   void SetPtrMember(const std::string &name, void *value);
 
-  // Get the members map (for debugging)
-  const std::unordered_map<std::string, MemberInfo> &GetMembers() const {
-    return m_Members;
+  // Resolve a member once for repeated typed access
+  // Usage: auto age = instance->GetAccessor<int32_t>("age");
+  //        age.Set(instance->GetInstancePtr(), age.Get(ptr) + 1);
+  template <typename T>
+  QJMemberAccessor<T> GetAccessor(const std::string &name) const {
+    return m_Layout->GetAccessor<T>(name);
   }
 
+  // Members in layout order
+  const std::vector<QJMember> &GetMembers() const {
+    return m_Layout->GetMembers();
+  }
+
+  // Current value of every member, in GetMembers() order (embedded structs
+  // read as null). The overload taking a vector reuses its storage.
+  std::vector<QJValue> SnapshotMembers() const;
+  void SnapshotMembers(std::vector<QJValue> &values) const;
+
+  // Copy the members 'other' also has (same name, type and size), e.g. from
+  // an instance of an older layout of the class. Returns how many.
+  //
+  // Members of a class in 'changedClasses' hold objects of its old layout.
+  // References are redirected through 'relocated' (old object -> migrated
+  // object) where possible; embedded structs and references to objects that
+  // were not migrated keep the value the constructor gave them.
+  size_t CopyMembersFrom(
+      const QJClassInstance &other,
+      const std::set<std::string> &changedClasses = {},
+      const std::unordered_map<const void *, void *> &relocated = {});
+
+  // For instances that keep their layout: redirect references to objects of
+  // a class in 'changedClasses' through 'relocated', and clear the ones that
+  // were not migrated. Returns how many references changed.
+  size_t RelocateReferences(
+      const std::set<std::string> &changedClasses,
+      const std::unordered_map<const void *, void *> &relocated);
+
 private:
-  std::string m_ClassName;
+  std::shared_ptr<const QJClassLayout> m_Layout;
   void *m_InstancePtr;
-  std::unordered_map<std::string, MemberInfo> m_Members;
 };
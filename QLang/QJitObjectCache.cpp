@@ -0,0 +1,178 @@
+#include "QJitObjectCache.h"
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <llvm/ADT/StringExtras.h>
+#include <llvm/Bitcode/BitcodeWriter.h>
+#include <llvm/Config/llvm-config.h>
+#include <llvm/ExecutionEngine/Orc/JITTargetMachineBuilder.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/SHA1.h>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+// Identifiers produced by ComputeKey: "qjit-" + 40 hex digits
+static const char *KeyPrefix = "qjit-";
+
+QJitObjectCache::QJitObjectCache(const std::string &directory)
+    : m_Directory(directory) {
+  std::error_code ec;
+  std::filesystem::create_directories(m_Directory, ec);
+  if (ec) {
+    std::cerr << "[WARNING] QJitObjectCache: Cannot create cache directory '"
+              << m_Directory << "': " << ec.message() << std::endl;
+    return;
+  }
+  Prune();
+}
+
+void QJitObjectCache::Prune(uint64_t maxBytes, int maxAgeDays) {
+  namespace fs = std::filesystem;
+  struct Entry {
+    fs::path path;
+    fs::file_time_type stamp;
+    uint64_t size;
+  };
+
+  std::error_code ec;
+  const auto now = fs::file_time_type::clock::now();
+  const auto maxAge = std::chrono::hours(24) * maxAgeDays;
+  std::vector<Entry> objects;
+  uint64_t total = 0;
+  size_t removed = 0;
+
+  for (const auto &file : fs::directory_iterator(m_Directory, ec)) {
+    if (!file.is_regular_file(ec))
+      continue;
+    std::string name = file.path().filename().string();
+    if (!IsKey(name))
+      continue;
+    auto stamp = file.last_write_time(ec);
+    if (ec)
+      continue;
+
+    // Temporaries of a writer that crashed, and objects unused for too long
+    bool temporary = name.find(".tmp") != std::string::npos;
+    if ((temporary && now - stamp > std::chrono::hours(1)) ||
+        (!temporary && now - stamp > maxAge)) {
+      removed += fs::remove(file.path(), ec) ? 1 : 0;
+      continue;
+    }
+    if (temporary)
+      continue;
+
+    uint64_t size = file.file_size(ec);
+    objects.push_back({file.path(), stamp, size});
+    total += size;
+  }
+
+  // Least recently used first (getObject refreshes the stamp on a hit)
+  if (total > maxBytes) {
+    std::sort(objects.begin(), objects.end(),
+              [](const Entry &a, const Entry &b) { return a.stamp < b.stamp; });
+    for (const Entry &entry : objects) {
+      if (total <= maxBytes)
+        break;
+      if (fs::remove(entry.path, ec)) {
+        total -= entry.size;
+        ++removed;
+      }
+    }
+  }
+
+  if (removed > 0) {
+    std::cout << "[INFO] QJitObjectCache: Pruned " << removed
+              << " cached objects" << std::endl;
+  }
+}
+
+std::string
+QJitObjectCache::ComputeKey(llvm::Module &module,
+                            const llvm::orc::JITTargetMachineBuilder &target,
+                            const std::string &pipeline) {
+  // The identifier/source name must not feed the hash (they differ between
+  // runs for otherwise identical partitions)
+  module.setModuleIdentifier("");
+  module.setSourceFileName("");
+
+  llvm::SmallVector<char, 0> bitcode;
+  {
+    llvm::raw_svector_ostream os(bitcode);
+    llvm::WriteBitcodeToFile(module, os);
+  }
+
+  llvm::SHA1 hasher;
+  hasher.update(LLVM_VERSION_STRING);
+  hasher.update(target.getTargetTriple().str());
+  hasher.update(target.getCPU());
+  hasher.update(target.getFeatures().getString());
+  hasher.update(pipeline);
+  hasher.update(llvm::StringRef(bitcode.data(), bitcode.size()));
+  auto digest = hasher.final();
+
+  std::string key = KeyPrefix + llvm::toHex(digest, true);
+  module.setModuleIdentifier(key);
+  return key;
+}
+
+bool QJitObjectCache::IsKey(const std::string &identifier) {
+  return identifier.rfind(KeyPrefix, 0) == 0;
+}
+
+std::string QJitObjectCache::GetPath(const std::string &key) const {
+  return (std::filesystem::path(m_Directory) / (key + ".o")).string();
+}
+
+bool QJitObjectCache::Contains(const std::string &key) const {
+  return std::filesystem::exists(GetPath(key));
+}
+
+void QJitObjectCache::notifyObjectCompiled(const llvm::Module *module,
+                                           llvm::MemoryBufferRef object) {
+  const std::string &key = module->getModuleIdentifier();
+  if (!IsKey(key))
+    return;
+
+  // Write to a temporary and rename, so a concurrent reader (or a crash)
+  // never sees a partial object
+  std::string path = GetPath(key);
+  std::stringstream tempName;
+  tempName << path << ".tmp" << std::this_thread::get_id();
+  {
+    std::ofstream file(tempName.str(), std::ios::binary);
+    if (!file)
+      return;
+    file.write(object.getBufferStart(), object.getBufferSize());
+  }
+
+  std::error_code ec;
+  std::filesystem::rename(tempName.str(), path, ec);
+  if (ec) {
+    std::filesystem::remove(tempName.str(), ec);
+  }
+}
+
+std::unique_ptr<llvm::MemoryBuffer>
+QJitObjectCache::getObject(const llvm::Module *module) {
+  const std::string &key = module->getModuleIdentifier();
+  if (!IsKey(key))
+    return nullptr;
+
+  auto buffer = llvm::MemoryBuffer::getFile(GetPath(key), /*IsText=*/false,
+                                            /*RequiresNullTerminator=*/false);
+  if (!buffer)
+    return nullptr;
+
+  // Keeps the object out of Prune's least-recently-used end
+  std::error_code ec;
+  std::filesystem::last_write_time(
+      GetPath(key), std::filesystem::file_time_type::clock::now(), ec);
+
+  // The JIT takes ownership; copy so the file isn't kept mapped/locked
+  return llvm::MemoryBuffer::getMemBufferCopy((*buffer)->getBuffer(),
+                                              key);
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+#include <llvm/ExecutionEngine/ObjectCache.h>
+#include <string>
+
+namespace llvm {
+class Module;
+namespace orc {
+class JITTargetMachineBuilder;
+} // namespace orc
+} // namespace llvm
+
+// On-disk cache of JIT-compiled object code.
+//
+// Keys are computed from the IR before it is optimized (see ComputeKey) and
+// stored as the module identifier, so a hit skips both the optimization
+// pipeline and codegen. The key covers the IR, the LLVM version, the target
+// triple, the CPU and its features, and the pipeline settings (optimization
+// level, profiler instrumentation, pass list version): any change to those
+// simply misses and compiles again.
+//
+// Objects that no key produces any more are never looked up again, so the
+// directory is pruned when the cache is opened: objects not used for
+// MaxAgeDays go first, then the least recently used ones until the directory
+// is under MaxBytes.
+class QJitObjectCache : public llvm::ObjectCache {
+public:
+  static constexpr uint64_t MaxBytes = 256ull * 1024 * 1024;
+  static constexpr int MaxAgeDays = 30;
+
+  explicit QJitObjectCache(const std::string &directory);
+
+  // Hash the module (unoptimized) together with the target and the pipeline
+  // settings and store it as the module identifier. Returns the key.
+  static std::string ComputeKey(llvm::Module &module,
+                                const llvm::orc::JITTargetMachineBuilder &target,
+                                const std::string &pipeline);
+
+  // Remove old objects and leftover temporaries; see above
+  void Prune(uint64_t maxBytes = MaxBytes, int maxAgeDays = MaxAgeDays);
+
+  // True if an object for this key is already on disk
+  bool Contains(const std::string &key) const;
+
+  // llvm::ObjectCache
+  void notifyObjectCompiled(const llvm::Module *module,
+                            llvm::MemoryBufferRef object) override;
+  std::unique_ptr<llvm::MemoryBuffer>
+  getObject(const llvm::Module *module) override;
+
+  const std::string &GetDirectory() const { return m_Directory; }
+
+private:
+  std::string GetPath(const std::string &key) const;
+  static bool IsKey(const std::string &identifier);
+
+  std::string m_Directory;
+};
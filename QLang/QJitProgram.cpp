@@ -1,18 +1,328 @@
 #include "QJitProgram.h"
+#include "QAotLibrary.h"
+#include "QHeap.h"
+#include "QHeapToStack.h"
+#include "QJitObjectCache.h"
 #include "QLVM.h"
+#include "QNativeLibrary.h"
+#include "QProfiler.h"
 #include "QStaticRegistry.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
 #include <iostream>
-#include <llvm/ExecutionEngine/ExecutionEngine.h>
-#include <llvm/ExecutionEngine/GenericValue.h>
-#include <llvm/ExecutionEngine/MCJIT.h>
+#include <optional>
+#include <thread>
+#if defined(__linux__)
+#include <unistd.h>
+#endif
+#include <llvm/Bitcode/BitcodeReader.h>
+#include <llvm/Bitcode/BitcodeWriter.h>
+#include <llvm/Config/llvm-config.h>
+#include <llvm/ExecutionEngine/JITEventListener.h>
+#include <llvm/ExecutionEngine/Orc/CompileOnDemandLayer.h>
+#include <llvm/ExecutionEngine/Orc/CompileUtils.h>
+#include <llvm/ExecutionEngine/Orc/JITTargetMachineBuilder.h>
+#include <llvm/ExecutionEngine/Orc/LLJIT.h>
+#include <llvm/ExecutionEngine/Orc/ObjectTransformLayer.h>
+#include <llvm/ExecutionEngine/Orc/RTDyldObjectLinkingLayer.h>
 #include <llvm/ExecutionEngine/SectionMemoryManager.h>
+#include <llvm/IR/InstIterator.h>
+#include <llvm/IR/Instructions.h>
+#include <llvm/IR/LLVMContext.h>
 #include <llvm/IR/Module.h>
+#include <llvm/Object/SymbolSize.h>
+#include <llvm/Passes/PassBuilder.h>
+#include <llvm/Support/DynamicLibrary.h>
+#include <llvm/Support/MemoryBuffer.h>
 #include <llvm/Support/TargetSelect.h>
+#include <llvm/Target/TargetMachine.h>
 #include <llvm/Target/TargetOptions.h>
+#include <llvm/Transforms/Scalar/SROA.h>
+#include <llvm/Transforms/Utils/Cloning.h>
 
 QJitProgram *QJitProgram::s_Instance = nullptr;
+QJitOptLevel QJitProgram::s_DefaultOptLevel = QJitOptLevel::O2;
+std::string QJitProgram::s_ObjectCacheDirectory;
+bool QJitProgram::s_PerfOutput = false;
 
-QJitProgram::QJitProgram(std::unique_ptr<llvm::Module> module) {
+static double ElapsedMs(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(
+             std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+// Everything besides the IR and the target that decides the object code of
+// a partition. Bump PipelineVersion when OptimizeModule's passes change.
+static std::string PipelineKey(QJitOptLevel optLevel) {
+  constexpr int PipelineVersion = 1;
+  return "O" + std::to_string(static_cast<int>(optLevel)) +
+         (QProfiler::IsInstrumentationEnabled() ? ";instrumented" : "") +
+         ";passes" + std::to_string(PipelineVersion);
+}
+
+static size_t CountInstructions(const llvm::Module &module,
+                                size_t *functionCount = nullptr) {
+  size_t count = 0;
+  size_t functions = 0;
+  for (const auto &func : module) {
+    if (func.isDeclaration())
+      continue;
+    ++functions;
+    count += func.getInstructionCount();
+  }
+  if (functionCount)
+    *functionCount = functions;
+  return count;
+}
+
+// Resolves natives registered with QLVMContext::AddFunc
+// (sys::DynamicLibrary::AddSymbol), QProfiler counters and symbols of the
+// host process
+class QProcessSymbolGenerator : public llvm::orc::DefinitionGenerator {
+public:
+  llvm::Error
+  tryToGenerate(llvm::orc::LookupState &, llvm::orc::LookupKind,
+                llvm::orc::JITDylib &dylib, llvm::orc::JITDylibLookupFlags,
+                const llvm::orc::SymbolLookupSet &symbols) override {
+    llvm::orc::SymbolMap found;
+    for (const auto &[name, flags] : symbols) {
+      std::string symbol = (*name).str();
+      void *addr = QProfiler::Get().FindCounters(symbol);
+      if (!addr)
+        addr = llvm::sys::DynamicLibrary::SearchForAddressOfSymbol(symbol);
+      if (addr) {
+        found[name] = {llvm::orc::ExecutorAddr::fromPtr(addr),
+                       llvm::JITSymbolFlags::Exported};
+      }
+    }
+    if (found.empty())
+      return llvm::Error::success();
+    return dylib.define(llvm::orc::absoluteSymbols(std::move(found)));
+  }
+};
+
+// Writes /tmp/perf-<pid>.map, which Linux perf reads to name JIT frames
+// without any post-processing (jitdump needs 'perf inject --jit')
+class QPerfMapListener : public llvm::JITEventListener {
+public:
+  static QPerfMapListener &Get() {
+    static QPerfMapListener listener;
+    return listener;
+  }
+
+  void notifyObjectLoaded(ObjectKey, const llvm::object::ObjectFile &object,
+                          const llvm::RuntimeDyld::LoadedObjectInfo &info)
+      override {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    if (!m_File)
+      return;
+
+    auto symbols = llvm::object::computeSymbolSizes(object);
+    for (const auto &[symbol, size] : symbols) {
+      auto type = symbol.getType();
+      if (!type || *type != llvm::object::SymbolRef::ST_Function) {
+        if (!type)
+          llvm::consumeError(type.takeError());
+        continue;
+      }
+      auto name = symbol.getName();
+      auto address = symbol.getAddress();
+      auto section = symbol.getSection();
+      if (!name || !address || !section || *section == object.section_end()) {
+        if (!name)
+          llvm::consumeError(name.takeError());
+        if (!address)
+          llvm::consumeError(address.takeError());
+        if (!section)
+          llvm::consumeError(section.takeError());
+        continue;
+      }
+      uint64_t loaded = *address + info.getSectionLoadAddress(**section);
+      std::fprintf(m_File, "%llx %llx %s\n",
+                   static_cast<unsigned long long>(loaded),
+                   static_cast<unsigned long long>(size), name->str().c_str());
+    }
+    std::fflush(m_File);
+  }
+
+private:
+  QPerfMapListener() {
+#if defined(__linux__)
+    std::string path = "/tmp/perf-" + std::to_string(getpid()) + ".map";
+    m_File = std::fopen(path.c_str(), "a");
+#endif
+  }
+  ~QPerfMapListener() {
+    if (m_File)
+      std::fclose(m_File);
+  }
+
+  std::mutex m_Mutex;
+  std::FILE *m_File = nullptr;
+};
+
+// Lazy partitions: the requested functions plus the small functions they
+// call directly, so accessors like Vec3.Plus land in the caller's partition
+// and can be inlined by the optimization pipeline
+static std::optional<llvm::orc::CompileOnDemandLayer::GlobalValueSet>
+PartitionWithSmallCallees(
+    llvm::orc::CompileOnDemandLayer::GlobalValueSet requested) {
+  const unsigned maxCalleeInstructions = 64;
+
+  auto partition = requested;
+  std::vector<const llvm::Function *> worklist;
+  for (const auto *gv : requested) {
+    if (const auto *func = llvm::dyn_cast<llvm::Function>(gv))
+      worklist.push_back(func);
+  }
+
+  while (!worklist.empty()) {
+    const llvm::Function *func = worklist.back();
+    worklist.pop_back();
+    if (func->isDeclaration())
+      continue;
+
+    for (const auto &inst : llvm::instructions(*func)) {
+      const auto *call = llvm::dyn_cast<llvm::CallBase>(&inst);
+      if (!call)
+        continue;
+      const llvm::Function *callee = call->getCalledFunction();
+      if (!callee || callee->isDeclaration() ||
+          callee->getInstructionCount() > maxCalleeInstructions)
+        continue;
+      if (partition.insert(callee).second)
+        worklist.push_back(callee);
+    }
+  }
+  return partition;
+}
+
+// Move a module into a new context owned by the JIT. The compile threads
+// lock it while working, and the editor can keep generating IR in the shared
+// QLVM context at the same time.
+static std::unique_ptr<llvm::Module>
+TransferModule(std::unique_ptr<llvm::Module> module,
+               std::unique_ptr<llvm::LLVMContext> &context) {
+  llvm::SmallVector<char, 0> bitcode;
+  {
+    llvm::raw_svector_ostream os(bitcode);
+    llvm::WriteBitcodeToFile(*module, os);
+  }
+  module.reset();
+
+  context = std::make_unique<llvm::LLVMContext>();
+  auto parsed = llvm::parseBitcodeFile(
+      llvm::MemoryBufferRef(llvm::StringRef(bitcode.data(), bitcode.size()),
+                            "QLangJIT"),
+      *context);
+  if (!parsed) {
+    std::cerr << "[ERROR] QJitProgram: Failed to transfer module: "
+              << llvm::toString(parsed.takeError()) << std::endl;
+    return nullptr;
+  }
+  return std::move(*parsed);
+}
+
+// Split a program into the part of each script module ('modules': symbol
+// -> module) and the main part (everything else). Each part defines its own
+// symbols and declares the rest, except for module-private values and
+// always-inline helpers (value class methods), which every part gets a
+// private copy of so calls to them can still be inlined.
+static std::vector<std::pair<std::string, std::unique_ptr<llvm::Module>>>
+SplitModule(const llvm::Module &module,
+            const std::unordered_map<std::string, std::string> &modules) {
+  // Aliases (inherited methods) live with their target; slots with their
+  // function
+  auto moduleOf = [&](const llvm::GlobalValue *value) -> std::string {
+    if (const auto *alias = llvm::dyn_cast<llvm::GlobalAlias>(value))
+      value = alias->getAliaseeObject();
+    std::string name = value ? value->getName().str() : "";
+    auto it = modules.find(name);
+    if (it == modules.end() && name.size() > 5 &&
+        name.compare(name.size() - 5, 5, ".slot") == 0)
+      it = modules.find(name.substr(0, name.size() - 5));
+    return it != modules.end() ? it->second : "";
+  };
+  auto isInlineHelper = [](const llvm::GlobalValue *value) {
+    const auto *func = llvm::dyn_cast<llvm::Function>(value);
+    return func && !func->isDeclaration() &&
+           func->hasFnAttribute(llvm::Attribute::AlwaysInline);
+  };
+
+  std::vector<std::string> names = {""};
+  for (const auto &value : module.global_values()) {
+    std::string name = moduleOf(&value);
+    if (std::find(names.begin(), names.end(), name) == names.end())
+      names.push_back(name);
+  }
+
+  std::vector<std::pair<std::string, std::unique_ptr<llvm::Module>>> parts;
+  for (const auto &name : names) {
+    llvm::ValueToValueMapTy vmap;
+    auto part =
+        llvm::CloneModule(module, vmap, [&](const llvm::GlobalValue *value) {
+          return value->hasLocalLinkage() || isInlineHelper(value) ||
+                 moduleOf(value) == name;
+        });
+    for (auto &func : *part) {
+      if (isInlineHelper(&func) && !func.hasLocalLinkage() &&
+          moduleOf(&func) != name)
+        func.setLinkage(llvm::GlobalValue::InternalLinkage);
+    }
+    parts.push_back({name, std::move(part)});
+  }
+  return parts;
+}
+
+// Make calls to the given functions load their target from '<name>.slot'.
+// The program defines the slots (initialized to the functions); patches only
+// declare them. Direct calls to the new body would bypass later patches.
+static void RouteCallsThroughSlots(llvm::Module &module,
+                                   const std::vector<std::string> &names,
+                                   bool defineSlots) {
+  auto *ptrType = llvm::PointerType::getUnqual(module.getContext());
+  for (const auto &name : names) {
+    llvm::Function *func = module.getFunction(name);
+    if (!func)
+      continue;
+    if (defineSlots && func->isDeclaration())
+      continue;
+
+    std::string slotName = name + ".slot";
+    llvm::GlobalVariable *slot = module.getGlobalVariable(slotName);
+    if (!slot) {
+      slot = new llvm::GlobalVariable(module, ptrType, false,
+                                      llvm::GlobalValue::ExternalLinkage,
+                                      defineSlots ? func : nullptr, slotName);
+    }
+
+    std::vector<llvm::CallBase *> calls;
+    for (llvm::User *user : func->users()) {
+      auto *call = llvm::dyn_cast<llvm::CallBase>(user);
+      if (call && call->getCalledOperand() == func)
+        calls.push_back(call);
+    }
+    for (llvm::CallBase *call : calls) {
+      auto *target = new llvm::LoadInst(ptrType, slot, name + ".target", call);
+      call->setCalledOperand(target);
+    }
+  }
+}
+
+extern "C" void QJitLazyCompileFailed() {
+  std::cerr << "[ERROR] QJitProgram: Lazy compilation of a script function "
+               "failed"
+            << std::endl;
+}
+
+QJitProgram::QJitProgram(std::unique_ptr<llvm::Module> module)
+    : QJitProgram(std::move(module), s_DefaultOptLevel) {}
+
+QJitProgram::QJitProgram(
+    std::unique_ptr<llvm::Module> module, QJitOptLevel optLevel,
+    const std::vector<std::string> &patchable,
+    const std::unordered_map<std::string, std::string> &modules) {
   if (!s_Instance) {
     s_Instance = this;
   }
@@ -21,48 +331,339 @@ QJitProgram::QJitProgram(std::unique_ptr<llvm::Module> module) {
     return;
   }
 
-  std::string err;
-  llvm::EngineBuilder builder(std::move(module));
-  builder.setErrorStr(&err);
-  builder.setEngineKind(llvm::EngineKind::JIT);
+  m_Stats.optLevel = optLevel;
+  auto start = std::chrono::steady_clock::now();
 
-  m_Engine = builder.create();
+  // Hot patching: calls to patchable functions go through their slots
+  if (!patchable.empty()) {
+    m_Patchable = patchable;
+    RouteCallsThroughSlots(*module, m_Patchable, true);
+    for (const auto &name : m_Patchable) {
+      if (module->getGlobalVariable(name + ".slot"))
+        m_Slots[name] = name + ".slot";
+    }
+    // Inherited methods are aliases of the parent's function
+    for (const auto &alias : module->aliases()) {
+      auto *target = llvm::dyn_cast<llvm::Function>(
+          alias.getAliasee()->stripPointerCasts());
+      if (target && m_Slots.count(target->getName().str()))
+        m_Slots[alias.getName().str()] = m_Slots[target->getName().str()];
+    }
+  }
 
-  if (!m_Engine) {
-    std::cerr << "[ERROR] QJitProgram: Failed to create ExecutionEngine: "
-              << err << std::endl;
+  std::unique_ptr<llvm::LLVMContext> context;
+  std::unique_ptr<llvm::Module> ownedModule =
+      TransferModule(std::move(module), context);
+  if (!ownedModule)
+    return;
+  m_Stats.functionCount = 0;
+  CountInstructions(*ownedModule, &m_Stats.functionCount);
 
-    // Fallback to interpreter
-    std::cout << "[INFO] QJitProgram: Falling back to Interpreter..."
-              << std::endl;
-    builder.setEngineKind(llvm::EngineKind::Interpreter);
-    m_Engine = builder.create();
-    if (m_Engine) {
-      std::cout << "[INFO] QJitProgram: Interpreter created successfully."
-                << std::endl;
-    } else {
-      std::cerr << "[ERROR] QJitProgram: Interpreter creation also failed: "
-                << err << std::endl;
+  auto targetBuilder = llvm::orc::JITTargetMachineBuilder::detectHost();
+  if (!targetBuilder) {
+    std::cerr << "[ERROR] QJitProgram: Failed to detect host target: "
+              << llvm::toString(targetBuilder.takeError()) << std::endl;
+    return;
+  }
+#if LLVM_VERSION_MAJOR >= 18
+  targetBuilder->setCodeGenOptLevel(optLevel == QJitOptLevel::O0
+                                        ? llvm::CodeGenOptLevel::None
+                                    : optLevel == QJitOptLevel::O3
+                                        ? llvm::CodeGenOptLevel::Aggressive
+                                        : llvm::CodeGenOptLevel::Default);
+#else
+  targetBuilder->setCodeGenOptLevel(
+      optLevel == QJitOptLevel::O0   ? llvm::CodeGenOpt::None
+      : optLevel == QJitOptLevel::O3 ? llvm::CodeGenOpt::Aggressive
+                                     : llvm::CodeGenOpt::Default);
+#endif
+  m_TargetBuilder =
+      std::make_unique<llvm::orc::JITTargetMachineBuilder>(*targetBuilder);
+
+  if (!s_ObjectCacheDirectory.empty()) {
+    m_ObjectCache = std::make_unique<QJitObjectCache>(s_ObjectCacheDirectory);
+  }
+
+  unsigned threads = std::max(1u, std::thread::hardware_concurrency() / 2);
+  llvm::orc::LLLazyJITBuilder jitBuilder;
+  jitBuilder.setJITTargetMachineBuilder(std::move(*targetBuilder))
+      .setCompileFunctionCreator(
+          [this](llvm::orc::JITTargetMachineBuilder jtmb)
+              -> llvm::Expected<
+                  std::unique_ptr<llvm::orc::IRCompileLayer::IRCompiler>> {
+            return std::make_unique<llvm::orc::ConcurrentIRCompiler>(
+                std::move(jtmb), m_ObjectCache.get());
+          })
+      .setNumCompileThreads(threads)
+      .setLazyCompileFailureAddr(
+          llvm::orc::ExecutorAddr::fromPtr(&QJitLazyCompileFailed));
+
+  // Perf symbols: JIT event listeners are a RuntimeDyld feature, so the
+  // object layer is RuntimeDyld while perf output is on
+  if (s_PerfOutput) {
+    jitBuilder.setObjectLinkingLayerCreator(
+        [](llvm::orc::ExecutionSession &session, const llvm::Triple &triple)
+            -> llvm::Expected<std::unique_ptr<llvm::orc::ObjectLayer>> {
+          auto layer = std::make_unique<llvm::orc::RTDyldObjectLinkingLayer>(
+              session,
+              []() { return std::make_unique<llvm::SectionMemoryManager>(); });
+          if (triple.isOSBinFormatCOFF()) {
+            layer->setOverrideObjectFlagsWithResponsibilityFlags(true);
+            layer->setAutoClaimResponsibilityForObjectSymbols(true);
+          }
+          layer->registerJITEventListener(QPerfMapListener::Get());
+          // nullptr unless LLVM was built with LLVM_USE_PERF
+          if (auto *jitdump =
+                  llvm::JITEventListener::createPerfJITEventListener()) {
+            layer->registerJITEventListener(*jitdump);
+          }
+          return std::move(layer);
+        });
+  }
+  auto jit = jitBuilder.create();
+  if (!jit) {
+    std::cerr << "[ERROR] QJitProgram: Failed to create LLJIT: "
+              << llvm::toString(jit.takeError()) << std::endl;
+    return;
+  }
+  m_Jit = std::move(*jit);
+
+  m_Jit->getMainJITDylib().addGenerator(
+      std::make_unique<QProcessSymbolGenerator>());
+  m_Jit->setPartitionFunction(PartitionWithSmallCallees);
+
+  // Optimize each partition right before its machine code is emitted; the
+  // codegen time is measured on the same thread between the two transforms.
+  // With an object cache the partition is keyed on its unoptimized IR, and a
+  // hit skips the pipeline (the compiler then loads the object from disk).
+  static thread_local std::chrono::steady_clock::time_point codegenStart;
+  m_Jit->getIRTransformLayer().setTransform(
+      [this](llvm::orc::ThreadSafeModule tsm,
+             llvm::orc::MaterializationResponsibility &)
+          -> llvm::Expected<llvm::orc::ThreadSafeModule> {
+        tsm.withModuleDo([this](llvm::Module &partition) {
+          auto optStart = std::chrono::steady_clock::now();
+          size_t functions = 0;
+          size_t before = CountInstructions(partition, &functions);
+          bool cached = false;
+          if (m_ObjectCache) {
+            std::string key = QJitObjectCache::ComputeKey(
+                partition, *m_TargetBuilder, PipelineKey(m_Stats.optLevel));
+            cached = m_ObjectCache->Contains(key);
+          }
+          if (cached) {
+            std::lock_guard<std::mutex> lock(m_StatsMutex);
+            m_Stats.compiledFunctions += functions;
+            m_Stats.cachedFunctions += functions;
+            return;
+          }
+          Optimize(partition);
+          size_t after = CountInstructions(partition);
+
+          std::lock_guard<std::mutex> lock(m_StatsMutex);
+          m_Stats.compiledFunctions += functions;
+          m_Stats.instructionsBefore += before;
+          m_Stats.instructionsAfter += after;
+          m_Stats.optimizeMs += ElapsedMs(optStart);
+        });
+        codegenStart = std::chrono::steady_clock::now();
+        return std::move(tsm);
+      });
+  m_Jit->getObjTransformLayer().setTransform(
+      [this](std::unique_ptr<llvm::MemoryBuffer> object)
+          -> llvm::Expected<std::unique_ptr<llvm::MemoryBuffer>> {
+        std::lock_guard<std::mutex> lock(m_StatsMutex);
+        m_Stats.codegenMs += ElapsedMs(codegenStart);
+        return std::move(object);
+      });
+
+  // One JITDylib per script module, each linked against the others and the
+  // main one (which resolves natives), so a patch links into its own module
+  llvm::orc::JITDylib &mainDylib = m_Jit->getMainJITDylib();
+  std::vector<std::pair<std::string, std::unique_ptr<llvm::Module>>> parts;
+  if (modules.empty())
+    parts.push_back({"", std::move(ownedModule)});
+  else
+    parts = SplitModule(*ownedModule, modules);
+  ownedModule.reset();
+  std::vector<llvm::orc::JITDylib *> dylibs;
+  for (auto &[name, part] : parts) {
+    llvm::orc::JITDylib *dylib = &mainDylib;
+    if (!name.empty()) {
+      auto created = m_Jit->createJITDylib(name);
+      if (!created) {
+        std::cerr << "[ERROR] QJitProgram: Failed to create module '" << name
+                  << "': " << llvm::toString(created.takeError())
+                  << std::endl;
+        m_Jit.reset();
+        return;
+      }
+      dylib = &*created;
+      for (const auto &value : part->global_values()) {
+        if (!value.isDeclaration() && !value.hasLocalLinkage())
+          m_SymbolDylibs[value.getName().str()] = dylib;
+      }
+    }
+    dylibs.push_back(dylib);
+  }
+  for (auto *dylib : dylibs) {
+    for (auto *other : dylibs) {
+      if (other != dylib)
+        dylib->addToLinkOrder(*other);
     }
-  } else {
-    std::cout << "[INFO] QJitProgram: ExecutionEngine created successfully."
-              << std::endl;
   }
+
+  // Every function gets a lazy stub; nothing is compiled until called
+  llvm::orc::ThreadSafeContext threadSafeContext(std::move(context));
+  for (size_t i = 0; i < parts.size(); ++i) {
+    if (auto err = m_Jit->addLazyIRModule(
+            *dylibs[i], llvm::orc::ThreadSafeModule(std::move(parts[i].second),
+                                                    threadSafeContext))) {
+      std::cerr << "[ERROR] QJitProgram: Failed to add module: "
+                << llvm::toString(std::move(err)) << std::endl;
+      m_Jit.reset();
+      return;
+    }
+  }
+
+  m_Stats.setupMs = ElapsedMs(start);
+  std::cout << "[INFO] QJitProgram: LLJIT ready (O" << static_cast<int>(optLevel)
+            << ", " << m_Stats.functionCount << " lazy functions in "
+            << dylibs.size() << " modules, " << threads << " compile threads, "
+            << m_Stats.setupMs << " ms)" << std::endl;
+}
+
+void QJitProgram::Optimize(llvm::Module &module) {
+  // Coroutines (yield/wait) have to be split into their ramp and resume
+  // functions even when nothing is optimized
+  llvm::Function *coroBegin = module.getFunction("llvm.coro.begin");
+  bool hasCoroutines = coroBegin && !coroBegin->use_empty();
+  if (m_Stats.optLevel == QJitOptLevel::O0 && !hasCoroutines)
+    return;
+
+  // Runs on compile threads: one TargetMachine per partition
+  auto targetMachine = m_TargetBuilder->createTargetMachine();
+  if (!targetMachine) {
+    llvm::consumeError(targetMachine.takeError());
+    return;
+  }
+  OptimizeModule(module, targetMachine->get(), m_Stats.optLevel);
+}
+
+void QJitProgram::OptimizeModule(llvm::Module &module,
+                                 llvm::TargetMachine *targetMachine,
+                                 QJitOptLevel optLevel, bool wholeProgram) {
+  llvm::OptimizationLevel level = llvm::OptimizationLevel::O2;
+  switch (optLevel) {
+  case QJitOptLevel::O1:
+    level = llvm::OptimizationLevel::O1;
+    break;
+  case QJitOptLevel::O3:
+    level = llvm::OptimizationLevel::O3;
+    break;
+  default:
+    break;
+  }
+
+  // New PassManager. The default module pipeline runs the per-function
+  // simplification passes (SROA/mem2reg, instcombine, GVN, loop passes)
+  // bottom-up over the call graph, so small methods such as Vec3.Plus are
+  // simplified before their callers decide whether to inline them.
+  llvm::LoopAnalysisManager lam;
+  llvm::FunctionAnalysisManager fam;
+  llvm::CGSCCAnalysisManager cgam;
+  llvm::ModuleAnalysisManager mam;
+
+  llvm::PassBuilder passBuilder(targetMachine);
+
+  // After inlining, non-escaping 'new' temporaries move to the stack and SROA
+  // splits them into registers
+  passBuilder.registerScalarOptimizerLateEPCallback(
+      [](llvm::FunctionPassManager &fpm, llvm::OptimizationLevel) {
+        fpm.addPass(QHeapToStackPass());
+#if LLVM_VERSION_MAJOR >= 16
+        fpm.addPass(llvm::SROAPass(llvm::SROAOptions::ModifyCFG));
+#else
+        fpm.addPass(llvm::SROAPass());
+#endif
+      });
+  passBuilder.registerModuleAnalyses(mam);
+  passBuilder.registerCGSCCAnalyses(cgam);
+  passBuilder.registerFunctionAnalyses(fam);
+  passBuilder.registerLoopAnalyses(lam);
+  passBuilder.crossRegisterProxies(lam, fam, cgam, mam);
+
+  if (optLevel == QJitOptLevel::O0) {
+    passBuilder.buildO0DefaultPipeline(llvm::OptimizationLevel::O0)
+        .run(module, mam);
+    return;
+  }
+  if (!wholeProgram) {
+    passBuilder.buildPerModuleDefaultPipeline(level).run(module, mam);
+    return;
+  }
+
+  // Full LTO: the module holds every script and only the entry points are
+  // external, so the link-time pipeline can inline, specialize and drop
+  // code across script boundaries
+  passBuilder.buildLTOPreLinkDefaultPipeline(level).run(module, mam);
+  passBuilder.buildLTODefaultPipeline(level, nullptr).run(module, mam);
+}
+
+QJitCompileStats QJitProgram::GetCompileStats() const {
+  std::lock_guard<std::mutex> lock(m_StatsMutex);
+  return m_Stats;
 }
 
 QJitProgram::~QJitProgram() {
-  if (m_Engine) {
-    delete m_Engine;
+  // Joins the compile threads before the members they use go away
+  m_Jit.reset();
+}
+
+std::shared_ptr<QJitProgram>
+QJitProgram::LoadNativeLibrary(const std::string &path) {
+  auto start = std::chrono::steady_clock::now();
+
+  // Binds natives and adopts static instances
+  auto library = QNativeLibrary::Load(path);
+  if (!library)
+    return nullptr;
+  const QAotManifest *manifest = &library->GetManifest();
+
+  std::shared_ptr<QJitProgram> program(new QJitProgram());
+  program->m_NativeLibrary = std::move(library);
+  program->m_Stats.optLevel = QJitOptLevel::O3;
+  if (!s_Instance) {
+    s_Instance = program.get();
   }
+
+  // No struct types without LLVM: instances only need sizes and offsets
+  for (uint32_t i = 0; i < manifest->classCount; ++i) {
+    const QAotClass &cls = manifest->classes[i];
+    program->RegisterClass(cls.name, nullptr, cls.size, cls.constructorName,
+                           cls.isStatic != 0);
+    for (uint32_t m = 0; m < cls.memberCount; ++m) {
+      const QAotMember &member = cls.members[m];
+      program->RegisterMember(cls.name, member.name, member.offset,
+                              member.size, member.typeToken, member.typeName);
+    }
+  }
+
+  program->m_Stats.setupMs = ElapsedMs(start);
+  std::cout << "[INFO] QJitProgram: Loaded native library '" << path << "' ("
+            << manifest->classCount << " classes, " << manifest->importCount
+            << " natives, " << program->m_Stats.setupMs << " ms)"
+            << std::endl;
+  return program;
 }
 
 void QJitProgram::Run() {
-  if (!m_Engine) {
-    std::cerr << "[ERROR] QJitProgram: Cannot run, engine is null" << std::endl;
+  if (!m_Jit && !m_NativeLibrary) {
+    std::cerr << "[ERROR] QJitProgram: Cannot run, JIT is null" << std::endl;
     return;
   }
 
-  uint64_t addr = m_Engine->getFunctionAddress("__qlang_global_entry");
+  uint64_t addr = GetFunctionAddress("__qlang_global_entry");
   if (addr) {
     std::cout << "[INFO] QJitProgram: Executing __qlang_global_entry at 0x"
               << std::hex << addr << std::dec << "..." << std::endl;
@@ -82,10 +683,99 @@ void QJitProgram::Run() {
 }
 
 uint64_t QJitProgram::GetFunctionAddress(const std::string &funcName) {
-  if (!m_Engine) {
+  if (m_NativeLibrary) {
+    return reinterpret_cast<uint64_t>(m_NativeLibrary->GetSymbol(funcName));
+  }
+  if (!m_Jit) {
+    return 0;
+  }
+  // Patchable functions: the slot holds the current body
+  auto slot = m_Slots.find(funcName);
+  if (slot != m_Slots.end()) {
+    auto slotSymbol = m_Jit->lookup(DylibOf(slot->second), slot->second);
+    if (!slotSymbol) {
+      llvm::consumeError(slotSymbol.takeError());
+      return 0;
+    }
+    return *reinterpret_cast<const uint64_t *>(slotSymbol->getValue());
+  }
+  // Returns the lazy stub; the body is compiled on its first call
+  auto symbol = m_Jit->lookup(DylibOf(funcName), funcName);
+  if (!symbol) {
+    llvm::consumeError(symbol.takeError());
     return 0;
   }
-  return m_Engine->getFunctionAddress(funcName);
+  return symbol->getValue();
+}
+
+llvm::orc::JITDylib &QJitProgram::DylibOf(const std::string &symbol) const {
+  auto it = m_SymbolDylibs.find(symbol);
+  return it != m_SymbolDylibs.end() ? *it->second : m_Jit->getMainJITDylib();
+}
+
+bool QJitProgram::ReplaceFunctions(std::unique_ptr<llvm::Module> patch,
+                                   const std::vector<std::string> &names) {
+  if (!m_Jit || !patch)
+    return false;
+
+  // Calls between the new bodies (recursion included) go through the slots
+  // too, then the bodies get names of their own: the JIT never redefines a
+  // symbol
+  RouteCallsThroughSlots(*patch, m_Patchable, false);
+  std::string suffix = ".p" + std::to_string(++m_PatchCount);
+  std::vector<std::pair<std::string, std::string>> renamed;
+  // Links into the module of the patched functions, against the others
+  llvm::orc::JITDylib *dylib = &DylibOf(names.empty() ? "" : names[0]);
+  for (const auto &name : names) {
+    llvm::Function *func = patch->getFunction(name);
+    if (!func || func->isDeclaration() || !m_Slots.count(name) ||
+        &DylibOf(name) != dylib) {
+      std::cerr << "[ERROR] QJitProgram: '" << name << "' cannot be patched"
+                << std::endl;
+      return false;
+    }
+    func->setName(name + suffix);
+    renamed.push_back({name, name + suffix});
+  }
+
+  std::unique_ptr<llvm::LLVMContext> context;
+  std::unique_ptr<llvm::Module> owned =
+      TransferModule(std::move(patch), context);
+  if (!owned)
+    return false;
+  if (auto err = m_Jit->addIRModule(
+          *dylib,
+          llvm::orc::ThreadSafeModule(std::move(owned), std::move(context)))) {
+    std::cerr << "[ERROR] QJitProgram: Failed to add patch: "
+              << llvm::toString(std::move(err)) << std::endl;
+    return false;
+  }
+
+  // Resolve every new body before touching a slot, so a failure leaves the
+  // program as it was
+  std::vector<std::pair<uint64_t *, uint64_t>> updates;
+  for (const auto &[name, newName] : renamed) {
+    auto body = m_Jit->lookup(*dylib, newName);
+    auto slot = m_Jit->lookup(DylibOf(m_Slots[name]), m_Slots[name]);
+    if (!body || !slot) {
+      if (!body)
+        llvm::consumeError(body.takeError());
+      if (!slot)
+        llvm::consumeError(slot.takeError());
+      std::cerr << "[ERROR] QJitProgram: Failed to resolve patched '" << name
+                << "'" << std::endl;
+      return false;
+    }
+    updates.push_back(
+        {reinterpret_cast<uint64_t *>(slot->getValue()), body->getValue()});
+  }
+
+  // Called between frames: no script code is running. Calls already made
+  // through the old slot value finish in the old body, which stays mapped.
+  for (const auto &[slot, address] : updates) {
+    *slot = address;
+  }
+  return true;
 }
 
 void QJitProgram::RegisterClass(const std::string &className,
@@ -144,6 +834,30 @@ void QJitProgram::RegisterMember(const std::string &className,
   info.typeToken = typeToken;
   info.typeName = typeName;
   it->second.members[memberName] = info;
+  it->second.layout.reset(); // Rebuilt with the new member on next use
+}
+
+std::shared_ptr<const QJClassLayout>
+QJitProgram::GetClassLayout(const std::string &className) const {
+  auto it = m_RegisteredClasses.find(className);
+  if (it == m_RegisteredClasses.end()) {
+    return nullptr;
+  }
+
+  const RuntimeClassInfo &info = it->second;
+  if (!info.layout) {
+    std::vector<QJMember> members;
+    members.reserve(info.members.size());
+    for (const auto &member : info.members) {
+      QJMember entry;
+      entry.name = member.first;
+      entry.info = member.second;
+      members.push_back(std::move(entry));
+    }
+    info.layout = std::make_shared<const QJClassLayout>(className, info.size,
+                                                        std::move(members));
+  }
+  return info.layout;
 }
 
 std::shared_ptr<QJClassInstance>
@@ -157,17 +871,15 @@ QJitProgram::CreateClassInstance(const std::string &className) {
 
   const RuntimeClassInfo &info = it->second;
 
-  // Allocate memory for the instance
-  void *instancePtr = malloc(static_cast<size_t>(info.size));
+  // Allocate zeroed memory for the instance on the managed heap. It stays
+  // alive while a QJClassInstance refers to it.
+  void *instancePtr = QHeap::Get().AllocObject(static_cast<size_t>(info.size));
   if (!instancePtr) {
     std::cerr << "[ERROR] QJitProgram: Failed to allocate memory for class '"
               << className << "'" << std::endl;
     return nullptr;
   }
 
-  // Zero-initialize
-  memset(instancePtr, 0, static_cast<size_t>(info.size));
-
   // Call constructor if available
   if (!info.constructorName.empty()) {
     uint64_t ctorAddr = GetFunctionAddress(info.constructorName);
@@ -178,15 +890,9 @@ QJitProgram::CreateClassInstance(const std::string &className) {
     }
   }
 
-  // Create instance and register member info
-  auto instance = std::make_shared<QJClassInstance>(className, instancePtr);
-
-  // Copy member info to instance for runtime access
-  for (const auto &member : info.members) {
-    instance->RegisterMember(member.first, member.second);
-  }
-
-  return instance;
+  // Instances share the class layout instead of copying member info
+  return std::make_shared<QJClassInstance>(GetClassLayout(className),
+                                           instancePtr);
 }
 
 std::shared_ptr<QJClassInstance>
@@ -214,15 +920,8 @@ QJitProgram::GetStaticInstance(const std::string &className) {
   }
 
   // Create a wrapper instance pointing to the static memory
-  auto instance =
-      std::make_shared<QJClassInstance>(className, info.staticInstancePtr);
-
-  // Copy member info to instance for runtime access
-  for (const auto &member : info.members) {
-    instance->RegisterMember(member.first, member.second);
-  }
-
-  return instance;
+  return std::make_shared<QJClassInstance>(GetClassLayout(className),
+                                           info.staticInstancePtr);
 }
 
 // Pack a QJValue into a void* slot for passing through the wrapper
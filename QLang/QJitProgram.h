@@ -1,6 +1,7 @@
 #pragma once
 
 #include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -10,12 +11,20 @@
 #include "QMethodHandle.h"
 
 namespace llvm {
-class ExecutionEngine;
 class Module;
 class StructType;
+class TargetMachine;
 class Type;
+namespace orc {
+class JITDylib;
+class LLLazyJIT;
+class JITTargetMachineBuilder;
+} // namespace orc
 } // namespace llvm
 
+class QJitObjectCache;
+class QNativeLibrary;
+
 // Method parameter type enum - matches QLang types
 enum class QJParamType { Int32, Int64, Float32, Float64, Bool, String, Ptr };
 
@@ -27,6 +36,26 @@ struct MethodSignature {
   bool returnsVoid = true;
 };
 
+// IR optimization level applied before machine code generation
+// O0: no IR passes, fastest edit-compile; O2/O3: play/shipping builds
+enum class QJitOptLevel { O0, O1, O2, O3 };
+
+// Per-phase compile timing (milliseconds). Functions are compiled lazily,
+// so optimize/codegen totals grow as new functions get called.
+struct QJitCompileStats {
+  QJitOptLevel optLevel = QJitOptLevel::O0;
+  double setupMs = 0.0;    // Module transfer + JIT creation + lazy stubs
+  double optimizeMs = 0.0; // New PassManager pipeline
+  double codegenMs = 0.0;  // Machine code emission
+  size_t functionCount = 0;     // Defined in the module
+  size_t compiledFunctions = 0; // Actually materialized so far
+  size_t cachedFunctions = 0;   // Of those, loaded from the object cache
+  size_t instructionsBefore = 0;
+  size_t instructionsAfter = 0;
+
+  double TotalMs() const { return setupMs + optimizeMs + codegenMs; }
+};
+
 // Stores compiled class metadata for runtime instance creation
 struct RuntimeClassInfo {
   llvm::StructType *structType = nullptr;
@@ -35,6 +64,8 @@ struct RuntimeClassInfo {
   std::unordered_map<std::string, MethodSignature> methods;
   std::unordered_map<std::string, MemberInfo>
       members;           // Member offset info for get/set
+  // Shared by all instances; built from 'members' on first use
+  mutable std::shared_ptr<const QJClassLayout> layout;
   bool isStatic = false; // True if this is a static class (singleton)
   void *staticInstancePtr = nullptr; // Pointer to static instance (if isStatic)
 };
@@ -42,16 +73,79 @@ struct RuntimeClassInfo {
 class QJitProgram {
 public:
   QJitProgram(std::unique_ptr<llvm::Module> module);
+  // 'patchable' names functions that ReplaceFunctions may swap out later
+  // (edit-and-continue). Calls to them load their target from a pointer
+  // slot instead of being direct, which also keeps them from being inlined.
+  // 'modules' maps symbols to the script module defining them: each module
+  // gets a JITDylib of its own, linked against the others, and symbols not
+  // listed form the main one.
+  QJitProgram(std::unique_ptr<llvm::Module> module, QJitOptLevel optLevel,
+              const std::vector<std::string> &patchable = {},
+              const std::unordered_map<std::string, std::string> &modules = {});
   ~QJitProgram();
 
+  // Load a native library built by QJitRunner::CompileLibrary: classes and
+  // members come from its tables, methods resolve through dlsym, so nothing
+  // is compiled at startup. Natives must be registered (QLVMContext or
+  // QNativeSymbols) before the call. Returns null if the library is missing
+  // or does not match; see QNativeLibrary, which does the loading without
+  // LLVM. The library stays loaded for the rest of the process.
+  static std::shared_ptr<QJitProgram>
+  LoadNativeLibrary(const std::string &path);
+
   static QJitProgram *Instance() { return s_Instance; }
   static void SetInstance(QJitProgram *instance) { s_Instance = instance; }
 
+  // Level used by programs created without an explicit one
+  static void SetDefaultOptLevel(QJitOptLevel level) {
+    s_DefaultOptLevel = level;
+  }
+  static QJitOptLevel GetDefaultOptLevel() { return s_DefaultOptLevel; }
+
+  // Directory for compiled object code reused across runs (empty = off).
+  // Applies to programs created after the call.
+  static void SetObjectCacheDirectory(const std::string &directory) {
+    s_ObjectCacheDirectory = directory;
+  }
+  static const std::string &GetObjectCacheDirectory() {
+    return s_ObjectCacheDirectory;
+  }
+
+  // Emit symbols of compiled code for Linux perf: /tmp/perf-<pid>.map, plus
+  // a jitdump file when LLVM has perf support. Applies to programs created
+  // after the call.
+  static void SetPerfOutput(bool enabled) { s_PerfOutput = enabled; }
+  static bool IsPerfOutputEnabled() { return s_PerfOutput; }
+
+  QJitCompileStats GetCompileStats() const;
+
+  // Optimization pipeline of the JIT, also used for ahead-of-time builds.
+  // 'wholeProgram': the module is the entire program with only its entry
+  // points external; runs the full LTO pipeline.
+  static void OptimizeModule(llvm::Module &module,
+                             llvm::TargetMachine *targetMachine,
+                             QJitOptLevel optLevel, bool wholeProgram = false);
+
+  bool IsNativeLibrary() const { return m_NativeLibrary != nullptr; }
+
   void Run();
 
-  // Get address of a JIT-compiled function by name
+  // Get address of a JIT-compiled function by name. Functions compile on
+  // their first call, so this is cheap; cache the result on hot paths.
   uint64_t GetFunctionAddress(const std::string &funcName);
 
+  // Swap in new bodies for patchable functions. 'patch' defines them under
+  // their own names; everything else it uses can be a declaration. The names
+  // must belong to one module, which the patch is linked into. Callers
+  // pick up the new code on their next call; addresses obtained earlier
+  // from GetFunctionAddress still point at the old code, so resolve handles
+  // again. Returns false, changing nothing, if a body fails to link.
+  bool ReplaceFunctions(std::unique_ptr<llvm::Module> patch,
+                        const std::vector<std::string> &names);
+  bool IsPatchable(const std::string &funcName) const {
+    return m_Slots.count(funcName) != 0;
+  }
+
   // Register a class for runtime instance creation
   void RegisterClass(const std::string &className, llvm::StructType *structType,
                      uint64_t size, const std::string &constructorName,
@@ -84,6 +178,11 @@ public:
     return nullptr;
   }
 
+  // Member layout shared by every instance of the class (nullptr if the
+  // class is not registered)
+  std::shared_ptr<const QJClassLayout>
+  GetClassLayout(const std::string &className) const;
+
   // ==== Method Calling Options (slowest to fastest) ====
 
   // 1. Dynamic call - most flexible, slowest (~100ns per call)
@@ -121,12 +220,34 @@ public:
   }
 
 private:
+  QJitProgram() = default; // LoadNativeLibrary
+
+  // Run the optimization pipeline for m_Stats.optLevel on a lazy partition
+  void Optimize(llvm::Module &module);
+
+  // JITDylib of the script module defining a symbol (main if none)
+  llvm::orc::JITDylib &DylibOf(const std::string &symbol) const;
+
   // Internal helper for dynamic function calling
   void CallMethodDynamic(uint64_t funcAddr, void *thisPtr,
                          const std::vector<QJValue> &args,
                          const MethodSignature &sig);
 
-  llvm::ExecutionEngine *m_Engine = nullptr;
+  std::unique_ptr<QJitObjectCache> m_ObjectCache; // Outlives m_Jit
+  std::unique_ptr<llvm::orc::LLLazyJIT> m_Jit;
+  std::unique_ptr<llvm::orc::JITTargetMachineBuilder> m_TargetBuilder;
+  // Instead of m_Jit; never unloaded
+  std::unique_ptr<QNativeLibrary> m_NativeLibrary;
   std::unordered_map<std::string, RuntimeClassInfo> m_RegisteredClasses;
+  std::vector<std::string> m_Patchable;
+  // Function (or alias) name -> symbol of the slot holding its current body
+  std::unordered_map<std::string, std::string> m_Slots;
+  std::unordered_map<std::string, llvm::orc::JITDylib *> m_SymbolDylibs;
+  unsigned m_PatchCount = 0;
+  mutable std::mutex m_StatsMutex; // Stats are updated on compile threads
+  QJitCompileStats m_Stats;
   static QJitProgram *s_Instance;
+  static QJitOptLevel s_DefaultOptLevel;
+  static std::string s_ObjectCacheDirectory;
+  static bool s_PerfOutput;
 };
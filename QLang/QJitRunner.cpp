@@ -1,4 +1,5 @@
 #include "QJitRunner.h"
+#include "QAotLibrary.h"
 #include "QAssign.h"
 #include "QClass.h"
 #include "QCode.h"
@@ -9,36 +10,53 @@
 #include "QIf.h"
 #include "QInstanceDecl.h"
 #include "QJitProgram.h"
+#include "QLocalConstants.h"
 #include "QMemberAssign.h"
 #include "QMethod.h"
 #include "QModuleFile.h"
 
 #include "QMethodCall.h"
+#include "QProfiler.h"
 #include "QReturn.h"
+#include "QWhile.h"
+#include "QYield.h"
 
 #include "Parser.h"
 #include "QConsole.h"
 #include "QLVM.h"
 #include "QLVMContext.h"
 #include "QProgram.h"
+#include "QScriptGraph.h"
 #include "QStatement.h"
 #include "QStaticRegistry.h"
 #include "QValidator.h"
 #include "QVariableDecl.h"
 #include "Tokenizer.h"
 
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <set>
+#include <llvm/Bitcode/BitcodeReader.h>
+#include <llvm/Bitcode/BitcodeWriter.h>
+#include <llvm/Config/llvm-config.h>
+#include <llvm/ExecutionEngine/Orc/JITTargetMachineBuilder.h>
 #include <llvm/IR/Constants.h>
 #include <llvm/IR/DerivedTypes.h>
 #include <llvm/IR/IRBuilder.h>
+#include <llvm/IR/InstIterator.h>
 #include <llvm/IR/Instructions.h>
+#include <llvm/IR/Intrinsics.h>
+#include <llvm/IR/LegacyPassManager.h>
 #include <llvm/IR/Module.h>
 #include <llvm/IR/Type.h>
 #include <llvm/IR/Verifier.h>
 #include <llvm/Linker/Linker.h>
 #include <llvm/Support/raw_ostream.h>
+#include <llvm/Target/TargetMachine.h>
 #include <llvm/Transforms/Utils/Cloning.h>
 
 QJitRunner::QJitRunner(std::shared_ptr<QLVMContext> lvmContext,
@@ -120,6 +138,14 @@ llvm::Type *QJitRunner::GetLLVMType(int tokenType,
     return llvm::PointerType::getUnqual(context); // byte* pointer
   case TokenType::T_STRING_TYPE:
     return llvm::PointerType::getUnqual(context);
+  case TokenType::T_VEC2:
+    return llvm::ArrayType::get(llvm::Type::getFloatTy(context), 2);
+  case TokenType::T_VEC3:
+    return llvm::ArrayType::get(llvm::Type::getFloatTy(context), 3);
+  case TokenType::T_VEC4:
+    return llvm::ArrayType::get(llvm::Type::getFloatTy(context), 4);
+  case TokenType::T_MAT4:
+    return llvm::ArrayType::get(llvm::Type::getFloatTy(context), 16);
   case TokenType::T_IDENTIFIER:
     // This could be a class type - look it up
     // This could be a class type - look it up
@@ -178,6 +204,11 @@ llvm::Value *QJitRunner::CompilePrimaryExpr(const std::vector<Token> &tokens,
 
   const Token &token = tokens[pos];
 
+  // Literals inside a vector expression are float32 (v * 2.0)
+  if (GetVectorWidth(expectedType)) {
+    expectedType = builder.getFloatTy();
+  }
+
   // Handle parenthesized sub-expressions
   if (token.type == TokenType::T_LPAREN) {
     pos++; // consume '('
@@ -196,23 +227,23 @@ llvm::Value *QJitRunner::CompilePrimaryExpr(const std::vector<Token> &tokens,
 
   switch (token.type) {
   case TokenType::T_INTEGER: {
-    int64_t value = std::stoll(token.value);
+    int64_t value = std::stoll(token.Text());
 
     // Check for .ToString() on integer literal: 12.ToString()
     if (pos < tokens.size() && tokens[pos].type == TokenType::T_DOT) {
       size_t savedPos = pos;
       pos++; // consume '.'
       if (pos < tokens.size() && tokens[pos].type == TokenType::T_IDENTIFIER &&
-          tokens[pos].value == "ToString") {
+          tokens[pos].Text() == "ToString") {
         pos++; // consume 'ToString'
         if (pos < tokens.size() && tokens[pos].type == TokenType::T_LPAREN) {
           pos++; // consume '('
           if (pos < tokens.size() && tokens[pos].type == TokenType::T_RPAREN) {
             pos++; // consume ')'
             std::cout << "[DEBUG] QJitRunner: Integer.ToString() "
-                      << token.value << " = \"" << token.value << "\""
+                      << token.Text() << " = \"" << token.Text() << "\""
                       << std::endl;
-            return builder.CreateGlobalStringPtr(token.value);
+            return builder.CreateGlobalStringPtr(token.Text());
           }
         }
       }
@@ -227,22 +258,22 @@ llvm::Value *QJitRunner::CompilePrimaryExpr(const std::vector<Token> &tokens,
   }
 
   case TokenType::T_FLOAT: {
-    double value = std::stod(token.value);
+    double value = std::stod(token.Text());
 
     // Check for .ToString() on float literal: 3.14.ToString()
     if (pos < tokens.size() && tokens[pos].type == TokenType::T_DOT) {
       size_t savedPos = pos;
       pos++; // consume '.'
       if (pos < tokens.size() && tokens[pos].type == TokenType::T_IDENTIFIER &&
-          tokens[pos].value == "ToString") {
+          tokens[pos].Text() == "ToString") {
         pos++; // consume 'ToString'
         if (pos < tokens.size() && tokens[pos].type == TokenType::T_LPAREN) {
           pos++; // consume '('
           if (pos < tokens.size() && tokens[pos].type == TokenType::T_RPAREN) {
             pos++; // consume ')'
-            std::cout << "[DEBUG] QJitRunner: Float.ToString() " << token.value
-                      << " = \"" << token.value << "\"" << std::endl;
-            return builder.CreateGlobalStringPtr(token.value);
+            std::cout << "[DEBUG] QJitRunner: Float.ToString() " << token.Text()
+                      << " = \"" << token.Text() << "\"" << std::endl;
+            return builder.CreateGlobalStringPtr(token.Text());
           }
         }
       }
@@ -257,7 +288,7 @@ llvm::Value *QJitRunner::CompilePrimaryExpr(const std::vector<Token> &tokens,
   }
 
   case TokenType::T_STRING:
-    return builder.CreateGlobalStringPtr(token.value);
+    return builder.CreateGlobalStringPtr(token.Text());
 
   case TokenType::T_TRUE: {
     // Check for .ToString(): true.ToString()
@@ -265,7 +296,7 @@ llvm::Value *QJitRunner::CompilePrimaryExpr(const std::vector<Token> &tokens,
       size_t savedPos = pos;
       pos++;
       if (pos < tokens.size() && tokens[pos].type == TokenType::T_IDENTIFIER &&
-          tokens[pos].value == "ToString") {
+          tokens[pos].Text() == "ToString") {
         pos++;
         if (pos < tokens.size() && tokens[pos].type == TokenType::T_LPAREN) {
           pos++;
@@ -286,7 +317,7 @@ llvm::Value *QJitRunner::CompilePrimaryExpr(const std::vector<Token> &tokens,
       size_t savedPos = pos;
       pos++;
       if (pos < tokens.size() && tokens[pos].type == TokenType::T_IDENTIFIER &&
-          tokens[pos].value == "ToString") {
+          tokens[pos].Text() == "ToString") {
         pos++;
         if (pos < tokens.size() && tokens[pos].type == TokenType::T_LPAREN) {
           pos++;
@@ -301,6 +332,13 @@ llvm::Value *QJitRunner::CompilePrimaryExpr(const std::vector<Token> &tokens,
     return llvm::ConstantInt::getFalse(QLVM::GetContext());
   }
 
+  case TokenType::T_VEC2:
+  case TokenType::T_VEC3:
+  case TokenType::T_VEC4:
+  case TokenType::T_MAT4:
+    // Constructor: vec3(x, y, z), vec3(s), mat4()
+    return CompileVectorConstructor(static_cast<int>(token.type), tokens, pos);
+
   case TokenType::T_NULL: {
     // Return a null pointer constant for class instance variables
     std::cout << "[DEBUG] QJitRunner: Null literal" << std::endl;
@@ -330,7 +368,7 @@ llvm::Value *QJitRunner::CompilePrimaryExpr(const std::vector<Token> &tokens,
                   << std::endl;
         return nullptr;
       }
-      int arraySize = std::stoi(tokens[pos].value);
+      int arraySize = std::stoi(tokens[pos].Text());
       pos++; // consume size
 
       // Expect ']'
@@ -352,10 +390,10 @@ llvm::Value *QJitRunner::CompilePrimaryExpr(const std::vector<Token> &tokens,
                 << "[" << arraySize << "] (" << totalBytes << " bytes)"
                 << std::endl;
 
-      // Get or declare malloc
-      llvm::Function *mallocFunc = m_LVMContext->GetLLVMFunc("malloc");
+      // Get or declare the managed allocator
+      llvm::Function *mallocFunc = m_LVMContext->GetLLVMFunc("qlang_alloc");
       if (!mallocFunc) {
-        mallocFunc = QLVM::GetModule()->getFunction("malloc");
+        mallocFunc = QLVM::GetModule()->getFunction("qlang_alloc");
         if (!mallocFunc) {
           std::vector<llvm::Type *> args = {
               llvm::Type::getInt64Ty(QLVM::GetContext())};
@@ -363,12 +401,12 @@ llvm::Value *QJitRunner::CompilePrimaryExpr(const std::vector<Token> &tokens,
               llvm::PointerType::getUnqual(QLVM::GetContext()), args, false);
           mallocFunc = llvm::Function::Create(mallocType,
                                               llvm::Function::ExternalLinkage,
-                                              "malloc", QLVM::GetModule());
+                                              "qlang_alloc", QLVM::GetModule());
         }
       }
 
       if (!mallocFunc) {
-        std::cerr << "[ERROR] QJitRunner: malloc not available" << std::endl;
+        std::cerr << "[ERROR] QJitRunner: qlang_alloc not available" << std::endl;
         return nullptr;
       }
 
@@ -386,7 +424,7 @@ llvm::Value *QJitRunner::CompilePrimaryExpr(const std::vector<Token> &tokens,
                 << std::endl;
       return nullptr;
     }
-    std::string className = tokens[pos].value;
+    std::string className = tokens[pos].Text();
     pos++; // consume class name
 
     // Parse constructor arguments
@@ -467,11 +505,11 @@ llvm::Value *QJitRunner::CompilePrimaryExpr(const std::vector<Token> &tokens,
       return nullptr;
     }
 
-    // Allocate memory on heap using malloc and call constructor
-    llvm::Function *mallocFunc = m_LVMContext->GetLLVMFunc("malloc");
+    // Allocate on the managed heap and call constructor
+    llvm::Function *mallocFunc = m_LVMContext->GetLLVMFunc("qlang_alloc");
     if (!mallocFunc) {
       // Fallback: try to find or declare in current module
-      mallocFunc = QLVM::GetModule()->getFunction("malloc");
+      mallocFunc = QLVM::GetModule()->getFunction("qlang_alloc");
       if (!mallocFunc) {
         std::vector<llvm::Type *> args = {
             llvm::Type::getInt64Ty(QLVM::GetContext())};
@@ -479,12 +517,12 @@ llvm::Value *QJitRunner::CompilePrimaryExpr(const std::vector<Token> &tokens,
             llvm::PointerType::getUnqual(QLVM::GetContext()), args, false);
         mallocFunc =
             llvm::Function::Create(mallocType, llvm::Function::ExternalLinkage,
-                                   "malloc", QLVM::GetModule());
+                                   "qlang_alloc", QLVM::GetModule());
       }
     }
 
     if (!mallocFunc) {
-      std::cerr << "[ERROR] QJitRunner: malloc not found" << std::endl;
+      std::cerr << "[ERROR] QJitRunner: qlang_alloc not found" << std::endl;
       return nullptr;
     }
 
@@ -576,7 +614,7 @@ llvm::Value *QJitRunner::CompilePrimaryExpr(const std::vector<Token> &tokens,
   }
 
   case TokenType::T_IDENTIFIER: {
-    std::string varName = token.value;
+    std::string varName = token.Text();
 
     // Check for method call on 'this' (e.g., GetNumber())
     if (pos < tokens.size() && tokens[pos].type == TokenType::T_LPAREN) {
@@ -639,9 +677,28 @@ llvm::Value *QJitRunner::CompilePrimaryExpr(const std::vector<Token> &tokens,
         return nullptr;
       }
 
-      std::string memberName = tokens[pos].value;
+      std::string memberName = tokens[pos].Text();
       pos++; // consume member name
 
+      // Component of a vector local or member: v.x
+      llvm::Value *vectorPtr = nullptr;
+      llvm::Type *vectorType = nullptr;
+      int component = GetVectorComponent(memberName);
+      if (component >= 0 && FindVectorStorage(varName, vectorPtr, vectorType)) {
+        unsigned width = GetVectorWidth(vectorType);
+        if (width == 16 || component >= static_cast<int>(width)) {
+          std::cerr << "[ERROR] QJitRunner: '" << varName
+                    << "' has no component '" << memberName << "'"
+                    << std::endl;
+          return nullptr;
+        }
+        llvm::Value *componentPtr = builder.CreateConstInBoundsGEP2_32(
+            vectorType, vectorPtr, 0, static_cast<unsigned>(component),
+            varName + "." + memberName + ".ptr");
+        return builder.CreateLoad(builder.getFloatTy(), componentPtr,
+                                  varName + "." + memberName);
+      }
+
       // Special case: primitive variable.ToString() - intercept before method
       // call handling
       if (memberName == "ToString" && pos < tokens.size() &&
@@ -727,22 +784,32 @@ llvm::Value *QJitRunner::CompilePrimaryExpr(const std::vector<Token> &tokens,
                 tokens[pos].type == TokenType::T_RPAREN) {
               pos++; // consume ')'
 
-              // Load the string pointer
-              llvm::Value *strPtr =
-                  builder.CreateLoad(varType, varIt->second, varName);
-
               // Determine which helper to call based on method name
               std::string helperName;
+              llvm::Type *resultType = builder.getInt32Ty();
               if (memberName == "ToInt" || memberName == "ToInt32") {
                 helperName = "__string_to_int32";
               } else if (memberName == "ToInt64") {
                 helperName = "__string_to_int64";
+                resultType = builder.getInt64Ty();
               } else if (memberName == "ToFloat" || memberName == "ToFloat32") {
                 helperName = "__string_to_float32";
+                resultType = builder.getFloatTy();
               } else if (memberName == "ToFloat64") {
                 helperName = "__string_to_float64";
+                resultType = builder.getDoubleTy();
+              }
+
+              // A literal that never changes converts now
+              if (const std::string *text =
+                      m_LocalConstants.FindString(varName)) {
+                return QLocalConstants::FoldStringToNumber(*text, resultType);
               }
 
+              // Load the string pointer
+              llvm::Value *strPtr =
+                  builder.CreateLoad(varType, varIt->second, varName);
+
               llvm::Function *helperFunc =
                   m_LVMContext->GetLLVMFunc(helperName);
               if (!helperFunc) {
@@ -866,7 +933,7 @@ llvm::Value *QJitRunner::CompilePrimaryExpr(const std::vector<Token> &tokens,
             pos++; // consume '.'
             if (pos < tokens.size() &&
                 tokens[pos].type == TokenType::T_IDENTIFIER &&
-                tokens[pos].value == "ToString") {
+                tokens[pos].Text() == "ToString") {
               pos++; // consume 'ToString'
               // Check for ()
               if (pos < tokens.size() &&
@@ -1074,9 +1141,12 @@ llvm::Value *QJitRunner::CompilePrimaryExpr(const std::vector<Token> &tokens,
             llvm::PointerType::getUnqual(QLVM::GetContext()), it->second,
             varName + ".instanceptr");
       }
-      // Primitive type - load the value
-      llvm::Value *loadedVal = builder.CreateLoad(
-          it->second->getAllocatedType(), it->second, varName);
+      // Primitive type - load the value, unless it is a known constant
+      llvm::Value *loadedVal = m_LocalConstants.Find(varName);
+      if (!loadedVal) {
+        loadedVal = builder.CreateLoad(it->second->getAllocatedType(),
+                                       it->second, varName);
+      }
 
       // Check for .ToString() on primitive variable
       if (pos < tokens.size() && tokens[pos].type == TokenType::T_DOT) {
@@ -1084,7 +1154,7 @@ llvm::Value *QJitRunner::CompilePrimaryExpr(const std::vector<Token> &tokens,
         pos++; // consume '.'
         if (pos < tokens.size() &&
             tokens[pos].type == TokenType::T_IDENTIFIER &&
-            tokens[pos].value == "ToString") {
+            tokens[pos].Text() == "ToString") {
           pos++; // consume 'ToString'
           if (pos < tokens.size() && tokens[pos].type == TokenType::T_LPAREN) {
             pos++; // consume '('
@@ -1092,6 +1162,14 @@ llvm::Value *QJitRunner::CompilePrimaryExpr(const std::vector<Token> &tokens,
                 tokens[pos].type == TokenType::T_RPAREN) {
               pos++; // consume ')'
 
+              // Constant: the text is known now
+              std::string text;
+              if (auto *constant = llvm::dyn_cast<llvm::Constant>(loadedVal);
+                  constant &&
+                  QLocalConstants::FoldToString(constant, text)) {
+                return builder.CreateGlobalStringPtr(text);
+              }
+
               // Determine which helper to call based on variable type
               llvm::Type *varType = it->second->getAllocatedType();
               std::string helperName;
@@ -1254,12 +1332,37 @@ llvm::Value *QJitRunner::CompilePrimaryExpr(const std::vector<Token> &tokens,
 
   default:
     std::cerr << "[ERROR] QJitRunner: Unexpected token in expression: "
-              << token.value << " (type " << static_cast<int>(token.type) << ")"
-              << std::endl;
+              << token.Text() << " (type " << static_cast<int>(token.type)
+              << ")" << std::endl;
     return nullptr;
   }
 }
 
+// Numeric type inference for literals: a constant operand takes the type of
+// the other operand where that removes a conversion. A float32 value stays in
+// float32 instead of widening to double for a literal (literals in vector
+// expressions are float32 too), and an integer literal takes the width of
+// the other operand if its value fits. Not the width of a byte: bytes are
+// unsigned, but comparisons and division are signed, so a byte is widened
+// to the literal instead.
+static void MatchConstantOperand(llvm::Value *&operand, llvm::Value *other) {
+  if (llvm::isa<llvm::Constant>(other))
+    return;
+  llvm::Type *type = other->getType();
+  if (auto *real = llvm::dyn_cast<llvm::ConstantFP>(operand)) {
+    if (type->isFloatTy() && real->getType()->isDoubleTy()) {
+      operand =
+          llvm::ConstantFP::get(type, real->getValueAPF().convertToDouble());
+    }
+  } else if (auto *integer = llvm::dyn_cast<llvm::ConstantInt>(operand)) {
+    if (type->isIntegerTy() && type->getIntegerBitWidth() > 8 &&
+        integer->getBitWidth() > 1 && integer->getType() != type &&
+        integer->getValue().isSignedIntN(type->getIntegerBitWidth())) {
+      operand = llvm::ConstantInt::get(type, integer->getSExtValue(), true);
+    }
+  }
+}
+
 llvm::Value *QJitRunner::ApplyBinaryOp(const std::string &op, llvm::Value *left,
                                        llvm::Value *right) {
   auto &builder = QLVM::GetBuilder();
@@ -1267,6 +1370,32 @@ llvm::Value *QJitRunner::ApplyBinaryOp(const std::string &op, llvm::Value *left,
   if (!left || !right)
     return nullptr;
 
+  if (GetVectorWidth(left->getType()) || GetVectorWidth(right->getType())) {
+    return ApplyVectorOp(op, left, right);
+  }
+
+  MatchConstantOperand(left, right);
+  MatchConstantOperand(right, left);
+
+  // Integers of different widths: widen the narrower one (bytes are
+  // unsigned)
+  llvm::Type *leftType = left->getType();
+  llvm::Type *rightType = right->getType();
+  if (leftType->isIntegerTy() && rightType->isIntegerTy() &&
+      leftType != rightType && !leftType->isIntegerTy(1) &&
+      !rightType->isIntegerTy(1)) {
+    auto widen = [&builder](llvm::Value *value, llvm::Type *type) {
+      return value->getType()->isIntegerTy(8)
+                 ? builder.CreateZExt(value, type, "zexttmp")
+                 : builder.CreateSExt(value, type, "sexttmp");
+    };
+    if (leftType->getIntegerBitWidth() < rightType->getIntegerBitWidth()) {
+      left = widen(left, rightType);
+    } else {
+      right = widen(right, leftType);
+    }
+  }
+
   // Promote if one is float and other is int
   if (left->getType()->isFloatingPointTy() && right->getType()->isIntegerTy()) {
     right = builder.CreateSIToFP(right, left->getType(), "promotetmp");
@@ -1346,6 +1475,406 @@ llvm::Value *QJitRunner::ApplyBinaryOp(const std::string &op, llvm::Value *left,
   return nullptr;
 }
 
+// ============================================================================
+// Vector Types
+// ============================================================================
+//
+// vec2/vec3/vec4/mat4 are stored as [N x float] (mat4 as 16 floats,
+// column-major), which gives them glm's size and alignment: a vec3 member is
+// 12 bytes and a native can read it as 'const glm::vec3 &'. Arithmetic moves
+// the values into <N x float> registers and back; LLVM folds the moves into
+// vector loads and stores.
+
+unsigned QJitRunner::GetVectorWidth(llvm::Type *type) {
+  auto *arrayType = llvm::dyn_cast_or_null<llvm::ArrayType>(type);
+  if (!arrayType || !arrayType->getElementType()->isFloatTy())
+    return 0;
+  uint64_t width = arrayType->getNumElements();
+  if (width == 2 || width == 3 || width == 4 || width == 16)
+    return static_cast<unsigned>(width);
+  return 0;
+}
+
+int QJitRunner::GetVectorComponent(const std::string &name) {
+  if (name == "x")
+    return 0;
+  if (name == "y")
+    return 1;
+  if (name == "z")
+    return 2;
+  if (name == "w")
+    return 3;
+  return -1;
+}
+
+bool QJitRunner::IsVectorIntrinsic(const std::string &name) {
+  return name == "dot" || name == "cross" || name == "normalize" ||
+         name == "length" || name == "lerp" || name == "mul";
+}
+
+llvm::Value *QJitRunner::ToSIMD(llvm::Value *value) {
+  auto &builder = QLVM::GetBuilder();
+  unsigned width = GetVectorWidth(value->getType());
+  llvm::Value *simd = llvm::PoisonValue::get(
+      llvm::FixedVectorType::get(builder.getFloatTy(), width));
+  for (unsigned i = 0; i < width; ++i) {
+    simd = builder.CreateInsertElement(
+        simd, builder.CreateExtractValue(value, {i}), builder.getInt32(i));
+  }
+  return simd;
+}
+
+llvm::Value *QJitRunner::FromSIMD(llvm::Value *simd) {
+  auto &builder = QLVM::GetBuilder();
+  unsigned width =
+      llvm::cast<llvm::FixedVectorType>(simd->getType())->getNumElements();
+  llvm::Value *value =
+      llvm::PoisonValue::get(llvm::ArrayType::get(builder.getFloatTy(), width));
+  for (unsigned i = 0; i < width; ++i) {
+    value = builder.CreateInsertValue(
+        value, builder.CreateExtractElement(simd, builder.getInt32(i)), {i});
+  }
+  return value;
+}
+
+llvm::Value *QJitRunner::ToFloatScalar(llvm::Value *value) {
+  auto &builder = QLVM::GetBuilder();
+  llvm::Type *type = value->getType();
+  if (type->isFloatTy())
+    return value;
+  if (type->isDoubleTy())
+    return builder.CreateFPTrunc(value, builder.getFloatTy(), "fptrunc");
+  if (type->isIntegerTy())
+    return builder.CreateSIToFP(value, builder.getFloatTy(), "promotetmp");
+  return nullptr;
+}
+
+llvm::Value *QJitRunner::MultiplyMatrix(llvm::Value *lhs, llvm::Value *rhs) {
+  auto &builder = QLVM::GetBuilder();
+
+  // Column j of the result is the sum over k of lhs.column(k) * rhs[j][k]
+  llvm::Value *columns[4];
+  for (int k = 0; k < 4; ++k) {
+    columns[k] = builder.CreateShuffleVector(
+        lhs, {k * 4, k * 4 + 1, k * 4 + 2, k * 4 + 3});
+  }
+
+  unsigned rhsColumns =
+      llvm::cast<llvm::FixedVectorType>(rhs->getType())->getNumElements() / 4;
+  std::vector<llvm::Value *> result;
+  for (unsigned j = 0; j < rhsColumns; ++j) {
+    llvm::Value *sum = nullptr;
+    for (unsigned k = 0; k < 4; ++k) {
+      llvm::Value *scale = builder.CreateVectorSplat(
+          4, builder.CreateExtractElement(rhs, builder.getInt32(j * 4 + k)));
+      llvm::Value *term = builder.CreateFMul(columns[k], scale, "matmul");
+      sum = sum ? builder.CreateFAdd(sum, term, "matmul") : term;
+    }
+    result.push_back(sum);
+  }
+
+  if (result.size() == 1)
+    return result[0]; // mat4 * vec4
+
+  static const int pairMask[] = {0, 1, 2, 3, 4, 5, 6, 7};
+  static const int concatMask[] = {0, 1, 2,  3,  4,  5,  6,  7,
+                                   8, 9, 10, 11, 12, 13, 14, 15};
+  llvm::Value *low = builder.CreateShuffleVector(
+      result[0], result[1], llvm::ArrayRef<int>(pairMask));
+  llvm::Value *high = builder.CreateShuffleVector(
+      result[2], result[3], llvm::ArrayRef<int>(pairMask));
+  return builder.CreateShuffleVector(low, high,
+                                     llvm::ArrayRef<int>(concatMask));
+}
+
+llvm::Value *QJitRunner::ApplyVectorOp(const std::string &op,
+                                       llvm::Value *left, llvm::Value *right) {
+  auto &builder = QLVM::GetBuilder();
+  unsigned leftWidth = GetVectorWidth(left->getType());
+  unsigned rightWidth = GetVectorWidth(right->getType());
+
+  if (op == "*" && leftWidth == 16 && (rightWidth == 16 || rightWidth == 4)) {
+    return FromSIMD(MultiplyMatrix(ToSIMD(left), ToSIMD(right)));
+  }
+  if (leftWidth && rightWidth &&
+      (leftWidth != rightWidth || (leftWidth == 16 && op == "/"))) {
+    std::cerr << "[ERROR] QJitRunner: Operator '" << op
+              << "' not defined between vectors of width " << leftWidth
+              << " and " << rightWidth << std::endl;
+    return nullptr;
+  }
+
+  // A scalar operand applies to every component
+  unsigned width = leftWidth ? leftWidth : rightWidth;
+  auto operand = [&](llvm::Value *value, unsigned valueWidth) -> llvm::Value * {
+    if (valueWidth)
+      return ToSIMD(value);
+    llvm::Value *scalar = ToFloatScalar(value);
+    return scalar ? builder.CreateVectorSplat(width, scalar) : nullptr;
+  };
+  llvm::Value *lhs = operand(left, leftWidth);
+  llvm::Value *rhs = operand(right, rightWidth);
+  if (!lhs || !rhs) {
+    std::cerr << "[ERROR] QJitRunner: Operator '" << op
+              << "' needs a number or vector operand" << std::endl;
+    return nullptr;
+  }
+
+  if (op == "+")
+    return FromSIMD(builder.CreateFAdd(lhs, rhs, "vaddtmp"));
+  if (op == "-")
+    return FromSIMD(builder.CreateFSub(lhs, rhs, "vsubtmp"));
+  if (op == "*")
+    return FromSIMD(builder.CreateFMul(lhs, rhs, "vmultmp"));
+  if (op == "/")
+    return FromSIMD(builder.CreateFDiv(lhs, rhs, "vdivtmp"));
+  if (op == "==" || op == "=")
+    return builder.CreateAndReduce(builder.CreateFCmpOEQ(lhs, rhs, "veqtmp"));
+  if (op == "!=" || op == "<>")
+    return builder.CreateOrReduce(builder.CreateFCmpONE(lhs, rhs, "vnetmp"));
+
+  std::cerr << "[ERROR] QJitRunner: Operator '" << op
+            << "' not supported for vector types" << std::endl;
+  return nullptr;
+}
+
+llvm::Value *
+QJitRunner::CompileVectorConstructor(int tokenType,
+                                     const std::vector<Token> &tokens,
+                                     size_t &pos) {
+  auto &builder = QLVM::GetBuilder();
+  llvm::Type *vectorType = GetLLVMType(tokenType);
+  unsigned width = GetVectorWidth(vectorType);
+
+  if (pos >= tokens.size() || tokens[pos].type != TokenType::T_LPAREN) {
+    std::cerr << "[ERROR] QJitRunner: Expected '(' after vector type"
+              << std::endl;
+    return nullptr;
+  }
+  pos++; // consume '('
+
+  // Arguments contribute their components in order: vec4(v3, 1.0)
+  std::vector<llvm::Value *> components;
+  while (pos < tokens.size() && tokens[pos].type != TokenType::T_RPAREN) {
+    auto argExpr = std::make_shared<QExpression>();
+    int depth = 0;
+    while (pos < tokens.size()) {
+      if (tokens[pos].type == TokenType::T_LPAREN)
+        depth++;
+      else if (tokens[pos].type == TokenType::T_RPAREN) {
+        if (depth == 0)
+          break;
+        depth--;
+      } else if (tokens[pos].type == TokenType::T_COMMA && depth == 0)
+        break;
+      argExpr->AddElement(tokens[pos]);
+      pos++;
+    }
+
+    llvm::Value *argVal = CompileExpression(argExpr, builder.getFloatTy());
+    if (!argVal)
+      return nullptr;
+    if (unsigned argWidth = GetVectorWidth(argVal->getType())) {
+      for (unsigned i = 0; i < argWidth; ++i) {
+        components.push_back(builder.CreateExtractValue(argVal, {i}));
+      }
+    } else if (llvm::Value *scalar = ToFloatScalar(argVal)) {
+      components.push_back(scalar);
+    } else {
+      std::cerr << "[ERROR] QJitRunner: Vector components must be numbers"
+                << std::endl;
+      return nullptr;
+    }
+
+    if (pos < tokens.size() && tokens[pos].type == TokenType::T_COMMA) {
+      pos++; // consume ','
+    }
+  }
+  if (pos < tokens.size() && tokens[pos].type == TokenType::T_RPAREN) {
+    pos++; // consume ')'
+  }
+
+  // mat4() is the identity and mat4(s) a scaled identity, as in glm;
+  // vecN() is zero and vecN(s) sets every component to s
+  if (width == 16 && components.size() <= 1) {
+    llvm::Value *diagonal =
+        components.empty() ? llvm::ConstantFP::get(builder.getFloatTy(), 1.0)
+                           : components[0];
+    llvm::Value *zero = llvm::ConstantFP::get(builder.getFloatTy(), 0.0);
+    components.assign(16, zero);
+    for (unsigned i = 0; i < 4; ++i) {
+      components[i * 5] = diagonal;
+    }
+  } else if (components.empty()) {
+    return llvm::ConstantAggregateZero::get(vectorType);
+  } else if (components.size() == 1) {
+    components.assign(width, components[0]);
+  } else if (components.size() != width) {
+    std::cerr << "[ERROR] QJitRunner: Vector of width " << width << " given "
+              << components.size() << " components" << std::endl;
+    return nullptr;
+  }
+
+  llvm::Value *result = llvm::PoisonValue::get(vectorType);
+  for (unsigned i = 0; i < width; ++i) {
+    result = builder.CreateInsertValue(result, components[i], {i});
+  }
+  return result;
+}
+
+llvm::Value *
+QJitRunner::CompileVectorIntrinsic(const std::string &name,
+                                   const std::vector<llvm::Value *> &args) {
+  auto &builder = QLVM::GetBuilder();
+  size_t arity = (name == "lerp") ? 3 : (name == "dot" || name == "cross" ||
+                                         name == "mul")
+                                            ? 2
+                                            : 1;
+  if (args.size() != arity) {
+    std::cerr << "[ERROR] QJitRunner: " << name << "() takes " << arity
+              << " arguments, got " << args.size() << std::endl;
+    return nullptr;
+  }
+
+  if (name == "mul") {
+    return ApplyBinaryOp("*", args[0], args[1]);
+  }
+  if (name == "lerp") {
+    // a + (b - a) * t, for numbers as well as vectors
+    return ApplyBinaryOp(
+        "+", args[0],
+        ApplyBinaryOp("*", ApplyBinaryOp("-", args[1], args[0]), args[2]));
+  }
+
+  unsigned width = GetVectorWidth(args[0]->getType());
+  if (!width || width == 16 ||
+      (arity == 2 && GetVectorWidth(args[1]->getType()) != width) ||
+      (name == "cross" && width != 3)) {
+    std::cerr << "[ERROR] QJitRunner: Invalid argument types for " << name
+              << "()" << std::endl;
+    return nullptr;
+  }
+
+  llvm::Value *a = ToSIMD(args[0]);
+  auto dot = [&](llvm::Value *lhs, llvm::Value *rhs) {
+    return builder.CreateFAddReduce(
+        llvm::ConstantFP::getNegativeZero(builder.getFloatTy()),
+        builder.CreateFMul(lhs, rhs, "dottmp"));
+  };
+
+  if (name == "dot") {
+    return dot(a, ToSIMD(args[1]));
+  }
+  if (name == "length") {
+    return builder.CreateUnaryIntrinsic(llvm::Intrinsic::sqrt, dot(a, a));
+  }
+  if (name == "normalize") {
+    llvm::Value *length =
+        builder.CreateUnaryIntrinsic(llvm::Intrinsic::sqrt, dot(a, a));
+    return FromSIMD(
+        builder.CreateFDiv(a, builder.CreateVectorSplat(width, length)));
+  }
+
+  // cross: a.yzx * b.zxy - a.zxy * b.yzx
+  llvm::Value *b = ToSIMD(args[1]);
+  llvm::Value *lhs =
+      builder.CreateFMul(builder.CreateShuffleVector(a, {1, 2, 0}),
+                         builder.CreateShuffleVector(b, {2, 0, 1}));
+  llvm::Value *rhs =
+      builder.CreateFMul(builder.CreateShuffleVector(a, {2, 0, 1}),
+                         builder.CreateShuffleVector(b, {1, 2, 0}));
+  return FromSIMD(builder.CreateFSub(lhs, rhs, "crosstmp"));
+}
+
+bool QJitRunner::FindVectorStorage(const std::string &name, llvm::Value *&ptr,
+                                   llvm::Type *&type) {
+  auto varIt = m_LocalVariables.find(name);
+  if (varIt != m_LocalVariables.end()) {
+    if (!GetVectorWidth(varIt->second->getAllocatedType()))
+      return false;
+    ptr = varIt->second;
+    type = varIt->second->getAllocatedType();
+    return true;
+  }
+
+  if (!m_CurrentInstance || m_CurrentClassName.empty())
+    return false;
+  auto classIt = m_CompiledClasses.find(m_CurrentClassName);
+  if (classIt == m_CompiledClasses.end())
+    return false;
+  CompiledClass &classInfo = classIt->second;
+  int memberIdx = FindMemberIndex(classInfo, name);
+  if (memberIdx < 0 || !GetVectorWidth(classInfo.memberTypes[memberIdx]))
+    return false;
+
+  ptr = QLVM::GetBuilder().CreateStructGEP(classInfo.structType,
+                                           m_CurrentInstance,
+                                           static_cast<unsigned>(memberIdx),
+                                           "this." + name + ".ptr");
+  type = classInfo.memberTypes[memberIdx];
+  return true;
+}
+
+// ============================================================================
+// Parallel Safety
+// ============================================================================
+
+QClassAccess *QJitRunner::CurrentAccess() {
+  if (m_CurrentClassName.empty())
+    return nullptr;
+  auto classIt = m_CompiledClasses.find(m_CurrentClassName);
+  return classIt != m_CompiledClasses.end() ? &classIt->second.access
+                                            : nullptr;
+}
+
+bool QJitRunner::IsParallelSafe(const std::string &className) const {
+  std::unordered_set<std::string> visiting;
+  return IsParallelSafe(className, visiting);
+}
+
+bool QJitRunner::IsParallelSafe(
+    const std::string &className,
+    std::unordered_set<std::string> &visiting) const {
+  auto classIt = m_CompiledClasses.find(className);
+  if (classIt == m_CompiledClasses.end())
+    return false;
+  // Recursion between classes: the cycle adds nothing new
+  if (!visiting.insert(className).second)
+    return true;
+
+  const CompiledClass &classInfo = classIt->second;
+  const QClassAccess &access = classInfo.access;
+  if (access.writesShared)
+    return false;
+
+  for (const auto &native : access.natives) {
+    if (!m_LVMContext->IsThreadSafe(native))
+      return false;
+  }
+
+  for (const auto &calledName : access.classes) {
+    // Methods that write their own members write another script's state
+    // when called from here. Structs too: locals and parameters of a value
+    // class still point at the object they were initialized from.
+    auto calledIt = m_CompiledClasses.find(calledName);
+    if (calledIt == m_CompiledClasses.end())
+      return false;
+    if (calledIt->second.access.writesSelf)
+      return false;
+    if (!IsParallelSafe(calledName, visiting))
+      return false;
+  }
+
+  // Objects this class allocated itself may be written freely
+  for (const auto &calledName : access.localClasses) {
+    if (!IsParallelSafe(calledName, visiting))
+      return false;
+  }
+
+  return classInfo.parentClassName.empty() ||
+         IsParallelSafe(classInfo.parentClassName, visiting);
+}
+
 int QJitRunner::GetOperatorPrecedence(const std::string &op) {
   if (op == "*" || op == "/" || op == "%")
     return 20;
@@ -1390,7 +1919,7 @@ llvm::Value *QJitRunner::CompileExprTokensRecursive(
     // Handle operators - T_OPERATOR, T_GREATER (>), T_LESS (<)
     std::string op;
     if (opToken.type == TokenType::T_OPERATOR) {
-      op = opToken.value;
+      op = opToken.Text();
     } else if (opToken.type == TokenType::T_GREATER) {
       op = ">";
     } else if (opToken.type == TokenType::T_LESS) {
@@ -1461,6 +1990,9 @@ llvm::Value *QJitRunner::CompileExprTokensRecursive(
               }
             }
 
+            if (QClassAccess *access = CurrentAccess()) {
+              access->classes.insert(leftClassName);
+            }
             std::vector<llvm::Value *> args = {leftArg, rightArg};
             result = builder.CreateCall(methodIt->second, args,
                                         "op_" + methodName + "_tmp");
@@ -1601,7 +2133,7 @@ void QJitRunner::CompileVariableDecl(std::shared_ptr<QVariableDecl> varDecl) {
         elements[4].type == TokenType::T_RBRACKET) {
 
       // Extract array size
-      int arraySize = std::stoi(elements[3].value);
+      int arraySize = std::stoi(elements[3].Text());
 
       // Determine element size: 1 for byte, 4 for int32/float32
       int elementSize = (elements[1].type == TokenType::T_BYTE) ? 1 : 4;
@@ -1619,10 +2151,10 @@ void QJitRunner::CompileVariableDecl(std::shared_ptr<QVariableDecl> varDecl) {
                 << elementTypeName << "[" << arraySize << "] (" << totalBytes
                 << " bytes)" << std::endl;
 
-      // Get or declare malloc function
-      llvm::Function *mallocFunc = m_LVMContext->GetLLVMFunc("malloc");
+      // Get or declare the managed allocator
+      llvm::Function *mallocFunc = m_LVMContext->GetLLVMFunc("qlang_alloc");
       if (!mallocFunc) {
-        mallocFunc = QLVM::GetModule()->getFunction("malloc");
+        mallocFunc = QLVM::GetModule()->getFunction("qlang_alloc");
         if (!mallocFunc) {
           std::vector<llvm::Type *> args = {
               llvm::Type::getInt64Ty(QLVM::GetContext())};
@@ -1630,7 +2162,7 @@ void QJitRunner::CompileVariableDecl(std::shared_ptr<QVariableDecl> varDecl) {
               llvm::PointerType::getUnqual(QLVM::GetContext()), args, false);
           mallocFunc = llvm::Function::Create(mallocType,
                                               llvm::Function::ExternalLinkage,
-                                              "malloc", QLVM::GetModule());
+                                              "qlang_alloc", QLVM::GetModule());
         }
       }
 
@@ -1654,7 +2186,7 @@ void QJitRunner::CompileVariableDecl(std::shared_ptr<QVariableDecl> varDecl) {
         std::cout << "[DEBUG] QJitRunner: Array allocated for '" << varName
                   << "' (type: " << ptrType << ")" << std::endl;
       } else {
-        std::cerr << "[ERROR] QJitRunner: malloc not found for array allocation"
+        std::cerr << "[ERROR] QJitRunner: qlang_alloc not found for array allocation"
                   << std::endl;
       }
 
@@ -1667,15 +2199,27 @@ void QJitRunner::CompileVariableDecl(std::shared_ptr<QVariableDecl> varDecl) {
     if (initValue) {
       builder.CreateStore(initValue, alloca);
 
+      // Never assigned again: uses fold to the initializer. The store stays
+      // for anything that takes the local's address.
+      if (m_LocalConstants.IsSingleAssignment(varName)) {
+        if (llvm::isa<llvm::ConstantInt>(initValue) ||
+            llvm::isa<llvm::ConstantFP>(initValue)) {
+          m_LocalConstants.Bind(varName, llvm::cast<llvm::Constant>(initValue));
+        } else if (elements.size() == 1 &&
+                   elements[0].type == TokenType::T_STRING) {
+          m_LocalConstants.BindString(varName, elements[0].Text());
+        }
+      }
+
       // Deduce class name if unknown
       if (varDecl->GetVarType() == TokenType::T_UNKNOWN ||
           varDecl->GetVarType() == TokenType::T_IDENTIFIER) {
         if (!elements.empty() && elements[0].type == TokenType::T_NEW) {
           if (elements.size() > 1 &&
               elements[1].type == TokenType::T_IDENTIFIER) {
-            m_VariableTypes[varName] = elements[1].value;
+            m_VariableTypes[varName] = elements[1].Text();
             std::cout << "[DEBUG] QJitRunner: Deduced type for '" << varName
-                      << "' as '" << elements[1].value << "'" << std::endl;
+                      << "' as '" << elements[1].Text() << "'" << std::endl;
           }
         }
       }
@@ -1807,6 +2351,35 @@ void QJitRunner::CompileIf(std::shared_ptr<QIf> ifNode) {
         condVal, llvm::ConstantInt::get(condVal->getType(), 0), "ifcond");
   }
 
+  // A condition that folded to a constant picks its branch now. Locals are
+  // function-wide, so the branches that are skipped still get storage for
+  // the names they declare; their bodies are not compiled.
+  if (auto *constant = llvm::dyn_cast<llvm::ConstantInt>(condVal)) {
+    const auto &elseIfs = ifNode->GetElseIfBlocks();
+    if (!constant->isZero()) {
+      CompileCodeBlock(ifNode->GetThenBlock());
+      for (const auto &elseIf : elseIfs) {
+        DeclareSkippedLocals(elseIf.second);
+      }
+      DeclareSkippedLocals(ifNode->GetElseBlock());
+    } else {
+      DeclareSkippedLocals(ifNode->GetThenBlock());
+      if (!elseIfs.empty()) {
+        // The first else-if takes the place of the if
+        auto rest = std::make_shared<QIf>();
+        rest->SetIf(elseIfs[0].first, elseIfs[0].second);
+        for (size_t i = 1; i < elseIfs.size(); ++i) {
+          rest->AddElseIf(elseIfs[i].first, elseIfs[i].second);
+        }
+        rest->SetElse(ifNode->GetElseBlock());
+        CompileIf(rest);
+      } else if (ifNode->HasElse()) {
+        CompileCodeBlock(ifNode->GetElseBlock());
+      }
+    }
+    return;
+  }
+
   // Create basic blocks for then, else-if chain, else, and merge
   llvm::BasicBlock *thenBB =
       llvm::BasicBlock::Create(context, "if.then", currentFunc);
@@ -1906,6 +2479,66 @@ void QJitRunner::CompileIf(std::shared_ptr<QIf> ifNode) {
             << std::endl;
 }
 
+// Give the locals declared in a branch that is never compiled their storage,
+// zeroed, so code after the if can still name them
+void QJitRunner::DeclareSkippedLocals(std::shared_ptr<QCode> code) {
+  if (!code)
+    return;
+
+  auto &builder = QLVM::GetBuilder();
+
+  auto declare = [&](const std::string &name, llvm::Type *type) {
+    if (!type || m_LocalVariables.count(name))
+      return false;
+    llvm::AllocaInst *alloca = builder.CreateAlloca(type, nullptr, name);
+    builder.CreateStore(llvm::Constant::getNullValue(type), alloca);
+    m_LocalVariables[name] = alloca;
+    return true;
+  };
+
+  for (auto node : code->GetNodes()) {
+    if (auto varDecl = std::dynamic_pointer_cast<QVariableDecl>(node)) {
+      const std::string &typeName = varDecl->GetTypeName();
+      llvm::Type *varType =
+          GetLLVMType(static_cast<int>(varDecl->GetVarType()), typeName);
+      if (declare(varDecl->GetName(), varType) &&
+          varDecl->GetVarType() == TokenType::T_IDENTIFIER &&
+          !typeName.empty() &&
+          m_CompiledClasses.find(typeName) != m_CompiledClasses.end()) {
+        m_VariableTypes[varDecl->GetName()] = typeName;
+      }
+    } else if (auto instDecl =
+                   std::dynamic_pointer_cast<QInstanceDecl>(node)) {
+      std::string className = instDecl->GetQClassName();
+      if (instDecl->HasTypeArguments()) {
+        const auto &typeArgs = instDecl->GetTypeArguments();
+        auto templateIt = m_GenericClassTemplates.find(className);
+        if (templateIt == m_GenericClassTemplates.end())
+          continue;
+        CompileGenericClass(className, templateIt->second, typeArgs);
+        className = GetSpecializedClassName(className, typeArgs);
+      }
+      llvm::Type *ptrType = llvm::PointerType::getUnqual(builder.getContext());
+      if (declare(instDecl->GetInstanceName(), ptrType)) {
+        m_VariableTypes[instDecl->GetInstanceName()] = className;
+      }
+    } else if (auto forNode = std::dynamic_pointer_cast<QFor>(node)) {
+      llvm::Type *varType = builder.getInt32Ty();
+      if (forNode->HasDeclaredType()) {
+        varType = GetLLVMType(static_cast<int>(forNode->GetVarType()));
+      }
+      declare(forNode->GetVarName(), varType);
+      DeclareSkippedLocals(forNode->GetBody());
+    } else if (auto ifNode = std::dynamic_pointer_cast<QIf>(node)) {
+      DeclareSkippedLocals(ifNode->GetThenBlock());
+      for (const auto &elseIf : ifNode->GetElseIfBlocks()) {
+        DeclareSkippedLocals(elseIf.second);
+      }
+      DeclareSkippedLocals(ifNode->GetElseBlock());
+    }
+  }
+}
+
 // ============================================================================
 // Statement Compilation
 // ============================================================================
@@ -1960,41 +2593,8 @@ void QJitRunner::CompileStatement(std::shared_ptr<QStatement> stmt) {
 
             // Apply type conversions if needed
             if (i + 1 < ft->getNumParams()) {
-              llvm::Type *paramType =
-                  ft->getParamType(static_cast<unsigned>(i + 1));
-
-              // Integer type conversion
-              if (paramType->isIntegerTy() &&
-                  argValue->getType()->isIntegerTy()) {
-                if (argValue->getType()->getIntegerBitWidth() <
-                    paramType->getIntegerBitWidth()) {
-                  argValue = builder.CreateSExt(argValue, paramType);
-                } else if (argValue->getType()->getIntegerBitWidth() >
-                           paramType->getIntegerBitWidth()) {
-                  argValue = builder.CreateTrunc(argValue, paramType);
-                }
-              }
-              // Float type conversion
-              else if (paramType->isFloatingPointTy() &&
-                       argValue->getType()->isFloatingPointTy()) {
-                if (argValue->getType()->isFloatTy() &&
-                    paramType->isDoubleTy()) {
-                  argValue = builder.CreateFPExt(argValue, paramType);
-                } else if (argValue->getType()->isDoubleTy() &&
-                           paramType->isFloatTy()) {
-                  argValue = builder.CreateFPTrunc(argValue, paramType);
-                }
-              }
-              // Int to float
-              else if (paramType->isFloatingPointTy() &&
-                       argValue->getType()->isIntegerTy()) {
-                argValue = builder.CreateSIToFP(argValue, paramType);
-              }
-              // Float to int
-              else if (paramType->isIntegerTy() &&
-                       argValue->getType()->isFloatingPointTy()) {
-                argValue = builder.CreateFPToSI(argValue, paramType);
-              }
+              argValue = CoerceArgument(
+                  argValue, ft->getParamType(static_cast<unsigned>(i + 1)));
             }
 
             callArgs.push_back(argValue);
@@ -2024,7 +2624,7 @@ void QJitRunner::CompileStatement(std::shared_ptr<QStatement> stmt) {
       const auto &argTokens = exprs[i]->GetElements();
       if (!argTokens.empty()) {
         std::cout << "[DEBUG] Compiling Arg " << i
-                  << " First Token: " << argTokens[0].value << std::endl;
+                  << " First Token: " << argTokens[0].Text() << std::endl;
       }
 
       llvm::Value *argValue = CompileExpression(exprs[i], paramType);
@@ -2036,6 +2636,8 @@ void QJitRunner::CompileStatement(std::shared_ptr<QStatement> stmt) {
         // Vararg promotion: float -> double
         if (!paramType && argValue->getType()->isFloatTy()) {
           argValue = builder.CreateFPExt(argValue, builder.getDoubleTy());
+        } else if (paramType) {
+          argValue = CoerceArgument(argValue, paramType);
         }
         llvmArgs.push_back(argValue);
       } else {
@@ -2045,6 +2647,9 @@ void QJitRunner::CompileStatement(std::shared_ptr<QStatement> stmt) {
     }
   }
 
+  if (QClassAccess *access = CurrentAccess()) {
+    access->natives.insert(funcName);
+  }
   builder.CreateCall(targetFunc, llvmArgs);
 }
 
@@ -2114,6 +2719,11 @@ void QJitRunner::CompileNode(std::shared_ptr<QNode> node) {
     return;
   }
 
+  if (auto yieldNode = std::dynamic_pointer_cast<QYield>(node)) {
+    CompileYield(yieldNode);
+    return;
+  }
+
   if (auto methodCall = std::dynamic_pointer_cast<QMethodCall>(node)) {
     CompileMethodCall(methodCall);
     return;
@@ -2168,6 +2778,10 @@ void QJitRunner::CompileClass(std::shared_ptr<QClass> classNode) {
     isRecompile = true;
   }
 
+  if (!m_CurrentScriptPath.empty()) {
+    m_ClassSources[className] = m_CurrentScriptPath;
+  }
+
   // Check if this is a generic class template (has type parameters)
   if (classNode->IsGeneric()) {
     std::cout << "[DEBUG] QJitRunner: Storing generic template '" << className
@@ -2194,52 +2808,75 @@ void QJitRunner::CompileClass(std::shared_ptr<QClass> classNode) {
   CompiledClass classInfo;
   llvm::StructType *structType = nullptr;
 
+  // Collect member types and names
+  std::vector<llvm::Type *> memberTypes;
+  std::vector<std::string> memberNames;
+  std::vector<int> memberTypeTokens;
+  std::vector<std::string> memberTypeNames;
+
+  // First: include parent class members (if any)
+  if (!parentClassName.empty()) {
+    const CompiledClass &parentInfo = m_CompiledClasses[parentClassName];
+
+    // Copy parent members first
+    for (size_t i = 0; i < parentInfo.memberNames.size(); i++) {
+      memberTypes.push_back(parentInfo.memberTypes[i]);
+      memberNames.push_back(parentInfo.memberNames[i]);
+      memberTypeTokens.push_back(parentInfo.memberTypeTokens[i]);
+      memberTypeNames.push_back(parentInfo.memberTypeNames[i]);
+    }
+  }
+
+  // Then: include child class's own members
+  for (const auto &member : classNode->GetMembers()) {
+    llvm::Type *memberType = GetLLVMType(
+        static_cast<int>(member->GetVarType()), member->GetTypeName());
+    if (memberType) {
+      memberTypes.push_back(memberType);
+      memberNames.push_back(member->GetName());
+      memberTypeTokens.push_back(static_cast<int>(member->GetVarType()));
+      memberTypeNames.push_back(member->GetTypeName());
+    }
+  }
+
+  // A recompile with different members gets a new struct type (the old one
+  // stays with code compiled against it). Live instances are migrated by the
+  // host (TakeChangedLayouts), and classes whose code uses the old layout
+  // are rebuilt by CompileScriptIntoMaster.
+  bool layoutChanged = false;
   if (isRecompile) {
+    const CompiledClass &previous = m_CompiledClasses[className];
+    if (previous.memberNames != memberNames ||
+        previous.memberTypes != memberTypes) {
+      layoutChanged = true;
+      std::cout << "[INFO] QJitRunner: Layout of '" << className
+                << "' changed" << std::endl;
+      CollectLayoutDependents(className, previous.structType);
+      m_ChangedLayouts.insert(className);
+    }
+  }
+
+  if (isRecompile && !layoutChanged) {
     // Reuse existing class info and struct type
     classInfo = m_CompiledClasses[className];
     structType = classInfo.structType;
+    classInfo.access = {}; // Recorded again as the methods compile
   } else {
     // Get or create struct type (don't create duplicate with suffix like .1)
-    structType = llvm::StructType::getTypeByName(context, className);
+    structType = layoutChanged
+                     ? nullptr
+                     : llvm::StructType::getTypeByName(context, className);
     if (!structType) {
       structType = llvm::StructType::create(context, className);
     }
 
-    // Collect member types and names
-    std::vector<llvm::Type *> memberTypes;
-    std::vector<std::string> memberNames;
-    std::vector<int> memberTypeTokens;
-    std::vector<std::string> memberTypeNames;
-
-    // First: include parent class members (if any)
+    // Copy parent methods
     if (!parentClassName.empty()) {
       const CompiledClass &parentInfo = m_CompiledClasses[parentClassName];
-
-      // Copy parent members first
-      for (size_t i = 0; i < parentInfo.memberNames.size(); i++) {
-        memberTypes.push_back(parentInfo.memberTypes[i]);
-        memberNames.push_back(parentInfo.memberNames[i]);
-        memberTypeTokens.push_back(parentInfo.memberTypeTokens[i]);
-        memberTypeNames.push_back(parentInfo.memberTypeNames[i]);
-      }
-
-      // Copy parent methods
       classInfo.methods = parentInfo.methods;
       classInfo.methodReturnTypes = parentInfo.methodReturnTypes;
     }
 
-    // Then: include child class's own members
-    for (const auto &member : classNode->GetMembers()) {
-      llvm::Type *memberType = GetLLVMType(
-          static_cast<int>(member->GetVarType()), member->GetTypeName());
-      if (memberType) {
-        memberTypes.push_back(memberType);
-        memberNames.push_back(member->GetName());
-        memberTypeTokens.push_back(static_cast<int>(member->GetVarType()));
-        memberTypeNames.push_back(member->GetTypeName());
-      }
-    }
-
     // Set struct body only if new
     if (structType->isOpaque()) {
       structType->setBody(memberTypes);
@@ -2252,6 +2889,7 @@ void QJitRunner::CompileClass(std::shared_ptr<QClass> classNode) {
     classInfo.memberTypeTokens = memberTypeTokens;
     classInfo.memberTypeNames = memberTypeNames;
     classInfo.isStatic = classNode->IsStatic();
+    classInfo.isValue = classNode->IsValueType();
     classInfo.parentClassName = parentClassName; // Store inheritance info
 
     // Inherit parent methods if applicable
@@ -2454,6 +3092,7 @@ void QJitRunner::CompileGenericClass(const std::string &baseName,
   CompiledClass classInfo;
   classInfo.structType = structType;
   classInfo.isStatic = classTemplate->IsStatic();
+  classInfo.isValue = classTemplate->IsValueType();
 
   // Process members with type substitution
   std::vector<llvm::Type *> memberLLVMTypes;
@@ -2626,21 +3265,41 @@ void QJitRunner::CompileMethod(const std::string &className,
     }
   }
 
+  bool isCoroutine = ContainsYield(method->GetBody());
+
+  // Value classes: inline into callers so 'new' temporaries become local to
+  // the caller, where QHeapToStackPass can move them to the stack
+  if (classInfo.isValue && !isCoroutine) {
+    func->addFnAttr(llvm::Attribute::AlwaysInline);
+  }
+
   // Create entry block
   llvm::BasicBlock *entryBB = llvm::BasicBlock::Create(context, "entry", func);
 
   // Save current state
   auto savedLocals = m_LocalVariables;
   auto savedVariableTypes = m_VariableTypes;
+  auto savedConstants = m_LocalConstants;
   auto savedInstance = m_CurrentInstance;
   auto savedClassName = m_CurrentClassName;
+  bool savedInConstructor = m_InConstructor;
+  CoroutineState savedCoroutine = m_Coroutine;
   auto savedInsertPoint = builder.GetInsertBlock();
 
   // Set method context
   builder.SetInsertPoint(entryBB);
   m_LocalVariables.clear();
   m_VariableTypes.clear();
+  m_LocalConstants = QLocalConstants();
+  m_LocalConstants.Scan(method->GetBody());
   m_CurrentClassName = className;
+  // Constructors are named after the class (the base name for generics)
+  m_InConstructor = methodName == className ||
+                    methodName == className.substr(0, className.find('_'));
+  m_Coroutine = {};
+  if (isCoroutine) {
+    BeginCoroutine(func);
+  }
 
   // Name parameters and create allocas
   auto argIt = func->arg_begin();
@@ -2746,6 +3405,9 @@ void QJitRunner::CompileMethod(const std::string &className,
 
   // Compile method body
   CompileCodeBlock(method->GetBody());
+  if (isCoroutine) {
+    EndCoroutine(func);
+  }
 
   // Add return if not already terminated
   if (!builder.GetInsertBlock()->getTerminator()) {
@@ -2756,11 +3418,21 @@ void QJitRunner::CompileMethod(const std::string &className,
     }
   }
 
+  // Coroutines are left out (the time they spend suspended is not theirs),
+  // and value class methods are inlined into their callers
+  if (QProfiler::IsInstrumentationEnabled() && !isCoroutine &&
+      !classInfo.isValue) {
+    InstrumentMethod(func, className, mangledName);
+  }
+
   // Restore state
   m_LocalVariables = savedLocals;
   m_VariableTypes = savedVariableTypes;
+  m_LocalConstants = savedConstants;
   m_CurrentInstance = savedInstance;
   m_CurrentClassName = savedClassName;
+  m_InConstructor = savedInConstructor;
+  m_Coroutine = savedCoroutine;
   if (savedInsertPoint) {
     builder.SetInsertPoint(savedInsertPoint);
   }
@@ -2799,6 +3471,15 @@ void QJitRunner::CompileAssign(std::shared_ptr<QAssign> assign) {
         std::cout << "[DEBUG] QJitRunner: Treating as member assignment this."
                   << varName << std::endl;
 
+        // Indexed stores go through a pointer that other instances may share
+        if (QClassAccess *access = CurrentAccess()) {
+          if (assign->HasIndex()) {
+            access->writesShared = true;
+          } else if (!m_InConstructor) {
+            access->writesSelf = true;
+          }
+        }
+
         llvm::Type *memberType = classInfo.memberTypes[memberIdx];
         llvm::Value *memberPtr = builder.CreateStructGEP(
             classInfo.structType, m_CurrentInstance,
@@ -3139,6 +3820,12 @@ void QJitRunner::CompileReturn(std::shared_ptr<QReturn> returnNode) {
   llvm::Function *currentFunc = builder.GetInsertBlock()->getParent();
   llvm::Type *returnType = currentFunc->getReturnType();
 
+  // Coroutines are void; leaving one goes through its cleanup
+  if (m_Coroutine.handle) {
+    builder.CreateBr(m_Coroutine.cleanup);
+    return;
+  }
+
   if (returnNode->HasExpression()) {
     // Check if return type is a pointer (class return type)
     if (returnType->isPointerTy()) {
@@ -3148,7 +3835,7 @@ void QJitRunner::CompileReturn(std::shared_ptr<QReturn> returnNode) {
       if (expr) {
         const std::vector<Token> &tokens = expr->GetElements();
         if (tokens.size() == 1 && tokens[0].type == TokenType::T_IDENTIFIER) {
-          std::string varName = tokens[0].value;
+          std::string varName = tokens[0].Text();
           auto varIt = m_LocalVariables.find(varName);
           if (varIt != m_LocalVariables.end()) {
             // Check if it's a class instance (stored as a pointer in the
@@ -3192,22 +3879,284 @@ void QJitRunner::CompileReturn(std::shared_ptr<QReturn> returnNode) {
   }
 }
 
-llvm::Value *
-QJitRunner::CompileMethodCall(std::shared_ptr<QMethodCall> methodCall) {
-  if (!methodCall)
-    return nullptr;
+// ============================================================================
+// Coroutines
+// ============================================================================
+
+bool QJitRunner::ContainsYield(const std::shared_ptr<QCode> &code) {
+  if (!code)
+    return false;
+
+  for (const auto &node : code->GetNodes()) {
+    if (std::dynamic_pointer_cast<QYield>(node))
+      return true;
+    if (auto ifNode = std::dynamic_pointer_cast<QIf>(node)) {
+      if (ContainsYield(ifNode->GetThenBlock()) ||
+          ContainsYield(ifNode->GetElseBlock()))
+        return true;
+      for (const auto &elseIf : ifNode->GetElseIfBlocks()) {
+        if (ContainsYield(elseIf.second))
+          return true;
+      }
+    } else if (auto forNode = std::dynamic_pointer_cast<QFor>(node)) {
+      if (ContainsYield(forNode->GetBody()))
+        return true;
+    } else if (auto whileNode = std::dynamic_pointer_cast<QWhile>(node)) {
+      if (ContainsYield(whileNode->GetBody()))
+        return true;
+    }
+  }
+  return false;
+}
 
+void QJitRunner::BeginCoroutine(llvm::Function *func) {
   auto &builder = QLVM::GetBuilder();
-  std::string instanceName = methodCall->GetInstanceName();
-  std::string methodName = methodCall->GetMethodName();
+  auto &context = QLVM::GetContext();
+  auto *module = func->getParent();
 
-  std::cout << "[DEBUG] QJitRunner: Compiling method call " << instanceName
-            << "." << methodName << std::endl;
+  // CoroSplit only splits functions marked before it runs
+#if LLVM_VERSION_MAJOR >= 15
+  func->setPresplitCoroutine();
+#else
+  func->addFnAttr("coroutine.presplit", "0");
+#endif
 
-  llvm::Value *instancePtr = nullptr;
-  std::string className;
+  // The frame always comes from QHeap (no llvm.coro.alloc elision): it
+  // outlives the call that starts the coroutine
+  llvm::Value *nullPtr = llvm::ConstantPointerNull::get(builder.getPtrTy());
+  llvm::Value *id = builder.CreateCall(
+      llvm::Intrinsic::getDeclaration(module, llvm::Intrinsic::coro_id),
+      {builder.getInt32(0), nullPtr, nullPtr, nullPtr}, "coro.id");
+  llvm::Value *size = builder.CreateCall(
+      llvm::Intrinsic::getDeclaration(module, llvm::Intrinsic::coro_size,
+                                      {builder.getInt64Ty()}),
+      {}, "coro.size");
+  llvm::Value *memory = builder.CreateCall(
+      m_LVMContext->GetLLVMFunc("qlang_coro_alloc"), {size}, "coro.mem");
+  m_Coroutine.handle = builder.CreateCall(
+      llvm::Intrinsic::getDeclaration(module, llvm::Intrinsic::coro_begin),
+      {id, memory}, "coro.frame");
+
+  m_Coroutine.cleanup = llvm::BasicBlock::Create(context, "coro.cleanup", func);
+  m_Coroutine.suspend = llvm::BasicBlock::Create(context, "coro.suspend", func);
+}
 
-  if (instanceName == "this" || instanceName.empty()) {
+void QJitRunner::EndCoroutine(llvm::Function *func) {
+  auto &builder = QLVM::GetBuilder();
+  auto *module = func->getParent();
+
+  if (!builder.GetInsertBlock()->getTerminator()) {
+    builder.CreateBr(m_Coroutine.cleanup);
+  }
+
+  // Nothing to release: once the scheduler lets go of a finished frame,
+  // QHeap reclaims it
+  builder.SetInsertPoint(m_Coroutine.cleanup);
+  builder.CreateBr(m_Coroutine.suspend);
+
+  builder.SetInsertPoint(m_Coroutine.suspend);
+  llvm::Function *coroEnd =
+      llvm::Intrinsic::getDeclaration(module, llvm::Intrinsic::coro_end);
+  std::vector<llvm::Value *> endArgs = {m_Coroutine.handle,
+                                        builder.getFalse()};
+  if (coroEnd->arg_size() > 2) {
+    endArgs.push_back(llvm::ConstantTokenNone::get(QLVM::GetContext()));
+  }
+  builder.CreateCall(coroEnd, endArgs);
+  builder.CreateRetVoid();
+
+  // Locals declared in nested blocks are allocas outside the entry block;
+  // hoist them so each one gets a fixed slot in the frame
+  llvm::BasicBlock &entry = func->getEntryBlock();
+  std::vector<llvm::AllocaInst *> nested;
+  for (auto &block : *func) {
+    if (&block == &entry)
+      continue;
+    for (auto &inst : block) {
+      if (auto *alloca = llvm::dyn_cast<llvm::AllocaInst>(&inst)) {
+        if (llvm::isa<llvm::Constant>(alloca->getArraySize()))
+          nested.push_back(alloca);
+      }
+    }
+  }
+  for (llvm::AllocaInst *alloca : nested) {
+    alloca->moveBefore(&*entry.getFirstInsertionPt());
+  }
+}
+
+void QJitRunner::EmitSuspend() {
+  auto &builder = QLVM::GetBuilder();
+  auto &context = QLVM::GetContext();
+  llvm::Function *func = builder.GetInsertBlock()->getParent();
+
+  // 0: resumed, 1: destroyed, otherwise: suspended (return to the caller)
+  llvm::Value *state = builder.CreateCall(
+      llvm::Intrinsic::getDeclaration(func->getParent(),
+                                      llvm::Intrinsic::coro_suspend),
+      {llvm::ConstantTokenNone::get(context), builder.getFalse()},
+      "coro.state");
+  llvm::BasicBlock *resumeBB =
+      llvm::BasicBlock::Create(context, "coro.resume", func);
+  llvm::SwitchInst *dispatch =
+      builder.CreateSwitch(state, m_Coroutine.suspend, 2);
+  dispatch->addCase(builder.getInt8(0), resumeBB);
+  dispatch->addCase(builder.getInt8(1), m_Coroutine.cleanup);
+  builder.SetInsertPoint(resumeBB);
+}
+
+void QJitRunner::CompileYield(std::shared_ptr<QYield> yieldNode) {
+  if (!yieldNode)
+    return;
+
+  auto &builder = QLVM::GetBuilder();
+  auto &context = QLVM::GetContext();
+  if (!m_Coroutine.handle || !m_CurrentInstance) {
+    std::cerr << "[ERROR] QJitRunner: '" << yieldNode->GetName()
+              << "' used outside a method" << std::endl;
+    return;
+  }
+
+  llvm::Function *yieldFunc = m_LVMContext->GetLLVMFunc("qlang_coro_yield");
+  llvm::Function *waitFunc = m_LVMContext->GetLLVMFunc("qlang_coro_wait");
+  if (QClassAccess *access = CurrentAccess()) {
+    access->natives.insert(yieldNode->GetKind() == QYield::Kind::Seconds
+                               ? "qlang_coro_wait"
+                               : "qlang_coro_yield");
+  }
+
+  switch (yieldNode->GetKind()) {
+  case QYield::Kind::Frame:
+    builder.CreateCall(yieldFunc, {m_Coroutine.handle, m_CurrentInstance});
+    EmitSuspend();
+    break;
+
+  case QYield::Kind::Seconds: {
+    llvm::Value *seconds =
+        CompileExpression(yieldNode->GetExpression(), builder.getFloatTy());
+    if (!seconds) {
+      std::cerr << "[ERROR] QJitRunner: Failed to compile wait time"
+                << std::endl;
+      return;
+    }
+    seconds = CoerceArgument(seconds, builder.getFloatTy());
+    builder.CreateCall(waitFunc,
+                       {m_Coroutine.handle, m_CurrentInstance, seconds});
+    EmitSuspend();
+    break;
+  }
+
+  case QYield::Kind::Until: {
+    // Check once per frame: resume, test, suspend again while false
+    llvm::Function *func = builder.GetInsertBlock()->getParent();
+    llvm::BasicBlock *checkBB =
+        llvm::BasicBlock::Create(context, "wait.check", func);
+    llvm::BasicBlock *sleepBB =
+        llvm::BasicBlock::Create(context, "wait.sleep", func);
+    llvm::BasicBlock *doneBB =
+        llvm::BasicBlock::Create(context, "wait.done", func);
+    builder.CreateBr(checkBB);
+
+    builder.SetInsertPoint(checkBB);
+    llvm::Value *condVal = CompileExpression(yieldNode->GetExpression());
+    if (!condVal) {
+      std::cerr << "[ERROR] QJitRunner: Failed to compile waitUntil condition"
+                << std::endl;
+      builder.CreateBr(doneBB);
+      builder.SetInsertPoint(doneBB);
+      return;
+    }
+    if (!condVal->getType()->isIntegerTy(1)) {
+      condVal = builder.CreateICmpNE(
+          condVal, llvm::ConstantInt::get(condVal->getType(), 0), "waitcond");
+    }
+    builder.CreateCondBr(condVal, doneBB, sleepBB);
+
+    builder.SetInsertPoint(sleepBB);
+    builder.CreateCall(yieldFunc, {m_Coroutine.handle, m_CurrentInstance});
+    EmitSuspend();
+    builder.CreateBr(checkBB);
+
+    builder.SetInsertPoint(doneBB);
+    break;
+  }
+  }
+}
+
+// ============================================================================
+// Profiling
+// ============================================================================
+
+void QJitRunner::InstrumentMethod(llvm::Function *func,
+                                  const std::string &className,
+                                  const std::string &methodName) {
+  auto *module = func->getParent();
+  llvm::IRBuilder<> builder(QLVM::GetContext());
+
+  // { calls, cycles } as in QProfileCounters. Declared external and resolved
+  // by QJitProgram when the code is linked, so no address ends up in the IR.
+  llvm::ArrayType *countersType = llvm::ArrayType::get(builder.getInt64Ty(), 2);
+  std::string symbol = QProfiler::GetSymbolName(className, methodName);
+  llvm::GlobalVariable *counters = module->getGlobalVariable(symbol);
+  if (!counters) {
+    counters = new llvm::GlobalVariable(*module, countersType, false,
+                                        llvm::GlobalValue::ExternalLinkage,
+                                        nullptr, symbol);
+  }
+
+  auto readClock = [&]() -> llvm::Value * {
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) ||             \
+    defined(__i386__)
+    return builder.CreateCall(
+        llvm::Intrinsic::getDeclaration(module,
+                                        llvm::Intrinsic::readcyclecounter),
+        {}, "prof.clock");
+#else
+    return builder.CreateCall(m_LVMContext->GetLLVMFunc("qlang_profile_clock"),
+                              {}, "prof.clock");
+#endif
+  };
+
+  llvm::BasicBlock &entry = func->getEntryBlock();
+  builder.SetInsertPoint(&entry, entry.getFirstInsertionPt());
+  llvm::Value *start = readClock();
+
+  std::vector<llvm::ReturnInst *> returns;
+  for (auto &block : *func) {
+    if (auto *ret =
+            llvm::dyn_cast_or_null<llvm::ReturnInst>(block.getTerminator()))
+      returns.push_back(ret);
+  }
+  for (llvm::ReturnInst *ret : returns) {
+    builder.SetInsertPoint(ret);
+    llvm::Value *elapsed = builder.CreateSub(readClock(), start, "prof.time");
+    builder.CreateAtomicRMW(
+        llvm::AtomicRMWInst::Add,
+        builder.CreateConstInBoundsGEP2_32(countersType, counters, 0, 0),
+        builder.getInt64(1), llvm::MaybeAlign(8),
+        llvm::AtomicOrdering::Monotonic);
+    builder.CreateAtomicRMW(
+        llvm::AtomicRMWInst::Add,
+        builder.CreateConstInBoundsGEP2_32(countersType, counters, 0, 1),
+        elapsed, llvm::MaybeAlign(8), llvm::AtomicOrdering::Monotonic);
+  }
+}
+
+llvm::Value *
+QJitRunner::CompileMethodCall(std::shared_ptr<QMethodCall> methodCall) {
+  if (!methodCall)
+    return nullptr;
+
+  auto &builder = QLVM::GetBuilder();
+  std::string instanceName = methodCall->GetInstanceName();
+  std::string methodName = methodCall->GetMethodName();
+
+  std::cout << "[DEBUG] QJitRunner: Compiling method call " << instanceName
+            << "." << methodName << std::endl;
+
+  llvm::Value *instancePtr = nullptr;
+  std::string className;
+
+  if (instanceName == "this" || instanceName.empty()) {
     instancePtr = m_CurrentInstance;
     className = m_CurrentClassName;
     std::cout << "[DEBUG] Method call on THIS: " << className << std::endl;
@@ -3286,6 +4235,26 @@ QJitRunner::CompileMethodCall(std::shared_ptr<QMethodCall> methodCall) {
   }
 
   if (!instancePtr || className.empty()) {
+    // Outside a class, an unqualified call can only be an intrinsic or a
+    // native
+    if ((instanceName == "this" || instanceName.empty()) &&
+        IsVectorIntrinsic(methodName)) {
+      std::vector<llvm::Value *> args;
+      if (auto arguments = methodCall->GetArguments()) {
+        for (const auto &param : arguments->GetParameters()) {
+          llvm::Value *argVal = CompileExpression(param);
+          if (!argVal)
+            return nullptr;
+          args.push_back(argVal);
+        }
+      }
+      return CompileVectorIntrinsic(methodName, args);
+    }
+    if (instanceName == "this" || instanceName.empty()) {
+      if (llvm::Function *native = m_LVMContext->GetLLVMFunc(methodName)) {
+        return CompileNativeCall(native, methodCall->GetArguments());
+      }
+    }
     std::cerr << "[ERROR] QJitRunner: Cannot resolve instance for method call: "
               << methodName << std::endl;
     return nullptr;
@@ -3318,6 +4287,16 @@ QJitRunner::CompileMethodCall(std::shared_ptr<QMethodCall> methodCall) {
   // Use FindMethodOverload to find the best matching overload
   llvm::Function *targetFunc =
       FindMethodOverload(classInfo, methodName, compiledArgs);
+  if (!targetFunc && (instanceName == "this" || instanceName.empty())) {
+    // Not a method of this class: an intrinsic or a native called from an
+    // expression
+    if (IsVectorIntrinsic(methodName)) {
+      return CompileVectorIntrinsic(methodName, compiledArgs);
+    }
+    if (llvm::Function *native = m_LVMContext->GetLLVMFunc(methodName)) {
+      return EmitNativeCall(native, compiledArgs);
+    }
+  }
   if (!targetFunc) {
     std::cerr << "[ERROR] QJitRunner: Method '" << methodName
               << "' not found in class '" << className
@@ -3351,43 +4330,123 @@ QJitRunner::CompileMethodCall(std::shared_ptr<QMethodCall> methodCall) {
 
     // Apply type conversions if needed
     if (i + 1 < ft->getNumParams()) {
-      llvm::Type *paramType = ft->getParamType(static_cast<unsigned>(i + 1));
+      argVal = CoerceArgument(argVal,
+                              ft->getParamType(static_cast<unsigned>(i + 1)));
+    }
 
-      // Integer type conversion
-      if (paramType->isIntegerTy() && argVal->getType()->isIntegerTy()) {
-        if (argVal->getType()->getIntegerBitWidth() <
-            paramType->getIntegerBitWidth()) {
-          argVal = builder.CreateSExt(argVal, paramType);
-        } else if (argVal->getType()->getIntegerBitWidth() >
-                   paramType->getIntegerBitWidth()) {
-          argVal = builder.CreateTrunc(argVal, paramType);
-        }
-      }
-      // Float type conversion
-      else if (paramType->isFloatingPointTy() &&
-               argVal->getType()->isFloatingPointTy()) {
-        if (argVal->getType()->isFloatTy() && paramType->isDoubleTy()) {
-          argVal = builder.CreateFPExt(argVal, paramType);
-        } else if (argVal->getType()->isDoubleTy() && paramType->isFloatTy()) {
-          argVal = builder.CreateFPTrunc(argVal, paramType);
-        }
-      }
-      // Int to float
-      else if (paramType->isFloatingPointTy() &&
-               argVal->getType()->isIntegerTy()) {
-        argVal = builder.CreateSIToFP(argVal, paramType);
+    callArgs.push_back(argVal);
+  }
+
+  // Calls on another instance run that class's code on shared data
+  if (instanceName != "this" && instanceName != "super" &&
+      !instanceName.empty()) {
+    if (QClassAccess *access = CurrentAccess()) {
+      if (m_LocalConstants.IsLocalAllocation(instanceName)) {
+        access->localClasses.insert(className);
+      } else {
+        access->classes.insert(className);
       }
-      // Float to int
-      else if (paramType->isIntegerTy() &&
-               argVal->getType()->isFloatingPointTy()) {
-        argVal = builder.CreateFPToSI(argVal, paramType);
+    }
+  }
+
+  return builder.CreateCall(targetFunc, callArgs);
+}
+
+llvm::Value *QJitRunner::CoerceArgument(llvm::Value *argVal,
+                                        llvm::Type *paramType) {
+  auto &builder = QLVM::GetBuilder();
+  llvm::Type *argType = argVal->getType();
+
+  // Integer type conversion
+  if (paramType->isIntegerTy() && argType->isIntegerTy()) {
+    if (argType->getIntegerBitWidth() < paramType->getIntegerBitWidth()) {
+      return builder.CreateSExt(argVal, paramType);
+    }
+    if (argType->getIntegerBitWidth() > paramType->getIntegerBitWidth()) {
+      return builder.CreateTrunc(argVal, paramType);
+    }
+  }
+  // Float type conversion
+  else if (paramType->isFloatingPointTy() && argType->isFloatingPointTy()) {
+    if (argType->isFloatTy() && paramType->isDoubleTy()) {
+      return builder.CreateFPExt(argVal, paramType);
+    }
+    if (argType->isDoubleTy() && paramType->isFloatTy()) {
+      return builder.CreateFPTrunc(argVal, paramType);
+    }
+  }
+  // Int to float
+  else if (paramType->isFloatingPointTy() && argType->isIntegerTy()) {
+    return builder.CreateSIToFP(argVal, paramType);
+  }
+  // Float to int
+  else if (paramType->isIntegerTy() && argType->isFloatingPointTy()) {
+    return builder.CreateFPToSI(argVal, paramType);
+  }
+  // Vector to a native taking 'const glm::vec3 &' etc.: pass its address
+  else if (paramType->isPointerTy() && GetVectorWidth(argType)) {
+    llvm::Function *func = builder.GetInsertBlock()->getParent();
+    llvm::IRBuilder<> entryBuilder(&func->getEntryBlock(),
+                                   func->getEntryBlock().begin());
+    llvm::AllocaInst *slot =
+        entryBuilder.CreateAlloca(argType, nullptr, "vec.arg");
+    builder.CreateStore(argVal, slot);
+    return slot;
+  }
+  return argVal;
+}
+
+llvm::Value *
+QJitRunner::CompileNativeCall(llvm::Function *native,
+                              std::shared_ptr<QParameters> arguments) {
+  llvm::FunctionType *ft = native->getFunctionType();
+  std::vector<llvm::Value *> args;
+  if (arguments) {
+    const auto &params = arguments->GetParameters();
+    for (size_t i = 0; i < params.size(); ++i) {
+      llvm::Type *paramType =
+          i < ft->getNumParams()
+              ? ft->getParamType(static_cast<unsigned>(i))
+              : nullptr;
+      llvm::Value *argVal = CompileExpression(params[i], paramType);
+      if (!argVal) {
+        std::cerr << "[ERROR] QJitRunner: Failed to compile argument " << i
+                  << " for " << native->getName().str() << std::endl;
+        return nullptr;
       }
+      args.push_back(argVal);
     }
+  }
+  return EmitNativeCall(native, args);
+}
 
-    callArgs.push_back(argVal);
+llvm::Value *QJitRunner::EmitNativeCall(llvm::Function *native,
+                                        std::vector<llvm::Value *> args) {
+  auto &builder = QLVM::GetBuilder();
+  llvm::FunctionType *ft = native->getFunctionType();
+
+  if (args.size() < ft->getNumParams() ||
+      (args.size() > ft->getNumParams() && !ft->isVarArg())) {
+    std::cerr << "[ERROR] QJitRunner: Native '" << native->getName().str()
+              << "' takes " << ft->getNumParams() << " arguments, got "
+              << args.size() << std::endl;
+    return nullptr;
   }
 
-  return builder.CreateCall(targetFunc, callArgs);
+  for (size_t i = 0; i < args.size(); ++i) {
+    if (i < ft->getNumParams()) {
+      args[i] =
+          CoerceArgument(args[i], ft->getParamType(static_cast<unsigned>(i)));
+    } else if (args[i]->getType()->isFloatTy()) {
+      // Vararg promotion: float -> double
+      args[i] = builder.CreateFPExt(args[i], builder.getDoubleTy());
+    }
+  }
+
+  if (QClassAccess *access = CurrentAccess()) {
+    access->natives.insert(native->getName().str());
+  }
+  return builder.CreateCall(native, args);
 }
 
 // ============================================================================
@@ -3617,10 +4676,10 @@ void QJitRunner::CompileInstanceDecl(std::shared_ptr<QInstanceDecl> instDecl) {
   std::cout << "[DEBUG] QJitRunner: Instance '" << instanceName
             << "' allocating with constructor args" << std::endl;
 
-  // Allocate memory on heap using malloc
-  llvm::Function *mallocFunc = m_LVMContext->GetLLVMFunc("malloc");
+  // Allocate memory on the managed heap
+  llvm::Function *mallocFunc = m_LVMContext->GetLLVMFunc("qlang_alloc");
   if (!mallocFunc) {
-    mallocFunc = QLVM::GetModule()->getFunction("malloc");
+    mallocFunc = QLVM::GetModule()->getFunction("qlang_alloc");
     if (!mallocFunc) {
       std::vector<llvm::Type *> args = {
           llvm::Type::getInt64Ty(QLVM::GetContext())};
@@ -3628,12 +4687,12 @@ void QJitRunner::CompileInstanceDecl(std::shared_ptr<QInstanceDecl> instDecl) {
           llvm::PointerType::getUnqual(QLVM::GetContext()), args, false);
       mallocFunc =
           llvm::Function::Create(mallocType, llvm::Function::ExternalLinkage,
-                                 "malloc", QLVM::GetModule());
+                                 "qlang_alloc", QLVM::GetModule());
     }
   }
 
   if (!mallocFunc) {
-    std::cerr << "[ERROR] QJitRunner: malloc not found for InstanceDecl"
+    std::cerr << "[ERROR] QJitRunner: qlang_alloc not found for InstanceDecl"
               << std::endl;
     return;
   }
@@ -3740,6 +4799,38 @@ void QJitRunner::CompileMemberAssign(
   std::cout << "[DEBUG] QJitRunner: Compiling member assignment "
             << instanceName << "." << memberName << std::endl;
 
+  // Component of a vector local or member: v.x = value
+  llvm::Value *vectorPtr = nullptr;
+  llvm::Type *vectorType = nullptr;
+  int component = GetVectorComponent(memberName);
+  if (component >= 0 &&
+      FindVectorStorage(instanceName, vectorPtr, vectorType)) {
+    unsigned width = GetVectorWidth(vectorType);
+    if (width == 16 || component >= static_cast<int>(width)) {
+      std::cerr << "[ERROR] QJitRunner: '" << instanceName
+                << "' has no component '" << memberName << "'" << std::endl;
+      return;
+    }
+    llvm::Value *value = CompileExpression(memberAssign->GetValueExpression(),
+                                           builder.getFloatTy());
+    if (value)
+      value = ToFloatScalar(value);
+    if (!value) {
+      std::cerr << "[ERROR] QJitRunner: Failed to compile value for "
+                << instanceName << "." << memberName << std::endl;
+      return;
+    }
+    llvm::Value *componentPtr = builder.CreateConstInBoundsGEP2_32(
+        vectorType, vectorPtr, 0, static_cast<unsigned>(component),
+        instanceName + "." + memberName + ".ptr");
+    builder.CreateStore(value, componentPtr);
+    QClassAccess *access = CurrentAccess();
+    if (access && !m_InConstructor && !m_LocalVariables.count(instanceName)) {
+      access->writesSelf = true;
+    }
+    return;
+  }
+
   // Look up instance
   llvm::Value *instancePtr = nullptr;
   std::string className;
@@ -3813,6 +4904,15 @@ void QJitRunner::CompileMemberAssign(
     return;
   }
 
+  // Structs are not copied on assignment, so a local or parameter of any
+  // class may point at another instance; only an object this body allocated
+  // is private
+  if (QClassAccess *access = CurrentAccess()) {
+    if (staticClassInfo || !m_LocalConstants.IsLocalAllocation(instanceName)) {
+      access->writesShared = true;
+    }
+  }
+
   // Compile the value expression
   llvm::Type *memberType = classInfo.memberTypes[memberIdx];
   llvm::Value *value =
@@ -3919,6 +5019,8 @@ QJitRunner::CompileProgram(std::shared_ptr<QProgram> program, bool accumulate) {
 
   // Compile the main code block
   if (auto globalCode = program->GetCode()) {
+    m_LocalConstants = QLocalConstants();
+    m_LocalConstants.Scan(globalCode);
     CompileCodeBlock(globalCode);
   }
 
@@ -3978,12 +5080,38 @@ QJitRunner::CompileProgram(std::shared_ptr<QProgram> program, bool accumulate) {
   return jitProgram;
 }
 
+// Scripts are tracked by canonical path, however the caller spelled it
+static std::string ScriptKey(const std::string &path) {
+  std::error_code ec;
+  auto canonical = std::filesystem::weakly_canonical(path, ec);
+  return ec ? path : canonical.string();
+}
+
 bool QJitRunner::BuildModule(const std::string &path) {
   // Clear previous errors
   if (m_ErrorCollector) {
     m_ErrorCollector->ClearErrors();
   }
 
+  // Library classes ship a .qm next to the source; if it was built from this
+  // exact source, link it instead of tokenizing/parsing/validating again
+  std::filesystem::path sourceFile(path);
+  std::filesystem::path binaryFile = sourceFile;
+  binaryFile.replace_extension(".qm");
+  bool hasBinary = std::filesystem::exists(binaryFile);
+  std::string sourceHash;
+  if (hasBinary) {
+    sourceHash = QModuleFile::HashSource(path);
+    QModuleFile header;
+    if (!sourceHash.empty() &&
+        header.ReadSourceHash(binaryFile.string()) == sourceHash &&
+        LoadModuleBinary(sourceFile.stem().string(), binaryFile.string())) {
+      m_MasterModuleNeedsRecompile = true;
+      QConsole::Print("Loaded: " + binaryFile.filename().string());
+      return true;
+    }
+  }
+
   // Tokenize
   Tokenizer tokenizer(path, m_ErrorCollector);
   tokenizer.Tokenize();
@@ -3995,7 +5123,7 @@ bool QJitRunner::BuildModule(const std::string &path) {
   }
 
   // Parse
-  Parser parser(tokenizer.GetTokens(), m_ErrorCollector);
+  Parser parser(tokenizer.TakeTokens(), m_ErrorCollector);
   auto program = parser.Parse();
 
   if (m_ErrorCollector->HasErrors()) {
@@ -4033,6 +5161,16 @@ bool QJitRunner::BuildModule(const std::string &path) {
   // Mark master module as needing recompile since we added new code
   m_MasterModuleNeedsRecompile = true;
 
+  // Baseline for PatchScript
+  if (!m_ErrorCollector->HasErrors()) {
+    RecordScriptState(path, program);
+  }
+
+  // Refresh the stale binary so the next launch takes the fast path
+  if (hasBinary && !m_ErrorCollector->HasErrors()) {
+    CompileModule(sourceFile.stem().string(), path, binaryFile.string());
+  }
+
   // Log success
   std::filesystem::path p(path);
   QConsole::Print("Compiled: " + p.filename().string());
@@ -4046,31 +5184,444 @@ std::string QJitRunner::CompileScriptIntoMaster(const std::string &path) {
    m_CurrentScriptPath.clear();
 
   if (success) {
-    // Extract class name from path stem
-    std::filesystem::path p(path);
-    std::string className = p.stem().string();
-
-    // Check if any scripts were waiting for this type
-    auto pendingIt = m_ScriptsPendingType.find(className);
-    if (pendingIt != m_ScriptsPendingType.end()) {
-      std::vector<std::string> dependents = pendingIt->second;
-      m_ScriptsPendingType.erase(pendingIt); // Remove from pending list
-
-      for (const auto &depPath : dependents) {
-        std::cout << "[INFO] QJitRunner: Auto-recompiling dependent script: "
-                  << std::filesystem::path(depPath).filename().string()
-                  << std::endl;
+    RebuildDependents(path);
+    return std::filesystem::path(path).stem().string();
+  }
+  return "";
+}
+
+void QJitRunner::RebuildDependents(const std::string &path) {
+  // Extract class name from path stem
+  std::string className = std::filesystem::path(path).stem().string();
+
+  // Check if any scripts were waiting for this type
+  auto pendingIt = m_ScriptsPendingType.find(className);
+  if (pendingIt != m_ScriptsPendingType.end()) {
+    std::vector<std::string> dependents = pendingIt->second;
+    m_ScriptsPendingType.erase(pendingIt); // Remove from pending list
+
+    for (const auto &depPath : dependents) {
+      std::cout << "[INFO] QJitRunner: Auto-recompiling dependent script: "
+                << std::filesystem::path(depPath).filename().string()
+                << std::endl;
 
-        // Recompile dependent script
-        m_CurrentScriptPath = depPath;
-        BuildModule(depPath);
-        m_CurrentScriptPath.clear();
+      // Recompile dependent script
+      m_CurrentScriptPath = depPath;
+      BuildModule(depPath);
+      m_CurrentScriptPath.clear();
+    }
+  }
+
+  // Code compiled against a class layout that just changed
+  std::set<std::string> layoutDependents;
+  layoutDependents.swap(m_LayoutDependents);
+  for (const auto &depPath : layoutDependents) {
+    if (ScriptKey(depPath) == ScriptKey(path))
+      continue;
+    std::cout << "[INFO] QJitRunner: Recompiling for new layout: "
+              << std::filesystem::path(depPath).filename().string()
+              << std::endl;
+    m_CurrentScriptPath = depPath;
+    BuildModule(depPath);
+    m_CurrentScriptPath.clear();
+  }
+}
+
+namespace {
+
+// A .qm carries class layouts and methods only; modules with top-level code,
+// enums or generic templates still go through BuildModule
+bool CanBuildAsBinary(const QScriptNode &node) {
+  if (!node.program || node.errors->HasErrors())
+    return false;
+  if (!node.program->GetEnums().empty())
+    return false;
+  auto code = node.program->GetCode();
+  if (code && !code->GetNodes().empty())
+    return false;
+  for (const auto &cls : node.program->GetClasses()) {
+    if (cls->IsGeneric())
+      return false;
+  }
+  return true;
+}
+
+} // namespace
+
+bool QJitRunner::BuildModules(const std::vector<std::string> &paths,
+                              unsigned threads) {
+  if (m_ErrorCollector) {
+    m_ErrorCollector->ClearErrors();
+  }
+
+  std::string basePath = m_BasePath.empty() ? "test" : m_BasePath;
+
+  QScriptGraph graph;
+  std::set<size_t> requested;
+  for (const auto &path : paths) {
+    requested.insert(graph.AddScript(path));
+  }
+  graph.Parse(basePath, threads);
+
+  std::vector<std::vector<size_t>> waves;
+  std::string cycle;
+  if (!graph.BuildWaves(waves, &cycle)) {
+    QConsole::PrintError("QJitRunner: Import cycle between " + cycle +
+                         ", building modules one at a time");
+    bool success = true;
+    for (const auto &path : paths) {
+      success = BuildModule(path) && success;
+    }
+    return success;
+  }
+
+  // Every class in the set is known up front, as it would be to a serial
+  // build once the files before it were compiled
+  std::set<std::string> knownClasses;
+  for (const auto &pair : m_CompiledClasses) {
+    knownClasses.insert(pair.first);
+  }
+  for (size_t i = 0; i < graph.Size(); ++i) {
+    if (auto program = graph.GetNode(i).program) {
+      for (const auto &cls : program->GetClasses()) {
+        knownClasses.insert(cls->GetName());
       }
     }
+  }
 
-    return className;
+  enum class ModuleState { UpToDate, Compiled, Serial };
+  std::vector<ModuleState> states(graph.Size(), ModuleState::Serial);
+
+  for (const auto &wave : waves) {
+    QScriptGraph::ParallelFor(wave, threads, [&](size_t index) {
+      QScriptNode &node = graph.GetNode(index);
+      if (!CanBuildAsBinary(node))
+        return;
+      // A worker must never compile an import itself - two could race on
+      // the same .qm - so dependents of serial modules are serial too
+      for (size_t dep : node.dependencies) {
+        if (states[dep] == ModuleState::Serial)
+          return;
+      }
+
+      std::filesystem::path binaryFile(node.path);
+      binaryFile.replace_extension(".qm");
+      std::string sourceHash = QModuleFile::HashSource(node.path);
+      QModuleFile header;
+      if (!sourceHash.empty() && std::filesystem::exists(binaryFile) &&
+          header.ReadSourceHash(binaryFile.string()) == sourceHash) {
+        states[index] = ModuleState::UpToDate;
+        return;
+      }
+
+      QValidator validator(node.errors);
+      validator.RegisterKnownClasses(knownClasses);
+      validator.Validate(node.program);
+      if (node.errors->HasErrors())
+        return;
+
+      // Declared before the worker so the thread's LLVM state outlives it
+      QLVM::ThreadState threadState;
+      QJitRunner worker(m_LVMContext->CloneForCurrentThread(), node.errors);
+      worker.SetBasePath(basePath);
+      if (worker.CompileModuleProgram(node.name, node.program, node.path,
+                                      binaryFile.string())) {
+        states[index] = ModuleState::Compiled;
+      }
+    });
+  }
+
+  // Link on this thread, dependencies first
+  bool success = true;
+  for (const auto &wave : waves) {
+    for (size_t index : wave) {
+      const QScriptNode &node = graph.GetNode(index);
+      std::filesystem::path binaryFile(node.path);
+      binaryFile.replace_extension(".qm");
+
+      if (states[index] != ModuleState::Serial &&
+          (m_LoadedModules.count(node.name) ||
+           LoadModuleBinary(node.name, binaryFile.string()))) {
+        QConsole::Print((states[index] == ModuleState::Compiled ? "Compiled: "
+                                                                : "Loaded: ") +
+                        binaryFile.filename().string());
+        continue;
+      }
+
+      // Imports picked up along the way are left to ImportModule, as before
+      if (!requested.count(index))
+        continue;
+
+      // Reports its own diagnostics
+      success = BuildModule(node.path) && success;
+    }
+  }
+
+  m_MasterModuleNeedsRecompile = true;
+  return success;
+}
+
+namespace {
+
+std::string WriteBitcode(const llvm::Module &module) {
+  std::string bitcode;
+  llvm::raw_string_ostream os(bitcode);
+  llvm::WriteBitcodeToFile(module, os);
+  os.flush();
+  return bitcode;
+}
+
+// Declarations nothing refers to, left over from what a worker linked in
+void DropUnusedDeclarations(llvm::Module &module) {
+  for (auto it = module.global_begin(); it != module.global_end();) {
+    llvm::GlobalVariable &global = *it++;
+    if (global.isDeclaration() && global.use_empty())
+      global.eraseFromParent();
+  }
+  for (auto it = module.begin(); it != module.end();) {
+    llvm::Function &func = *it++;
+    if (func.isDeclaration() && func.use_empty())
+      func.eraseFromParent();
   }
-  return "";
+}
+
+// A script compiled on a worker: its own definitions (what it uses from the
+// master or other scripts is only declared) and its classes
+struct ScriptBinary {
+  std::string bitcode;
+  std::vector<ModuleClassInfo> classes;
+};
+
+} // namespace
+
+std::vector<std::string>
+QJitRunner::CompileScriptsIntoMaster(const std::vector<std::string> &paths,
+                                     unsigned threads) {
+  std::string basePath = m_BasePath.empty() ? "test" : m_BasePath;
+
+  QScriptGraph graph;
+  std::vector<int> nodeOf(paths.size(), -1);
+  std::set<size_t> requested;
+  for (size_t i = 0; i < paths.size(); ++i) {
+    size_t index = graph.AddScript(paths[i]);
+    // A second script of the same name is built on its own afterwards
+    if (ScriptKey(graph.GetNode(index).path) != ScriptKey(paths[i]))
+      continue;
+    nodeOf[i] = static_cast<int>(index);
+    requested.insert(index);
+  }
+  graph.Parse(basePath, threads);
+  graph.AddClassDependencies();
+
+  std::vector<std::vector<size_t>> waves;
+  std::string cycle;
+  if (!graph.BuildWaves(waves, &cycle)) {
+    QConsole::Print("QJitRunner: " + cycle +
+                    " use each other, building them one at a time");
+  }
+
+  std::set<std::string> knownClasses;
+  for (const auto &pair : m_CompiledClasses) {
+    knownClasses.insert(pair.first);
+  }
+  for (size_t i = 0; i < graph.Size(); ++i) {
+    if (auto program = graph.GetNode(i).program) {
+      for (const auto &cls : program->GetClasses()) {
+        knownClasses.insert(cls->GetName());
+      }
+    }
+  }
+
+  // Read-only snapshot for the workers: declarations of everything in the
+  // master, plus a global per class that keeps its layout in the bitcode
+  std::string masterBitcode;
+  std::vector<ModuleClassInfo> masterClasses;
+  {
+    llvm::ValueToValueMapTy map;
+    auto declarations = llvm::CloneModule(
+        *QLVM::GetModule(), map,
+        [](const llvm::GlobalValue *) { return false; });
+    std::vector<std::string> classNames;
+    for (const auto &pair : m_CompiledClasses) {
+      classNames.push_back(pair.first);
+      new llvm::GlobalVariable(*declarations, pair.second.structType, false,
+                               llvm::GlobalValue::ExternalLinkage, nullptr,
+                               "__qlang_layout." + pair.first);
+    }
+    masterBitcode = WriteBitcode(*declarations);
+    masterClasses = DescribeClasses(classNames);
+  }
+
+  // Imports the master has loaded count as built; scripts are built here
+  enum class BuildState { Serial, Compiled, Loaded };
+  std::vector<BuildState> states(graph.Size(), BuildState::Serial);
+  for (size_t i = 0; i < graph.Size(); ++i) {
+    if (!requested.count(i) && m_LoadedModules.count(graph.GetNode(i).name))
+      states[i] = BuildState::Loaded;
+  }
+
+  // Everything a script uses, directly or through other scripts
+  std::vector<std::set<size_t>> uses(graph.Size());
+  for (const auto &wave : waves) {
+    for (size_t index : wave) {
+      for (size_t dep : graph.GetNode(index).dependencies) {
+        uses[index].insert(dep);
+        uses[index].insert(uses[dep].begin(), uses[dep].end());
+      }
+    }
+  }
+
+  std::vector<ScriptBinary> binaries(graph.Size());
+  for (const auto &wave : waves) {
+    QScriptGraph::ParallelFor(wave, threads, [&](size_t index) {
+      QScriptNode &node = graph.GetNode(index);
+      if (!requested.count(index) || !CanBuildAsBinary(node))
+        return;
+      // A new layout for a compiled class has to reach its dependents
+      for (const auto &cls : node.program->GetClasses()) {
+        if (m_CompiledClasses.count(cls->GetName()))
+          return;
+      }
+      for (const auto &import : node.imports) {
+        if (!m_LoadedModules.count(import))
+          return;
+      }
+      for (size_t dep : node.dependencies) {
+        if (states[dep] == BuildState::Serial)
+          return;
+      }
+
+      QValidator validator(node.errors);
+      validator.RegisterKnownClasses(knownClasses);
+      validator.Validate(node.program);
+      if (node.errors->HasErrors())
+        return;
+
+      // Declared before the worker so the thread's LLVM state outlives it
+      QLVM::ThreadState threadState;
+      QJitRunner worker(m_LVMContext->CloneForCurrentThread(), node.errors);
+      worker.SetBasePath(basePath);
+      worker.SetHotPatching(m_HotPatching);
+      worker.m_GenericClassTemplates = m_GenericClassTemplates;
+      worker.m_CompiledEnums = m_CompiledEnums;
+      if (!worker.LinkBitcode(masterBitcode, masterClasses))
+        return;
+      for (size_t dep : uses[index]) {
+        if (states[dep] == BuildState::Compiled &&
+            !worker.LinkBitcode(binaries[dep].bitcode, binaries[dep].classes))
+          return;
+      }
+
+      // Specializations linked in are not compiled again, and nothing
+      // defined so far goes into this script's bitcode
+      std::set<std::string> linkedClasses;
+      for (const auto &pair : worker.m_CompiledClasses) {
+        linkedClasses.insert(pair.first);
+        worker.m_CompiledSpecializations.insert(pair.first);
+      }
+      std::set<std::string> linked;
+      for (const auto &value : QLVM::GetModule()->global_values()) {
+        if (!value.isDeclaration())
+          linked.insert(value.getName().str());
+      }
+
+      for (const auto &cls : node.program->GetClasses()) {
+        worker.CompileClass(cls);
+      }
+      if (node.errors->HasErrors())
+        return;
+
+      std::string err;
+      llvm::raw_string_ostream os(err);
+      if (llvm::verifyModule(*QLVM::GetModule(), &os)) {
+        std::cerr << "[ERROR] QJitRunner: Module verification failed for "
+                  << node.path << ": " << os.str() << std::endl;
+        return;
+      }
+
+      llvm::ValueToValueMapTy map;
+      auto own = llvm::CloneModule(
+          *QLVM::GetModule(), map, [&](const llvm::GlobalValue *value) {
+            return value->hasLocalLinkage() ||
+                   !linked.count(value->getName().str());
+          });
+      DropUnusedDeclarations(*own);
+
+      std::vector<std::string> classNames;
+      for (const auto &pair : worker.m_CompiledClasses) {
+        if (!linkedClasses.count(pair.first))
+          classNames.push_back(pair.first);
+      }
+      binaries[index].bitcode = WriteBitcode(*own);
+      binaries[index].classes = worker.DescribeClasses(classNames);
+      states[index] = BuildState::Compiled;
+    });
+  }
+
+  // Link on this thread, dependencies first
+  std::vector<std::string> built(graph.Size());
+  std::set<size_t> done;
+  for (const auto &wave : waves) {
+    for (size_t index : wave) {
+      if (!requested.count(index))
+        continue;
+      const QScriptNode &node = graph.GetNode(index);
+      done.insert(index);
+
+      if (states[index] != BuildState::Compiled ||
+          !LinkBitcode(binaries[index].bitcode, binaries[index].classes)) {
+        // Reports its own diagnostics
+        built[index] = CompileScriptIntoMaster(node.path);
+        continue;
+      }
+
+      // What BuildModule records for a script compiled here
+      std::set<std::string> declared;
+      for (const auto &cls : node.program->GetClasses()) {
+        declared.insert(cls->GetName());
+        m_ClassSources[cls->GetName()] = node.path;
+      }
+      for (const auto &info : binaries[index].classes) {
+        if (!declared.count(info.className))
+          m_CompiledSpecializations.insert(info.className);
+      }
+      RecordScriptState(node.path, node.program);
+      m_MasterModuleNeedsRecompile = true;
+      QConsole::Print("Compiled: " +
+                      std::filesystem::path(node.path).filename().string());
+
+      RebuildDependents(node.path);
+      built[index] = std::filesystem::path(node.path).stem().string();
+    }
+  }
+
+  std::vector<std::string> classNames(paths.size());
+  for (size_t i = 0; i < paths.size(); ++i) {
+    if (nodeOf[i] < 0) {
+      classNames[i] = CompileScriptIntoMaster(paths[i]);
+      continue;
+    }
+    size_t index = static_cast<size_t>(nodeOf[i]);
+    // Scripts of a cycle, in the order given
+    if (done.insert(index).second)
+      built[index] = CompileScriptIntoMaster(paths[i]);
+    classNames[i] = built[index];
+  }
+  return classNames;
+}
+
+bool QJitRunner::LinkBitcode(const std::string &bitcode,
+                             const std::vector<ModuleClassInfo> &classes) {
+  auto module = llvm::parseBitcodeFile(
+      llvm::MemoryBufferRef(bitcode, "script"), QLVM::GetContext());
+  if (!module) {
+    std::cerr << "[ERROR] QJitRunner: Failed to read bitcode: "
+              << llvm::toString(module.takeError()) << std::endl;
+    return false;
+  }
+  LinkModuleInto(module->get(), QLVM::GetModule());
+  RegisterModuleClasses(classes);
+  return true;
 }
 
 // ============================================================================
@@ -4090,17 +5641,17 @@ bool QJitRunner::ImportModule(const std::string &moduleName) {
   std::string sourcePath = basePath + "/" + moduleName + ".q";
   std::string binaryPath = basePath + "/" + moduleName + ".qm";
 
-  // Check if binary exists and is up to date
+  // Check if binary exists and was built from the current source
   bool needsCompile = false;
   if (!std::filesystem::exists(binaryPath)) {
     std::cout << "[INFO] QJitRunner: Binary not found for '" << moduleName
               << "', compiling from source..." << std::endl;
     needsCompile = true;
   } else if (std::filesystem::exists(sourcePath)) {
-    auto sourceTime = std::filesystem::last_write_time(sourcePath);
-    auto binaryTime = std::filesystem::last_write_time(binaryPath);
-    if (sourceTime > binaryTime) {
-      std::cout << "[INFO] QJitRunner: Source file newer than binary for '"
+    QModuleFile header;
+    if (header.ReadSourceHash(binaryPath) !=
+        QModuleFile::HashSource(sourcePath)) {
+      std::cout << "[INFO] QJitRunner: Source changed since binary for '"
                 << moduleName << "', recompiling..." << std::endl;
       needsCompile = true;
     }
@@ -4119,6 +5670,11 @@ bool QJitRunner::ImportModule(const std::string &moduleName) {
     }
   }
 
+  return LoadModuleBinary(moduleName, binaryPath);
+}
+
+bool QJitRunner::LoadModuleBinary(const std::string &moduleName,
+                                  const std::string &binaryPath) {
   // Load the binary module
   QModuleFile moduleFile;
   std::unique_ptr<llvm::Module> loadedModule;
@@ -4138,6 +5694,16 @@ bool QJitRunner::ImportModule(const std::string &moduleName) {
   std::cout << "[INFO] QJitRunner: Importing module '" << moduleName << "'"
             << std::endl;
 
+  RegisterModuleClasses(classes);
+
+  m_LoadedModules.insert(moduleName);
+  std::cout << "[INFO] QJitRunner: Imported " << classes.size()
+            << " classes from module '" << moduleName << "'" << std::endl;
+  return true;
+}
+
+void QJitRunner::RegisterModuleClasses(
+    const std::vector<ModuleClassInfo> &classes) {
   for (const auto &classInfo : classes) {
     // Create the compiled class entry
     CompiledClass cc;
@@ -4156,6 +5722,9 @@ bool QJitRunner::ImportModule(const std::string &moduleName) {
     cc.memberTypeTokens = classInfo.memberTypeTokens;
     cc.memberTypeNames = classInfo.memberTypeNames;
     cc.isStatic = classInfo.isStatic;
+    cc.isValue = classInfo.isValue;
+    cc.access = classInfo.access;
+    cc.parentClassName = classInfo.parentClassName;
 
     // Get member types from the struct
     for (unsigned i = 0; i < cc.structType->getNumElements(); ++i) {
@@ -4178,11 +5747,34 @@ bool QJitRunner::ImportModule(const std::string &moduleName) {
               << " members and " << cc.methods.size() << " methods"
               << std::endl;
   }
+}
 
-  m_LoadedModules.insert(moduleName);
-  std::cout << "[INFO] QJitRunner: Imported " << classes.size()
-            << " classes from module '" << moduleName << "'" << std::endl;
-  return true;
+std::vector<ModuleClassInfo> QJitRunner::DescribeClasses(
+    const std::vector<std::string> &classNames) const {
+  std::vector<ModuleClassInfo> classInfos;
+  for (const auto &className : classNames) {
+    auto classIt = m_CompiledClasses.find(className);
+    if (classIt == m_CompiledClasses.end())
+      continue;
+
+    ModuleClassInfo info;
+    info.className = className;
+    info.memberNames = classIt->second.memberNames;
+    info.memberTypeTokens = classIt->second.memberTypeTokens;
+    info.memberTypeNames = classIt->second.memberTypeNames;
+    info.isStatic = classIt->second.isStatic;
+    info.isValue = classIt->second.isValue;
+    info.access = classIt->second.access;
+    info.parentClassName = classIt->second.parentClassName;
+
+    for (const auto &mp : classIt->second.methods) {
+      info.methodNames.push_back(mp.first);
+    }
+    info.methodReturnTypes = classIt->second.methodReturnTypes;
+
+    classInfos.push_back(info);
+  }
+  return classInfos;
 }
 
 bool QJitRunner::CompileModule(const std::string &moduleName,
@@ -4214,6 +5806,14 @@ bool QJitRunner::CompileModule(const std::string &moduleName,
     return false;
   }
 
+  return CompileModuleProgram(moduleName, moduleProgram, sourcePath,
+                              binaryPath);
+}
+
+bool QJitRunner::CompileModuleProgram(const std::string &moduleName,
+                                      std::shared_ptr<QProgram> moduleProgram,
+                                      const std::string &sourcePath,
+                                      const std::string &binaryPath) {
   std::cout << "[INFO] QJitRunner: Compiling module '" << moduleName
             << "' to file " << binaryPath << std::endl;
 
@@ -4254,6 +5854,14 @@ bool QJitRunner::CompileModule(const std::string &moduleName,
       std::cerr << "[ERROR] QJitRunner: Failed to import module '" << importName
                 << "' for module '" << moduleName << "'. Aborting."
                 << std::endl;
+
+      // Put the main module and registries back before bailing out
+      QLVM::SetModule(std::move(oldModule));
+      if (oldBB)
+        builder.SetInsertPoint(oldBB, oldIP);
+      m_LVMContext->ResetCache();
+      m_LoadedModules = oldLoadedModules;
+      m_CompiledClasses = savedCompiledClasses;
       return false;
     }
   }
@@ -4265,32 +5873,17 @@ bool QJitRunner::CompileModule(const std::string &moduleName,
 
   // Gather class metadata for serialization - ONLY for classes defined in this
   // module
-  std::vector<ModuleClassInfo> classInfos;
+  std::vector<std::string> classNames;
   for (const auto &classNode : moduleProgram->GetClasses()) {
-    std::string className = classNode->GetName();
-    auto classIt = m_CompiledClasses.find(className);
-    if (classIt == m_CompiledClasses.end())
-      continue;
-
-    ModuleClassInfo info;
-    info.className = className;
-    info.memberNames = classIt->second.memberNames;
-    info.memberTypeTokens = classIt->second.memberTypeTokens;
-    info.memberTypeNames = classIt->second.memberTypeNames;
-    info.isStatic = classIt->second.isStatic;
-
-    for (const auto &mp : classIt->second.methods) {
-      info.methodNames.push_back(mp.first);
-    }
-    info.methodReturnTypes = classIt->second.methodReturnTypes;
-
-    classInfos.push_back(info);
+    classNames.push_back(classNode->GetName());
   }
+  std::vector<ModuleClassInfo> classInfos = DescribeClasses(classNames);
 
   // Save to binary file
   QModuleFile moduleFile;
-  bool success = moduleFile.SaveModule(moduleName, binaryPath,
-                                       QLVM::GetModule(), classInfos);
+  bool success =
+      moduleFile.SaveModule(moduleName, binaryPath, QLVM::GetModule(),
+                            classInfos, QModuleFile::HashSource(sourcePath));
 
   // Restore LLVM module and builder state
   QLVM::SetModule(std::move(oldModule));
@@ -4427,6 +6020,9 @@ void QJitRunner::GenerateMethodWrapper(const std::string &className,
     } else if (paramType->isPointerTy()) {
       // For pointers (including strings), use directly
       callArgs.push_back(argSlot);
+    } else if (GetVectorWidth(paramType)) {
+      // For vectors: the void* slot points at the glm value
+      callArgs.push_back(builder.CreateLoad(paramType, argSlot));
     } else {
       // Default: use as pointer
       callArgs.push_back(argSlot);
@@ -4461,7 +6057,7 @@ std::shared_ptr<QJitProgram> QJitRunner::RunScript(const std::string &path) {
   }
 
   // Parse
-  Parser parser(tokenizer.GetTokens(), m_ErrorCollector);
+  Parser parser(tokenizer.TakeTokens(), m_ErrorCollector);
   auto program = parser.Parse();
 
   if (m_ErrorCollector->HasErrors()) {
@@ -4521,7 +6117,44 @@ std::shared_ptr<QJitProgram> QJitRunner::GetMasterProgram() {
 
   // Create the master program with a CLONE of the accumulated module
   // This keeps the original module in QLVM for future script accumulation
-  m_MasterProgram = std::make_shared<QJitProgram>(llvm::CloneModule(*module));
+  // With hot patching, calls to script methods go through slots so
+  // PatchScript can replace them. Value class methods are left out: they
+  // are meant to be inlined.
+  std::vector<std::string> patchable;
+  if (m_HotPatching) {
+    for (const auto &pair : m_CompiledClasses) {
+      if (pair.second.isValue)
+        continue;
+      std::string prefix = pair.first + "_";
+      for (const auto &method : pair.second.methods) {
+        std::string funcName = method.second->getName().str();
+        if (funcName.compare(0, prefix.size(), prefix) == 0 &&
+            !method.second->isDeclaration()) {
+          patchable.push_back(funcName);
+        }
+      }
+    }
+  }
+  // Each script is a module of its own in the program, so a patch relinks
+  // only that module. Symbols go with the class their name starts with
+  // ('Class_Method', 'Class_Method__wrap'), the longest one if several do.
+  std::unordered_map<std::string, std::string> modules;
+  for (const auto &value : module->global_values()) {
+    if (value.isDeclaration() || value.hasLocalLinkage())
+      continue;
+    std::string name = value.getName().str();
+    for (size_t end = name.rfind('_'); end != std::string::npos && end > 0;
+         end = name.rfind('_', end - 1)) {
+      auto source = m_ClassSources.find(name.substr(0, end));
+      if (source != m_ClassSources.end()) {
+        modules[name] = source->second;
+        break;
+      }
+    }
+  }
+  m_MasterProgram = std::make_shared<QJitProgram>(
+      llvm::CloneModule(*module), QJitProgram::GetDefaultOptLevel(),
+      patchable, modules);
 
   // Register all compiled classes with the master program
   for (const auto &pair : m_CompiledClasses) {
@@ -4562,3 +6195,587 @@ std::shared_ptr<QJitProgram> QJitRunner::GetMasterProgram() {
 
   return m_MasterProgram;
 }
+
+// ============================================================================
+// Incremental Recompilation
+// ============================================================================
+
+void QJitRunner::RecordScriptState(const std::string &path,
+                                   const std::shared_ptr<QProgram> &program) {
+  // Generic templates compile on use, their bodies cannot be patched alone
+  for (const auto &cls : program->GetClasses()) {
+    if (cls->IsGeneric()) {
+      m_ScriptStates.erase(ScriptKey(path));
+      return;
+    }
+  }
+
+  ScriptState state;
+  state.shapeHash = program->GetShapeHash();
+  for (const auto &cls : program->GetClasses()) {
+    for (const auto &method : cls->GetMethods()) {
+      std::string fullName =
+          cls->GetName() + "_" + MangleMethodName(method->GetName(), method);
+      state.bodyHashes[fullName] = method->GetBodyHash();
+    }
+  }
+  m_ScriptStates[ScriptKey(path)] = std::move(state);
+}
+
+void QJitRunner::CollectLayoutDependents(const std::string &className,
+                                         llvm::StructType *oldType) {
+  // Subclasses embed the layout; other classes address its members, allocate
+  // it with a size fixed at compile time or call its methods
+  std::string prefix = className + "_";
+  for (const auto &pair : m_CompiledClasses) {
+    if (pair.first == className)
+      continue;
+    const CompiledClass &info = pair.second;
+    bool dependent = info.parentClassName == className;
+    for (const auto &method : info.methods) {
+      if (dependent)
+        break;
+      for (const auto &inst : llvm::instructions(*method.second)) {
+        if (auto *gep = llvm::dyn_cast<llvm::GetElementPtrInst>(&inst)) {
+          dependent = gep->getSourceElementType() == oldType;
+        } else if (auto *alloca = llvm::dyn_cast<llvm::AllocaInst>(&inst)) {
+          dependent = alloca->getAllocatedType() == oldType;
+        } else if (auto *call = llvm::dyn_cast<llvm::CallBase>(&inst)) {
+          auto *callee = call->getCalledFunction();
+          std::string calleeName = callee ? callee->getName().str() : "";
+          dependent = calleeName.compare(0, prefix.size(), prefix) == 0;
+        }
+        if (dependent)
+          break;
+      }
+    }
+    if (!dependent)
+      continue;
+    auto source = m_ClassSources.find(pair.first);
+    if (source != m_ClassSources.end())
+      m_LayoutDependents.insert(source->second);
+  }
+}
+
+std::set<std::string> QJitRunner::TakeChangedLayouts() {
+  std::set<std::string> changed;
+  changed.swap(m_ChangedLayouts);
+  return changed;
+}
+
+QJitRunner::PatchResult QJitRunner::PatchScript(const std::string &path) {
+  auto stateIt = m_ScriptStates.find(ScriptKey(path));
+  if (!m_HotPatching || stateIt == m_ScriptStates.end() || !m_MasterProgram ||
+      m_MasterModuleNeedsRecompile) {
+    return PatchResult::NeedsRebuild;
+  }
+  auto start = std::chrono::steady_clock::now();
+
+  // Tokenize, parse and validate as BuildModule does, but stop at errors:
+  // the running program keeps its old code
+  m_ErrorCollector->ClearErrors();
+  Tokenizer tokenizer(path, m_ErrorCollector);
+  tokenizer.Tokenize();
+  std::shared_ptr<QProgram> program;
+  if (!m_ErrorCollector->HasErrors()) {
+    Parser parser(tokenizer.TakeTokens(), m_ErrorCollector);
+    program = parser.Parse();
+  }
+  if (program && !m_ErrorCollector->HasErrors()) {
+    QValidator validator(m_ErrorCollector);
+    for (const auto &pair : m_CompiledClasses) {
+      validator.RegisterKnownClass(pair.first);
+    }
+    validator.Validate(program);
+  }
+  if (!program || m_ErrorCollector->HasErrors()) {
+    QConsole::PrintError("QJitRunner: Errors in " + path + ", not patched");
+    m_ErrorCollector->ListErrors();
+    return PatchResult::Failed;
+  }
+
+  // Anything outside method bodies changed the shape
+  ScriptState &state = stateIt->second;
+  if (program->GetShapeHash() != state.shapeHash)
+    return PatchResult::NeedsRebuild;
+
+  std::vector<std::pair<std::string, std::shared_ptr<QMethod>>> changed;
+  std::vector<std::string> names;
+  for (const auto &cls : program->GetClasses()) {
+    if (cls->IsGeneric() || !m_CompiledClasses.count(cls->GetName()))
+      return PatchResult::NeedsRebuild;
+    for (const auto &method : cls->GetMethods()) {
+      std::string fullName =
+          cls->GetName() + "_" + MangleMethodName(method->GetName(), method);
+      auto hashIt = state.bodyHashes.find(fullName);
+      if (hashIt == state.bodyHashes.end())
+        return PatchResult::NeedsRebuild;
+      if (hashIt->second == method->GetBodyHash())
+        continue;
+      if (!m_MasterProgram->IsPatchable(fullName))
+        return PatchResult::NeedsRebuild; // e.g. inlined value class methods
+      changed.push_back({cls->GetName(), method});
+      names.push_back(fullName);
+    }
+  }
+  if (changed.empty())
+    return PatchResult::Unchanged;
+
+  // Recompile the changed bodies in the accumulated module, which stays the
+  // source of truth for the next full rebuild
+  auto *module = QLVM::GetModule();
+  m_CurrentScriptPath = path;
+  for (size_t i = 0; i < changed.size(); ++i) {
+    if (llvm::Function *func = module->getFunction(names[i])) {
+      func->deleteBody();
+    }
+    CompileMethod(changed[i].first, changed[i].second);
+  }
+  m_CurrentScriptPath.clear();
+
+  bool broken = m_ErrorCollector->HasErrors();
+  for (const auto &name : names) {
+    llvm::Function *func = module->getFunction(name);
+    broken = broken || !func || llvm::verifyFunction(*func, &llvm::errs());
+  }
+  if (broken) {
+    QConsole::PrintError("QJitRunner: Compilation errors in " + path);
+    m_ErrorCollector->ListErrors();
+    m_MasterModuleNeedsRecompile = true;
+    return PatchResult::Failed;
+  }
+
+  // The patch defines the new bodies plus what the program cannot share
+  // with it: module-private values and always-inline helpers (as
+  // available_externally, the program already defines them). The rest are
+  // declarations resolved against the running program.
+  std::set<std::string> changedNames(names.begin(), names.end());
+  llvm::ValueToValueMapTy vmap;
+  auto patch =
+      llvm::CloneModule(*module, vmap, [&](const llvm::GlobalValue *value) {
+        if (value->hasLocalLinkage() ||
+            changedNames.count(value->getName().str()))
+          return true;
+        auto *func = llvm::dyn_cast<llvm::Function>(value);
+        return func && func->hasFnAttribute(llvm::Attribute::AlwaysInline);
+      });
+  for (auto &func : *patch) {
+    if (!func.isDeclaration() && !func.hasLocalLinkage() &&
+        !changedNames.count(func.getName().str())) {
+      func.setLinkage(llvm::GlobalValue::AvailableExternallyLinkage);
+    }
+  }
+
+  if (!m_MasterProgram->ReplaceFunctions(std::move(patch), names)) {
+    m_MasterModuleNeedsRecompile = true;
+    return PatchResult::NeedsRebuild;
+  }
+
+  for (size_t i = 0; i < changed.size(); ++i) {
+    state.bodyHashes[names[i]] = changed[i].second->GetBodyHash();
+  }
+  double ms = std::chrono::duration<double, std::milli>(
+                  std::chrono::steady_clock::now() - start)
+                  .count();
+  char timing[32];
+  std::snprintf(timing, sizeof(timing), "%.1f", ms);
+  std::string file = std::filesystem::path(path).filename().string();
+  QConsole::Print("Patched: " + file + " (" + std::to_string(names.size()) +
+                  " methods, " + timing + " ms)");
+  return PatchResult::Patched;
+}
+
+// ============================================================================
+// Ahead-of-Time Compilation
+// ============================================================================
+
+namespace {
+
+// Private constant C string
+llvm::Constant *AotString(llvm::Module &module, const std::string &text) {
+  llvm::Constant *data =
+      llvm::ConstantDataArray::getString(module.getContext(), text);
+  auto *global = new llvm::GlobalVariable(module, data->getType(), true,
+                                          llvm::GlobalValue::PrivateLinkage,
+                                          data, ".aot.str");
+  global->setUnnamedAddr(llvm::GlobalValue::UnnamedAddr::Global);
+  return global;
+}
+
+// Private constant array of 'items', or null if there are none
+llvm::Constant *AotTable(llvm::Module &module, llvm::StructType *type,
+                         const std::vector<llvm::Constant *> &items,
+                         const std::string &name) {
+  if (items.empty()) {
+    return llvm::ConstantPointerNull::get(
+        llvm::PointerType::getUnqual(module.getContext()));
+  }
+  auto *arrayType = llvm::ArrayType::get(type, items.size());
+  return new llvm::GlobalVariable(
+      module, arrayType, true, llvm::GlobalValue::PrivateLinkage,
+      llvm::ConstantArray::get(arrayType, items), name);
+}
+
+// Static class instances live in the library. Code refers to them by the
+// absolute address of the editor's instance, mapped here to the storage.
+llvm::Constant *AotStatic(
+    llvm::Module &module, const CompiledClass &classInfo,
+    const std::string &className,
+    std::unordered_map<llvm::Constant *, llvm::Constant *> &addresses) {
+  llvm::LLVMContext &context = module.getContext();
+  llvm::PointerType *ptrType = llvm::PointerType::getUnqual(context);
+  void *address = QStaticRegistry::Instance().GetInstance(className);
+  if (!classInfo.isStatic || !address)
+    return llvm::ConstantPointerNull::get(ptrType);
+
+  const llvm::DataLayout &dataLayout = module.getDataLayout();
+  auto *storageType = llvm::ArrayType::get(
+      llvm::Type::getInt8Ty(context),
+      dataLayout.getTypeAllocSize(classInfo.structType));
+  auto *storage = new llvm::GlobalVariable(
+      module, storageType, false, llvm::GlobalValue::InternalLinkage,
+      llvm::ConstantAggregateZero::get(storageType),
+      "__qlang_static." + className);
+  storage->setAlignment(llvm::Align(16));
+  addresses[llvm::ConstantExpr::getIntToPtr(
+      llvm::ConstantInt::get(llvm::Type::getInt64Ty(context),
+                             reinterpret_cast<uint64_t>(address)),
+      ptrType)] = storage;
+  return storage;
+}
+
+// Rewrites constants built on the mapped addresses. Constants are shared
+// with the editor's module, so only this module's instructions are changed.
+llvm::Constant *
+AotRemap(llvm::Constant *constant,
+         const std::unordered_map<llvm::Constant *, llvm::Constant *> &map) {
+  auto found = map.find(constant);
+  if (found != map.end())
+    return found->second;
+  auto *expr = llvm::dyn_cast<llvm::ConstantExpr>(constant);
+  if (!expr)
+    return constant;
+  std::vector<llvm::Constant *> operands;
+  bool changed = false;
+  for (llvm::Value *operand : expr->operand_values()) {
+    auto *original = llvm::cast<llvm::Constant>(operand);
+    operands.push_back(AotRemap(original, map));
+    changed |= operands.back() != original;
+  }
+  return changed ? expr->getWithOperands(operands) : constant;
+}
+
+void AotRelocate(
+    llvm::Module &module,
+    const std::unordered_map<llvm::Constant *, llvm::Constant *> &map) {
+  if (map.empty())
+    return;
+  for (llvm::Function &func : module) {
+    for (llvm::Instruction &inst : llvm::instructions(func)) {
+      for (unsigned i = 0; i < inst.getNumOperands(); ++i) {
+        auto *constant = llvm::dyn_cast<llvm::Constant>(inst.getOperand(i));
+        if (!constant || llvm::isa<llvm::GlobalValue>(constant))
+          continue;
+        llvm::Constant *remapped = AotRemap(constant, map);
+        if (remapped != constant)
+          inst.setOperand(i, remapped);
+      }
+    }
+  }
+}
+
+// Every function the library calls but does not define (natives, runtime)
+// becomes an internal thunk calling through a slot that the loader fills
+// with the address the JIT would have bound, so the host executable does
+// not have to export anything. Variadic ones (C runtime) are left to the
+// system linker.
+std::vector<std::pair<std::string, llvm::GlobalVariable *>>
+AotImportThunks(llvm::Module &module) {
+  llvm::LLVMContext &context = module.getContext();
+  llvm::PointerType *ptrType = llvm::PointerType::getUnqual(context);
+
+  std::vector<std::pair<std::string, llvm::GlobalVariable *>> imports;
+  for (llvm::Function &func : module) {
+    if (!func.isDeclaration() || func.isIntrinsic() || func.isVarArg() ||
+        func.use_empty())
+      continue;
+    std::string name = func.getName().str();
+    auto *slot = new llvm::GlobalVariable(
+        module, ptrType, false, llvm::GlobalValue::InternalLinkage,
+        llvm::ConstantPointerNull::get(ptrType), "__qlang_import." + name);
+
+    // The thunk stays out of line and keeps the native's name and
+    // attributes, so passes still recognize runtime calls (QHeapToStack
+    // looks for qlang_alloc) and pure natives are still combined. It reads
+    // its slot: memory(none) becomes read-only.
+    llvm::AttributeList attributes = func.getAttributes();
+#if LLVM_VERSION_MAJOR >= 16
+    func.setMemoryEffects(func.getMemoryEffects() |
+                          llvm::MemoryEffects::readOnly());
+#else
+    if (func.hasFnAttribute(llvm::Attribute::ReadNone)) {
+      func.removeFnAttr(llvm::Attribute::ReadNone);
+      func.addFnAttr(llvm::Attribute::ReadOnly);
+    }
+#endif
+    func.removeFnAttr(llvm::Attribute::AlwaysInline);
+    func.addFnAttr(llvm::Attribute::NoInline);
+
+    llvm::IRBuilder<> builder(
+        llvm::BasicBlock::Create(context, "entry", &func));
+    llvm::LoadInst *target =
+        builder.CreateLoad(ptrType, slot, name + ".target");
+    target->setMetadata(llvm::LLVMContext::MD_invariant_load,
+                        llvm::MDNode::get(context, {}));
+    std::vector<llvm::Value *> args;
+    for (llvm::Argument &arg : func.args()) {
+      args.push_back(&arg);
+    }
+    llvm::CallInst *call =
+        builder.CreateCall(func.getFunctionType(), target, args);
+    call->setAttributes(attributes);
+    call->setCallingConv(func.getCallingConv());
+    if (func.getReturnType()->isVoidTy()) {
+      builder.CreateRetVoid();
+    } else {
+      builder.CreateRet(call);
+    }
+    func.setLinkage(llvm::GlobalValue::InternalLinkage);
+    imports.push_back({name, slot});
+  }
+  return imports;
+}
+
+} // namespace
+
+bool QJitRunner::CompileLibrary(const std::vector<std::string> &paths,
+                                const std::string &libraryPath) {
+  auto start = std::chrono::steady_clock::now();
+
+  if (!paths.empty() && !BuildModules(paths)) {
+    std::cerr << "[ERROR] QJitRunner: Library not built, scripts failed to "
+                 "compile"
+              << std::endl;
+    return false;
+  }
+  auto *source = QLVM::GetModule();
+  if (!source) {
+    std::cerr << "[ERROR] QJitRunner: No module available" << std::endl;
+    return false;
+  }
+  std::string errorStr;
+  llvm::raw_string_ostream os(errorStr);
+  if (llvm::verifyModule(*source, &os)) {
+    std::cerr << "[ERROR] QJitRunner: Module verification failed: "
+              << os.str() << std::endl;
+    return false;
+  }
+
+  // The library runs on other machines: baseline CPU of the target, not
+  // the features of this one
+  llvm::orc::JITTargetMachineBuilder targetBuilder(
+      llvm::Triple(source->getTargetTriple()));
+  targetBuilder.setRelocationModel(llvm::Reloc::PIC_);
+#if LLVM_VERSION_MAJOR >= 18
+  targetBuilder.setCodeGenOptLevel(llvm::CodeGenOptLevel::Aggressive);
+#else
+  targetBuilder.setCodeGenOptLevel(llvm::CodeGenOpt::Aggressive);
+#endif
+  auto targetMachine = targetBuilder.createTargetMachine();
+  if (!targetMachine) {
+    std::cerr << "[ERROR] QJitRunner: No target machine: "
+              << llvm::toString(targetMachine.takeError()) << std::endl;
+    return false;
+  }
+  llvm::TargetMachine &target = **targetMachine;
+  bool windows = target.getTargetTriple().isOSWindows();
+
+  auto module = llvm::CloneModule(*source);
+  llvm::LLVMContext &context = module->getContext();
+  const llvm::DataLayout &dataLayout = module->getDataLayout();
+  llvm::Type *ptrType = llvm::PointerType::getUnqual(context);
+  llvm::Type *i32Type = llvm::Type::getInt32Ty(context);
+  llvm::Type *i64Type = llvm::Type::getInt64Ty(context);
+
+  // Class metadata, as GetMasterProgram registers it (see QAotLibrary.h)
+  auto *memberType = llvm::StructType::get(
+      context, {ptrType, i64Type, i64Type, i32Type, ptrType});
+  auto *classType = llvm::StructType::get(
+      context,
+      {ptrType, i64Type, ptrType, i32Type, i32Type, ptrType, ptrType});
+  std::vector<llvm::Constant *> classes;
+  std::unordered_map<llvm::Constant *, llvm::Constant *> staticAddresses;
+  for (const auto &pair : m_CompiledClasses) {
+    const std::string &clsName = pair.first;
+    const CompiledClass &classInfo = pair.second;
+    const llvm::StructLayout *layout =
+        dataLayout.getStructLayout(classInfo.structType);
+
+    std::vector<llvm::Constant *> members;
+    for (size_t i = 0; i < classInfo.memberNames.size(); i++) {
+      std::string typeName = i < classInfo.memberTypeNames.size()
+                                 ? classInfo.memberTypeNames[i]
+                                 : "";
+      members.push_back(llvm::ConstantStruct::get(
+          memberType,
+          {AotString(*module, classInfo.memberNames[i]),
+           llvm::ConstantInt::get(i64Type, layout->getElementOffset(i)),
+           llvm::ConstantInt::get(
+               i64Type, dataLayout.getTypeAllocSize(classInfo.memberTypes[i])),
+           llvm::ConstantInt::get(i32Type, classInfo.memberTypeTokens[i]),
+           AotString(*module, typeName)}));
+    }
+    classes.push_back(llvm::ConstantStruct::get(
+        classType,
+        {AotString(*module, clsName),
+         llvm::ConstantInt::get(
+             i64Type, dataLayout.getTypeAllocSize(classInfo.structType)),
+         AotString(*module, clsName + "_" + clsName),
+         llvm::ConstantInt::get(i32Type, classInfo.isStatic ? 1 : 0),
+         llvm::ConstantInt::get(i32Type, members.size()),
+         AotTable(*module, memberType, members,
+                  "__qlang_aot_members." + clsName),
+         AotStatic(*module, classInfo, clsName, staticAddresses)}));
+  }
+  AotRelocate(*module, staticAddresses);
+
+  // Scripts refer to class functions by name from outside (instances,
+  // CallMethod, handles): those and the global entry stay exported
+  auto isEntryPoint = [&](const llvm::GlobalValue &value) {
+    std::string name = value.getName().str();
+    if (name == "__qlang_global_entry")
+      return true;
+    for (const auto &pair : m_CompiledClasses) {
+      std::string prefix = pair.first + "_";
+      if (name.compare(0, prefix.size(), prefix) == 0)
+        return true;
+    }
+    return false;
+  };
+  std::vector<llvm::GlobalValue *> exported;
+  for (llvm::Function &func : *module) {
+    if (func.isDeclaration())
+      continue;
+    if (isEntryPoint(func)) {
+      exported.push_back(&func);
+    } else {
+      func.setLinkage(llvm::GlobalValue::InternalLinkage);
+    }
+  }
+  for (llvm::GlobalAlias &alias : module->aliases()) {
+    if (isEntryPoint(alias)) {
+      exported.push_back(&alias);
+    } else {
+      alias.setLinkage(llvm::GlobalValue::InternalLinkage);
+    }
+  }
+  for (llvm::GlobalVariable &global : module->globals()) {
+    if (global.hasAppendingLinkage())
+      continue; // llvm.used and the like
+    if (global.isDeclaration()) {
+      // Profiler counters of an instrumented build: the library keeps its
+      // own
+      std::cerr << "[WARNING] QJitRunner: '" << global.getName().str()
+                << "' is private to the native library" << std::endl;
+      global.setInitializer(
+          llvm::Constant::getNullValue(global.getValueType()));
+    }
+    global.setLinkage(llvm::GlobalValue::InternalLinkage);
+  }
+
+  auto imports = AotImportThunks(*module);
+  auto *importType = llvm::StructType::get(context, {ptrType, ptrType});
+  std::vector<llvm::Constant *> importEntries;
+  for (const auto &[name, slot] : imports) {
+    importEntries.push_back(llvm::ConstantStruct::get(
+        importType, {AotString(*module, name), slot}));
+  }
+
+  auto *manifestType = llvm::StructType::get(
+      context, {i32Type, i32Type, ptrType, i32Type, ptrType});
+  auto *manifest = new llvm::GlobalVariable(
+      *module, manifestType, true, llvm::GlobalValue::ExternalLinkage,
+      llvm::ConstantStruct::get(
+          manifestType,
+          {llvm::ConstantInt::get(i32Type, QAotVersion),
+           llvm::ConstantInt::get(i32Type, classes.size()),
+           AotTable(*module, classType, classes, "__qlang_aot_classes"),
+           llvm::ConstantInt::get(i32Type, importEntries.size()),
+           AotTable(*module, importType, importEntries,
+                    "__qlang_aot_imports")}),
+      QAotManifestSymbol);
+  exported.push_back(manifest);
+  if (windows) {
+    for (llvm::GlobalValue *value : exported) {
+      value->setDLLStorageClass(llvm::GlobalValue::DLLExportStorageClass);
+    }
+  }
+
+  errorStr.clear();
+  if (llvm::verifyModule(*module, &os)) {
+    std::cerr << "[ERROR] QJitRunner: Library module verification failed: "
+              << os.str() << std::endl;
+    return false;
+  }
+
+  // One module holding every script with only the entry points external:
+  // the LTO pipeline inlines and drops code across modules
+  QJitProgram::OptimizeModule(*module, &target, QJitOptLevel::O3, true);
+
+  llvm::SmallVector<char, 0> object;
+  llvm::raw_svector_ostream objectStream(object);
+  llvm::legacy::PassManager codegen;
+#if LLVM_VERSION_MAJOR >= 18
+  auto fileType = llvm::CodeGenFileType::ObjectFile;
+#else
+  auto fileType = llvm::CGFT_ObjectFile;
+#endif
+  if (target.addPassesToEmitFile(codegen, objectStream, nullptr, fileType)) {
+    std::cerr << "[ERROR] QJitRunner: Target cannot emit object files"
+              << std::endl;
+    return false;
+  }
+  codegen.run(*module);
+
+  std::string objectPath = libraryPath + (windows ? ".obj" : ".o");
+  {
+    std::ofstream file(objectPath, std::ios::binary);
+    file.write(object.data(), object.size());
+    if (!file) {
+      std::cerr << "[ERROR] QJitRunner: Cannot write " << objectPath
+                << std::endl;
+      return false;
+    }
+  }
+
+  std::string command = m_LibraryLinker;
+  if (command.empty()) {
+    command = windows
+                  ? "lld-link /dll /noentry /defaultlib:msvcrt /out:{out} {in}"
+                  : "cc -shared -o {out} {in}";
+  }
+  auto substitute = [&command](const std::string &key,
+                               const std::string &path) {
+    size_t pos = command.find(key);
+    if (pos != std::string::npos)
+      command.replace(pos, key.size(), "\"" + path + "\"");
+  };
+  substitute("{in}", objectPath);
+  substitute("{out}", libraryPath);
+  int status = std::system(command.c_str());
+  std::error_code ec;
+  std::filesystem::remove(objectPath, ec);
+  if (status != 0) {
+    std::cerr << "[ERROR] QJitRunner: Linking the library failed: "
+              << command << std::endl;
+    return false;
+  }
+
+  double ms = std::chrono::duration<double, std::milli>(
+                  std::chrono::steady_clock::now() - start)
+                  .count();
+  std::cout << "[INFO] QJitRunner: Built native library '" << libraryPath
+            << "' (" << classes.size() << " classes, " << imports.size()
+            << " natives, " << ms << " ms)" << std::endl;
+  return true;
+}
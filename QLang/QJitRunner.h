@@ -1,12 +1,16 @@
 #pragma once
 
+#include <cstdint>
 #include <memory>
+#include <set>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
+#include "QClassAccess.h"
 #include "QJClassInstance.h"
+#include "QLocalConstants.h"
 
 // Forward declarations
 class QProgram;
@@ -23,10 +27,13 @@ class QMemberAssign;
 class QAssign;
 class QMethod;
 class QReturn;
+class QYield;
 class QMethodCall;
+class QParameters;
 class QLVMContext;
 class QErrorCollector;
 class QJitProgram;
+struct ModuleClassInfo;
 class QEnum;
 struct Token;
 
@@ -38,6 +45,7 @@ class AllocaInst;
 class Function;
 class LLVMContext;
 class Module;
+class BasicBlock;
 } // namespace llvm
 
 // Compiled class information for JIT
@@ -51,7 +59,9 @@ struct CompiledClass {
   std::unordered_map<std::string, std::string>
       methodReturnTypes;       // For chained ops
   bool isStatic = false;       // True if this is a static class (singleton)
+  bool isValue = false;        // Declared with 'struct' (methods inlined)
   std::string parentClassName; // Parent class for inheritance
+  QClassAccess access;         // What its methods touch, see IsParallelSafe
 };
 
 class QJitRunner {
@@ -71,18 +81,83 @@ public:
   std::shared_ptr<QJitProgram> RunScript(const std::string &path);
   bool BuildModule(const std::string &path);
 
+  // Build several modules at once. The import graph is resolved up front;
+  // each wave of independent modules is parsed, validated and compiled to
+  // .qm on worker threads (one LLVMContext per thread), then everything is
+  // linked into the current module in dependency order. Modules that cannot
+  // go through a .qm fall back to BuildModule. threads = 0 uses all cores.
+  bool BuildModules(const std::vector<std::string> &paths,
+                    unsigned threads = 0);
+
   // Master module architecture - shared script compilation
   std::string CompileScriptIntoMaster(const std::string &path);
+
+  // Same for several scripts at once, returning the class name of each (""
+  // on failure). Scripts depend on the scripts declaring classes they name;
+  // each wave of independent scripts is parsed, validated and compiled on
+  // worker threads against a read-only snapshot of the master, then linked
+  // into it here in dependency order. Scripts the workers cannot take (top
+  // level code, enums, generics, classes compiled before, cycles) go through
+  // CompileScriptIntoMaster. threads = 0 uses all cores.
+  std::vector<std::string>
+  CompileScriptsIntoMaster(const std::vector<std::string> &paths,
+                           unsigned threads = 0);
   std::shared_ptr<QJitProgram> GetMasterProgram();
 
+  // Edit-and-continue. With hot patching on (before the first
+  // GetMasterProgram), script methods are called through pointer slots so
+  // PatchScript can swap in new bodies for methods whose code changed
+  // without rebuilding the master program. Anything beyond method bodies
+  // (members, signatures, new methods or classes) needs a rebuild.
+  enum class PatchResult { Unchanged, Patched, NeedsRebuild, Failed };
+  void SetHotPatching(bool enabled) { m_HotPatching = enabled; }
+  bool IsHotPatching() const { return m_HotPatching; }
+  PatchResult PatchScript(const std::string &path);
+
+  // Classes whose member layout changed since the last call. Their live
+  // instances still have the old layout and must be migrated by the host.
+  std::set<std::string> TakeChangedLayouts();
+
+  // Ahead-of-time build for shipping. Builds 'paths' (as BuildModules) on
+  // top of everything compiled so far, optimizes the whole program at O3
+  // with LTO across modules and links it into one native shared library
+  // (.so, .dll on Windows) that QJitProgram::LoadNativeLibrary loads
+  // without compiling anything.
+  bool CompileLibrary(const std::vector<std::string> &paths,
+                      const std::string &libraryPath);
+
+  // Command linking the object file of CompileLibrary; {in} and {out} are
+  // replaced by the quoted object and library paths. Defaults to
+  // 'cc -shared' ('lld-link /dll' on Windows).
+  void SetLibraryLinker(const std::string &command) {
+    m_LibraryLinker = command;
+  }
+
   // Module system
   bool ImportModule(const std::string &moduleName);
 
+  // True if OnUpdate of different instances of the class may run
+  // concurrently: it only writes its own members, its locals and objects its
+  // methods allocate themselves (struct locals are not copies), and everything
+  // it calls (natives, other classes, the parent class) is safe as well.
+  // Inferred from the compiled code, see QClassAccess.
+  bool IsParallelSafe(const std::string &className) const;
+
+  // Link a compiled .qm into the current module and register its classes
+  bool LoadModuleBinary(const std::string &moduleName,
+                        const std::string &binaryPath);
+
 public:
   bool CompileModule(const std::string &moduleName,
                      const std::string &sourcePath,
                      const std::string &binaryPath);
 
+  // Same, for a module that has already been parsed
+  bool CompileModuleProgram(const std::string &moduleName,
+                            std::shared_ptr<QProgram> moduleProgram,
+                            const std::string &sourcePath,
+                            const std::string &binaryPath);
+
 private:
   std::shared_ptr<QLVMContext> m_LVMContext;
   std::shared_ptr<QErrorCollector> m_ErrorCollector;
@@ -92,6 +167,7 @@ private:
 
   // Variable storage for current scope
   std::unordered_map<std::string, llvm::AllocaInst *> m_LocalVariables;
+  QLocalConstants m_LocalConstants; // Of the body being compiled
 
   // Track variable types for class instances
   std::unordered_map<std::string, std::string>
@@ -118,6 +194,16 @@ private:
   // Method context - for implicit member access (this pointer)
   llvm::Value *m_CurrentInstance = nullptr;
   std::string m_CurrentClassName;
+  bool m_InConstructor = false; // Member writes there do not count as writes
+
+  // Method being compiled as a coroutine (it uses yield/wait/waitUntil);
+  // handle is null otherwise
+  struct CoroutineState {
+    llvm::Value *handle = nullptr;       // Frame, from llvm.coro.begin
+    llvm::BasicBlock *cleanup = nullptr; // Body finished or destroyed
+    llvm::BasicBlock *suspend = nullptr; // Return to the caller/scheduler
+  };
+  CoroutineState m_Coroutine;
 
   // Generic class templates (not yet compiled, waiting for specialization)
   std::unordered_map<std::string, std::shared_ptr<QClass>>
@@ -138,6 +224,34 @@ private:
   std::shared_ptr<QJitProgram> m_MasterProgram;
   bool m_MasterModuleNeedsRecompile = false;
 
+  // Incremental recompilation: token hashes of each script's last build
+  // (keyed by canonical path), and where each class came from
+  struct ScriptState {
+    uint64_t shapeHash = 0;
+    std::unordered_map<std::string, uint64_t> bodyHashes; // By function
+  };
+  std::unordered_map<std::string, ScriptState> m_ScriptStates;
+  std::unordered_map<std::string, std::string> m_ClassSources;
+  std::set<std::string> m_ChangedLayouts;
+  std::set<std::string> m_LayoutDependents; // Scripts to rebuild
+  bool m_HotPatching = false;
+  std::string m_LibraryLinker; // Empty: platform default
+  void RecordScriptState(const std::string &path,
+                         const std::shared_ptr<QProgram> &program);
+  void CollectLayoutDependents(const std::string &className,
+                               llvm::StructType *oldType);
+  // Recompile scripts waiting on the class of 'path' or on a layout it
+  // changed
+  void RebuildDependents(const std::string &path);
+
+  // Class metadata as stored in a .qm, and back
+  std::vector<ModuleClassInfo>
+  DescribeClasses(const std::vector<std::string> &classNames) const;
+  void RegisterModuleClasses(const std::vector<ModuleClassInfo> &classes);
+  // Link bitcode made on another thread (see CompileScriptsIntoMaster)
+  bool LinkBitcode(const std::string &bitcode,
+                   const std::vector<ModuleClassInfo> &classes);
+
   // Reusable compilation methods
   void CompileCodeBlock(std::shared_ptr<QCode> code);
   void CompileNode(std::shared_ptr<QNode> node);
@@ -145,6 +259,7 @@ private:
   void CompileVariableDecl(std::shared_ptr<QVariableDecl> varDecl);
   void CompileForLoop(std::shared_ptr<QFor> forNode);
   void CompileIf(std::shared_ptr<QIf> ifNode);
+  void DeclareSkippedLocals(std::shared_ptr<QCode> code);
 
   // Class compilation
   void CompileClass(std::shared_ptr<QClass> classNode);
@@ -160,8 +275,31 @@ private:
   void CompileAssign(std::shared_ptr<QAssign> assign);
   void CompileReturn(std::shared_ptr<QReturn> returnNode);
 
+  // Coroutines: a method whose body contains a QYield is lowered through the
+  // LLVM coroutine intrinsics (switch-resumed) and driven by
+  // QCoroutineScheduler
+  static bool ContainsYield(const std::shared_ptr<QCode> &code);
+  void BeginCoroutine(llvm::Function *func);
+  void EndCoroutine(llvm::Function *func);
+  void CompileYield(std::shared_ptr<QYield> yieldNode);
+  void EmitSuspend();
+
+  // Entry/exit timing into the method's QProfiler counters
+  void InstrumentMethod(llvm::Function *func, const std::string &className,
+                        const std::string &methodName);
+
   llvm::Value *CompileMethodCall(std::shared_ptr<QMethodCall> methodCall);
 
+  // Calls to natives registered in QLVMContext from within expressions
+  llvm::Value *CompileNativeCall(llvm::Function *native,
+                                 std::shared_ptr<QParameters> arguments);
+  llvm::Value *EmitNativeCall(llvm::Function *native,
+                              std::vector<llvm::Value *> args);
+
+  // Convert an argument to a parameter type (int/float widening, narrowing
+  // and int <-> float)
+  llvm::Value *CoerceArgument(llvm::Value *argVal, llvm::Type *paramType);
+
   // Expression evaluation - main entry point
   llvm::Value *CompileExpression(std::shared_ptr<QExpression> expr,
                                  llvm::Type *expectedType = nullptr,
@@ -181,6 +319,31 @@ private:
   llvm::Value *ApplyBinaryOp(const std::string &op, llvm::Value *left,
                              llvm::Value *right);
 
+  // Built-in vector types (vec2/vec3/vec4/mat4). Values are [N x float]
+  // with glm's layout; arithmetic runs on <N x float> vectors.
+  static unsigned GetVectorWidth(llvm::Type *type); // 0 if not a vector type
+  static int GetVectorComponent(const std::string &name); // x/y/z/w, or -1
+  static bool IsVectorIntrinsic(const std::string &name);
+  llvm::Value *ToSIMD(llvm::Value *value);
+  llvm::Value *FromSIMD(llvm::Value *simd);
+  llvm::Value *ToFloatScalar(llvm::Value *value);
+  llvm::Value *MultiplyMatrix(llvm::Value *lhs, llvm::Value *rhs);
+  llvm::Value *ApplyVectorOp(const std::string &op, llvm::Value *left,
+                             llvm::Value *right);
+  llvm::Value *CompileVectorConstructor(int tokenType,
+                                        const std::vector<Token> &tokens,
+                                        size_t &pos);
+  llvm::Value *CompileVectorIntrinsic(const std::string &name,
+                                      const std::vector<llvm::Value *> &args);
+  // Address and type of a vector local or member of 'this'
+  bool FindVectorStorage(const std::string &name, llvm::Value *&ptr,
+                         llvm::Type *&type);
+
+  // Access record of the class being compiled, nullptr outside a class
+  QClassAccess *CurrentAccess();
+  bool IsParallelSafe(const std::string &className,
+                      std::unordered_set<std::string> &visiting) const;
+
   // Precedence helper
   int GetOperatorPrecedence(const std::string &op);
 
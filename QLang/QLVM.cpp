@@ -12,6 +12,7 @@
 #include <llvm/TargetParser/Host.h> // Newer LLVM location
 
 std::unique_ptr<QLVM::LLVMState> QLVM::s_State = nullptr;
+thread_local QLVM::LLVMState *QLVM::t_State = nullptr;
 bool QLVM::s_Initialized = false;
 std::string QLVM::s_TargetTriple = "";
 std::string QLVM::s_DataLayoutStr = "";
@@ -95,14 +96,16 @@ void QLVM::InitLLVM() {
 #endif
 }
 
-llvm::LLVMContext &QLVM::GetContext() { return s_State->Context; }
+QLVM::LLVMState &QLVM::State() { return t_State ? *t_State : *s_State; }
 
-llvm::IRBuilder<> &QLVM::GetBuilder() { return s_State->Builder; }
+llvm::LLVMContext &QLVM::GetContext() { return State().Context; }
 
-llvm::Module *QLVM::GetModule() { return s_State->Module.get(); }
+llvm::IRBuilder<> &QLVM::GetBuilder() { return State().Builder; }
+
+llvm::Module *QLVM::GetModule() { return State().Module.get(); }
 
 std::unique_ptr<llvm::Module> QLVM::TakeModule() {
-  auto oldModule = std::move(s_State->Module);
+  auto oldModule = std::move(State().Module);
   CreateNewModule();
   return oldModule;
 }
@@ -115,29 +118,32 @@ void QLVM::CreateNewModule() {
     InitLLVM();
   }
 
-  s_State->Module =
-      std::make_unique<llvm::Module>("QLangJIT", s_State->Context);
+  auto &state = State();
+  state.Module = std::make_unique<llvm::Module>("QLangJIT", state.Context);
+  ConfigureModule(*state.Module);
+}
 
+void QLVM::ConfigureModule(llvm::Module &module) {
   // Apply cached target triple and data layout
   if (!s_TargetTriple.empty()) {
-    s_State->Module->setTargetTriple(s_TargetTriple);
+    module.setTargetTriple(s_TargetTriple);
   }
 
   if (!s_DataLayoutStr.empty()) {
-    s_State->Module->setDataLayout(llvm::DataLayout(s_DataLayoutStr));
+    module.setDataLayout(llvm::DataLayout(s_DataLayoutStr));
   } else {
     // Fallback if InitLLVM didn't set it (shouldn't happen)
     std::string err;
     auto triple = llvm::sys::getDefaultTargetTriple();
     if (s_TargetTriple.empty())
-      s_State->Module->setTargetTriple(triple);
+      module.setTargetTriple(triple);
 
     auto target = llvm::TargetRegistry::lookupTarget(triple, err);
     if (target) {
       auto *targetMachine = target->createTargetMachine(
           triple, "generic", "", llvm::TargetOptions(), llvm::Reloc::Static);
       if (targetMachine) {
-        s_State->Module->setDataLayout(targetMachine->createDataLayout());
+        module.setDataLayout(targetMachine->createDataLayout());
         delete targetMachine;
       }
     } else {
@@ -149,5 +155,14 @@ void QLVM::CreateNewModule() {
 }
 
 void QLVM::SetModule(std::unique_ptr<llvm::Module> module) {
-  s_State->Module = std::move(module);
+  State().Module = std::move(module);
 }
+
+QLVM::ThreadState::ThreadState()
+    : m_State(std::make_unique<LLVMState>()), m_Previous(t_State) {
+  // InitLLVM must already have run on the main thread
+  ConfigureModule(*m_State->Module);
+  t_State = m_State.get();
+}
+
+QLVM::ThreadState::~ThreadState() { t_State = m_Previous; }
@@ -25,6 +25,31 @@ private:
     ~LLVMState();
   };
 
+public:
+  // Gives the calling thread its own LLVMContext, IRBuilder and Module for
+  // the lifetime of the scope; GetContext/GetBuilder/GetModule on that thread
+  // return them instead of the shared state. Used to compile modules on
+  // worker threads - anything created inside the scope belongs to its
+  // context, so results must leave as bitcode (see QModuleFile).
+  class ThreadState {
+  public:
+    ThreadState();
+    ~ThreadState();
+
+    ThreadState(const ThreadState &) = delete;
+    ThreadState &operator=(const ThreadState &) = delete;
+
+  private:
+    std::unique_ptr<LLVMState> m_State;
+    LLVMState *m_Previous;
+  };
+
+private:
+  static LLVMState &State();
+  static void ConfigureModule(llvm::Module &module);
+
+  static thread_local LLVMState *t_State;
+
   static std::unique_ptr<LLVMState> s_State;
   static bool s_Initialized;
   static std::string s_TargetTriple;
@@ -1,93 +1,13 @@
 #include "QLVMContext.h"
 #include "QLVM.h"
-#include <cstdarg>
-#include <cstdio>
-#include <cstdlib>
-#include <cstring>
+#include "QNativeSymbols.h"
+#include "QRuntimeBuiltins.h"
 #include <iostream>
 #include <llvm/IR/DerivedTypes.h>
 #include <llvm/IR/Function.h>
+#include <vector>
 #include <llvm/Support/DynamicLibrary.h>
 
-// ============================================================================
-// Built-in Native Functions for QLang
-// ============================================================================
-
-// Native printf for QLang scripts
-extern "C" void LV_printf(const char *fmt, ...) {
-  va_list args;
-  va_start(args, fmt);
-  vprintf(fmt, args);
-  va_end(args);
-  printf("\n");
-}
-
-// String concatenation for QLang
-extern "C" char *LV_str_concat(const char *s1, const char *s2) {
-  if (!s1)
-    s1 = "";
-  if (!s2)
-    s2 = "";
-  char *result = (char *)malloc(strlen(s1) + strlen(s2) + 1);
-  strcpy(result, s1);
-  strcat(result, s2);
-  return result;
-}
-
-// ToString helper functions for runtime conversion
-extern "C" char *LV_int32_to_string(int32_t value) {
-  char *result = (char *)malloc(16);
-  snprintf(result, 16, "%d", value);
-  return result;
-}
-
-extern "C" char *LV_int64_to_string(int64_t value) {
-  char *result = (char *)malloc(24);
-  snprintf(result, 24, "%lld", value);
-  return result;
-}
-
-extern "C" char *LV_float32_to_string(float value) {
-  char *result = (char *)malloc(24);
-  snprintf(result, 24, "%g", value);
-  return result;
-}
-
-extern "C" char *LV_float64_to_string(double value) {
-  char *result = (char *)malloc(32);
-  snprintf(result, 32, "%g", value);
-  return result;
-}
-
-extern "C" char *LV_bool_to_string(int8_t value) {
-  return value ? _strdup("true") : _strdup("false");
-}
-
-// String-to-number conversion functions (for ToInt/ToFloat methods)
-extern "C" int32_t LV_string_to_int32(const char *str) {
-  if (!str)
-    return 0;
-  return (int32_t)atoi(str);
-}
-
-extern "C" int64_t LV_string_to_int64(const char *str) {
-  if (!str)
-    return 0;
-  return (int64_t)atoll(str);
-}
-
-extern "C" float LV_string_to_float32(const char *str) {
-  if (!str)
-    return 0.0f;
-  return (float)atof(str);
-}
-
-extern "C" double LV_string_to_float64(const char *str) {
-  if (!str)
-    return 0.0;
-  return atof(str);
-}
-
 // ============================================================================
 // QLVMContext Implementation
 // ============================================================================
@@ -102,11 +22,42 @@ QLVMContext::~QLVMContext() {}
 void QLVMContext::RegisterBuiltinFunctions() {
   auto &context = QLVM::GetContext();
 
+  // Built-ins touch only QHeap and the coroutine scheduler (which lock), the
+  // profiler clock and stdout, so scripts may call them during the parallel
+  // update phase
+  QNativeOptions builtin;
+  builtin.threadSafe = true;
+
   // qprintf - variadic printf for QLang
   auto *qprintfType =
       llvm::FunctionType::get(llvm::Type::getVoidTy(context),
                               {llvm::PointerType::getUnqual(context)}, true);
-  AddFunc("qprintf", (void *)LV_printf, qprintfType);
+  AddFunc("qprintf", (void *)LV_printf, qprintfType, builtin);
+
+  // qlang_alloc - managed heap allocation used for every 'new'
+  auto *allocType =
+      llvm::FunctionType::get(llvm::PointerType::getUnqual(context),
+                              {llvm::Type::getInt64Ty(context)}, false);
+  AddFunc("qlang_alloc", (void *)LV_alloc, allocType, builtin);
+
+  // Coroutine frame allocation and suspension (separate from qlang_alloc so
+  // QHeapToStackPass leaves frames on the heap)
+  AddFunc("qlang_coro_alloc", (void *)LV_coro_alloc, allocType, builtin);
+  auto *coroYieldType = llvm::FunctionType::get(
+      llvm::Type::getVoidTy(context),
+      {llvm::PointerType::getUnqual(context),
+       llvm::PointerType::getUnqual(context)},
+      false);
+  AddFunc("qlang_coro_yield", (void *)LV_coro_yield, coroYieldType, builtin);
+  auto *coroWaitType = llvm::FunctionType::get(
+      llvm::Type::getVoidTy(context),
+      {llvm::PointerType::getUnqual(context),
+       llvm::PointerType::getUnqual(context), llvm::Type::getFloatTy(context)},
+      false);
+  AddFunc("qlang_coro_wait", (void *)LV_coro_wait, coroWaitType, builtin);
+  AddFunc("qlang_profile_clock", (void *)LV_profile_clock,
+          llvm::FunctionType::get(llvm::Type::getInt64Ty(context), false),
+          builtin);
 
   // string_concat - concatenate two strings
   auto *strConcatType =
@@ -114,79 +65,126 @@ void QLVMContext::RegisterBuiltinFunctions() {
                               {llvm::PointerType::getUnqual(context),
                                llvm::PointerType::getUnqual(context)},
                               false);
-  AddFunc("string_concat", (void *)LV_str_concat, strConcatType);
+  AddFunc("string_concat", (void *)LV_str_concat, strConcatType, builtin);
 
   // ToString helper functions for runtime numeric/bool to string conversion
   auto *int32ToStrType =
       llvm::FunctionType::get(llvm::PointerType::getUnqual(context),
                               {llvm::Type::getInt32Ty(context)}, false);
-  AddFunc("__int32_to_string", (void *)LV_int32_to_string, int32ToStrType);
+  AddFunc("__int32_to_string", (void *)LV_int32_to_string,
+          int32ToStrType, builtin);
 
   auto *int64ToStrType =
       llvm::FunctionType::get(llvm::PointerType::getUnqual(context),
                               {llvm::Type::getInt64Ty(context)}, false);
-  AddFunc("__int64_to_string", (void *)LV_int64_to_string, int64ToStrType);
+  AddFunc("__int64_to_string", (void *)LV_int64_to_string,
+          int64ToStrType, builtin);
 
   auto *float32ToStrType =
       llvm::FunctionType::get(llvm::PointerType::getUnqual(context),
                               {llvm::Type::getFloatTy(context)}, false);
   AddFunc("__float32_to_string", (void *)LV_float32_to_string,
-          float32ToStrType);
+          float32ToStrType, builtin);
 
   auto *float64ToStrType =
       llvm::FunctionType::get(llvm::PointerType::getUnqual(context),
                               {llvm::Type::getDoubleTy(context)}, false);
   AddFunc("__float64_to_string", (void *)LV_float64_to_string,
-          float64ToStrType);
+          float64ToStrType, builtin);
 
   auto *boolToStrType =
       llvm::FunctionType::get(llvm::PointerType::getUnqual(context),
                               {llvm::Type::getInt1Ty(context)}, false);
-  AddFunc("__bool_to_string", (void *)LV_bool_to_string, boolToStrType);
+  AddFunc("__bool_to_string", (void *)LV_bool_to_string,
+          boolToStrType, builtin);
 
   // String-to-number conversion functions (ToInt/ToFloat methods)
   auto *strToInt32Type =
       llvm::FunctionType::get(llvm::Type::getInt32Ty(context),
                               {llvm::PointerType::getUnqual(context)}, false);
-  AddFunc("__string_to_int32", (void *)LV_string_to_int32, strToInt32Type);
+  AddFunc("__string_to_int32", (void *)LV_string_to_int32,
+          strToInt32Type, builtin);
 
   auto *strToInt64Type =
       llvm::FunctionType::get(llvm::Type::getInt64Ty(context),
                               {llvm::PointerType::getUnqual(context)}, false);
-  AddFunc("__string_to_int64", (void *)LV_string_to_int64, strToInt64Type);
+  AddFunc("__string_to_int64", (void *)LV_string_to_int64,
+          strToInt64Type, builtin);
 
   auto *strToFloat32Type =
       llvm::FunctionType::get(llvm::Type::getFloatTy(context),
                               {llvm::PointerType::getUnqual(context)}, false);
   AddFunc("__string_to_float32", (void *)LV_string_to_float32,
-          strToFloat32Type);
+          strToFloat32Type, builtin);
 
   auto *strToFloat64Type =
       llvm::FunctionType::get(llvm::Type::getDoubleTy(context),
                               {llvm::PointerType::getUnqual(context)}, false);
   AddFunc("__string_to_float64", (void *)LV_string_to_float64,
-          strToFloat64Type);
+          strToFloat64Type, builtin);
 }
 
 void QLVMContext::AddFunc(const std::string &name, void *funcPtr,
-                          llvm::FunctionType *funcType) {
-  auto &context = QLVM::GetContext();
+                          llvm::FunctionType *funcType,
+                          const QNativeOptions &options) {
   auto *module = QLVM::GetModule();
 
-  // Create the function declaration in the LLVM module
-  llvm::Function *func = llvm::Function::Create(
-      funcType, llvm::Function::ExternalLinkage, name, module);
-
-  m_LLVMFunctions[name] = func;
   m_FunctionTypes[name] = funcType;
   m_FunctionPtrs[name] = funcPtr;
+  m_FunctionOptions[name] = options;
+
+  // Create the function declaration in the LLVM module
+  m_LLVMFunctions[name] = CreateFunction(name, funcType, module);
 
-  // Register the symbol globally so MCJIT can find it
+  if (!funcPtr) {
+    return; // Inline body only, nothing for the JIT to resolve
+  }
+
+  // Register the symbol globally so the JIT can find it
   llvm::sys::DynamicLibrary::AddSymbol(name, funcPtr);
+  // ...and native libraries loaded without LLVM
+  QNativeSymbols::Get().Add(name, funcPtr);
   std::cout << "[DEBUG] QLVMContext: Registered symbol '" << name
             << "' at address " << funcPtr << std::endl;
 }
 
+llvm::Function *QLVMContext::CreateFunction(const std::string &name,
+                                            llvm::FunctionType *funcType,
+                                            llvm::Module *module) const {
+  llvm::Function *func = llvm::Function::Create(
+      funcType, llvm::Function::ExternalLinkage, name, module);
+
+  // QLang bools are i1; C++ reads them as a whole byte
+  for (unsigned i = 0; i < funcType->getNumParams(); ++i) {
+    if (funcType->getParamType(i)->isIntegerTy(1))
+      func->addParamAttr(i, llvm::Attribute::ZExt);
+  }
+  if (funcType->getReturnType()->isIntegerTy(1))
+    func->addRetAttr(llvm::Attribute::ZExt);
+
+  auto optIt = m_FunctionOptions.find(name);
+  if (optIt == m_FunctionOptions.end())
+    return func;
+  const QNativeOptions &options = optIt->second;
+
+  if (options.noThrow)
+    func->setDoesNotThrow();
+  if (options.pure) {
+    func->setDoesNotAccessMemory();
+    func->addFnAttr(llvm::Attribute::WillReturn);
+  } else if (options.readOnly) {
+    func->setOnlyReadsMemory();
+  }
+
+  if (options.inlineBody) {
+    // One copy per module; identical definitions merge when modules link
+    func->setLinkage(llvm::Function::LinkOnceODRLinkage);
+    func->addFnAttr(llvm::Attribute::AlwaysInline);
+    options.inlineBody(func);
+  }
+  return func;
+}
+
 void *QLVMContext::GetFuncPtr(const std::string &name) const {
   auto it = m_FunctionPtrs.find(name);
   if (it != m_FunctionPtrs.end()) {
@@ -195,6 +193,12 @@ void *QLVMContext::GetFuncPtr(const std::string &name) const {
   return nullptr;
 }
 
+bool QLVMContext::IsThreadSafe(const std::string &name) const {
+  auto it = m_FunctionOptions.find(name);
+  return it != m_FunctionOptions.end() &&
+         (it->second.pure || it->second.threadSafe);
+}
+
 llvm::Function *QLVMContext::GetLLVMFunc(const std::string &name) const {
   auto it = m_LLVMFunctions.find(name);
   if (it != m_LLVMFunctions.end()) {
@@ -221,8 +225,7 @@ llvm::Function *QLVMContext::GetLLVMFunc(const std::string &name) const {
     }
 
     // Create fresh declaration
-    llvm::Function *newFunc = llvm::Function::Create(
-        typeIt->second, llvm::Function::ExternalLinkage, name, module);
+    llvm::Function *newFunc = CreateFunction(name, typeIt->second, module);
     m_LLVMFunctions[name] = newFunc;
     return newFunc;
   }
@@ -231,3 +234,89 @@ llvm::Function *QLVMContext::GetLLVMFunc(const std::string &name) const {
 }
 
 void QLVMContext::ResetCache() { m_LLVMFunctions.clear(); }
+
+// Rebuild a type from another LLVMContext in 'context'. Named structs are
+// looked up by name (or declared opaque); natives only pass them by pointer.
+static llvm::Type *RemapType(llvm::Type *type, llvm::LLVMContext &context) {
+  switch (type->getTypeID()) {
+  case llvm::Type::VoidTyID:
+    return llvm::Type::getVoidTy(context);
+  case llvm::Type::HalfTyID:
+    return llvm::Type::getHalfTy(context);
+  case llvm::Type::FloatTyID:
+    return llvm::Type::getFloatTy(context);
+  case llvm::Type::DoubleTyID:
+    return llvm::Type::getDoubleTy(context);
+  case llvm::Type::IntegerTyID:
+    return llvm::IntegerType::get(context, type->getIntegerBitWidth());
+  case llvm::Type::PointerTyID:
+    return llvm::PointerType::get(context, type->getPointerAddressSpace());
+  case llvm::Type::ArrayTyID: {
+    auto *arrayType = llvm::cast<llvm::ArrayType>(type);
+    llvm::Type *element = RemapType(arrayType->getElementType(), context);
+    return element ? llvm::ArrayType::get(element, arrayType->getNumElements())
+                   : nullptr;
+  }
+  case llvm::Type::FixedVectorTyID: {
+    auto *vectorType = llvm::cast<llvm::FixedVectorType>(type);
+    llvm::Type *element = RemapType(vectorType->getElementType(), context);
+    return element ? llvm::FixedVectorType::get(element,
+                                                vectorType->getNumElements())
+                   : nullptr;
+  }
+  case llvm::Type::StructTyID: {
+    auto *structType = llvm::cast<llvm::StructType>(type);
+    if (structType->hasName()) {
+      if (auto *existing =
+              llvm::StructType::getTypeByName(context, structType->getName()))
+        return existing;
+      return llvm::StructType::create(context, structType->getName());
+    }
+    std::vector<llvm::Type *> elements;
+    for (llvm::Type *element : structType->elements()) {
+      llvm::Type *mapped = RemapType(element, context);
+      if (!mapped)
+        return nullptr;
+      elements.push_back(mapped);
+    }
+    return llvm::StructType::get(context, elements, structType->isPacked());
+  }
+  case llvm::Type::FunctionTyID: {
+    auto *funcType = llvm::cast<llvm::FunctionType>(type);
+    llvm::Type *result = RemapType(funcType->getReturnType(), context);
+    std::vector<llvm::Type *> params;
+    for (llvm::Type *param : funcType->params()) {
+      llvm::Type *mapped = RemapType(param, context);
+      if (!mapped)
+        return nullptr;
+      params.push_back(mapped);
+    }
+    return result ? llvm::FunctionType::get(result, params,
+                                            funcType->isVarArg())
+                  : nullptr;
+  }
+  default:
+    return nullptr;
+  }
+}
+
+std::shared_ptr<QLVMContext> QLVMContext::CloneForCurrentThread() const {
+  auto &context = QLVM::GetContext();
+  auto clone = std::shared_ptr<QLVMContext>(new QLVMContext(NoBuiltins{}));
+
+  // Declarations are created lazily by GetLLVMFunc in the thread's module;
+  // the symbols themselves were registered with the JIT by AddFunc
+  for (const auto &[name, funcType] : m_FunctionTypes) {
+    auto *mapped =
+        llvm::cast_or_null<llvm::FunctionType>(RemapType(funcType, context));
+    if (!mapped) {
+      std::cerr << "[WARNING] QLVMContext: Cannot rebuild type of native '"
+                << name << "' for worker thread" << std::endl;
+      continue;
+    }
+    clone->m_FunctionTypes[name] = mapped;
+  }
+  clone->m_FunctionPtrs = m_FunctionPtrs;
+  clone->m_FunctionOptions = m_FunctionOptions; // Bodies build in any context
+  return clone;
+}
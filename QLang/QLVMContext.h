@@ -1,5 +1,6 @@
 #pragma once
 
+#include <functional>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -7,16 +8,37 @@
 namespace llvm {
 class Function;
 class FunctionType;
+class LLVMContext;
+class Module;
 } // namespace llvm
 
+// How a native function behaves, so LLVM can optimize calls to it
+struct QNativeOptions {
+  bool pure = false;     // Reads and writes no memory (readnone)
+  bool readOnly = false; // Reads memory but never writes it
+  bool noThrow = true;   // Never unwinds into script code
+
+  // May be called from the parallel script update phase: it only reads
+  // engine state, or defers its changes (e.g. to a per-thread command buffer)
+  bool threadSafe = false;
+
+  // Optional IR body emitted into each module in place of a call to the
+  // native pointer. The function is alwaysinline, so trivial natives fold
+  // into the calling script code. Called with the empty function to fill.
+  std::function<void(llvm::Function *)> inlineBody;
+};
+
 class QLVMContext {
 public:
   QLVMContext();
   ~QLVMContext();
 
-  // Register a native function with LLVM
+  // Register a native function with LLVM (see QNativeBinding.h to derive
+  // the type from the C++ signature). funcPtr may be null for natives that
+  // only have an inline body.
   void AddFunc(const std::string &name, void *funcPtr,
-               llvm::FunctionType *funcType);
+               llvm::FunctionType *funcType,
+               const QNativeOptions &options = {});
 
   // Get the native function pointer
   void *GetFuncPtr(const std::string &name) const;
@@ -24,13 +46,30 @@ public:
   // Get the LLVM function declaration
   llvm::Function *GetLLVMFunc(const std::string &name) const;
 
+  // True if the native is pure or registered as threadSafe
+  bool IsThreadSafe(const std::string &name) const;
+
   // Clear cached LLVM functions (used when module changes)
   void ResetCache();
 
+  // Copy of the registered natives with their function types rebuilt in the
+  // calling thread's LLVMContext (see QLVM::ThreadState)
+  std::shared_ptr<QLVMContext> CloneForCurrentThread() const;
+
 private:
+  struct NoBuiltins {};
+  explicit QLVMContext(NoBuiltins) {}
+
   // Register all built-in functions automatically
   void RegisterBuiltinFunctions();
+
+  // Declare (or define, for inline bodies) a native in a module
+  llvm::Function *CreateFunction(const std::string &name,
+                                 llvm::FunctionType *funcType,
+                                 llvm::Module *module) const;
+
   mutable std::unordered_map<std::string, llvm::Function *> m_LLVMFunctions;
   std::unordered_map<std::string, llvm::FunctionType *> m_FunctionTypes;
   std::unordered_map<std::string, void *> m_FunctionPtrs;
+  std::unordered_map<std::string, QNativeOptions> m_FunctionOptions;
 };
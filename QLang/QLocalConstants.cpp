@@ -0,0 +1,108 @@
+#include "QLocalConstants.h"
+#include "QAssign.h"
+#include "QCode.h"
+#include "QFor.h"
+#include "QIf.h"
+#include "QIncrement.h"
+#include "QInstanceDecl.h"
+#include "QVariableDecl.h"
+#include "QWhile.h"
+#include <cstdio>
+#include <cstdlib>
+#include <llvm/IR/Constants.h>
+#include <llvm/IR/Type.h>
+
+void QLocalConstants::Scan(const std::shared_ptr<QCode> &code) {
+  if (!code)
+    return;
+
+  for (const auto &node : code->GetNodes()) {
+    if (auto varDecl = std::dynamic_pointer_cast<QVariableDecl>(node)) {
+      ++m_Declarations[varDecl->GetName()];
+    } else if (auto instDecl = std::dynamic_pointer_cast<QInstanceDecl>(node)) {
+      ++m_Declarations[instDecl->GetInstanceName()];
+      if (instDecl->GetConstructorArgs() &&
+          !instDecl->HasInitializerExpression()) {
+        m_Allocated.insert(instDecl->GetInstanceName());
+      }
+    } else if (auto assign = std::dynamic_pointer_cast<QAssign>(node)) {
+      m_Assigned.insert(assign->GetVariableName());
+    } else if (auto increment = std::dynamic_pointer_cast<QIncrement>(node)) {
+      m_Assigned.insert(increment->GetVarName());
+    } else if (auto forNode = std::dynamic_pointer_cast<QFor>(node)) {
+      m_Assigned.insert(forNode->GetVarName());
+      Scan(forNode->GetBody());
+    } else if (auto whileNode = std::dynamic_pointer_cast<QWhile>(node)) {
+      Scan(whileNode->GetBody());
+    } else if (auto ifNode = std::dynamic_pointer_cast<QIf>(node)) {
+      Scan(ifNode->GetThenBlock());
+      for (const auto &elseIf : ifNode->GetElseIfBlocks()) {
+        Scan(elseIf.second);
+      }
+      Scan(ifNode->GetElseBlock());
+    }
+  }
+}
+
+bool QLocalConstants::IsSingleAssignment(const std::string &name) const {
+  auto it = m_Declarations.find(name);
+  return it != m_Declarations.end() && it->second == 1 &&
+         !m_Assigned.count(name);
+}
+
+llvm::Constant *QLocalConstants::FoldStringToNumber(const std::string &text,
+                                                    llvm::Type *type) {
+  const char *str = text.c_str();
+  if (type->isIntegerTy(32))
+    return llvm::ConstantInt::get(type, static_cast<int32_t>(atoi(str)), true);
+  if (type->isIntegerTy(64))
+    return llvm::ConstantInt::get(type, static_cast<int64_t>(atoll(str)),
+                                  true);
+  if (type->isFloatTy())
+    return llvm::ConstantFP::get(type, static_cast<float>(atof(str)));
+  if (type->isDoubleTy())
+    return llvm::ConstantFP::get(type, atof(str));
+  return nullptr;
+}
+
+bool QLocalConstants::FoldToString(const llvm::Constant *value,
+                                   std::string &text) {
+  char buffer[32];
+  if (auto *integer = llvm::dyn_cast<llvm::ConstantInt>(value)) {
+    switch (integer->getBitWidth()) {
+    case 1:
+      text = integer->isZero() ? "false" : "true";
+      return true;
+    case 8: // Bytes print as int32
+      std::snprintf(buffer, sizeof(buffer), "%d",
+                    static_cast<int32_t>(integer->getZExtValue()));
+      break;
+    case 32:
+      std::snprintf(buffer, sizeof(buffer), "%d",
+                    static_cast<int32_t>(integer->getSExtValue()));
+      break;
+    case 64:
+      std::snprintf(buffer, sizeof(buffer), "%lld",
+                    static_cast<long long>(integer->getSExtValue()));
+      break;
+    default:
+      return false;
+    }
+    text = buffer;
+    return true;
+  }
+  if (auto *real = llvm::dyn_cast<llvm::ConstantFP>(value)) {
+    if (real->getType()->isFloatTy()) {
+      std::snprintf(buffer, sizeof(buffer), "%g",
+                    real->getValueAPF().convertToFloat());
+    } else if (real->getType()->isDoubleTy()) {
+      std::snprintf(buffer, sizeof(buffer), "%g",
+                    real->getValueAPF().convertToDouble());
+    } else {
+      return false;
+    }
+    text = buffer;
+    return true;
+  }
+  return false;
+}
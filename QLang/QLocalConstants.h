@@ -0,0 +1,66 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+class QCode;
+
+namespace llvm {
+class Constant;
+class Type;
+} // namespace llvm
+
+// QLocalConstants - locals whose value is known while a body is compiled
+//
+// Scan() runs over a method (or script) body before QJitRunner compiles it.
+// A local declared exactly once and never assigned afterwards (no
+// assignment, increment or for loop over it) holds its initializer wherever
+// it is in scope. When the initializer compiles to a constant, QJitRunner
+// binds it here and uses the constant instead of loading the local, so the
+// expressions and conditions built on it fold as well.
+class QLocalConstants {
+public:
+  void Scan(const std::shared_ptr<QCode> &code);
+
+  bool IsSingleAssignment(const std::string &name) const;
+
+  // Declared once with '= new' and never assigned: the local can only refer
+  // to an object this body allocated, never to one another script can see
+  bool IsLocalAllocation(const std::string &name) const {
+    return m_Allocated.count(name) && IsSingleAssignment(name);
+  }
+
+  void Bind(const std::string &name, llvm::Constant *value) {
+    m_Values[name] = value;
+  }
+  llvm::Constant *Find(const std::string &name) const {
+    auto it = m_Values.find(name);
+    return it != m_Values.end() ? it->second : nullptr;
+  }
+
+  // String locals initialized with a literal keep its text, for folding
+  // ToInt()/ToFloat()
+  void BindString(const std::string &name, const std::string &text) {
+    m_Strings[name] = text;
+  }
+  const std::string *FindString(const std::string &name) const {
+    auto it = m_Strings.find(name);
+    return it != m_Strings.end() ? &it->second : nullptr;
+  }
+
+  // Compile-time versions of the runtime conversions in QLVMContext.cpp
+  // (LV_string_to_int32, LV_int32_to_string, ...), with the same results.
+  // Null / false if the type has no conversion.
+  static llvm::Constant *FoldStringToNumber(const std::string &text,
+                                            llvm::Type *type);
+  static bool FoldToString(const llvm::Constant *value, std::string &text);
+
+private:
+  std::unordered_map<std::string, int> m_Declarations;
+  std::unordered_set<std::string> m_Assigned;
+  std::unordered_set<std::string> m_Allocated;
+  std::unordered_map<std::string, llvm::Constant *> m_Values;
+  std::unordered_map<std::string, std::string> m_Strings;
+};
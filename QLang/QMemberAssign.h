@@ -38,7 +38,7 @@ public:
     if (m_ValueExpression) {
       const auto &elems = m_ValueExpression->GetElements();
       for (const auto &e : elems) {
-        std::cout << e.value << " ";
+        std::cout << e.Text() << " ";
       }
     }
     std::cout << std::endl;
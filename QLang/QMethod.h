@@ -9,8 +9,9 @@
 #include <string>
 #include <vector>
 
-// Forward declaration
+// Forward declarations
 class QExpression;
+class QFrameLayout;
 
 // QMethodParam - represents a method parameter
 struct QMethodParam {
@@ -80,6 +81,16 @@ public:
   void SetOverride(bool isOverride) { m_IsOverride = isOverride; }
   bool IsOverride() const { return m_IsOverride; }
 
+  // Hash of the body's tokens, see QJitRunner::PatchScript
+  void SetBodyHash(uint64_t hash) { m_BodyHash = hash; }
+  uint64_t GetBodyHash() const { return m_BodyHash; }
+
+  // Frame layout resolved by QRunner (parameters, members, locals)
+  std::shared_ptr<QFrameLayout> GetFrameLayout() const { return m_FrameLayout; }
+  void SetFrameLayout(std::shared_ptr<QFrameLayout> layout) {
+    m_FrameLayout = std::move(layout);
+  }
+
 private:
   std::string m_Name;
   TokenType m_ReturnType = TokenType::T_EOF; // T_EOF = void/no return
@@ -88,6 +99,8 @@ private:
   std::shared_ptr<QCode> m_Body;
   bool m_IsVirtual = false;  // True if method is virtual
   bool m_IsOverride = false; // True if method overrides a parent method
+  std::shared_ptr<QFrameLayout> m_FrameLayout;
+  uint64_t m_BodyHash = 0;
 
   std::string GetTypeName(TokenType type) const {
     switch (type) {
@@ -36,7 +36,7 @@ public:
       for (size_t i = 0; i < params.size(); i++) {
         const auto &elems = params[i]->GetElements();
         for (const auto &e : elems) {
-          std::cout << e.value << " ";
+          std::cout << e.Text() << " ";
         }
         if (i < params.size() - 1)
           std::cout << ", ";
@@ -104,6 +104,10 @@ public:
 
   bool IsValid() const { return m_ThisPtr && m_FuncPtr; }
 
+  // Raw parts, for callers that batch many instances of one class
+  void *GetThisPtr() const { return m_ThisPtr; }
+  FnType GetFunctionPtr() const { return m_FuncPtr; }
+
   // Direct call - zero overhead beyond the actual function call!
   void operator()(Args... args) const {
     if (m_FuncPtr) {
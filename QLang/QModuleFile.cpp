@@ -1,9 +1,15 @@
 #include "QModuleFile.h"
+#include "QProfiler.h"
 #include <iostream>
 #include <llvm/Bitcode/BitcodeReader.h>
+#include <llvm/ADT/StringExtras.h>
 #include <llvm/Bitcode/BitcodeWriter.h>
 #include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/SHA1.h>
 #include <llvm/Support/raw_ostream.h>
+#include <filesystem>
+#include <set>
+#include <sstream>
 
 void QModuleFile::WriteString(std::ostream &os, const std::string &str) {
   uint32_t len = static_cast<uint32_t>(str.size());
@@ -42,9 +48,67 @@ uint32_t QModuleFile::ReadUInt32(std::istream &is) {
   return value;
 }
 
+// Source text plus, recursively, the text of every "import X;" next to it:
+// binaries link their imports in, so an edited dependency must invalidate them
+static void HashSourceRecursive(const std::filesystem::path &sourcePath,
+                                std::set<std::string> &visited,
+                                llvm::SHA1 &hasher) {
+  if (!visited.insert(sourcePath.string()).second)
+    return;
+
+  std::ifstream file(sourcePath, std::ios::binary);
+  if (!file)
+    return;
+  std::stringstream contents;
+  contents << file.rdbuf();
+  std::string source = contents.str();
+  hasher.update(source);
+
+  std::istringstream lines(source);
+  std::string line;
+  while (std::getline(lines, line)) {
+    size_t start = line.find_first_not_of(" \t");
+    if (start == std::string::npos || line.compare(start, 7, "import ") != 0)
+      continue;
+    size_t nameStart = line.find_first_not_of(" \t", start + 7);
+    size_t nameEnd = line.find_first_of(" \t;\r", nameStart);
+    if (nameStart == std::string::npos)
+      continue;
+    std::string name = line.substr(nameStart, nameEnd - nameStart);
+    HashSourceRecursive(sourcePath.parent_path() / (name + ".q"), visited,
+                        hasher);
+  }
+}
+
+std::string QModuleFile::HashSource(const std::string &sourcePath) {
+  if (!std::filesystem::exists(sourcePath))
+    return "";
+
+  llvm::SHA1 hasher;
+  std::set<std::string> visited;
+  HashSourceRecursive(sourcePath, visited, hasher);
+  // Instrumented methods carry profiler counters in their IR
+  if (QProfiler::IsInstrumentationEnabled()) {
+    hasher.update("instrumented");
+  }
+  auto digest = hasher.final();
+  return llvm::toHex(digest, true);
+}
+
+std::string QModuleFile::ReadSourceHash(const std::string &filePath) {
+  std::ifstream file(filePath, std::ios::binary);
+  if (!file)
+    return "";
+  if (ReadUInt32(file) != MAGIC || ReadUInt32(file) != VERSION)
+    return "";
+  ReadString(file); // Module name
+  return ReadString(file);
+}
+
 bool QModuleFile::SaveModule(const std::string &moduleName,
                              const std::string &filePath, llvm::Module *module,
-                             const std::vector<ModuleClassInfo> &classes) {
+                             const std::vector<ModuleClassInfo> &classes,
+                             const std::string &sourceHash) {
   std::ofstream file(filePath, std::ios::binary);
   if (!file) {
     m_ErrorMessage = "Failed to open file for writing: " + filePath;
@@ -58,11 +122,13 @@ bool QModuleFile::SaveModule(const std::string &moduleName,
   WriteUInt32(file, MAGIC);
   WriteUInt32(file, VERSION);
   WriteString(file, moduleName);
+  WriteString(file, sourceHash);
 
   // Write class metadata
   WriteUInt32(file, static_cast<uint32_t>(classes.size()));
   for (const auto &cls : classes) {
     WriteString(file, cls.className);
+    WriteString(file, cls.parentClassName);
 
     // Write members
     WriteUInt32(file, static_cast<uint32_t>(cls.memberNames.size()));
@@ -85,8 +151,25 @@ bool QModuleFile::SaveModule(const std::string &moduleName,
       WriteString(file, retType);
     }
 
-    // Write static flag
-    WriteInt32(file, cls.isStatic ? 1 : 0);
+    // Write class flags (bit 0: static, bit 1: value, bit 2: writes shared
+    // state, bit 3: writes own members)
+    WriteInt32(file, (cls.isStatic ? 1 : 0) | (cls.isValue ? 2 : 0) |
+                         (cls.access.writesShared ? 4 : 0) |
+                         (cls.access.writesSelf ? 8 : 0));
+
+    // Write what the class calls (see QClassAccess)
+    WriteUInt32(file, static_cast<uint32_t>(cls.access.natives.size()));
+    for (const auto &native : cls.access.natives) {
+      WriteString(file, native);
+    }
+    WriteUInt32(file, static_cast<uint32_t>(cls.access.classes.size()));
+    for (const auto &calledClass : cls.access.classes) {
+      WriteString(file, calledClass);
+    }
+    WriteUInt32(file, static_cast<uint32_t>(cls.access.localClasses.size()));
+    for (const auto &calledClass : cls.access.localClasses) {
+      WriteString(file, calledClass);
+    }
 
     std::cout << "[DEBUG] QModuleFile: Wrote class '" << cls.className
               << "' with " << cls.memberNames.size() << " members and "
@@ -148,6 +231,7 @@ bool QModuleFile::LoadModule(const std::string &filePath,
   std::string moduleName = ReadString(file);
   std::cout << "[DEBUG] QModuleFile: Loading module '" << moduleName << "'"
             << std::endl;
+  ReadString(file); // Source hash (checked by ReadSourceHash)
 
   // Read class metadata
   uint32_t classCount = ReadUInt32(file);
@@ -157,6 +241,7 @@ bool QModuleFile::LoadModule(const std::string &filePath,
   for (uint32_t c = 0; c < classCount; ++c) {
     ModuleClassInfo cls;
     cls.className = ReadString(file);
+    cls.parentClassName = ReadString(file);
 
     // Read members
     uint32_t memberCount = ReadUInt32(file);
@@ -182,8 +267,27 @@ bool QModuleFile::LoadModule(const std::string &filePath,
       }
     }
 
-    // Read static flag
-    cls.isStatic = ReadInt32(file) != 0;
+    // Read class flags (bit 0: static, bit 1: value, bit 2: writes shared
+    // state, bit 3: writes own members)
+    int32_t flags = ReadInt32(file);
+    cls.isStatic = (flags & 1) != 0;
+    cls.isValue = (flags & 2) != 0;
+    cls.access.writesShared = (flags & 4) != 0;
+    cls.access.writesSelf = (flags & 8) != 0;
+
+    // Read what the class calls
+    uint32_t nativeCount = ReadUInt32(file);
+    for (uint32_t j = 0; j < nativeCount; ++j) {
+      cls.access.natives.insert(ReadString(file));
+    }
+    uint32_t calledCount = ReadUInt32(file);
+    for (uint32_t j = 0; j < calledCount; ++j) {
+      cls.access.classes.insert(ReadString(file));
+    }
+    uint32_t localCount = ReadUInt32(file);
+    for (uint32_t j = 0; j < localCount; ++j) {
+      cls.access.localClasses.insert(ReadString(file));
+    }
 
     std::cout << "[DEBUG] QModuleFile: Loaded class '" << cls.className
               << "' with " << cls.memberNames.size() << " members and "
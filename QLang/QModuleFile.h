@@ -1,4 +1,5 @@
 #pragma once
+#include "QClassAccess.h"
 #include <fstream>
 #include <llvm/IR/Module.h>
 #include <memory>
@@ -18,6 +19,9 @@ struct ModuleClassInfo {
   std::vector<std::string> methodNames;
   std::unordered_map<std::string, std::string> methodReturnTypes;
   bool isStatic = false; // True if this is a static class (singleton)
+  bool isValue = false;  // True if declared with 'struct'
+  QClassAccess access;   // What its methods touch beyond their instance
+  std::string parentClassName; // Empty if the class has no parent
 };
 
 // Handles reading/writing compiled QLang modules (.qm files)
@@ -25,16 +29,27 @@ class QModuleFile {
 public:
   QModuleFile() = default;
 
-  // Save a module to a binary file
+  // Save a module to a binary file. sourceHash identifies the source it was
+  // compiled from (see HashSource)
   bool SaveModule(const std::string &moduleName, const std::string &filePath,
                   llvm::Module *module,
-                  const std::vector<ModuleClassInfo> &classes);
+                  const std::vector<ModuleClassInfo> &classes,
+                  const std::string &sourceHash = "");
 
   // Load a module from a binary file
   bool LoadModule(const std::string &filePath, llvm::LLVMContext &context,
                   std::unique_ptr<llvm::Module> &outModule,
                   std::vector<ModuleClassInfo> &outClasses);
 
+  // Read only the header of a module file and return its source hash
+  // (empty if missing, unreadable or written by an older version)
+  std::string ReadSourceHash(const std::string &filePath);
+
+  // Hash of a source file's contents (and its imports), as stored by
+  // SaveModule. Also covers the compile settings that change the stored IR
+  // (profiler instrumentation), so a binary built with others is stale.
+  static std::string HashSource(const std::string &sourcePath);
+
   // Get the last error message
   const std::string &GetError() const { return m_ErrorMessage; }
 
@@ -43,7 +58,9 @@ private:
 
   // Magic number and version for file format
   static constexpr uint32_t MAGIC = 0x514D4F44; // "QMOD"
-  static constexpr uint32_t VERSION = 1;
+  // 2: source hash in header, 3: class access (QClassAccess), 4: classes
+  // called on local allocations, 5: parent class
+  static constexpr uint32_t VERSION = 5;
 
   void WriteString(std::ostream &os, const std::string &str);
   std::string ReadString(std::istream &is);
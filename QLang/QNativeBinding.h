@@ -0,0 +1,107 @@
+#pragma once
+
+#include "QLVM.h"
+#include "QLVMContext.h"
+#include <cstdint>
+#include <llvm/IR/DerivedTypes.h>
+#include <llvm/IR/LLVMContext.h>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// QNativeBinding - registers C++ functions as QLang natives
+//
+// The LLVM signature is derived from the C++ function type, so natives no
+// longer need hand-built llvm::FunctionTypes:
+//
+//   QBindNative(*context, "Node_CountOverlaps", LV_Node_CountOverlaps);
+//   QBindNative(*context, "Math_Length", LV_Length, {.readOnly = true});
+//   QBindInline<float(float)>(*context, "Math_Radians", [](llvm::Function *f) {
+//     ...emit the body...
+//   });
+//
+// Type mapping: integers by width, bool -> i1, float/double, and any pointer
+// or reference -> ptr. QLang value structs (Vec3, ...) live in script memory
+// and reach natives by address, so take them as 'const T &' (or 'T *' when
+// the native writes them) with a C++ struct of the same layout.
+
+template <typename T, typename Enable = void> struct QNativeType {
+  static_assert(sizeof(T) == 0, "No QLang type for this native parameter; "
+                                "pass structs by reference or pointer");
+};
+
+template <> struct QNativeType<void> {
+  static llvm::Type *Get(llvm::LLVMContext &context) {
+    return llvm::Type::getVoidTy(context);
+  }
+};
+
+template <> struct QNativeType<bool> {
+  static llvm::Type *Get(llvm::LLVMContext &context) {
+    return llvm::Type::getInt1Ty(context);
+  }
+};
+
+template <typename T>
+struct QNativeType<T, std::enable_if_t<std::is_integral<T>::value &&
+                                       !std::is_same<T, bool>::value>> {
+  static llvm::Type *Get(llvm::LLVMContext &context) {
+    return llvm::IntegerType::get(context, sizeof(T) * 8);
+  }
+};
+
+template <> struct QNativeType<float> {
+  static llvm::Type *Get(llvm::LLVMContext &context) {
+    return llvm::Type::getFloatTy(context);
+  }
+};
+
+template <> struct QNativeType<double> {
+  static llvm::Type *Get(llvm::LLVMContext &context) {
+    return llvm::Type::getDoubleTy(context);
+  }
+};
+
+template <typename T> struct QNativeType<T *, void> {
+  static llvm::Type *Get(llvm::LLVMContext &context) {
+    return llvm::PointerType::getUnqual(context);
+  }
+};
+
+template <typename T> struct QNativeType<T &, void> {
+  static llvm::Type *Get(llvm::LLVMContext &context) {
+    return llvm::PointerType::getUnqual(context);
+  }
+};
+
+// LLVM type of a C++ function signature, e.g. QNativeFunctionType<int(float)>
+template <typename Signature> struct QNativeFunctionType;
+
+template <typename R, typename... Args> struct QNativeFunctionType<R(Args...)> {
+  static llvm::FunctionType *Get(llvm::LLVMContext &context) {
+    std::vector<llvm::Type *> params{QNativeType<Args>::Get(context)...};
+    return llvm::FunctionType::get(QNativeType<R>::Get(context), params,
+                                   false);
+  }
+};
+
+// Register a C++ function under 'name'; the signature comes from its type
+template <typename R, typename... Args>
+void QBindNative(QLVMContext &context, const std::string &name,
+                 R (*func)(Args...), const QNativeOptions &options = {}) {
+  context.AddFunc(name, reinterpret_cast<void *>(func),
+                  QNativeFunctionType<R(Args...)>::Get(QLVM::GetContext()),
+                  options);
+}
+
+// Register a native that exists only as an IR body (see
+// QNativeOptions::inlineBody), e.g. QBindInline<float(float)>(...)
+template <typename Signature>
+void QBindInline(QLVMContext &context, const std::string &name,
+                 std::function<void(llvm::Function *)> body,
+                 QNativeOptions options = {}) {
+  options.inlineBody = std::move(body);
+  context.AddFunc(name, nullptr,
+                  QNativeFunctionType<Signature>::Get(QLVM::GetContext()),
+                  options);
+}
@@ -0,0 +1,94 @@
+#include "QNativeLibrary.h"
+#include "QNativeSymbols.h"
+#include "QProfiler.h"
+#include "QRuntimeBuiltins.h"
+#include "QStaticRegistry.h"
+#include <iostream>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <dlfcn.h>
+#endif
+
+// dlopen / LoadLibrary; never closed, code from it may run until exit
+static void *OpenLibrary(const std::string &path, std::string &error) {
+#ifdef _WIN32
+  HMODULE module = LoadLibraryA(path.c_str());
+  if (!module) {
+    error = "error " + std::to_string(GetLastError());
+  }
+  return module;
+#else
+  void *handle = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+  if (!handle) {
+    const char *message = dlerror();
+    error = message ? message : "unknown error";
+  }
+  return handle;
+#endif
+}
+
+void *QNativeLibrary::GetSymbol(const std::string &name) const {
+#ifdef _WIN32
+  return reinterpret_cast<void *>(
+      GetProcAddress(static_cast<HMODULE>(m_Handle), name.c_str()));
+#else
+  return dlsym(m_Handle, name.c_str());
+#endif
+}
+
+std::unique_ptr<QNativeLibrary> QNativeLibrary::Load(const std::string &path) {
+  std::string error;
+  void *handle = OpenLibrary(path, error);
+  if (!handle) {
+    std::cerr << "[ERROR] QNativeLibrary: Cannot load '" << path
+              << "': " << error << std::endl;
+    return nullptr;
+  }
+
+  std::unique_ptr<QNativeLibrary> library(new QNativeLibrary());
+  library->m_Handle = handle;
+  library->m_Path = path;
+  library->m_Manifest = static_cast<const QAotManifest *>(
+      library->GetSymbol(QAotManifestSymbol));
+  const QAotManifest *manifest = library->m_Manifest;
+  if (!manifest || manifest->version != QAotVersion) {
+    std::cerr << "[ERROR] QNativeLibrary: '" << path
+              << "' is not a QLang library of this version" << std::endl;
+    return nullptr;
+  }
+
+  // Bind natives before any script code can run, the way the JIT's
+  // QProcessSymbolGenerator does
+  QRegisterRuntimeBuiltins();
+  size_t missing = 0;
+  for (uint32_t i = 0; i < manifest->importCount; ++i) {
+    const QAotImport &import = manifest->imports[i];
+    void *addr = QProfiler::Get().FindCounters(import.name);
+    if (!addr)
+      addr = QNativeSymbols::Get().Find(import.name);
+    if (!addr) {
+      std::cerr << "[ERROR] QNativeLibrary: '" << path
+                << "' needs unknown function '" << import.name << "'"
+                << std::endl;
+      ++missing;
+      continue;
+    }
+    *import.slot = addr;
+  }
+  if (missing)
+    return nullptr;
+
+  // Static classes live in the library's own storage
+  for (uint32_t i = 0; i < manifest->classCount; ++i) {
+    const QAotClass &cls = manifest->classes[i];
+    if (cls.isStatic && cls.staticInstance) {
+      QStaticRegistry::Instance().AdoptInstance(cls.name, cls.staticInstance,
+                                                cls.size);
+    }
+  }
+  return library;
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "QAotLibrary.h"
+#include <memory>
+#include <string>
+
+// QNativeLibrary - a script library built by QJitRunner::CompileLibrary
+//
+// Load() opens the shared library, checks its manifest, binds the natives it
+// imports through QNativeSymbols and adopts the storage of its static
+// classes, so its code can run as soon as it returns. Plain C++ and the OS
+// loader, no LLVM: shipped builds get it from the QLangRuntime library.
+// QJitProgram::LoadNativeLibrary builds a program on top of it.
+class QNativeLibrary {
+public:
+  // Null if the library is missing, was built for another manifest version
+  // or imports a function nothing defines. Natives must be registered
+  // before the call. The library stays loaded for the rest of the process.
+  static std::unique_ptr<QNativeLibrary> Load(const std::string &path);
+
+  const QAotManifest &GetManifest() const { return *m_Manifest; }
+  const std::string &GetPath() const { return m_Path; }
+
+  // Exported function or data (dlsym / GetProcAddress); null if missing
+  void *GetSymbol(const std::string &name) const;
+
+private:
+  QNativeLibrary() = default;
+
+  void *m_Handle = nullptr;
+  const QAotManifest *m_Manifest = nullptr;
+  std::string m_Path;
+};
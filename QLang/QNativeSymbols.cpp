@@ -0,0 +1,49 @@
+#include "QNativeSymbols.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#include <vector>
+#else
+#include <dlfcn.h>
+#endif
+
+QNativeSymbols &QNativeSymbols::Get() {
+  static QNativeSymbols symbols;
+  return symbols;
+}
+
+void QNativeSymbols::Add(const std::string &name, void *address) {
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  m_Symbols[name] = address;
+}
+
+void *QNativeSymbols::Find(const std::string &name) const {
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    auto it = m_Symbols.find(name);
+    if (it != m_Symbols.end())
+      return it->second;
+  }
+
+#ifdef _WIN32
+  // The executable first, then every DLL it has loaded (the CRT included)
+  HANDLE process = GetCurrentProcess();
+  DWORD bytes = 0;
+  if (!EnumProcessModules(process, nullptr, 0, &bytes))
+    return nullptr;
+  std::vector<HMODULE> modules(bytes / sizeof(HMODULE));
+  if (!EnumProcessModules(process, modules.data(), bytes, &bytes))
+    return nullptr;
+  modules.resize(bytes / sizeof(HMODULE));
+  for (HMODULE module : modules) {
+    if (FARPROC address = GetProcAddress(module, name.c_str()))
+      return reinterpret_cast<void *>(address);
+  }
+  return nullptr;
+#else
+  return dlsym(RTLD_DEFAULT, name.c_str());
+#endif
+}
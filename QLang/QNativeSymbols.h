@@ -0,0 +1,28 @@
+#pragma once
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+// QNativeSymbols - addresses of the functions compiled scripts call, by name
+//
+// Natives are added as they are bound (QLVMContext::AddFunc) and the runtime
+// built-ins by QRegisterRuntimeBuiltins. Lookups that miss fall back to the
+// symbols the process exports. Native libraries resolve their imports here;
+// no LLVM is involved, so this is part of the QLangRuntime library.
+class QNativeSymbols {
+public:
+  static QNativeSymbols &Get();
+
+  void Add(const std::string &name, void *address);
+
+  // Registered symbols first, then the process and the libraries it loaded.
+  // Null if nothing defines the name.
+  void *Find(const std::string &name) const;
+
+private:
+  QNativeSymbols() = default;
+
+  mutable std::mutex m_Mutex;
+  std::unordered_map<std::string, void *> m_Symbols;
+};
@@ -0,0 +1,133 @@
+#include "QProfiler.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <sstream>
+
+#if defined(_M_X64) || defined(_M_IX86)
+#include <intrin.h>
+#define QPROFILER_RDTSC 1
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define QPROFILER_RDTSC 1
+#endif
+
+std::atomic<bool> QProfiler::s_Instrument{false};
+
+static double SteadyMs() {
+  return std::chrono::duration<double, std::milli>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+QProfiler &QProfiler::Get() {
+  static QProfiler profiler;
+  return profiler;
+}
+
+QProfiler::QProfiler() : m_StartClock(ReadClock()), m_StartMs(SteadyMs()) {}
+
+uint64_t QProfiler::ReadClock() {
+#if QPROFILER_RDTSC
+  return __rdtsc();
+#else
+  return static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now().time_since_epoch())
+          .count());
+#endif
+}
+
+double QProfiler::ClockTicksPerMs() const {
+  // Measured over the profiler's lifetime, so the rate gets more exact the
+  // longer the session runs
+  double elapsedMs = SteadyMs() - m_StartMs;
+  uint64_t ticks = ReadClock() - m_StartClock;
+  if (elapsedMs <= 0.0 || ticks == 0)
+    return 1e6;
+  return static_cast<double>(ticks) / elapsedMs;
+}
+
+std::string QProfiler::GetSymbolName(const std::string &className,
+                                     const std::string &methodName) {
+  return SymbolPrefix() + className + "." + methodName;
+}
+
+QProfileCounters *QProfiler::FindCounters(const std::string &symbolName) {
+  std::string prefix = SymbolPrefix();
+  if (symbolName.compare(0, prefix.size(), prefix) != 0)
+    return nullptr;
+
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  auto it = m_BySymbol.find(symbolName);
+  if (it != m_BySymbol.end())
+    return &it->second->counters;
+
+  // Class names never contain '.', mangled method names neither
+  size_t split = symbolName.find('.', prefix.size());
+  if (split == std::string::npos)
+    return nullptr;
+  Entry &entry = m_Entries.emplace_back();
+  entry.className = symbolName.substr(prefix.size(), split - prefix.size());
+  entry.methodName = symbolName.substr(split + 1);
+  m_BySymbol[symbolName] = &entry;
+  return &entry.counters;
+}
+
+std::vector<QProfileSample> QProfiler::Snapshot() const {
+  double ticksPerMs = ClockTicksPerMs();
+
+  std::vector<QProfileSample> samples;
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    for (const auto &entry : m_Entries) {
+      QProfileSample sample;
+      sample.calls = entry.counters.calls.load(std::memory_order_relaxed);
+      if (!sample.calls)
+        continue;
+      sample.className = entry.className;
+      sample.methodName = entry.methodName;
+      sample.cycles = entry.counters.cycles.load(std::memory_order_relaxed);
+      sample.totalMs = static_cast<double>(sample.cycles) / ticksPerMs;
+      samples.push_back(std::move(sample));
+    }
+  }
+
+  std::sort(samples.begin(), samples.end(),
+            [](const QProfileSample &a, const QProfileSample &b) {
+              return a.cycles > b.cycles;
+            });
+  return samples;
+}
+
+void QProfiler::Reset() {
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  for (auto &entry : m_Entries) {
+    entry.counters.calls.store(0, std::memory_order_relaxed);
+    entry.counters.cycles.store(0, std::memory_order_relaxed);
+  }
+}
+
+std::string QProfiler::FormatHotList(size_t count) const {
+  auto samples = Snapshot();
+  std::ostringstream out;
+  if (samples.empty()) {
+    out << "No profile samples (enable instrumentation and recompile)";
+    return out.str();
+  }
+
+  char line[256];
+  std::snprintf(line, sizeof(line), "%10s %10s %10s  %s", "total ms", "calls",
+                "avg us", "method");
+  out << line;
+  for (size_t i = 0; i < samples.size() && i < count; ++i) {
+    const auto &sample = samples[i];
+    std::snprintf(line, sizeof(line), "\n%10.3f %10llu %10.3f  %s.%s",
+                  sample.totalMs,
+                  static_cast<unsigned long long>(sample.calls),
+                  sample.AverageUs(), sample.className.c_str(),
+                  sample.methodName.c_str());
+    out << line;
+  }
+  return out.str();
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Counters of one instrumented method. Compiled code updates them in place
+// (see QJitRunner::InstrumentMethod), so the layout is fixed: two i64s.
+struct QProfileCounters {
+  std::atomic<uint64_t> calls{0};
+  std::atomic<uint64_t> cycles{0}; // Inclusive: callees are counted too
+};
+
+// One row of a profile snapshot
+struct QProfileSample {
+  std::string className;
+  std::string methodName; // Mangled (OnUpdate$float32)
+  uint64_t calls = 0;
+  uint64_t cycles = 0;
+  double totalMs = 0.0;
+
+  double AverageUs() const {
+    return calls ? totalMs * 1000.0 / static_cast<double>(calls) : 0.0;
+  }
+};
+
+// QProfiler - per-method call counts and timing of JIT-compiled script code
+//
+// With instrumentation enabled, QJitRunner adds entry/exit timing to every
+// method it compiles afterwards. Each method refers to its counters through
+// an external symbol (__qprof.<Class>.<Method>) that QJitProgram resolves
+// here, so instrumented module binaries and cached objects stay valid across
+// runs. Times are read with the cycle counter (rdtsc on x86) and converted
+// to milliseconds with a rate measured against the steady clock.
+class QProfiler {
+public:
+  static QProfiler &Get();
+
+  QProfiler(const QProfiler &) = delete;
+  QProfiler &operator=(const QProfiler &) = delete;
+
+  // Instrument methods compiled from now on (off by default). Code compiled
+  // earlier keeps whatever it was compiled with.
+  static void SetInstrumentation(bool enabled) { s_Instrument = enabled; }
+  static bool IsInstrumentationEnabled() { return s_Instrument; }
+
+  // Symbol names of counters, and the lookup used when linking them
+  static const char *SymbolPrefix() { return "__qprof."; }
+  static std::string GetSymbolName(const std::string &className,
+                                   const std::string &methodName);
+  QProfileCounters *FindCounters(const std::string &symbolName);
+
+  // The clock instrumented code reads (also the fallback called by compiled
+  // code on targets without a usable cycle counter)
+  static uint64_t ReadClock();
+
+  // Methods that were called at least once, most expensive first
+  std::vector<QProfileSample> Snapshot() const;
+
+  // Zero all counters (methods stay registered)
+  void Reset();
+
+  // Human-readable top 'count' methods, one line each
+  std::string FormatHotList(size_t count = 10) const;
+
+private:
+  QProfiler();
+
+  double ClockTicksPerMs() const;
+
+  struct Entry {
+    std::string className;
+    std::string methodName;
+    QProfileCounters counters;
+  };
+
+  mutable std::mutex m_Mutex;
+  std::deque<Entry> m_Entries; // Stable addresses; compiled code points here
+  std::unordered_map<std::string, Entry *> m_BySymbol;
+  uint64_t m_StartClock = 0;
+  double m_StartMs = 0.0;
+  static std::atomic<bool> s_Instrument;
+};
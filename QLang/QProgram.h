@@ -4,6 +4,7 @@
 #include "QClass.h"
 #include "QCode.h"
 #include "QEnum.h"
+#include <cstdint>
 #include <iostream>
 #include <memory>
 #include <set>
@@ -42,6 +43,11 @@ public:
 
   const std::vector<std::string> &GetImports() const { return m_Imports; }
 
+  // Hash of every token outside method bodies: equal shapes mean the same
+  // classes, member layouts and method signatures (QJitRunner::PatchScript)
+  void SetShapeHash(uint64_t hash) { m_ShapeHash = hash; }
+  uint64_t GetShapeHash() const { return m_ShapeHash; }
+
   void CheckForErrors(std::shared_ptr<QErrorCollector> collector) override {
     for (const auto &cls : m_Classes) {
       if (cls)
@@ -99,4 +105,5 @@ private:
   std::vector<std::shared_ptr<QEnum>> m_Enums;
   std::vector<std::string> m_Imports;
   std::set<std::string> m_ForwardDeclarations;
+  uint64_t m_ShapeHash = 0;
 };
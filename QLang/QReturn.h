@@ -29,7 +29,7 @@ public:
       std::cout << ": ";
       const auto &elems = m_Expression->GetElements();
       for (const auto &e : elems) {
-        std::cout << e.value << " ";
+        std::cout << e.Text() << " ";
       }
     }
     std::cout << std::endl;
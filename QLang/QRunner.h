@@ -2,6 +2,7 @@
 
 #include "Parser.h"
 #include "QAssign.h"
+#include "QBytecode.h"
 #include "QClassInstance.h"
 #include "QContext.h"
 #include "QError.h"
@@ -13,6 +14,7 @@
 #include "QParameters.h"
 #include "QReturn.h"
 #include "QWhile.h"
+#include <algorithm>
 #include <iostream>
 #include <memory>
 #include <set>
@@ -67,6 +69,8 @@ public:
     }
 
     auto code = program->GetCode();
+    ResolveLocals(code, *m_Context->GetLayout());
+    ResolveSlots(code, m_Context->GetLayout());
     ExecuteCode(code);
 
 #if QLANG_DEBUG
@@ -103,6 +107,10 @@ public:
   // Get the context (for advanced use)
   std::shared_ptr<QContext> GetContext() { return m_Context; }
 
+  // Bytecode can be turned off to compare against the RPN interpreter
+  void SetUseBytecode(bool enabled) { m_UseBytecode = enabled; }
+  bool IsUsingBytecode() const { return m_UseBytecode; }
+
   // Report a runtime error
   void ReportRuntimeError(const std::string &message, int line = 0,
                           int column = 0, int length = 0) {
@@ -175,11 +183,14 @@ public:
         }
       }
 
+      ResolveMemberLayout(cls);
+
       // Check method body references
       for (const auto &method : cls->GetMethods()) {
         if (!ValidateCodeBlock(method->GetBody(), cls)) {
           allValid = false;
         }
+        ResolveFrame(method, cls);
       }
     }
 
@@ -293,6 +304,7 @@ private:
   std::unordered_map<std::string, std::shared_ptr<QClass>> m_Classes;
   bool m_HasReturn = false;
   QValue m_ReturnValue;
+  bool m_UseBytecode = true; // Compile expressions (see EvaluateExpression)
 
   // Error handling
   std::shared_ptr<QErrorCollector> m_ErrorCollector;
@@ -440,8 +452,8 @@ private:
           tokens[i + 1].type == TokenType::T_LPAREN) {
 
         // Collect the full method chain (e.g., "light1.Cam.GetPosition")
-        std::string fullChain = tok.value;
-        std::string methodName = tok.value;
+        std::string fullChain = tok.Text();
+        std::string methodName = tok.Text();
 
         // Look backwards for chained access (identifier.identifier.identifier)
         size_t chainStart = i;
@@ -449,7 +461,7 @@ private:
                tokens[chainStart - 1].type == TokenType::T_DOT &&
                tokens[chainStart - 2].type == TokenType::T_IDENTIFIER) {
           chainStart -= 2;
-          fullChain = tokens[chainStart].value + "." + fullChain;
+          fullChain = tokens[chainStart].Text() + "." + fullChain;
         }
 
         // Now validate: if there's a dot, it's obj.method() style
@@ -842,7 +854,12 @@ private:
     }
 
     // Store in context
-    m_Context->SetVariable(name, value);
+    int slot = varDecl->GetResolvedSlot(m_Context->GetLayout());
+    if (slot >= 0) {
+      m_Context->SetSlot(static_cast<uint32_t>(slot), std::move(value));
+    } else {
+      m_Context->SetVariable(name, value);
+    }
   }
 
   // Internal helper for FindMethod with strict control
@@ -1316,7 +1333,7 @@ private:
 
   // Execute a variable assignment
   void ExecuteAssign(std::shared_ptr<QAssign> assign) {
-    std::string varName = assign->GetVariableName();
+    const std::string &varName = assign->GetVariableName();
 #if QLANG_DEBUG
     std::cout << "[DEBUG] QRunner::ExecuteAssign() - assigning variable: "
               << varName << std::endl;
@@ -1328,7 +1345,11 @@ private:
       newValue = EvaluateExpression(valExpr);
     }
 
-    if (m_Context->HasVariable(varName)) {
+    // Fast path: the variable is assigned in this frame's resolved slot
+    int slot = assign->GetResolvedSlot(m_Context->GetLayout());
+    if (slot >= 0 && m_Context->GetSlot(static_cast<uint32_t>(slot))) {
+      m_Context->SetSlot(static_cast<uint32_t>(slot), std::move(newValue));
+    } else if (m_Context->HasVariable(varName)) {
       m_Context->SetVariable(varName, newValue);
     } else {
       std::cerr << "[ERROR] QRunner::ExecuteAssign() - variable '" << varName
@@ -1525,32 +1546,38 @@ private:
 
     // Create a child context for the method execution
     // This context will have access to instance members as local variables
-    auto methodContext =
-        std::make_shared<QContext>("method:" + method->GetName(), m_Context);
-
-    // Copy instance member variables into the method's local context
-    for (const auto &[memberName, memberValue] : instance->GetMembers()) {
-      // Convert QInstanceValue to QValue
-      QValue qval = ConvertInstanceValueToQValue(memberValue);
-      methodContext->SetVariable(memberName, qval);
-#if QLANG_DEBUG
-      std::cout << "[DEBUG] QRunner::ExecuteMethod() - loaded member: "
-                << memberName << std::endl;
-#endif
+    auto layout = method->GetFrameLayout();
+    if (!layout) {
+      layout = ResolveFrame(method, instance->GetClassDef());
     }
-
-    // Also load nested class instances into the method context
-    // This allows access to nested instance members like ot.check
-    for (const auto &nestedName : instance->GetNestedInstanceNames()) {
-      auto nestedInstance = instance->GetNestedInstance(nestedName);
-      if (nestedInstance) {
-        methodContext->SetVariable(nestedName, nestedInstance);
-#if QLANG_DEBUG
-        std::cout
-            << "[DEBUG] QRunner::ExecuteMethod() - loaded nested instance: "
-            << nestedName << std::endl;
-#endif
-      }
+    auto methodContext =
+        std::make_shared<QContext>(layout->GetName(), m_Context, layout);
+
+    // Copy the instance's members into their frame slots. Members ResolveFrame
+    // bound go slot to slot; members added at runtime, or an instance whose
+    // layout the method was not resolved against, go by name.
+    const auto &memberLayout = *instance->GetMemberLayout();
+    bool bound = memberLayout.Extends(layout->GetMemberLayout());
+    size_t firstUnbound = bound ? layout->GetBoundMemberCount() : 0;
+    // A nested instance that was never created is left out
+    auto loadable = [](const QValue *value) {
+      auto *nested =
+          value ? std::get_if<std::shared_ptr<QClassInstance>>(value) : nullptr;
+      return value && (!nested || *nested);
+    };
+    if (bound) {
+      for (const auto &binding : layout->GetMemberBindings()) {
+        const QValue *value = instance->GetMemberSlot(binding.memberSlot);
+        if (loadable(value))
+          methodContext->SetSlot(binding.frameSlot, *value);
+      }
+    }
+    for (size_t slot = firstUnbound; slot < memberLayout.Size(); ++slot) {
+      auto memberSlot = static_cast<uint32_t>(slot);
+      const QValue *value = instance->GetMemberSlot(memberSlot);
+      if (loadable(value))
+        methodContext->SetVariable(memberLayout.GetSlotName(memberSlot),
+                                   *value);
     }
 
     // Store 'this' reference for the method
@@ -1585,36 +1612,28 @@ private:
     // Execute the method body
     ExecuteCode(method->GetBody());
 
-    // Copy modified values back to the instance
-    // Copy modified values back to the instance
-    auto contextVars = methodContext->GetAllVariables();
-    for (auto const &pair : contextVars) {
-      const std::string &varName = pair.first;
-      const QValue &varValue = pair.second;
-
-      // We only care about variables that actually exist as members on the
-      // instance
-      if (instance->HasMember(varName)) {
-        // Case 1: Value is a class instance (shared_ptr<QClassInstance>)
-        if (std::holds_alternative<std::shared_ptr<QClassInstance>>(varValue)) {
-          instance->SetNestedInstance(
-              varName, std::get<std::shared_ptr<QClassInstance>>(varValue));
-          // Optional: We could remove it from m_Members if it was there,
-          // but HasMember checks both, so this is safe.
-        }
-        // Case 2: Value is a primitive (convertible to QInstanceValue)
-        else {
-          QInstanceValue instVal = ConvertQValueToInstanceValue(varValue);
-          if (!std::holds_alternative<std::monostate>(instVal)) {
-            instance->SetMember(varName, instVal);
-          }
-        }
-#if QLANG_DEBUG
-        std::cout << "[DEBUG] QRunner::ExecuteMethod() - synced: " << varName
-                  << std::endl;
-#endif
+    // Copy modified values back to the instance, the same way. A null is
+    // not written back.
+    auto writeBack = [&](uint32_t memberSlot, const QValue *value) {
+      if (value && !std::holds_alternative<std::monostate>(*value)) {
+        instance->SetMemberSlot(memberSlot, *value);
+      }
+    };
+    if (bound) {
+      for (const auto &binding : layout->GetMemberBindings()) {
+        if (instance->GetMemberSlot(binding.memberSlot))
+          writeBack(binding.memberSlot,
+                    methodContext->GetSlot(binding.frameSlot));
       }
     }
+    for (size_t slot = firstUnbound; slot < memberLayout.Size(); ++slot) {
+      auto memberSlot = static_cast<uint32_t>(slot);
+      const std::string &name = memberLayout.GetSlotName(memberSlot);
+      int frameSlot = methodContext->GetLayout()->Find(name);
+      if (frameSlot >= 0 && instance->GetMemberSlot(memberSlot))
+        writeBack(memberSlot,
+                  methodContext->GetSlot(static_cast<uint32_t>(frameSlot)));
+    }
 
     // Restore original context
     m_Context = savedContext;
@@ -1628,6 +1647,162 @@ private:
 #endif
   }
 
+  // Resolve a method's frame layout: 'this', parameters, members (including
+  // inherited ones) and locals each get a slot, and each member's frame slot
+  // is bound to its instance slot. Done for every method by EnsureNames,
+  // otherwise on the first call.
+  std::shared_ptr<QFrameLayout> ResolveFrame(std::shared_ptr<QMethod> method,
+                                             std::shared_ptr<QClass> classDef) {
+    auto layout =
+        std::make_shared<QFrameLayout>("method:" + method->GetName());
+    layout->Add("__this__");
+    layout->Add("this");
+    for (const auto &param : method->GetParameters()) {
+      layout->Add(param.name);
+    }
+    auto members = ResolveMemberLayout(classDef);
+    std::vector<QFrameLayout::MemberBinding> bindings;
+    for (uint32_t slot = 0; members && slot < members->Size(); ++slot) {
+      bindings.push_back({layout->Add(members->GetSlotName(slot)), slot});
+    }
+    layout->BindMembers(members, std::move(bindings));
+    ResolveLocals(method->GetBody(), *layout);
+    ResolveSlots(method->GetBody(), layout);
+
+    method->SetFrameLayout(layout);
+    return layout;
+  }
+
+  // Resolve the slots of a class's instance members: its parent's members
+  // first, in the parent's slots, then its own. Kept if already resolved.
+  std::shared_ptr<QFrameLayout>
+  ResolveMemberLayout(std::shared_ptr<QClass> cls) {
+    if (!cls) {
+      return nullptr;
+    }
+    std::shared_ptr<QFrameLayout> base;
+    if (cls->HasParent()) {
+      auto parentIt = m_Classes.find(cls->GetParentClassName());
+      if (parentIt != m_Classes.end() && parentIt->second != cls) {
+        base = ResolveMemberLayout(parentIt->second);
+      }
+    }
+    auto layout = cls->GetMemberLayout();
+    if (layout && (!base || layout->Extends(base.get()))) {
+      return layout;
+    }
+    // Instances made before this keep the layout they were made with
+    layout = std::make_shared<QFrameLayout>("members:" + cls->GetName(), base);
+    for (const auto &member : cls->GetMembers()) {
+      layout->Add(member->GetName());
+    }
+    cls->SetMemberLayout(layout);
+    return layout;
+  }
+
+  // Give every variable declared in a code block (and nested blocks) a slot
+  void ResolveLocals(std::shared_ptr<QCode> code, QFrameLayout &layout) {
+    if (!code) {
+      return;
+    }
+    for (const auto &node : code->GetNodes()) {
+      if (auto varDecl = std::dynamic_pointer_cast<QVariableDecl>(node)) {
+        layout.Add(varDecl->GetName());
+      } else if (auto instanceDecl =
+                     std::dynamic_pointer_cast<QInstanceDecl>(node)) {
+        layout.Add(instanceDecl->GetInstanceName());
+      } else if (auto ifStmt = std::dynamic_pointer_cast<QIf>(node)) {
+        ResolveLocals(ifStmt->GetThenBlock(), layout);
+        for (const auto &elseif : ifStmt->GetElseIfBlocks()) {
+          ResolveLocals(elseif.second, layout);
+        }
+        ResolveLocals(ifStmt->GetElseBlock(), layout);
+      } else if (auto whileStmt = std::dynamic_pointer_cast<QWhile>(node)) {
+        ResolveLocals(whileStmt->GetBody(), layout);
+      } else if (auto forStmt = std::dynamic_pointer_cast<QFor>(node)) {
+        layout.Add(forStmt->GetVarName());
+        ResolveLocals(forStmt->GetBody(), layout);
+      }
+    }
+  }
+
+  // Store the slots of a block's variables on its nodes: declarations,
+  // assignments and every expression. Runs after ResolveLocals, so the
+  // layout already has all the locals.
+  void ResolveSlots(std::shared_ptr<QCode> code,
+                    const std::shared_ptr<QFrameLayout> &layout) {
+    if (!code) {
+      return;
+    }
+    auto resolveArgs = [&](const std::shared_ptr<QParameters> &args) {
+      if (args) {
+        for (const auto &arg : args->GetParameters()) {
+          ResolveExpressionSlots(arg, layout);
+        }
+      }
+    };
+    for (const auto &node : code->GetNodes()) {
+      if (auto varDecl = std::dynamic_pointer_cast<QVariableDecl>(node)) {
+        varDecl->SetResolvedSlot(layout, layout->Find(varDecl->GetName()));
+        ResolveExpressionSlots(varDecl->GetInitializer(), layout);
+      } else if (auto instanceDecl =
+                     std::dynamic_pointer_cast<QInstanceDecl>(node)) {
+        ResolveExpressionSlots(instanceDecl->GetInitializerExpression(),
+                               layout);
+        resolveArgs(instanceDecl->GetConstructorArgs());
+      } else if (auto assign = std::dynamic_pointer_cast<QAssign>(node)) {
+        assign->SetResolvedSlot(layout,
+                                layout->Find(assign->GetVariableName()));
+        ResolveExpressionSlots(assign->GetValueExpression(), layout);
+        ResolveExpressionSlots(assign->GetIndexExpression(), layout);
+        for (const auto &element : assign->GetArrayInitializer()) {
+          ResolveExpressionSlots(element, layout);
+        }
+      } else if (auto memberAssign =
+                     std::dynamic_pointer_cast<QMemberAssign>(node)) {
+        ResolveExpressionSlots(memberAssign->GetValueExpression(), layout);
+      } else if (auto methodCall =
+                     std::dynamic_pointer_cast<QMethodCall>(node)) {
+        resolveArgs(methodCall->GetArguments());
+      } else if (auto stmt = std::dynamic_pointer_cast<QStatement>(node)) {
+        resolveArgs(stmt->GetParameters());
+      } else if (auto returnStmt = std::dynamic_pointer_cast<QReturn>(node)) {
+        ResolveExpressionSlots(returnStmt->GetExpression(), layout);
+      } else if (auto ifStmt = std::dynamic_pointer_cast<QIf>(node)) {
+        ResolveExpressionSlots(ifStmt->GetCondition(), layout);
+        ResolveSlots(ifStmt->GetThenBlock(), layout);
+        for (const auto &elseif : ifStmt->GetElseIfBlocks()) {
+          ResolveExpressionSlots(elseif.first, layout);
+          ResolveSlots(elseif.second, layout);
+        }
+        ResolveSlots(ifStmt->GetElseBlock(), layout);
+      } else if (auto whileStmt = std::dynamic_pointer_cast<QWhile>(node)) {
+        ResolveExpressionSlots(whileStmt->GetCondition(), layout);
+        ResolveSlots(whileStmt->GetBody(), layout);
+      } else if (auto forStmt = std::dynamic_pointer_cast<QFor>(node)) {
+        ResolveExpressionSlots(forStmt->GetStart(), layout);
+        ResolveExpressionSlots(forStmt->GetEnd(), layout);
+        ResolveExpressionSlots(forStmt->GetStep(), layout);
+        ResolveSlots(forStmt->GetBody(), layout);
+      }
+    }
+  }
+
+  void ResolveExpressionSlots(const std::shared_ptr<QExpression> &expr,
+                              const std::shared_ptr<QFrameLayout> &layout) {
+    if (!expr) {
+      return;
+    }
+    const auto &elements = expr->GetElements();
+    std::vector<int> slots(elements.size(), -1);
+    for (size_t i = 0; i < elements.size(); ++i) {
+      if (elements[i].type == TokenType::T_IDENTIFIER) {
+        slots[i] = layout->Find(elements[i].Text());
+      }
+    }
+    expr->SetResolvedSlots(layout, std::move(slots));
+  }
+
   // Convert QInstanceValue to QValue
   QValue ConvertInstanceValueToQValue(const QInstanceValue &instVal) {
     if (std::holds_alternative<std::monostate>(instVal))
@@ -1753,7 +1928,7 @@ private:
         // [)]
         if (elements.size() >= 3 && elements[0].type == TokenType::T_NEW &&
             elements[1].type == TokenType::T_IDENTIFIER) {
-          std::string nestedClassName = elements[1].value;
+          std::string nestedClassName = elements[1].Text();
 
 #if QLANG_DEBUG
           std::cout << "[DEBUG] QRunner::InitializeInstanceMembers() - "
@@ -1980,7 +2155,7 @@ private:
            elements[i + 1].type == TokenType::T_LPAREN)) {
 
         bool isStandaloneCall = (elements[i + 1].type == TokenType::T_LPAREN);
-        std::string chain = elements[i].value;
+        std::string chain = elements[i].Text();
         size_t j = i + 1;
 
         if (!isStandaloneCall) {
@@ -1988,7 +2163,7 @@ private:
           while (j + 1 < elements.size() &&
                  elements[j].type == TokenType::T_DOT &&
                  elements[j + 1].type == TokenType::T_IDENTIFIER) {
-            chain += "." + elements[j + 1].value;
+            chain += "." + elements[j + 1].Text();
             j += 2; // Skip dot and identifier
           }
         }
@@ -2010,9 +2185,9 @@ private:
 
             if (balance > 0) {
               if (elements[k].type == TokenType::T_STRING) {
-                fullCall += "\"" + elements[k].value + "\"";
+                fullCall += "\"" + elements[k].Text() + "\"";
               } else {
-                fullCall += elements[k].value;
+                fullCall += elements[k].Text();
               }
             }
             k++;
@@ -2021,28 +2196,28 @@ private:
 
           Token methodCall;
           methodCall.type = hasNew ? TokenType::T_NEW : TokenType::T_IDENTIFIER;
-          methodCall.value = fullCall;
+          methodCall.SetText(fullCall);
           methodCall.line = elements[i].line;
           result.push_back(methodCall);
           i = k - 1; // Position after call
 #if QLANG_DEBUG
           std::cout << "[DEBUG] PreprocessMemberAccess() - "
                     << (hasNew ? "new " : "")
-                    << "method call: " << methodCall.value << std::endl;
+                    << "method call: " << methodCall.Text() << std::endl;
 #endif
         } else {
           // Member access
           Token memberAccess;
           memberAccess.type =
               hasNew ? TokenType::T_NEW : TokenType::T_IDENTIFIER;
-          memberAccess.value = chain;
+          memberAccess.SetText(chain);
           memberAccess.line = elements[i].line;
           result.push_back(memberAccess);
           i = j - 1; // Position at last consumed token
 #if QLANG_DEBUG
           std::cout << "[DEBUG] PreprocessMemberAccess() - "
                     << (hasNew ? "new " : "")
-                    << "combined: " << memberAccess.value << std::endl;
+                    << "combined: " << memberAccess.Text() << std::endl;
 #endif
         }
       } else {
@@ -2050,7 +2225,7 @@ private:
           // new followed by just identifier (no call)
           Token newIdent;
           newIdent.type = TokenType::T_NEW;
-          newIdent.value = elements[i].value;
+          newIdent.symbol = elements[i].symbol;
           newIdent.line = elements[i].line;
           result.push_back(newIdent);
         } else {
@@ -2062,8 +2237,9 @@ private:
     return result;
   }
 
-  // Evaluate an expression using Shunting Yard algorithm for operator
-  // precedence
+  // Evaluate an expression. Expressions are compiled to register bytecode on
+  // first use (see QBytecode.h); the RPN interpreter below is the fallback
+  // for expressions the compiler rejects and when bytecode is disabled.
   QValue EvaluateExpression(std::shared_ptr<QExpression> expr) {
     const auto &rawElements = expr->GetElements();
 
@@ -2071,6 +2247,23 @@ private:
       return std::monostate{};
     }
 
+    if (m_UseBytecode) {
+      auto code = expr->GetCompiledCode();
+      if (!code) {
+        code = CompileExpressionCode(*expr);
+        expr->SetCompiledCode(code);
+      }
+      if (code->valid) {
+        return RunExprCode(*code);
+      }
+    }
+
+    return EvaluateRPN(ExpressionToRPN(rawElements));
+  }
+
+  // Preprocess expression tokens (member access, unary minus) and convert
+  // them to RPN with the Shunting Yard algorithm
+  std::vector<Token> ExpressionToRPN(const std::vector<Token> &rawElements) {
     // Preprocess to combine member access patterns (t1.num -> single token)
     std::vector<Token> elements = PreprocessMemberAccess(rawElements);
 
@@ -2081,7 +2274,7 @@ private:
       const Token &token = elements[i];
 
       // Check if this is a unary minus
-      if (token.type == TokenType::T_OPERATOR && token.value == "-") {
+      if (token.type == TokenType::T_OPERATOR && token.Text() == "-") {
         bool isUnary = false;
 
         // Unary if at start of expression
@@ -2102,24 +2295,24 @@ private:
           if (next.type == TokenType::T_INTEGER) {
             Token negativeToken;
             negativeToken.type = TokenType::T_INTEGER;
-            negativeToken.value = "-" + next.value;
+            negativeToken.SetText("-" + next.Text());
             negativeToken.line = token.line;
             processedElements.push_back(negativeToken);
             i++; // Skip the number we just consumed
 #if QLANG_DEBUG
             std::cout << "[DEBUG] EvaluateExpression() - combined unary minus: "
-                      << negativeToken.value << std::endl;
+                      << negativeToken.Text() << std::endl;
 #endif
             continue;
           } else if (next.type == TokenType::T_FLOAT) {
             Token negativeToken;
             negativeToken.type = TokenType::T_FLOAT;
-            negativeToken.value = "-" + next.value;
+            negativeToken.SetText("-" + next.Text());
             negativeToken.line = token.line;
             processedElements.push_back(negativeToken);
             i++; // Skip the number we just consumed
             std::cout << "[DEBUG] EvaluateExpression() - combined unary minus: "
-                      << negativeToken.value << std::endl;
+                      << negativeToken.Text() << std::endl;
             continue;
           }
         }
@@ -2129,9 +2322,8 @@ private:
     }
     elements = processedElements;
 
-    // Single token - just return its value
     if (elements.size() == 1) {
-      return TokenToValue(elements[0]);
+      return elements;
     }
 
 #if QLANG_DEBUG
@@ -2166,11 +2358,11 @@ private:
         while (!operatorStack.empty() &&
                operatorStack.back().type != TokenType::T_LPAREN) {
           const auto &top = operatorStack.back();
-          int topPrec = GetPrecedence(top.value);
-          int curPrec = GetPrecedence(token.value);
+          int topPrec = GetPrecedence(top.Text());
+          int curPrec = GetPrecedence(token.Text());
 
-          if ((IsLeftAssociative(token.value) && curPrec <= topPrec) ||
-              (!IsLeftAssociative(token.value) && curPrec < topPrec)) {
+          if ((IsLeftAssociative(token.Text()) && curPrec <= topPrec) ||
+              (!IsLeftAssociative(token.Text()) && curPrec < topPrec)) {
             outputQueue.push_back(top);
             operatorStack.pop_back();
           } else {
@@ -2194,11 +2386,16 @@ private:
 #if QLANG_DEBUG
     std::cout << "[DEBUG] RPN: ";
     for (const auto &t : outputQueue) {
-      std::cout << t.value << " ";
+      std::cout << t.Text() << " ";
     }
     std::cout << std::endl;
 #endif
 
+    return outputQueue;
+  }
+
+  // Evaluate an RPN token sequence directly
+  QValue EvaluateRPN(const std::vector<Token> &outputQueue) {
     // Evaluate RPN
     std::vector<QValue> valueStack;
 
@@ -2207,7 +2404,7 @@ private:
         // Pop two operands
         if (valueStack.size() < 2) {
           std::cerr << "[ERROR] Not enough operands for operator: "
-                    << token.value << std::endl;
+                    << token.Text() << std::endl;
           return std::monostate{};
         }
         QValue right = valueStack.back();
@@ -2216,12 +2413,12 @@ private:
         valueStack.pop_back();
 
         // Apply operator
-        QValue result = ApplyOperator(left, token.value, right);
+        QValue result = ApplyOperator(left, token.Text(), right);
         valueStack.push_back(result);
 
 #if QLANG_DEBUG
         std::cout << "[DEBUG] RPN eval: " << ValueToString(left) << " "
-                  << token.value << " " << ValueToString(right) << " = "
+                  << token.Text() << " " << ValueToString(right) << " = "
                   << ValueToString(result) << std::endl;
 #endif
       } else {
@@ -2244,6 +2441,303 @@ private:
     return result;
   }
 
+  // Compile an expression to register bytecode. Operands map to the register
+  // of their RPN stack depth; operators fold the top two registers into one.
+  std::shared_ptr<const QExprCode>
+  CompileExpressionCode(const QExpression &expr) {
+    auto code = std::make_shared<QExprCode>();
+    code->layout = expr.GetResolvedLayout();
+    std::vector<Token> rpn = ExpressionToRPN(expr.GetElements());
+
+    // Slot ResolveSlots gave a variable of the expression, -1 if none
+    auto resolvedSlot = [&](const std::string &name) {
+      const auto &elements = expr.GetElements();
+      const auto &slots = expr.GetResolvedSlots();
+      for (size_t i = 0; i < slots.size() && i < elements.size(); ++i) {
+        if (slots[i] >= 0 && elements[i].Text() == name)
+          return slots[i];
+      }
+      return -1;
+    };
+
+    uint16_t depth = 0;
+    for (const auto &token : rpn) {
+      QInstr instr;
+      if (token.type == TokenType::T_OPERATOR) {
+        if (depth < 2) {
+          return code; // Not enough operands: leave it to the RPN evaluator
+        }
+        instr.op = QExprCode::OpcodeFor(token.Text());
+        instr.dst = depth - 2;
+        instr.a = depth - 2;
+        instr.b = depth - 1;
+        if (instr.op == QOp::Generic) {
+          instr.operand = static_cast<uint32_t>(code->operators.size());
+          code->operators.push_back(token.Text());
+        }
+        depth--;
+      } else {
+        instr.dst = depth;
+        switch (token.type) {
+        case TokenType::T_INTEGER:
+        case TokenType::T_FLOAT:
+        case TokenType::T_STRING:
+        case TokenType::T_TRUE:
+        case TokenType::T_FALSE:
+        case TokenType::T_NULL:
+          // Literals are converted once, here
+          instr.op = QOp::LoadConst;
+          instr.operand = static_cast<uint32_t>(code->constants.size());
+          code->constants.push_back(TokenToValue(token));
+          break;
+        default:
+          bool plainVariable = token.type == TokenType::T_IDENTIFIER &&
+                               token.Text().find('.') == std::string::npos &&
+                               token.Text().find('(') == std::string::npos;
+          instr.op = plainVariable ? QOp::LoadVar : QOp::EvalToken;
+          instr.operand = static_cast<uint32_t>(code->tokens.size());
+          if (plainVariable && code->tokens.size() <= UINT16_MAX) {
+            // Locals, parameters and members resolved by ResolveSlots
+            int slot = resolvedSlot(token.Text());
+            if (slot >= 0) {
+              instr.op = QOp::LoadSlot;
+              instr.a = static_cast<uint16_t>(code->tokens.size());
+              instr.operand = static_cast<uint32_t>(slot);
+            }
+          }
+          code->tokens.push_back(token);
+          break;
+        }
+        depth++;
+        code->registerCount = std::max(code->registerCount, depth);
+      }
+      code->code.push_back(instr);
+    }
+
+    if (depth == 0) {
+      return code;
+    }
+
+    QInstr ret;
+    ret.op = QOp::Return;
+    ret.a = depth - 1;
+    code->code.push_back(ret);
+    code->valid = true;
+    return code;
+  }
+
+  // Inline evaluation of an operator on same-typed int32, float or bool
+  // operands. Returns false when ApplyOperator is needed; the results match
+  // it exactly (int math in 64 bits, float math in double).
+  static bool FastBinary(QOp op, const QValue &left, const QValue &right,
+                         QValue &out) {
+    if (left.index() != right.index()) {
+      return false;
+    }
+    if (const int32_t *pl = std::get_if<int32_t>(&left)) {
+      int64_t l = *pl;
+      int64_t r = std::get<int32_t>(right);
+      switch (op) {
+      case QOp::Add:
+        out = static_cast<int32_t>(l + r);
+        return true;
+      case QOp::Sub:
+        out = static_cast<int32_t>(l - r);
+        return true;
+      case QOp::Mul:
+        out = static_cast<int32_t>(l * r);
+        return true;
+      case QOp::Div:
+        out = r != 0 ? static_cast<int32_t>(l / r) : 0;
+        return true;
+      case QOp::Eq:
+        out = l == r;
+        return true;
+      case QOp::Ne:
+        out = l != r;
+        return true;
+      case QOp::Lt:
+        out = l < r;
+        return true;
+      case QOp::Gt:
+        out = l > r;
+        return true;
+      case QOp::Le:
+        out = l <= r;
+        return true;
+      case QOp::Ge:
+        out = l >= r;
+        return true;
+      default:
+        return false;
+      }
+    }
+    if (const float *pl = std::get_if<float>(&left)) {
+      double l = *pl;
+      double r = std::get<float>(right);
+      switch (op) {
+      case QOp::Add:
+        out = static_cast<float>(l + r);
+        return true;
+      case QOp::Sub:
+        out = static_cast<float>(l - r);
+        return true;
+      case QOp::Mul:
+        out = static_cast<float>(l * r);
+        return true;
+      case QOp::Div:
+        out = r != 0.0 ? static_cast<float>(l / r) : 0.0f;
+        return true;
+      case QOp::Eq:
+        out = l == r;
+        return true;
+      case QOp::Ne:
+        out = l != r;
+        return true;
+      case QOp::Lt:
+        out = l < r;
+        return true;
+      case QOp::Gt:
+        out = l > r;
+        return true;
+      case QOp::Le:
+        out = l <= r;
+        return true;
+      case QOp::Ge:
+        out = l >= r;
+        return true;
+      default:
+        return false;
+      }
+    }
+    if (const bool *pl = std::get_if<bool>(&left)) {
+      bool l = *pl;
+      bool r = std::get<bool>(right);
+      switch (op) {
+      case QOp::Eq:
+        out = l == r;
+        return true;
+      case QOp::Ne:
+        out = l != r;
+        return true;
+      case QOp::And:
+        out = l && r;
+        return true;
+      case QOp::Or:
+        out = l || r;
+        return true;
+      default:
+        return false;
+      }
+    }
+    return false;
+  }
+
+  // Run compiled expression bytecode. Dispatch uses computed goto on
+  // GCC/Clang and a switch loop elsewhere.
+  QValue RunExprCode(const QExprCode &code) {
+    QValue inlineRegs[QExprCode::InlineRegisters];
+    std::vector<QValue> heapRegs;
+    QValue *r = inlineRegs;
+    if (code.registerCount > QExprCode::InlineRegisters) {
+      heapRegs.resize(code.registerCount);
+      r = heapRegs.data();
+    }
+
+    const QInstr *ip = code.code.data();
+
+#if defined(__GNUC__) || defined(__clang__)
+    static const void *const dispatch[] = {
+        &&op_LoadConst, &&op_LoadVar, &&op_LoadSlot, &&op_EvalToken,
+        &&op_Add,       &&op_Sub,     &&op_Mul,      &&op_Div,
+        &&op_Eq,        &&op_Ne,      &&op_Lt,       &&op_Gt,
+        &&op_Le,        &&op_Ge,      &&op_And,      &&op_Or,
+        &&op_Generic,   &&op_Return};
+    static_assert(sizeof(dispatch) / sizeof(dispatch[0]) ==
+                      static_cast<size_t>(QOp::Count),
+                  "dispatch table out of sync with QOp");
+#define QBC_OP(name) op_##name:
+#define QBC_NEXT() goto *dispatch[static_cast<size_t>((++ip)->op)]
+    goto *dispatch[static_cast<size_t>(ip->op)];
+#else
+#define QBC_OP(name) case QOp::name:
+#define QBC_NEXT()                                                             \
+  ++ip;                                                                        \
+  continue
+    for (;;) {
+      switch (ip->op) {
+#endif
+
+#define QBC_BINARY(name)                                                       \
+  QBC_OP(name) {                                                               \
+    if (!FastBinary(QOp::name, r[ip->a], r[ip->b], r[ip->dst])) {              \
+      r[ip->dst] = ApplyOperator(r[ip->a],                                     \
+                                 QExprCode::OperatorText(QOp::name),           \
+                                 r[ip->b]);                                    \
+    }                                                                          \
+    QBC_NEXT();                                                                \
+  }
+
+    QBC_OP(LoadConst) {
+      r[ip->dst] = code.constants[ip->operand];
+      QBC_NEXT();
+    }
+    QBC_OP(LoadVar) {
+      const Token &token = code.tokens[ip->operand];
+      if (const QValue *value = m_Context->FindVariable(token.Text())) {
+        r[ip->dst] = *value;
+      } else {
+        r[ip->dst] = TokenToValue(token); // Reports the unknown variable
+      }
+      QBC_NEXT();
+    }
+    QBC_OP(LoadSlot) {
+      const QValue *value = nullptr;
+      if (m_Context->GetLayout() == code.layout) {
+        value = m_Context->GetSlot(ip->operand);
+      }
+      if (!value) {
+        // Not assigned in this frame (a global, or not declared yet)
+        value = m_Context->FindVariable(code.tokens[ip->a].Text());
+      }
+      r[ip->dst] = value ? *value : TokenToValue(code.tokens[ip->a]);
+      QBC_NEXT();
+    }
+    QBC_OP(EvalToken) {
+      r[ip->dst] = TokenToValue(code.tokens[ip->operand]);
+      QBC_NEXT();
+    }
+    QBC_BINARY(Add)
+    QBC_BINARY(Sub)
+    QBC_BINARY(Mul)
+    QBC_BINARY(Div)
+    QBC_BINARY(Eq)
+    QBC_BINARY(Ne)
+    QBC_BINARY(Lt)
+    QBC_BINARY(Gt)
+    QBC_BINARY(Le)
+    QBC_BINARY(Ge)
+    QBC_BINARY(And)
+    QBC_BINARY(Or)
+    QBC_OP(Generic) {
+      r[ip->dst] =
+          ApplyOperator(r[ip->a], code.operators[ip->operand], r[ip->b]);
+      QBC_NEXT();
+    }
+    QBC_OP(Return) { return std::move(r[ip->a]); }
+
+#if !(defined(__GNUC__) || defined(__clang__))
+      default:
+        return std::monostate{};
+      }
+    }
+#endif
+
+#undef QBC_BINARY
+#undef QBC_NEXT
+#undef QBC_OP
+  }
+
   // Apply an operator to two values
   QValue ApplyOperator(const QValue &left, const std::string &op,
                        const QValue &right) {
@@ -2466,17 +2960,17 @@ private:
       // Check for method call (e.g., "t1.GetValue()" or "t1.ot.GetValue()" or
       // "method(1,2)")
       // We look for trailing ')'
-      if (token.value.size() > 2 && token.value.back() == ')') {
+      if (token.Text().size() > 2 && token.Text().back() == ')') {
         // This is a method call - parse instance.path.method(args)
-        size_t openParen = token.value.find('(');
+        size_t openParen = token.Text().find('(');
         if (openParen == std::string::npos) {
           // Should not happen if PreprocessMemberAccess works right
           return std::monostate{};
         }
 
-        std::string pathAndMethod = token.value.substr(0, openParen);
-        std::string argsStr = token.value.substr(
-            openParen + 1, token.value.size() - openParen - 2);
+        std::string pathAndMethod = token.Text().substr(0, openParen);
+        std::string argsStr = token.Text().substr(
+            openParen + 1, token.Text().size() - openParen - 2);
 
         // Parse arguments
         std::vector<QValue> argValues;
@@ -2561,7 +3055,7 @@ private:
           if (!m_Context->HasVariable(firstName)) {
             // Note: We don't have token for firstName here easily unless we
             // track it
-            ReportRuntimeError("unknown variable '" + token.value + "'");
+            ReportRuntimeError("unknown variable '" + token.Text() + "'");
             return std::monostate{};
           }
 
@@ -2678,20 +3172,20 @@ private:
       if (isNew) {
         // new ClassName without parens? (e.g. new Vec3)
         // We support this as empty arg constructor call
-        if (m_Classes.find(token.value) != m_Classes.end()) {
-          return CreateInstance(token.value, {});
+        if (m_Classes.find(token.Text()) != m_Classes.end()) {
+          return CreateInstance(token.Text(), {});
         }
-        ReportRuntimeError("unknown class for 'new': " + token.value);
+        ReportRuntimeError("unknown class for 'new': " + token.Text());
         return std::monostate{};
       }
 
       // Check for member access (e.g., "t1.num" or "t1.ot.check")
-      size_t dotPos = token.value.find('.');
+      size_t dotPos = token.Text().find('.');
       if (dotPos != std::string::npos) {
         // Split full path by dots
         std::vector<std::string> parts;
         std::string current;
-        for (char c : token.value) {
+        for (char c : token.Text()) {
           if (c == '.') {
             if (!current.empty()) {
               parts.push_back(current);
@@ -2707,7 +3201,7 @@ private:
 
         if (parts.size() < 2) {
           std::cerr << "[ERROR] TokenToValue() - invalid member access: "
-                    << token.value << std::endl;
+                    << token.Text() << std::endl;
           return std::monostate{};
         }
 
@@ -2722,7 +3216,7 @@ private:
         if (!m_Context->HasVariable(instanceName)) {
           ReportRuntimeError("unknown variable '" + instanceName + "'",
                              token.line, token.column,
-                             static_cast<int>(token.value.length()));
+                             static_cast<int>(token.Text().length()));
           return std::monostate{};
         }
 
@@ -2731,7 +3225,7 @@ private:
                 instanceVal)) {
           ReportRuntimeError("'" + instanceName + "' is not a class instance",
                              token.line, token.column,
-                             static_cast<int>(token.value.length()));
+                             static_cast<int>(token.Text().length()));
           return std::monostate{};
         }
 
@@ -2769,37 +3263,37 @@ private:
       }
 
       // Regular variable lookup
-      if (m_Context->HasVariable(token.value)) {
-        return m_Context->GetVariable(token.value);
+      if (m_Context->HasVariable(token.Text())) {
+        return m_Context->GetVariable(token.Text());
       } else {
-        ReportRuntimeError("unknown variable '" + token.value + "'", token.line,
-                           token.column,
-                           static_cast<int>(token.value.length()));
+        ReportRuntimeError("unknown variable '" + token.Text() + "'",
+                           token.line, token.column,
+                           static_cast<int>(token.Text().length()));
         return std::monostate{};
       }
     }
 
     case TokenType::T_INTEGER:
       try {
-        if (token.value.find("0x") == 0 || token.value.find("0X") == 0) {
-          return static_cast<int32_t>(std::stoll(token.value, nullptr, 16));
+        if (token.Text().find("0x") == 0 || token.Text().find("0X") == 0) {
+          return static_cast<int32_t>(std::stoll(token.Text(), nullptr, 16));
         }
-        return std::stoi(token.value);
+        return std::stoi(token.Text());
       } catch (...) {
         try {
-          return static_cast<int64_t>(std::stoll(token.value));
+          return static_cast<int64_t>(std::stoll(token.Text()));
         } catch (...) {
           return 0;
         }
       }
     case TokenType::T_FLOAT:
       try {
-        return std::stof(token.value);
+        return std::stof(token.Text());
       } catch (...) {
         return 0.0f;
       }
     case TokenType::T_STRING:
-      return token.value;
+      return token.Text();
     case TokenType::T_TRUE:
       return true;
     case TokenType::T_FALSE:
@@ -2807,7 +3301,7 @@ private:
     case TokenType::T_NULL:
       return std::monostate{};
     default:
-      return token.value; // Return as string
+      return token.Text(); // Return as string
     }
   }
 
@@ -0,0 +1,143 @@
+#include "QRuntimeBuiltins.h"
+#include "QCoroutineScheduler.h"
+#include "QHeap.h"
+#include "QNativeSymbols.h"
+#include "QProfiler.h"
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+
+// ============================================================================
+// Built-in Native Functions for QLang
+// ============================================================================
+
+// Native printf for QLang scripts
+extern "C" void LV_printf(const char *fmt, ...) {
+  va_list args;
+  va_start(args, fmt);
+  vprintf(fmt, args);
+  va_end(args);
+  printf("\n");
+}
+
+// Managed allocation for 'new' (instances and arrays), see QHeap
+extern "C" void *LV_alloc(int64_t size) {
+  return QHeap::Get().AllocObject(static_cast<size_t>(size));
+}
+
+// Coroutine frames (yield/wait/waitUntil), see QCoroutineScheduler
+extern "C" void *LV_coro_alloc(int64_t size) {
+  return QHeap::Get().AllocObject(static_cast<size_t>(size));
+}
+
+extern "C" void LV_coro_yield(void *frame, void *owner) {
+  QCoroutineScheduler::Get().ScheduleNextFrame(frame, owner);
+}
+
+extern "C" void LV_coro_wait(void *frame, void *owner, float seconds) {
+  QCoroutineScheduler::Get().ScheduleAfter(frame, owner, seconds);
+}
+
+// Profiler clock for targets where instrumented code cannot read the cycle
+// counter itself
+extern "C" uint64_t LV_profile_clock() { return QProfiler::ReadClock(); }
+
+// String concatenation for QLang
+extern "C" char *LV_str_concat(const char *s1, const char *s2) {
+  if (!s1)
+    s1 = "";
+  if (!s2)
+    s2 = "";
+  size_t len1 = strlen(s1);
+  size_t len2 = strlen(s2);
+  char *result = QHeap::Get().AllocString(len1 + len2 + 1);
+  memcpy(result, s1, len1);
+  memcpy(result + len1, s2, len2 + 1);
+  return result;
+}
+
+// ToString helper functions for runtime conversion
+extern "C" char *LV_int32_to_string(int32_t value) {
+  char *result = QHeap::Get().AllocString(16);
+  snprintf(result, 16, "%d", value);
+  return result;
+}
+
+extern "C" char *LV_int64_to_string(int64_t value) {
+  char *result = QHeap::Get().AllocString(24);
+  snprintf(result, 24, "%lld", value);
+  return result;
+}
+
+extern "C" char *LV_float32_to_string(float value) {
+  char *result = QHeap::Get().AllocString(24);
+  snprintf(result, 24, "%g", value);
+  return result;
+}
+
+extern "C" char *LV_float64_to_string(double value) {
+  char *result = QHeap::Get().AllocString(32);
+  snprintf(result, 32, "%g", value);
+  return result;
+}
+
+extern "C" char *LV_bool_to_string(int8_t value) {
+  const char *text = value ? "true" : "false";
+  char *result = QHeap::Get().AllocString(strlen(text) + 1);
+  strcpy(result, text);
+  return result;
+}
+
+// String-to-number conversion functions (for ToInt/ToFloat methods)
+extern "C" int32_t LV_string_to_int32(const char *str) {
+  if (!str)
+    return 0;
+  return (int32_t)atoi(str);
+}
+
+extern "C" int64_t LV_string_to_int64(const char *str) {
+  if (!str)
+    return 0;
+  return (int64_t)atoll(str);
+}
+
+extern "C" float LV_string_to_float32(const char *str) {
+  if (!str)
+    return 0.0f;
+  return (float)atof(str);
+}
+
+extern "C" double LV_string_to_float64(const char *str) {
+  if (!str)
+    return 0.0;
+  return atof(str);
+}
+
+// ============================================================================
+// Registration
+// ============================================================================
+
+void QRegisterRuntimeBuiltins() {
+  static std::once_flag registered;
+  std::call_once(registered, [] {
+    auto &symbols = QNativeSymbols::Get();
+    symbols.Add("qprintf", (void *)LV_printf);
+    symbols.Add("qlang_alloc", (void *)LV_alloc);
+    symbols.Add("qlang_coro_alloc", (void *)LV_coro_alloc);
+    symbols.Add("qlang_coro_yield", (void *)LV_coro_yield);
+    symbols.Add("qlang_coro_wait", (void *)LV_coro_wait);
+    symbols.Add("qlang_profile_clock", (void *)LV_profile_clock);
+    symbols.Add("string_concat", (void *)LV_str_concat);
+    symbols.Add("__int32_to_string", (void *)LV_int32_to_string);
+    symbols.Add("__int64_to_string", (void *)LV_int64_to_string);
+    symbols.Add("__float32_to_string", (void *)LV_float32_to_string);
+    symbols.Add("__float64_to_string", (void *)LV_float64_to_string);
+    symbols.Add("__bool_to_string", (void *)LV_bool_to_string);
+    symbols.Add("__string_to_int32", (void *)LV_string_to_int32);
+    symbols.Add("__string_to_int64", (void *)LV_string_to_int64);
+    symbols.Add("__string_to_float32", (void *)LV_string_to_float32);
+    symbols.Add("__string_to_float64", (void *)LV_string_to_float64);
+  });
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstdint>
+
+// Runtime side of the QLang built-ins: the functions compiled scripts call
+// for allocation, coroutines, profiling, strings and conversions.
+// QLVMContext declares them to the JIT under their script names; native
+// libraries (QNativeLibrary) import them by the same names. No LLVM here,
+// so these are part of the QLangRuntime library.
+
+extern "C" {
+void LV_printf(const char *fmt, ...);
+void *LV_alloc(int64_t size);
+void *LV_coro_alloc(int64_t size);
+void LV_coro_yield(void *frame, void *owner);
+void LV_coro_wait(void *frame, void *owner, float seconds);
+uint64_t LV_profile_clock();
+char *LV_str_concat(const char *s1, const char *s2);
+char *LV_int32_to_string(int32_t value);
+char *LV_int64_to_string(int64_t value);
+char *LV_float32_to_string(float value);
+char *LV_float64_to_string(double value);
+char *LV_bool_to_string(int8_t value);
+int32_t LV_string_to_int32(const char *str);
+int64_t LV_string_to_int64(const char *str);
+float LV_string_to_float32(const char *str);
+double LV_string_to_float64(const char *str);
+}
+
+// Add the built-ins to QNativeSymbols under their script names (once)
+void QRegisterRuntimeBuiltins();
@@ -0,0 +1,197 @@
+#include "QScriptGraph.h"
+#include "Parser.h"
+#include "QError.h"
+#include "QProgram.h"
+#include "Tokenizer.h"
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <thread>
+
+size_t QScriptGraph::AddScript(const std::string &path) {
+  std::string name = std::filesystem::path(path).stem().string();
+  auto it = m_Index.find(name);
+  if (it != m_Index.end()) {
+    return it->second;
+  }
+
+  QScriptNode node;
+  node.name = name;
+  node.path = path;
+  node.errors = std::make_shared<QErrorCollector>();
+  m_Index.emplace(name, m_Nodes.size());
+  m_Nodes.push_back(std::move(node));
+  return m_Nodes.size() - 1;
+}
+
+int QScriptGraph::Find(const std::string &name) const {
+  auto it = m_Index.find(name);
+  return it != m_Index.end() ? static_cast<int>(it->second) : -1;
+}
+
+void QScriptGraph::ParseNode(QScriptNode &node) {
+  Tokenizer tokenizer(node.path, node.errors);
+  tokenizer.Tokenize();
+  if (!node.errors->HasErrors()) {
+    for (const auto &token : tokenizer.GetTokens()) {
+      if (token.type == TokenType::T_IDENTIFIER)
+        node.identifiers.insert(token.Text());
+    }
+    Parser parser(tokenizer.TakeTokens(), node.errors);
+    node.program = parser.Parse();
+    if (node.program) {
+      node.imports = node.program->GetImports();
+    }
+  }
+  node.parsed = true;
+}
+
+void QScriptGraph::Parse(const std::string &basePath, unsigned threads) {
+  // Imports discovered in one round are parsed in the next, until the graph
+  // is closed over everything reachable under basePath
+  while (true) {
+    std::vector<size_t> pending;
+    for (size_t i = 0; i < m_Nodes.size(); ++i) {
+      if (!m_Nodes[i].parsed)
+        pending.push_back(i);
+    }
+    if (pending.empty())
+      break;
+
+    // m_Nodes does not grow while workers hold references into it
+    ParallelFor(pending, threads,
+                [this](size_t index) { ParseNode(m_Nodes[index]); });
+
+    for (size_t index : pending) {
+      for (const auto &import : m_Nodes[index].imports) {
+        if (m_Index.count(import))
+          continue;
+        std::filesystem::path source =
+            std::filesystem::path(basePath) / (import + ".q");
+        if (std::filesystem::exists(source)) {
+          AddScript(source.string());
+        }
+      }
+    }
+  }
+
+  for (auto &node : m_Nodes) {
+    node.dependencies.clear();
+    for (const auto &import : node.imports) {
+      int dep = Find(import);
+      if (dep >= 0 && m_Nodes[dep].name != node.name) {
+        node.dependencies.push_back(static_cast<size_t>(dep));
+      }
+    }
+  }
+}
+
+void QScriptGraph::AddClassDependencies() {
+  std::unordered_map<std::string, size_t> declaredIn;
+  for (size_t i = 0; i < m_Nodes.size(); ++i) {
+    if (!m_Nodes[i].program)
+      continue;
+    for (const auto &cls : m_Nodes[i].program->GetClasses()) {
+      declaredIn.emplace(cls->GetName(), i);
+    }
+  }
+
+  for (size_t i = 0; i < m_Nodes.size(); ++i) {
+    QScriptNode &node = m_Nodes[i];
+    for (const auto &name : node.identifiers) {
+      auto it = declaredIn.find(name);
+      if (it == declaredIn.end() || it->second == i)
+        continue;
+      if (std::find(node.dependencies.begin(), node.dependencies.end(),
+                    it->second) == node.dependencies.end()) {
+        node.dependencies.push_back(it->second);
+      }
+    }
+  }
+}
+
+bool QScriptGraph::BuildWaves(std::vector<std::vector<size_t>> &waves,
+                              std::string *cycle) const {
+  waves.clear();
+
+  // Kahn's algorithm, one wave per round
+  std::vector<size_t> remaining(m_Nodes.size());
+  std::vector<std::vector<size_t>> dependents(m_Nodes.size());
+  for (size_t i = 0; i < m_Nodes.size(); ++i) {
+    remaining[i] = m_Nodes[i].dependencies.size();
+    for (size_t dep : m_Nodes[i].dependencies) {
+      dependents[dep].push_back(i);
+    }
+  }
+
+  std::vector<size_t> ready;
+  for (size_t i = 0; i < m_Nodes.size(); ++i) {
+    if (remaining[i] == 0)
+      ready.push_back(i);
+  }
+
+  size_t placed = 0;
+  while (!ready.empty()) {
+    std::vector<size_t> next;
+    for (size_t index : ready) {
+      for (size_t dependent : dependents[index]) {
+        if (--remaining[dependent] == 0)
+          next.push_back(dependent);
+      }
+    }
+    placed += ready.size();
+    waves.push_back(std::move(ready));
+    ready = std::move(next);
+  }
+
+  if (placed == m_Nodes.size())
+    return true;
+
+  if (cycle) {
+    cycle->clear();
+    for (size_t i = 0; i < m_Nodes.size(); ++i) {
+      if (remaining[i] == 0)
+        continue;
+      if (!cycle->empty())
+        *cycle += ", ";
+      *cycle += m_Nodes[i].name;
+    }
+  }
+  return false;
+}
+
+unsigned QScriptGraph::DefaultThreadCount() {
+  return std::max(1u, std::thread::hardware_concurrency());
+}
+
+void QScriptGraph::ParallelFor(const std::vector<size_t> &items,
+                               unsigned threads,
+                               const std::function<void(size_t)> &fn) {
+  if (threads == 0)
+    threads = DefaultThreadCount();
+  threads = static_cast<unsigned>(
+      std::min<size_t>(threads, items.size()));
+
+  if (threads <= 1) {
+    for (size_t item : items)
+      fn(item);
+    return;
+  }
+
+  std::atomic<size_t> next{0};
+  auto worker = [&]() {
+    for (size_t i = next++; i < items.size(); i = next++) {
+      fn(items[i]);
+    }
+  };
+
+  std::vector<std::thread> pool;
+  pool.reserve(threads - 1);
+  for (unsigned t = 1; t < threads; ++t) {
+    pool.emplace_back(worker);
+  }
+  worker(); // The calling thread takes a share too
+  for (auto &thread : pool) {
+    thread.join();
+  }
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class QProgram;
+class QErrorCollector;
+
+// One script in a QScriptGraph
+struct QScriptNode {
+  std::string name; // Module name (file stem)
+  std::string path;
+  std::vector<std::string> imports;
+  std::vector<size_t> dependencies; // Imported scripts that are in the graph
+  std::set<std::string> identifiers; // Every name the script mentions
+  std::shared_ptr<QProgram> program;
+  std::shared_ptr<QErrorCollector> errors; // Per script, filled by workers
+  bool parsed = false;
+};
+
+// QScriptGraph - import graph of a set of scripts
+//
+// Scripts are tokenized and parsed across worker threads (each with its own
+// Parser arena and error collector), then ordered into waves: every script in
+// a wave only imports scripts from earlier waves, so a wave can be compiled
+// in parallel once the previous one is done.
+class QScriptGraph {
+public:
+  // Add a script by path; a script whose module name is already in the graph
+  // returns the existing index
+  size_t AddScript(const std::string &path);
+
+  // Parse every script not parsed yet. Imports that resolve to
+  // basePath/<name>.q are added to the graph and parsed as well.
+  void Parse(const std::string &basePath, unsigned threads = 0);
+
+  // Scripts also depend on the scripts declaring classes they name. Engine
+  // scripts use each other's classes without an import.
+  void AddClassDependencies();
+
+  // Group the scripts into dependency waves. Returns false if the imports
+  // form a cycle; 'cycle' then names the scripts involved and 'waves' holds
+  // the scripts outside of it that could be ordered.
+  bool BuildWaves(std::vector<std::vector<size_t>> &waves,
+                  std::string *cycle = nullptr) const;
+
+  size_t Size() const { return m_Nodes.size(); }
+  QScriptNode &GetNode(size_t index) { return m_Nodes[index]; }
+  const QScriptNode &GetNode(size_t index) const { return m_Nodes[index]; }
+  int Find(const std::string &name) const;
+
+  // Hardware threads, at least 1
+  static unsigned DefaultThreadCount();
+
+  // Call fn for each item on up to 'threads' threads (0 = all cores);
+  // returns when every call has finished
+  static void ParallelFor(const std::vector<size_t> &items, unsigned threads,
+                          const std::function<void(size_t)> &fn);
+
+private:
+  void ParseNode(QScriptNode &node);
+
+  std::vector<QScriptNode> m_Nodes;
+  std::unordered_map<std::string, size_t> m_Index; // Name -> node
+};
@@ -1,13 +1,21 @@
 #pragma once
 
+#include "QHeap.h"
 #include <cstdint>
+#include <cstring>
 #include <iostream>
+#include <mutex>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 
 // QStaticRegistry - stores static class instances that persist across modules
-// This is a global singleton that holds memory for static classes
+// This is a global singleton that holds memory for static classes. Code
+// generation reads it to embed instance addresses, also on the worker threads
+// of QJitRunner::BuildModules and CompileScriptsIntoMaster, so every access
+// is locked.
 class QStaticRegistry {
 public:
   static QStaticRegistry &Instance() {
@@ -17,6 +25,7 @@ public:
 
   // Allocate or get an existing static class instance
   void *GetOrCreateInstance(const std::string &className, uint64_t size) {
+    std::lock_guard<std::mutex> lock(m_Mutex);
     auto it = m_Instances.find(className);
     if (it != m_Instances.end()) {
       std::cout << "[DEBUG] QStaticRegistry: Returning existing instance of '"
@@ -29,14 +38,32 @@ public:
     if (ptr) {
       memset(ptr, 0, static_cast<size_t>(size));
       m_Instances[className] = ptr;
+      // Static members keep heap objects alive
+      QHeap::Get().AddRoot(ptr, static_cast<size_t>(size));
       std::cout << "[DEBUG] QStaticRegistry: Created new static instance of '"
                 << className << "' at " << ptr << std::endl;
     }
     return ptr;
   }
 
+  // Use storage owned elsewhere (a native script library) as the instance
+  // of a static class. It is never freed.
+  void AdoptInstance(const std::string &className, void *ptr, uint64_t size) {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    auto it = m_Instances.find(className);
+    if (it != m_Instances.end()) {
+      std::cerr << "[WARNING] QStaticRegistry: Replacing instance of '"
+                << className << "'" << std::endl;
+      QHeap::Get().RemoveRoot(it->second);
+    }
+    m_Instances[className] = ptr;
+    m_Adopted.insert(className);
+    QHeap::Get().AddRoot(ptr, static_cast<size_t>(size));
+  }
+
   // Get an existing instance (returns nullptr if not found)
   void *GetInstance(const std::string &className) const {
+    std::lock_guard<std::mutex> lock(m_Mutex);
     auto it = m_Instances.find(className);
     if (it != m_Instances.end()) {
       return it->second;
@@ -46,11 +73,13 @@ public:
 
   // Check if a static class instance exists
   bool HasInstance(const std::string &className) const {
+    std::lock_guard<std::mutex> lock(m_Mutex);
     return m_Instances.find(className) != m_Instances.end();
   }
 
   // Get all registered static class names
   std::vector<std::string> GetStaticClassNames() const {
+    std::lock_guard<std::mutex> lock(m_Mutex);
     std::vector<std::string> names;
     for (const auto &pair : m_Instances) {
       names.push_back(pair.first);
@@ -60,10 +89,14 @@ public:
 
   // Clear all static instances (for testing/cleanup)
   void Clear() {
+    std::lock_guard<std::mutex> lock(m_Mutex);
     for (auto &pair : m_Instances) {
-      free(pair.second);
+      QHeap::Get().RemoveRoot(pair.second);
+      if (!m_Adopted.count(pair.first))
+        free(pair.second);
     }
     m_Instances.clear();
+    m_Adopted.clear();
   }
 
 private:
@@ -78,4 +111,6 @@ private:
   QStaticRegistry &operator=(const QStaticRegistry &) = delete;
 
   std::unordered_map<std::string, void *> m_Instances;
+  std::unordered_set<std::string> m_Adopted;
+  mutable std::mutex m_Mutex;
 };
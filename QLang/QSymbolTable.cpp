@@ -0,0 +1,146 @@
+#include "QSymbolTable.h"
+#include <mutex>
+#include <stdexcept>
+
+QSymbolTable &QSymbolTable::Get() {
+  static QSymbolTable instance;
+  return instance;
+}
+
+QSymbolTable::QSymbolTable() {
+  InternLocked(""); // ID 0: NoSymbol
+
+  static const std::pair<const char *, TokenType> keywords[] = {
+      {"module", TokenType::T_MODULE},
+      {"import", TokenType::T_IMPORT},
+      {"end", TokenType::T_END},
+      {"if", TokenType::T_IF},
+      {"else", TokenType::T_ELSE},
+      {"elseif", TokenType::T_ELSEIF},
+      {"for", TokenType::T_FOR},
+      {"class", TokenType::T_CLASS},
+      {"static", TokenType::T_STATIC},
+      {"method", TokenType::T_METHOD},
+      {"new", TokenType::T_NEW},
+      {"return", TokenType::T_RETURN},
+      {"int32", TokenType::T_INT32},
+      {"int64", TokenType::T_INT64},
+      {"float32", TokenType::T_FLOAT32},
+      {"float64", TokenType::T_FLOAT64},
+      {"short", TokenType::T_SHORT},
+      {"string", TokenType::T_STRING_TYPE},
+      {"bool", TokenType::T_BOOL},
+      {"void", TokenType::T_VOID},
+      {"true", TokenType::T_TRUE},
+      {"false", TokenType::T_FALSE},
+      {"this", TokenType::T_THIS},
+      {"to", TokenType::T_TO},
+      {"next", TokenType::T_NEXT},
+      {"while", TokenType::T_WHILE},
+      {"wend", TokenType::T_WEND},
+      {"cptr", TokenType::T_CPTR},
+      {"iptr", TokenType::T_IPTR},
+      {"fptr", TokenType::T_FPTR},
+      {"byte", TokenType::T_BYTE},
+      {"bptr", TokenType::T_BPTR},
+      {"virtual", TokenType::T_VIRTUAL},
+      {"override", TokenType::T_OVERRIDE},
+      {"super", TokenType::T_SUPER},
+      {"null", TokenType::T_NULL},
+      {"enum", TokenType::T_ENUM},
+      {"declare", TokenType::T_DECLARE},
+      {"struct", TokenType::T_STRUCT},
+      {"vec2", TokenType::T_VEC2},
+      {"vec3", TokenType::T_VEC3},
+      {"vec4", TokenType::T_VEC4},
+      {"mat4", TokenType::T_MAT4},
+      {"yield", TokenType::T_YIELD},
+      {"wait", TokenType::T_WAIT},
+      {"waitUntil", TokenType::T_WAITUNTIL},
+  };
+
+  for (const auto &[name, type] : keywords) {
+    uint32_t id = InternLocked(name);
+    m_Blocks[id >> BlockBits].load()[id & (BlockSize - 1)].keyword = type;
+  }
+}
+
+QSymbolTable::~QSymbolTable() {
+  for (auto &block : m_Blocks) {
+    delete[] block.load();
+  }
+}
+
+uint32_t QSymbolTable::InternLocked(std::string_view name) {
+  auto it = m_Ids.find(name);
+  if (it != m_Ids.end()) {
+    return it->second;
+  }
+  uint32_t id = m_Count.load(std::memory_order_relaxed);
+  if ((id >> BlockBits) >= MaxBlocks) {
+    throw std::length_error("QSymbolTable: too many symbols");
+  }
+  Entry *block = m_Blocks[id >> BlockBits].load(std::memory_order_relaxed);
+  if (!block) {
+    block = new Entry[BlockSize];
+    m_Blocks[id >> BlockBits].store(block, std::memory_order_release);
+  }
+  Entry &entry = block[id & (BlockSize - 1)];
+  entry.name = std::string(name);
+  m_Ids.emplace(entry.name, id);
+  m_Count.store(id + 1, std::memory_order_release);
+  return id;
+}
+
+const QSymbolTable::Entry &QSymbolTable::GetEntry(uint32_t symbol) const {
+  if (symbol >= m_Count.load(std::memory_order_acquire)) {
+    symbol = NoSymbol;
+  }
+  return m_Blocks[symbol >> BlockBits].load(
+      std::memory_order_acquire)[symbol & (BlockSize - 1)];
+}
+
+uint32_t QSymbolTable::Intern(std::string_view name) {
+  {
+    std::shared_lock<std::shared_mutex> lock(m_Mutex);
+    auto it = m_Ids.find(name);
+    if (it != m_Ids.end()) {
+      return it->second;
+    }
+  }
+  std::unique_lock<std::shared_mutex> lock(m_Mutex);
+  return InternLocked(name);
+}
+
+uint32_t QSymbolTable::Intern(std::string_view name, TokenType &keyword) {
+  {
+    std::shared_lock<std::shared_mutex> lock(m_Mutex);
+    auto it = m_Ids.find(name);
+    if (it != m_Ids.end()) {
+      keyword = GetEntry(it->second).keyword;
+      return it->second;
+    }
+  }
+  std::unique_lock<std::shared_mutex> lock(m_Mutex);
+  uint32_t id = InternLocked(name);
+  keyword = GetEntry(id).keyword;
+  return id;
+}
+
+uint32_t QSymbolTable::Find(std::string_view name) const {
+  std::shared_lock<std::shared_mutex> lock(m_Mutex);
+  auto it = m_Ids.find(name);
+  return it != m_Ids.end() ? it->second : NoSymbol;
+}
+
+const std::string &QSymbolTable::GetName(uint32_t symbol) const {
+  return GetEntry(symbol).name;
+}
+
+TokenType QSymbolTable::GetKeyword(uint32_t symbol) const {
+  return GetEntry(symbol).keyword;
+}
+
+size_t QSymbolTable::Size() const {
+  return m_Count.load(std::memory_order_acquire);
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "Tokenizer.h"
+#include <atomic>
+#include <cstdint>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// QSymbolTable - interns token text as 32-bit symbol IDs
+//
+// The text of every token (names, literals, operators) is interned once per
+// process, so equal text shares one ID (and one string) across files and
+// recompiles, and a Token is a few integers. Keywords are interned up front
+// and carry their TokenType, which turns keyword recognition into a single
+// lookup. ID 0 means "no symbol" (empty text).
+//
+// The table is shared by all compiles and safe to use from several threads.
+// Interning takes a lock; GetName and GetKeyword do not, since every token
+// reads its text through them.
+class QSymbolTable {
+public:
+  static constexpr uint32_t NoSymbol = 0;
+
+  static QSymbolTable &Get();
+
+  QSymbolTable(const QSymbolTable &) = delete;
+  QSymbolTable &operator=(const QSymbolTable &) = delete;
+
+  // ID of a name, interning it on first use
+  uint32_t Intern(std::string_view name);
+
+  // Intern a scanned word and report its keyword type (T_IDENTIFIER for
+  // ordinary names) in one lookup
+  uint32_t Intern(std::string_view name, TokenType &keyword);
+
+  // ID of a name, or NoSymbol if it was never interned
+  uint32_t Find(std::string_view name) const;
+
+  // Interned text of a symbol (stable for the lifetime of the process)
+  const std::string &GetName(uint32_t symbol) const;
+
+  // Keyword type of a symbol (T_IDENTIFIER for ordinary names)
+  TokenType GetKeyword(uint32_t symbol) const;
+
+  size_t Size() const;
+
+private:
+  QSymbolTable();
+  ~QSymbolTable();
+
+  struct Entry {
+    std::string name;
+    TokenType keyword = TokenType::T_IDENTIFIER;
+  };
+
+  // Entries live in fixed blocks that never move, so readers index them
+  // without the lock; an ID is only handed out once its entry is written
+  static constexpr uint32_t BlockBits = 12;
+  static constexpr uint32_t BlockSize = 1u << BlockBits;
+  static constexpr uint32_t MaxBlocks = 1u << 14;
+
+  uint32_t InternLocked(std::string_view name);
+  const Entry &GetEntry(uint32_t symbol) const;
+
+  mutable std::shared_mutex m_Mutex; // Guards interning and m_Ids
+  std::atomic<Entry *> m_Blocks[MaxBlocks] = {};
+  std::atomic<uint32_t> m_Count{0};
+  std::unordered_map<std::string_view, uint32_t> m_Ids; // Views into entries
+};
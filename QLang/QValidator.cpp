@@ -13,6 +13,7 @@
 #include "QStatement.h"
 #include "QVariableDecl.h"
 #include "QWhile.h"
+#include "QYield.h"
 #include "Tokenizer.h"
 #include <iostream>
 
@@ -237,6 +238,8 @@ void QValidator::ValidateNode(std::shared_ptr<QNode> node) {
     ValidateWhile(whileNode);
   } else if (auto returnNode = std::dynamic_pointer_cast<QReturn>(node)) {
     ValidateReturn(returnNode);
+  } else if (auto yieldNode = std::dynamic_pointer_cast<QYield>(node)) {
+    ValidateYield(yieldNode);
   } else if (auto instDecl = std::dynamic_pointer_cast<QInstanceDecl>(node)) {
     // Instance declaration - validate class exists
     std::string className = instDecl->GetQClassName();
@@ -257,7 +260,7 @@ void QValidator::ValidateExpression(std::shared_ptr<QExpression> expr) {
     const Token &token = elements[i];
 
     if (token.type == TokenType::T_IDENTIFIER) {
-      std::string name = token.value;
+      std::string name = token.Text();
 
       // Check if it's a known variable, class member, or class name
       if (!IsKnownVariable(name) && !m_ClassMembers.count(name) &&
@@ -447,11 +450,32 @@ void QValidator::ValidateReturn(std::shared_ptr<QReturn> returnNode) {
   }
 }
 
+void QValidator::ValidateYield(std::shared_ptr<QYield> yieldNode) {
+  if (!yieldNode)
+    return;
+
+  // Only methods can become coroutines, and callers of a coroutine get no
+  // value back
+  if (m_CurrentMethodName.empty()) {
+    ReportError("'" + yieldNode->GetName() + "' can only be used in a method");
+  } else if (m_CurrentMethodName == m_CurrentClassName) {
+    ReportError("Constructor '" + m_CurrentMethodName + "' cannot use '" +
+                yieldNode->GetName() + "'");
+  } else if (!m_CurrentMethodReturnType.empty() &&
+             m_CurrentMethodReturnType != "void") {
+    ReportError("Method '" + m_CurrentMethodName + "' uses '" +
+                yieldNode->GetName() + "' and must return void");
+  }
+
+  ValidateExpression(yieldNode->GetExpression());
+}
+
 bool QValidator::IsValidTypeName(const std::string &typeName) const {
   // Valid primitive types in QLang
   static const std::set<std::string> validTypes = {
       "int32", "int64", "float32", "float64", "bool", "string",
-      "byte",  "iptr",  "fptr",    "bptr",    "ptr",  "void"};
+      "byte",  "iptr",  "fptr",    "bptr",    "ptr",  "void",
+      "vec2",  "vec3",  "vec4",    "mat4"};
 
   // Check if it's a valid primitive type
   if (validTypes.count(typeName)) {
@@ -21,6 +21,7 @@ class QIf;
 class QFor;
 class QWhile;
 class QReturn;
+class QYield;
 
 // QValidator - Performs semantic analysis on parsed QProgram AST
 class QValidator {
@@ -63,6 +64,7 @@ private:
   void ValidateFor(std::shared_ptr<QFor> forNode);
   void ValidateWhile(std::shared_ptr<QWhile> whileNode);
   void ValidateReturn(std::shared_ptr<QReturn> returnNode);
+  void ValidateYield(std::shared_ptr<QYield> yieldNode);
 
   // Helper methods
   bool IsValidTypeName(const std::string &typeName) const;
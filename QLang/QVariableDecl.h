@@ -8,6 +8,8 @@
 #include <memory>
 #include <string>
 
+class QFrameLayout;
+
 // QVariableDecl - represents a variable declaration (e.g., int age = 43;)
 class QVariableDecl : public QNode {
 public:
@@ -41,6 +43,16 @@ public:
   std::shared_ptr<QExpression> GetInitializer() const { return m_Initializer; }
   bool HasInitializer() const { return m_Initializer != nullptr; }
 
+  // Frame slot of the variable, resolved by QRunner before the code runs
+  // (-1 for a frame of another layout)
+  int GetResolvedSlot(const std::shared_ptr<QFrameLayout> &layout) const {
+    return layout == m_SlotLayout ? m_Slot : -1;
+  }
+  void SetResolvedSlot(std::shared_ptr<QFrameLayout> layout, int slot) {
+    m_SlotLayout = std::move(layout);
+    m_Slot = slot;
+  }
+
   void CheckForErrors(std::shared_ptr<QErrorCollector> collector) override {
     if (m_Initializer)
       m_Initializer->CheckForErrors(collector);
@@ -53,7 +65,7 @@ public:
       std::cout << " = ";
       const auto &elems = m_Initializer->GetElements();
       for (const auto &e : elems) {
-        std::cout << e.value << " ";
+        std::cout << e.Text() << " ";
       }
     }
     std::cout << std::endl;
@@ -66,6 +78,8 @@ private:
       m_TypeName; // Original type name string (for generics like T, K, V)
   std::vector<std::string> m_TypeParams;
   std::shared_ptr<QExpression> m_Initializer;
+  std::shared_ptr<QFrameLayout> m_SlotLayout;
+  int m_Slot = -1;
 
   std::string GetVarTypeName() const {
     switch (m_VarType) {
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "QExpression.h"
+#include "QNode.h"
+#include <iostream>
+#include <memory>
+
+// QYield - a suspension point in a coroutine method:
+//   yield;               resume next frame
+//   wait(seconds);       resume once the time has passed
+//   waitUntil(cond);     resume on the first frame cond is true
+// A method containing one is compiled as a coroutine (see QJitRunner).
+class QYield : public QNode {
+public:
+  enum class Kind { Frame, Seconds, Until };
+
+  explicit QYield(Kind kind) : m_Kind(kind) {
+#if QLANG_DEBUG
+    std::cout << "[DEBUG] QYield created" << std::endl;
+#endif
+  }
+
+  std::string GetName() const override {
+    switch (m_Kind) {
+    case Kind::Seconds:
+      return "wait";
+    case Kind::Until:
+      return "waitUntil";
+    default:
+      return "yield";
+    }
+  }
+
+  Kind GetKind() const { return m_Kind; }
+
+  // Seconds to wait, or the condition to wait for
+  void SetExpression(std::shared_ptr<QExpression> expr) { m_Expression = expr; }
+
+  std::shared_ptr<QExpression> GetExpression() const { return m_Expression; }
+
+  void Print(int indent = 0) const override {
+    PrintIndent(indent);
+    std::cout << GetName();
+    if (m_Expression) {
+      std::cout << ": ";
+      const auto &elems = m_Expression->GetElements();
+      for (const auto &e : elems) {
+        std::cout << e.Text() << " ";
+      }
+    }
+    std::cout << std::endl;
+  }
+
+private:
+  Kind m_Kind;
+  std::shared_ptr<QExpression> m_Expression;
+};
@@ -1,5 +1,6 @@
 #include "Tokenizer.h"
 #include "QError.h"
+#include "QSymbolTable.h"
 #include <cctype>
 #include <sstream>
 
@@ -39,14 +40,26 @@ void Tokenizer::ReportError(const std::string &message) {
 }
 
 void Tokenizer::Tokenize() {
+  // Scripts average well over four bytes per token
+  m_Tokens.reserve(m_Tokens.size() + m_Source.size() / 4);
+  m_TokenStart = m_Cursor;
   while (!IsAtEnd()) {
     ScanToken();
   }
+  m_TokenStart = m_Cursor;
   AddToken(TokenType::T_EOF, "");
 }
 
 const std::vector<Token> &Tokenizer::GetTokens() const { return m_Tokens; }
 
+const std::string &Token::Text() const {
+  return QSymbolTable::Get().GetName(symbol);
+}
+
+void Token::SetText(std::string_view text) {
+  symbol = QSymbolTable::Get().Intern(text);
+}
+
 void Tokenizer::PrintTokens() const {
   for (const auto &token : m_Tokens) {
     std::string typeStr;
@@ -189,9 +202,33 @@ void Tokenizer::PrintTokens() const {
     case TokenType::T_ENUM:
       typeStr = "T_ENUM";
       break;
+    case TokenType::T_STRUCT:
+      typeStr = "T_STRUCT";
+      break;
+    case TokenType::T_VEC2:
+      typeStr = "T_VEC2";
+      break;
+    case TokenType::T_VEC3:
+      typeStr = "T_VEC3";
+      break;
+    case TokenType::T_VEC4:
+      typeStr = "T_VEC4";
+      break;
+    case TokenType::T_MAT4:
+      typeStr = "T_MAT4";
+      break;
+    case TokenType::T_YIELD:
+      typeStr = "T_YIELD";
+      break;
+    case TokenType::T_WAIT:
+      typeStr = "T_WAIT";
+      break;
+    case TokenType::T_WAITUNTIL:
+      typeStr = "T_WAITUNTIL";
+      break;
     }
 #if QLANG_DEBUG
-    std::cout << "Token(" << typeStr << ", '" << token.value
+    std::cout << "Token(" << typeStr << ", '" << token.Text()
               << "', Line: " << token.line << ", Col: " << token.column << ")"
               << std::endl;
 #endif
@@ -236,6 +273,7 @@ char Tokenizer::Advance() {
 bool Tokenizer::IsAtEnd() const { return m_Cursor >= m_Source.length(); }
 
 void Tokenizer::ScanToken() {
+  m_TokenStart = m_Cursor;
   char c = Peek();
 
   // Handle newline explicitly to generate token
@@ -287,135 +325,61 @@ void Tokenizer::ScanToken() {
 }
 
 void Tokenizer::ScanIdentifierOrKeyword() {
-  std::string value;
   int startCol = m_Column;
   while (isalnum(Peek()) || Peek() == '_') {
-    value += Advance();
+    Advance(); // Identifiers never span lines
   }
+  std::string_view value(m_Source.data() + m_TokenStart,
+                         m_Cursor - m_TokenStart);
 
-  // Check for specific keywords
+  // Keywords are pre-interned with their token type
   TokenType type = TokenType::T_IDENTIFIER;
-  if (value == "module") {
-    type = TokenType::T_MODULE;
-  } else if (value == "import") {
-    type = TokenType::T_IMPORT;
-  } else if (value == "end") {
-    type = TokenType::T_END;
-  } else if (value == "if") {
-    type = TokenType::T_IF;
-  } else if (value == "else") {
-    type = TokenType::T_ELSE;
-  } else if (value == "elseif") {
-    type = TokenType::T_ELSEIF;
-  } else if (value == "for") {
-    type = TokenType::T_FOR;
-  } else if (value == "class") {
-    type = TokenType::T_CLASS;
-  } else if (value == "static") {
-    type = TokenType::T_STATIC;
-  } else if (value == "method") {
-    type = TokenType::T_METHOD;
-  } else if (value == "new") {
-    type = TokenType::T_NEW;
-  } else if (value == "return") {
-    type = TokenType::T_RETURN;
-  } else if (value == "int32") {
-    type = TokenType::T_INT32;
-  } else if (value == "int64") {
-    type = TokenType::T_INT64;
-  } else if (value == "float32") {
-    type = TokenType::T_FLOAT32;
-  } else if (value == "float64") {
-    type = TokenType::T_FLOAT64;
-  } else if (value == "short") {
-    type = TokenType::T_SHORT;
-  } else if (value == "string") {
-    type = TokenType::T_STRING_TYPE;
-  } else if (value == "bool") {
-    type = TokenType::T_BOOL;
-  } else if (value == "void") {
-    type = TokenType::T_VOID;
-  } else if (value == "true") {
-    type = TokenType::T_TRUE;
-  } else if (value == "false") {
-    type = TokenType::T_FALSE;
-  } else if (value == "this") {
-    type = TokenType::T_THIS;
-  } else if (value == "to") {
-    type = TokenType::T_TO;
-  } else if (value == "next") {
-    type = TokenType::T_NEXT;
-  } else if (value == "while") {
-    type = TokenType::T_WHILE;
-  } else if (value == "wend") {
-    type = TokenType::T_WEND;
-  } else if (value == "cptr") {
-    type = TokenType::T_CPTR;
-  } else if (value == "iptr") {
-    type = TokenType::T_IPTR;
-  } else if (value == "fptr") {
-    type = TokenType::T_FPTR;
-  } else if (value == "byte") {
-    type = TokenType::T_BYTE;
-  } else if (value == "bptr") {
-    type = TokenType::T_BPTR;
-  } else if (value == "virtual") {
-    type = TokenType::T_VIRTUAL;
-  } else if (value == "override") {
-    type = TokenType::T_OVERRIDE;
-  } else if (value == "super") {
-    type = TokenType::T_SUPER;
-  } else if (value == "null") {
-    type = TokenType::T_NULL;
-  } else if (value == "enum") {
-    type = TokenType::T_ENUM;
-  } else if (value == "declare") {
-    type = TokenType::T_DECLARE;
-  }
+  uint32_t symbol = QSymbolTable::Get().Intern(value, type);
 
   // Construct manually to keep start column
   Token token;
   token.type = type;
-  token.value = value;
   token.line = m_Line;
   token.column = startCol;
+  token.symbol = symbol;
+  token.offset = static_cast<uint32_t>(m_TokenStart);
   m_Tokens.push_back(token);
 }
 
 void Tokenizer::ScanNumber() {
-  std::string value;
   int startCol = m_Column;
   bool isFloat = false;
 
   while (isdigit(Peek())) {
-    value += Advance();
+    Advance();
   }
 
   if (Peek() == '.' && isdigit(Peek(1))) {
     isFloat = true;
-    value += Advance(); // Consume '.'
+    Advance(); // Consume '.'
     while (isdigit(Peek())) {
-      value += Advance();
+      Advance();
     }
   }
 
   Token token;
   token.type = isFloat ? TokenType::T_FLOAT : TokenType::T_INTEGER;
-  token.value = value;
+  token.SetText(std::string_view(m_Source.data() + m_TokenStart,
+                                 m_Cursor - m_TokenStart));
   token.line = m_Line;
   token.column = startCol;
+  token.offset = static_cast<uint32_t>(m_TokenStart);
   m_Tokens.push_back(token);
 }
 
 void Tokenizer::ScanString() {
   Advance(); // Consume opening "
-  std::string value;
   int startCol = m_Column; // Correct logic would be start of string
 
   while (Peek() != '"' && !IsAtEnd()) {
     if (Peek() == '\n')
       m_Line++;
-    value += Advance();
+    Advance();
   }
 
   if (IsAtEnd()) {
@@ -423,19 +387,22 @@ void Tokenizer::ScanString() {
     return;
   }
 
+  // Text between the quotes
+  std::string_view value(m_Source.data() + m_TokenStart + 1,
+                         m_Cursor - m_TokenStart - 1);
   Advance(); // Consume closing "
 
   Token token;
   token.type = TokenType::T_STRING;
-  token.value = value;
+  token.SetText(value);
   token.line = m_Line;
   token.column = startCol; // Approximate
+  token.offset = static_cast<uint32_t>(m_TokenStart);
   m_Tokens.push_back(token);
 }
 
 void Tokenizer::ScanOperatorOrPunctuation() {
   char c = Advance();
-  std::string value(1, c);
   TokenType type = TokenType::T_UNKNOWN;
 
   switch (c) {
@@ -443,14 +410,14 @@ void Tokenizer::ScanOperatorOrPunctuation() {
     type = TokenType::T_OPERATOR;
     // Check for ++ or +=
     if (Peek() == '+' || Peek() == '=') {
-      value += Advance();
+      Advance();
     }
     break;
   case '-':
     type = TokenType::T_OPERATOR;
     // Check for -- or -=
     if (Peek() == '-' || Peek() == '=') {
-      value += Advance();
+      Advance();
     }
     break;
   case '*':
@@ -460,13 +427,13 @@ void Tokenizer::ScanOperatorOrPunctuation() {
     type = TokenType::T_OPERATOR;
     // Check for 2-char operators like ==, !=
     if (Peek() == '=') {
-      value += Advance();
+      Advance();
     }
     break;
   case '<':
     // Check for <= (comparison operator)
     if (Peek() == '=') {
-      value += Advance();
+      Advance();
       type = TokenType::T_OPERATOR;
     } else {
       type = TokenType::T_LESS; // For generics
@@ -475,7 +442,7 @@ void Tokenizer::ScanOperatorOrPunctuation() {
   case '>':
     // Check for >= (comparison operator)
     if (Peek() == '=') {
-      value += Advance();
+      Advance();
       type = TokenType::T_OPERATOR;
     } else {
       type = TokenType::T_GREATER; // For generics
@@ -485,14 +452,14 @@ void Tokenizer::ScanOperatorOrPunctuation() {
     type = TokenType::T_OPERATOR;
     // Check for &&
     if (Peek() == '&') {
-      value += Advance();
+      Advance();
     }
     break;
   case '|':
     type = TokenType::T_OPERATOR;
     // Check for ||
     if (Peek() == '|') {
-      value += Advance();
+      Advance();
     }
     break;
   case ';':
@@ -507,7 +474,7 @@ void Tokenizer::ScanOperatorOrPunctuation() {
   case ':':
     // Check for :: (scope resolution)
     if (Peek() == ':') {
-      value += Advance(); // consume second :
+      Advance(); // consume second :
       type = TokenType::T_SCOPE;
     } else {
       type = TokenType::T_COLON;
@@ -533,14 +500,16 @@ void Tokenizer::ScanOperatorOrPunctuation() {
     break;
   }
 
-  AddToken(type, value);
+  AddToken(type, std::string_view(m_Source.data() + m_TokenStart,
+                                  m_Cursor - m_TokenStart));
 }
 
-void Tokenizer::AddToken(TokenType type, const std::string &value) {
+void Tokenizer::AddToken(TokenType type, std::string_view text) {
   Token token;
   token.type = type;
-  token.value = value;
+  token.SetText(text);
   token.line = m_Line;
-  token.column = m_Column - value.length(); // Simplified column tracking
+  token.column = m_Column - static_cast<int>(text.length()); // Simplified
+  token.offset = static_cast<uint32_t>(m_TokenStart);
   m_Tokens.push_back(token);
 }
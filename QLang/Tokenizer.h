@@ -1,9 +1,11 @@
 #pragma once
 
+#include <cstdint>
 #include <fstream>
 #include <iostream>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 
 enum class TokenType {
@@ -70,16 +72,31 @@ enum class TokenType {
   T_BPTR,     // byte pointer (byte*)
   T_VIRTUAL,  // virtual method keyword
   T_OVERRIDE, // override method keyword
-  T_ENUM      // enum keyword
+  T_ENUM,     // enum keyword
+  T_STRUCT,   // struct (value class) keyword
+  T_VEC2,     // vec2 type (2 x float32)
+  T_VEC3,     // vec3 type (3 x float32)
+  T_VEC4,     // vec4 type (4 x float32)
+  T_MAT4,     // mat4 type (4x4 float32, column-major)
+  T_YIELD,    // yield (suspend until the next frame)
+  T_WAIT,     // wait(seconds)
+  T_WAITUNTIL // waitUntil(condition)
 };
 
 class QErrorCollector;
 
+// A token is its type, the interned ID of its text and its position; the
+// text itself lives once in QSymbolTable
 struct Token {
-  TokenType type;
-  std::string value;
-  int line;
-  int column;
+  TokenType type = TokenType::T_UNKNOWN;
+  uint32_t symbol = 0; // Interned text (QSymbolTable)
+  uint32_t offset = 0; // Byte offset of the token in the source
+  int line = 0;
+  int column = 0;
+
+  // Name, literal (strings without their quotes) or operator
+  const std::string &Text() const;
+  void SetText(std::string_view text);
 };
 
 class Tokenizer {
@@ -95,6 +112,8 @@ public:
 
   void Tokenize();
   const std::vector<Token> &GetTokens() const;
+  // Move the tokens out (e.g. into a Parser); leaves the tokenizer empty
+  std::vector<Token> TakeTokens() { return std::move(m_Tokens); }
   void PrintTokens() const;
 
   // Error access
@@ -108,6 +127,7 @@ private:
   std::vector<Token> m_Tokens;
   std::shared_ptr<QErrorCollector> m_ErrorCollector;
   int m_Cursor = 0;
+  int m_TokenStart = 0; // Source offset of the token being scanned
   int m_Line = 1;
   int m_Column = 1;
 
@@ -124,5 +144,5 @@ private:
   void ScanString();
   void ScanOperatorOrPunctuation();
 
-  void AddToken(TokenType type, const std::string &value);
+  void AddToken(TokenType type, std::string_view text);
 };
@@ -422,10 +422,18 @@ void CodeEditor::setCompleter(QCompleter *completer) {
 }
 
 void CodeEditor::updateSymbols() {
-  m_symbolCollector.parse(toPlainText());
+  if (!m_hasCompiledSymbols) {
+    m_symbolCollector.parse(toPlainText());
+  }
   updateCompletionModel();
 }
 
+void CodeEditor::setCompiledSymbols(const QList<QLangSymbol> &symbols,
+                                    const QStringList &classNames) {
+  m_symbolCollector.setSymbols(symbols, classNames);
+  m_hasCompiledSymbols = true;
+}
+
 void CodeEditor::updateCompletionModel() {
   QStringList completions;
 
@@ -665,8 +673,11 @@ void CodeEditor::showDotCompletion(const QString &memberAccessChain) {
   emit debugLog("=== showDotCompletion called ===");
   emit debugLog("Member access chain: " + memberAccessChain);
 
-  // First, update symbols to have the latest state
-  m_symbolCollector.parse(toPlainText());
+  // First, update symbols to have the latest state (unless the background
+  // compile keeps them current)
+  if (!m_hasCompiledSymbols) {
+    m_symbolCollector.parse(toPlainText());
+  }
 
   // Get current context
   QString className = getCurrentClassName();
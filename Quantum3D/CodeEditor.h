@@ -30,6 +30,10 @@ public:
 
   // IntelliSense
   void updateSymbols(); // Re-parse symbols from current text
+  // Symbols from a background compile. From then on they replace the
+  // regex-based parse, which runs on the UI thread.
+  void setCompiledSymbols(const QList<QLangSymbol> &symbols,
+                          const QStringList &classNames);
   void setCompleter(QCompleter *completer);
   QCompleter *completer() const { return m_completer; }
 
@@ -59,6 +63,7 @@ private:
   // IntelliSense
   QCompleter *m_completer;
   QLangSymbolCollector m_symbolCollector;
+  bool m_hasCompiledSymbols = false;
 
   // Get the leading whitespace of a line
   QString getLineIndent(const QString &line);
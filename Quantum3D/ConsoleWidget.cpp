@@ -1,5 +1,8 @@
 #include "ConsoleWidget.h"
+#include "EngineGlobals.h"
+#include "QProfiler.h"
 #include <QtGui/QFont>
+#include <QtWidgets/QFileDialog>
 #include <QtWidgets/QScrollBar>
 
 // Static instance
@@ -20,7 +23,29 @@ ConsoleWidget::ConsoleWidget(QWidget *parent) : QWidget(parent) {
   m_clearButton->setFixedHeight(22);
   connect(m_clearButton, &QPushButton::clicked, this, &ConsoleWidget::Clear);
 
+  // Script profiler: instrumentation applies to scripts compiled after it
+  // is switched on
+  m_profileButton = new QPushButton("Profile", this);
+  m_profileButton->setCheckable(true);
+  m_profileButton->setFixedHeight(22);
+  m_profileButton->setChecked(QProfiler::IsInstrumentationEnabled());
+  connect(m_profileButton, &QPushButton::toggled, this,
+          &ConsoleWidget::ToggleProfiling);
+
+  m_hotListButton = new QPushButton("Hot List", this);
+  m_hotListButton->setFixedHeight(22);
+  connect(m_hotListButton, &QPushButton::clicked, this,
+          &ConsoleWidget::PrintProfile);
+
+  m_exportProfileButton = new QPushButton("Export Profile", this);
+  m_exportProfileButton->setFixedHeight(22);
+  connect(m_exportProfileButton, &QPushButton::clicked, this,
+          &ConsoleWidget::ExportProfile);
+
   toolbarLayout->addWidget(m_clearButton);
+  toolbarLayout->addWidget(m_profileButton);
+  toolbarLayout->addWidget(m_hotListButton);
+  toolbarLayout->addWidget(m_exportProfileButton);
   toolbarLayout->addStretch();
   mainLayout->addLayout(toolbarLayout);
 
@@ -109,6 +134,40 @@ void ConsoleWidget::PrintWithLevel(const std::string &message, int level) {
 
 void ConsoleWidget::Clear() { m_textEdit->clear(); }
 
+void ConsoleWidget::PrintProfile() {
+  // Columns are space-aligned; keep the whitespace
+  QString html =
+      QString("<pre style='color:#9cdcfe; margin:0;'>%1</pre>")
+          .arg(QString::fromStdString(QProfiler::Get().FormatHotList(20))
+                   .toHtmlEscaped());
+  appendHtml(html);
+}
+
+void ConsoleWidget::ToggleProfiling(bool enabled) {
+  QProfiler::SetInstrumentation(enabled);
+  if (enabled) {
+    QProfiler::Get().Reset();
+    Print("Script profiling on: recompile or reload scripts to instrument "
+          "them");
+  } else {
+    Print("Script profiling off for scripts compiled from now on");
+  }
+}
+
+void ConsoleWidget::ExportProfile() {
+  if (!EngineGlobals::m_QDomain) {
+    PrintError("No script domain to profile");
+    return;
+  }
+  QString path = QFileDialog::getSaveFileName(
+      this, "Export Script Profile", "profile.json", "JSON Files (*.json)");
+  if (path.isEmpty())
+    return;
+  if (EngineGlobals::m_QDomain->WriteProfileJson(path.toStdString())) {
+    Print("Script profile written to " + path.toStdString());
+  }
+}
+
 void ConsoleWidget::appendHtml(const QString &html) {
   m_textEdit->append(html);
 
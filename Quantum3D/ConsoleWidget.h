@@ -32,13 +32,21 @@ public:
   // Clear console output
   void Clear();
 
+  // Script profiler (QProfiler): hot list of the most expensive methods
+  void PrintProfile();
+
   QSize sizeHint() const override { return QSize(800, 200); }
 
 private:
   void appendHtml(const QString &html);
+  void ToggleProfiling(bool enabled);
+  void ExportProfile();
 
   QTextEdit *m_textEdit;
   QPushButton *m_clearButton;
+  QPushButton *m_profileButton;
+  QPushButton *m_hotListButton;
+  QPushButton *m_exportProfileButton;
 
   static ConsoleWidget *s_Instance;
 };
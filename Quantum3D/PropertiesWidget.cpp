@@ -126,8 +126,8 @@ void PropertiesWidget::RefreshProperties() {
               << clsInstance->GetMembers().size() << " registered members"
               << std::endl;
     for (const auto &m : clsInstance->GetMembers()) {
-      std::cout << "  - " << m.first << " (typeToken=" << m.second.typeToken
-                << ", typeName=" << m.second.typeName << ")" << std::endl;
+      std::cout << "  - " << m.name << " (typeToken=" << m.info.typeToken
+                << ", typeName=" << m.info.typeName << ")" << std::endl;
     }
 
     // Helper to check for GameNode inheritance
@@ -143,10 +143,11 @@ void PropertiesWidget::RefreshProperties() {
       return true; // TODO: implement proper inheritance check via QJitRunner
     };
 
-    // Iterate over registered members
-    for (const auto &memberPair : clsInstance->GetMembers()) {
-      const std::string &fieldName = memberPair.first;
-      const MemberInfo &memberInfo = memberPair.second;
+    // Iterate over registered members; each field resolves its member to a
+    // typed accessor once instead of looking the name up on every get/set
+    for (const auto &member : clsInstance->GetMembers()) {
+      const std::string &fieldName = member.name;
+      const MemberInfo &memberInfo = member.info;
 
       PropertyField field;
       field.Name = fieldName;
@@ -160,27 +161,30 @@ void PropertiesWidget::RefreshProperties() {
 
       if (typeName == "float32" || typeName == "float") {
         field.Type = PropertyType::Float;
-        field.GetFloat = [clsInstance, fieldName]() {
-          return clsInstance->GetMember<float>(fieldName);
+        auto accessor = clsInstance->GetAccessor<float>(fieldName);
+        field.GetFloat = [clsInstance, accessor]() {
+          return accessor.Get(clsInstance->GetInstancePtr());
         };
-        field.SetFloat = [clsInstance, fieldName](float val) {
-          clsInstance->SetMember<float>(fieldName, val);
+        field.SetFloat = [clsInstance, accessor](float val) {
+          accessor.Set(clsInstance->GetInstancePtr(), val);
         };
       } else if (typeName == "int32" || typeName == "int") {
         field.Type = PropertyType::Int;
-        field.GetInt = [clsInstance, fieldName]() {
-          return clsInstance->GetMember<int32_t>(fieldName);
+        auto accessor = clsInstance->GetAccessor<int32_t>(fieldName);
+        field.GetInt = [clsInstance, accessor]() {
+          return accessor.Get(clsInstance->GetInstancePtr());
         };
-        field.SetInt = [clsInstance, fieldName](int val) {
-          clsInstance->SetMember<int32_t>(fieldName, static_cast<int32_t>(val));
+        field.SetInt = [clsInstance, accessor](int val) {
+          accessor.Set(clsInstance->GetInstancePtr(), static_cast<int32_t>(val));
         };
       } else if (typeName == "bool") {
         field.Type = PropertyType::Bool;
-        field.GetBool = [clsInstance, fieldName]() {
-          return clsInstance->GetMember<bool>(fieldName);
+        auto accessor = clsInstance->GetAccessor<bool>(fieldName);
+        field.GetBool = [clsInstance, accessor]() {
+          return accessor.Get(clsInstance->GetInstancePtr());
         };
-        field.SetBool = [clsInstance, fieldName](bool val) {
-          clsInstance->SetMember<bool>(fieldName, val);
+        field.SetBool = [clsInstance, accessor](bool val) {
+          accessor.Set(clsInstance->GetInstancePtr(), val);
         };
       } else if (typeName == "cptr" || typeName == "iptr" ||
                  typeName == "fptr" || typeName == "bptr") {
@@ -188,45 +192,27 @@ void PropertiesWidget::RefreshProperties() {
         continue;
       } else if (!typeName.empty()) {
         // T_IDENTIFIER - class reference (stored as pointer)
-        if (typeName == "Vec3") {
-          // Vec3 is embedded, not a pointer - access via struct offset
+        if (typeName == "Vec3" || typeName == "vec3") {
+          // Vec3 and the built-in vec3 are embedded, not pointers - access via
+          // struct offset. Both are three consecutive floats, same as glm
           field.Type = PropertyType::Vec3;
-          field.GetVec3 = [clsInstance, fieldName]() {
-            // Get pointer to the Vec3 struct within the class instance
-            void *instancePtr = clsInstance->GetInstancePtr();
-            const auto &members = clsInstance->GetMembers();
-            auto it = members.find(fieldName);
-            if (it == members.end())
-              return glm::vec3(0.0f);
-
-            // The member is at offset within the struct
-            char *memberPtr =
-                static_cast<char *>(instancePtr) + it->second.offset;
-            // Vec3 struct has X, Y, Z as consecutive floats
-            float *floatPtr = reinterpret_cast<float *>(memberPtr);
-            return glm::vec3(floatPtr[0], floatPtr[1], floatPtr[2]);
+          auto accessor = clsInstance->GetAccessor<glm::vec3>(fieldName);
+          field.GetVec3 = [clsInstance, accessor]() {
+            return accessor.IsValid()
+                       ? accessor.Get(clsInstance->GetInstancePtr())
+                       : glm::vec3(0.0f);
           };
-          field.SetVec3 = [clsInstance, fieldName](glm::vec3 val) {
-            void *instancePtr = clsInstance->GetInstancePtr();
-            const auto &members = clsInstance->GetMembers();
-            auto it = members.find(fieldName);
-            if (it == members.end())
-              return;
-
-            char *memberPtr =
-                static_cast<char *>(instancePtr) + it->second.offset;
-            float *floatPtr = reinterpret_cast<float *>(memberPtr);
-            floatPtr[0] = val.x;
-            floatPtr[1] = val.y;
-            floatPtr[2] = val.z;
+          field.SetVec3 = [clsInstance, accessor](glm::vec3 val) {
+            accessor.Set(clsInstance->GetInstancePtr(), val);
           };
         } else if (isGameNodeClass(typeName)) {
           // Class reference (stored as pointer in struct)
           field.Type = PropertyType::Node;
           field.TargetClass = typeName;
 
-          field.GetNodeName = [clsInstance, fieldName]() {
-            void *ptr = clsInstance->GetPtrMember(fieldName);
+          auto accessor = clsInstance->GetAccessor<void *>(fieldName);
+          field.GetNodeName = [clsInstance, accessor]() {
+            void *ptr = accessor.Get(clsInstance->GetInstancePtr());
             if (ptr) {
               // ptr is the class instance's raw memory
               // If the target class inherits from GameNode, NodePtr is the
@@ -243,13 +229,13 @@ void PropertiesWidget::RefreshProperties() {
             }
             return std::string("null");
           };
-          field.ClearNode = [clsInstance, fieldName]() {
-            clsInstance->SetPtrMember(fieldName, nullptr);
+          field.ClearNode = [clsInstance, accessor]() {
+            accessor.Set(clsInstance->GetInstancePtr(), nullptr);
           };
-          field.SetNode = [clsInstance, fieldName,
+          field.SetNode = [clsInstance, accessor, fieldName,
                            typeName](GraphNode *newNode) {
             if (!newNode) {
-              clsInstance->SetPtrMember(fieldName, nullptr);
+              accessor.Set(clsInstance->GetInstancePtr(), nullptr);
               return;
             }
             // Scan the dropped node's scripts for matching class type
@@ -258,7 +244,7 @@ void PropertiesWidget::RefreshProperties() {
                 continue;
               if (sp->ClsInstance->GetClassName() == typeName) {
                 void *instancePtr = sp->ClsInstance->GetInstancePtr();
-                clsInstance->SetPtrMember(fieldName, instancePtr);
+                accessor.Set(clsInstance->GetInstancePtr(), instancePtr);
                 std::cout << "[INFO] PropertiesWidget: Set '" << fieldName
                           << "' to instance of '" << typeName << "' from node '"
                           << newNode->GetName() << "'" << std::endl;
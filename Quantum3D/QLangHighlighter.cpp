@@ -29,6 +29,9 @@ TokenColorType QLangHighlighter::getColorType(TokenType tokenType) const {
   case TokenType::T_WHILE:
   case TokenType::T_WEND:
   case TokenType::T_NULL:
+  case TokenType::T_YIELD:
+  case TokenType::T_WAIT:
+  case TokenType::T_WAITUNTIL:
     return TokenColorType::Keyword;
 
   // Types
@@ -41,6 +44,10 @@ TokenColorType QLangHighlighter::getColorType(TokenType tokenType) const {
   case TokenType::T_BOOL:
   case TokenType::T_VOID:
   case TokenType::T_CPTR:
+  case TokenType::T_VEC2:
+  case TokenType::T_VEC3:
+  case TokenType::T_VEC4:
+  case TokenType::T_MAT4:
     return TokenColorType::Type;
 
   // Booleans
@@ -123,7 +130,7 @@ void QLangHighlighter::highlightBlock(const QString &text) {
 
     // Calculate position (column is 1-indexed)
     int start = token.column - 1;
-    int length = static_cast<int>(token.value.length());
+    int length = static_cast<int>(token.Text().length());
 
     // Ensure we don't go past the end of the line
     if (start >= 0 && start < text.length()) {
@@ -22,6 +22,12 @@ void QLangSymbolCollector::parse(const QString &source) {
   parseClasses(source);
 }
 
+void QLangSymbolCollector::setSymbols(const QList<QLangSymbol> &symbols,
+                                      const QStringList &classNames) {
+  m_symbols = symbols;
+  m_classNames = classNames;
+}
+
 void QLangSymbolCollector::parseClasses(const QString &source) {
   // Find all class definitions using regex
   // Pattern: class ClassName or class ClassName(ParentClass)
@@ -35,6 +35,11 @@ public:
   // Parse source code and extract symbols
   void parse(const QString &source);
 
+  // Replace the symbols with ones produced elsewhere (the compiler's AST,
+  // see ScriptCompileService) instead of parse()
+  void setSymbols(const QList<QLangSymbol> &symbols,
+                  const QStringList &classNames);
+
   // Get all class names (including external)
   QStringList getClassNames() const;
 
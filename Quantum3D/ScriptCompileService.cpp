@@ -0,0 +1,383 @@
+#include "ScriptCompileService.h"
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <sstream>
+
+// QLang Includes (standalone parsing - no QLangDomain)
+#include "../QLang/Parser.h"
+#include "../QLang/QClass.h"
+#include "../QLang/QCode.h"
+#include "../QLang/QContext.h"
+#include "../QLang/QError.h"
+#include "../QLang/QFor.h"
+#include "../QLang/QIf.h"
+#include "../QLang/QInstanceDecl.h"
+#include "../QLang/QMethod.h"
+#include "../QLang/QRunner.h"
+#include "../QLang/QVariableDecl.h"
+#include "../QLang/QWhile.h"
+#include "../QLang/Tokenizer.h"
+
+namespace Quantum {
+
+ScriptCompileService::ScriptCompileService(QObject *parent)
+    : QObject(parent) {
+  m_worker = std::thread(&ScriptCompileService::workerLoop, this);
+}
+
+ScriptCompileService::~ScriptCompileService() {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stop = true;
+  }
+  m_wake.notify_all();
+  if (m_worker.joinable()) {
+    m_worker.join();
+  }
+}
+
+void ScriptCompileService::SetEngineClasses(
+    std::vector<std::shared_ptr<QProgram>> programs,
+    std::set<std::string> classNames) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_enginePrograms = std::move(programs);
+  m_engineClassNames = std::move(classNames);
+}
+
+uint64_t ScriptCompileService::Submit(const std::string &path,
+                                      const QString &source) {
+  std::string text = source.toStdString();
+  uint64_t version;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    version = ++m_versions[path];
+    m_forgotten.erase(path);
+    // Replaces a submission the worker has not started yet
+    m_pending[path] = {version, std::move(text)};
+  }
+  m_wake.notify_one();
+  return version;
+}
+
+void ScriptCompileService::Forget(const std::string &path) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_pending.erase(path);
+  m_published.erase(path);
+  m_versions.erase(path);
+  m_forgotten.insert(path);
+}
+
+std::shared_ptr<const ScriptAnalysis>
+ScriptCompileService::GetAnalysis(const std::string &path) const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto it = m_published.find(path);
+  return it != m_published.end() ? it->second : nullptr;
+}
+
+void ScriptCompileService::workerLoop() {
+  while (true) {
+    std::string path;
+    Job job;
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_wake.wait(lock, [this] { return m_stop || !m_pending.empty(); });
+      if (m_stop)
+        return;
+      for (const auto &forgotten : m_forgotten) {
+        m_files.erase(forgotten);
+      }
+      m_forgotten.clear();
+
+      auto it = m_pending.begin();
+      path = it->first;
+      job = std::move(it->second);
+      m_pending.erase(it);
+    }
+
+    auto analysis = analyze(path, job);
+    if (!analysis)
+      continue; // Nothing changed since the last analysis
+
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      // Superseded while it ran (or the file was closed): a newer job is
+      // queued, or nobody wants it any more
+      auto version = m_versions.find(path);
+      if (version == m_versions.end() || version->second != job.version)
+        continue;
+      m_published[path] = analysis;
+    }
+    emit analysisReady(QString::fromStdString(path));
+  }
+}
+
+std::shared_ptr<QProgram>
+ScriptCompileService::loadSibling(const std::filesystem::path &path) {
+  std::error_code ec;
+  auto stamp = std::filesystem::last_write_time(path, ec);
+  if (ec)
+    return nullptr;
+
+  std::string key = path.string();
+  auto cached = m_siblings.find(key);
+  if (cached != m_siblings.end() && cached->second.stamp == stamp) {
+    return cached->second.program;
+  }
+
+  SiblingEntry &entry = m_siblings[key];
+  entry.stamp = stamp;
+  entry.program = nullptr;
+
+  std::ifstream file(path);
+  if (!file.is_open())
+    return nullptr;
+  std::stringstream buffer;
+  buffer << file.rdbuf();
+
+  std::set<std::string> engineClassNames;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    engineClassNames = m_engineClassNames;
+  }
+
+  auto errorCollector = std::make_shared<QErrorCollector>();
+  Tokenizer tokenizer(buffer.str(), true, errorCollector);
+  tokenizer.Tokenize();
+  if (errorCollector->HasErrors())
+    return nullptr;
+
+  Parser parser(tokenizer.GetTokens(), errorCollector);
+  parser.RegisterKnownClasses(engineClassNames);
+  auto program = parser.Parse();
+  if (program && !errorCollector->HasErrors()) {
+    entry.program = program;
+  }
+  return entry.program;
+}
+
+std::shared_ptr<ScriptAnalysis>
+ScriptCompileService::analyze(const std::string &path, const Job &job) {
+  namespace fs = std::filesystem;
+  auto start = std::chrono::steady_clock::now();
+
+  std::vector<std::shared_ptr<QProgram>> enginePrograms;
+  std::set<std::string> engineClassNames;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    enginePrograms = m_enginePrograms;
+    engineClassNames = m_engineClassNames;
+  }
+
+  FileModel &model = m_files[path];
+  size_t sourceHash = std::hash<std::string>{}(job.source);
+  bool sourceChanged = !model.parsed || sourceHash != model.sourceHash;
+
+  auto analysis = std::make_shared<ScriptAnalysis>();
+  analysis->path = path;
+  analysis->version = job.version;
+
+  auto report = [&analysis](const QErrorCollector &collector) {
+    for (const auto &err : collector.GetErrors()) {
+      analysis->diagnostics.push_back(
+          {err.GetSeverityString(), err.line, err.message});
+    }
+    analysis->errorCount += collector.GetErrorCount();
+    analysis->warningCount += collector.GetWarningCount();
+  };
+
+  // Tokenize and parse only when the text changed
+  std::shared_ptr<QProgram> program = model.program;
+  if (sourceChanged) {
+    model.sourceHash = sourceHash;
+    model.parsed = false;
+    auto errorCollector = std::make_shared<QErrorCollector>();
+    Tokenizer tokenizer(job.source, true, errorCollector);
+    tokenizer.Tokenize();
+
+    // Don't continue to parsing if there are lexer errors
+    if (!errorCollector->HasErrors()) {
+      Parser parser(tokenizer.GetTokens(), errorCollector);
+      parser.RegisterKnownClasses(engineClassNames);
+      program = parser.Parse();
+    }
+
+    if (errorCollector->HasErrors() || !program) {
+      model.siblings.clear();
+      report(*errorCollector);
+      analysis->milliseconds =
+          std::chrono::duration<double, std::milli>(
+              std::chrono::steady_clock::now() - start)
+              .count();
+      return analysis;
+    }
+    model.program = program;
+    model.parsed = true;
+    model.warnings.clear();
+    for (const auto &err : errorCollector->GetErrors()) {
+      model.warnings.push_back(
+          {err.GetSeverityString(), err.line, err.message});
+    }
+  }
+  analysis->diagnostics = model.warnings;
+  analysis->warningCount = static_cast<int>(model.warnings.size());
+
+  // Sibling scripts of the same folder enable cross-references between
+  // user-defined classes. Open files contribute their edited version.
+  std::vector<std::shared_ptr<QProgram>> siblings;
+  fs::path scriptPath(path);
+  fs::path contentDir = scriptPath.parent_path();
+  std::error_code ec;
+  if (fs::is_directory(contentDir, ec)) {
+    for (const auto &entry : fs::directory_iterator(contentDir, ec)) {
+      if (!entry.is_regular_file() || entry.path().extension() != ".q")
+        continue;
+      std::string siblingPath = entry.path().string();
+      if (siblingPath == path) {
+        siblings.push_back(program);
+        continue;
+      }
+      auto open = m_files.find(siblingPath);
+      auto sibling = open != m_files.end() && open->second.program
+                         ? open->second.program
+                         : loadSibling(entry.path());
+      if (sibling) {
+        siblings.push_back(sibling);
+      }
+    }
+  }
+  if (siblings.empty()) {
+    siblings.push_back(program);
+  }
+
+  if (!sourceChanged && siblings == model.siblings)
+    return nullptr;
+  model.siblings = siblings;
+
+  // Name validation, with engine classes registered first
+  auto context = std::make_shared<QContext>();
+  auto validationErrorCollector = std::make_shared<QErrorCollector>();
+  QRunner runner(context, validationErrorCollector);
+  runner.RegisterClasses(enginePrograms);
+  runner.RegisterClasses(siblings);
+  analysis->scriptCount = siblings.size();
+
+  bool namesValid = runner.EnsureNames(program);
+  if (!namesValid) {
+    report(*validationErrorCollector);
+  }
+
+  collectSymbols(program, *analysis);
+
+  // Class definitions for dot-completion, only from a valid set of scripts
+  if (namesValid) {
+    for (const auto &prog : siblings) {
+      for (const auto &cls : prog->GetClasses()) {
+        QLangClassDef classDef;
+        classDef.name = QString::fromStdString(cls->GetName());
+        classDef.parentClass =
+            QString::fromStdString(cls->GetParentClassName());
+        for (const auto &member : cls->GetMembers()) {
+          QString memberName = QString::fromStdString(member->GetName());
+          classDef.members << memberName;
+          classDef.memberTypes[memberName] =
+              QString::fromStdString(member->GetTypeName());
+        }
+        for (const auto &method : cls->GetMethods()) {
+          classDef.methods << QString::fromStdString(method->GetName());
+        }
+        analysis->classes.append(classDef);
+      }
+    }
+  }
+
+  analysis->milliseconds = std::chrono::duration<double, std::milli>(
+                               std::chrono::steady_clock::now() - start)
+                               .count();
+  return analysis;
+}
+
+void ScriptCompileService::collectSymbols(
+    const std::shared_ptr<QProgram> &program, ScriptAnalysis &analysis) {
+  analysis.hasSymbols = true;
+
+  for (const auto &cls : program->GetClasses()) {
+    QString className = QString::fromStdString(cls->GetName());
+    analysis.classNames << className;
+
+    QLangSymbol classSym;
+    classSym.name = className;
+    classSym.symbolType = "class";
+    analysis.symbols.append(classSym);
+
+    for (const auto &member : cls->GetMembers()) {
+      QLangSymbol sym;
+      sym.name = QString::fromStdString(member->GetName());
+      sym.symbolType = "member";
+      sym.dataType = QString::fromStdString(member->GetTypeName());
+      sym.parentClass = className;
+      analysis.symbols.append(sym);
+    }
+
+    for (const auto &method : cls->GetMethods()) {
+      QString methodName = QString::fromStdString(method->GetName());
+
+      QLangSymbol sym;
+      sym.name = methodName;
+      sym.symbolType = "method";
+      sym.dataType = QString::fromStdString(method->GetReturnTypeName());
+      sym.parentClass = className;
+      analysis.symbols.append(sym);
+
+      for (const auto &param : method->GetParameters()) {
+        QLangSymbol paramSym;
+        paramSym.name = QString::fromStdString(param.name);
+        paramSym.symbolType = "parameter";
+        paramSym.dataType = QString::fromStdString(param.typeName);
+        paramSym.parentClass = className;
+        paramSym.parentMethod = methodName;
+        analysis.symbols.append(paramSym);
+      }
+
+      // Locals anywhere in the body, nested blocks included
+      auto addLocal = [&](const std::string &name, const std::string &type) {
+        QLangSymbol localSym;
+        localSym.name = QString::fromStdString(name);
+        localSym.symbolType = "local";
+        localSym.dataType = QString::fromStdString(type);
+        localSym.parentClass = className;
+        localSym.parentMethod = methodName;
+        analysis.symbols.append(localSym);
+      };
+      std::function<void(const std::shared_ptr<QCode> &)> visit =
+          [&](const std::shared_ptr<QCode> &code) {
+            if (!code)
+              return;
+            for (const auto &node : code->GetNodes()) {
+              if (auto decl = std::dynamic_pointer_cast<QVariableDecl>(node)) {
+                addLocal(decl->GetName(), decl->GetTypeName());
+              } else if (auto inst =
+                             std::dynamic_pointer_cast<QInstanceDecl>(node)) {
+                addLocal(inst->GetInstanceName(), inst->GetQClassName());
+              } else if (auto forLoop =
+                             std::dynamic_pointer_cast<QFor>(node)) {
+                addLocal(forLoop->GetVarName(), "");
+                visit(forLoop->GetBody());
+              } else if (auto whileLoop =
+                             std::dynamic_pointer_cast<QWhile>(node)) {
+                visit(whileLoop->GetBody());
+              } else if (auto branch = std::dynamic_pointer_cast<QIf>(node)) {
+                visit(branch->GetThenBlock());
+                for (const auto &elseIf : branch->GetElseIfBlocks()) {
+                  visit(elseIf.second);
+                }
+                visit(branch->GetElseBlock());
+              }
+            }
+          };
+      visit(method->GetBody());
+    }
+  }
+}
+
+} // namespace Quantum
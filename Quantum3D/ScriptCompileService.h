@@ -0,0 +1,127 @@
+#pragma once
+
+#include "QLangSymbols.h"
+#include <QtCore/QObject>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+class QProgram;
+
+namespace Quantum {
+
+// One error or warning found while validating a script
+struct ScriptDiagnostic {
+  std::string severity; // As QError::GetSeverityString()
+  int line = 0;         // 0 if unknown (name validation)
+  std::string message;
+};
+
+// Result of validating one version of an open script. Published as a whole,
+// so the UI never sees diagnostics of one version with symbols of another.
+struct ScriptAnalysis {
+  std::string path;
+  uint64_t version = 0; // Submit() count for this path
+  std::vector<ScriptDiagnostic> diagnostics;
+  int errorCount = 0;
+  int warningCount = 0;
+  size_t scriptCount = 0; // User scripts registered for name validation
+  double milliseconds = 0.0;
+
+  // From the AST, when the script parsed. Otherwise empty: keep the last
+  // symbols that were published.
+  bool hasSymbols = false;
+  QList<QLangSymbol> symbols;
+  QStringList classNames;
+  QList<QLangClassDef> classes; // This script and its siblings, if valid
+};
+
+// ScriptCompileService - validates open scripts off the UI thread
+//
+// The editor submits the text of a file after each edit (debounced); a
+// worker thread tokenizes, parses and validates it with the real QLang front
+// end and publishes a ScriptAnalysis. Only the newest submission of a file
+// is analyzed; older ones are dropped. Sibling scripts of the same folder
+// are parsed once and kept until their file changes on disk (open files
+// use their latest edited version instead).
+class ScriptCompileService : public QObject {
+  Q_OBJECT
+
+public:
+  explicit ScriptCompileService(QObject *parent = nullptr);
+  ~ScriptCompileService();
+
+  // Engine classes registered before every validation. Call before the
+  // first Submit.
+  void SetEngineClasses(std::vector<std::shared_ptr<QProgram>> programs,
+                        std::set<std::string> classNames);
+
+  // Queue the current text of a file; returns its version
+  uint64_t Submit(const std::string &path, const QString &source);
+
+  // The file was closed: drop its pending work and cached model
+  void Forget(const std::string &path);
+
+  // Latest published analysis of a file (null before the first one)
+  std::shared_ptr<const ScriptAnalysis>
+  GetAnalysis(const std::string &path) const;
+
+signals:
+  // Emitted from the worker thread; connections to UI objects are queued
+  void analysisReady(const QString &path);
+
+private:
+  struct Job {
+    uint64_t version = 0;
+    std::string source;
+  };
+
+  // Per open file, worker thread only
+  struct FileModel {
+    size_t sourceHash = 0;
+    bool parsed = false; // 'program' and 'warnings' are from sourceHash
+    std::shared_ptr<QProgram> program; // Last version that parsed
+    std::vector<ScriptDiagnostic> warnings; // Tokenizer/parser, of 'program'
+    // Programs the last analysis validated against; unchanged text with the
+    // same siblings needs no new analysis
+    std::vector<std::shared_ptr<QProgram>> siblings;
+  };
+
+  // Sibling script parsed from disk, worker thread only
+  struct SiblingEntry {
+    std::filesystem::file_time_type stamp;
+    std::shared_ptr<QProgram> program; // Null if it does not parse
+  };
+
+  void workerLoop();
+  std::shared_ptr<ScriptAnalysis> analyze(const std::string &path,
+                                          const Job &job);
+  std::shared_ptr<QProgram> loadSibling(const std::filesystem::path &path);
+  static void collectSymbols(const std::shared_ptr<QProgram> &program,
+                             ScriptAnalysis &analysis);
+
+  mutable std::mutex m_mutex;
+  std::condition_variable m_wake;
+  std::unordered_map<std::string, Job> m_pending;
+  std::set<std::string> m_forgotten; // Closed; models dropped by the worker
+  std::unordered_map<std::string, uint64_t> m_versions;
+  std::unordered_map<std::string, std::shared_ptr<const ScriptAnalysis>>
+      m_published;
+  std::vector<std::shared_ptr<QProgram>> m_enginePrograms;
+  std::set<std::string> m_engineClassNames;
+  bool m_stop = false;
+
+  std::unordered_map<std::string, FileModel> m_files;
+  std::unordered_map<std::string, SiblingEntry> m_siblings;
+
+  std::thread m_worker; // Last: started once everything above exists
+};
+
+} // namespace Quantum
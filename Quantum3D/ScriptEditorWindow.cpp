@@ -1,8 +1,12 @@
 #include "ScriptEditorWindow.h"
+#include "EngineGlobals.h"
+#include "ScriptCompileService.h"
+#include <QAction>
 #include <QTimer>
 #include <QtCore/QCoreApplication>
 #include <QtWidgets/QMessageBox>
 #include <QtWidgets/QVBoxLayout>
+#include <chrono>
 #include <filesystem>
 #include <fstream>
 #include <sstream>
@@ -19,6 +23,9 @@ namespace Quantum {
 ScriptEditorWindow::ScriptEditorWindow(QWidget *parent) : QMainWindow(parent) {
   setWindowTitle("QLang Script Editor");
   resize(1000, 700);
+  m_compileService = new ScriptCompileService(this);
+  connect(m_compileService, &ScriptCompileService::analysisReady, this,
+          &ScriptEditorWindow::OnAnalysisReady);
   setupUI();
   loadEngineClasses(); // Pre-load known engine classes (Vec3, Mat4, etc.)
 }
@@ -35,6 +42,13 @@ void ScriptEditorWindow::setupUI() {
   connect(m_tabWidget, &QTabWidget::tabCloseRequested, this,
           &ScriptEditorWindow::OnTabCloseRequested);
 
+  // Ctrl+S writes the file and applies it to the running game
+  QAction *saveAction = new QAction("Save", this);
+  saveAction->setShortcut(QKeySequence::Save);
+  connect(saveAction, &QAction::triggered, this,
+          &ScriptEditorWindow::OnSaveRequested);
+  addAction(saveAction);
+
   // Console Dock
   m_consoleDock = new QDockWidget("Script Console", this);
   m_consoleOutput = new QPlainTextEdit(m_consoleDock);
@@ -112,7 +126,8 @@ void ScriptEditorWindow::createNewTab(const std::string &path,
   data.path = path;
   data.compileTimer = new QTimer(this);
   data.compileTimer->setSingleShot(true);
-  data.compileTimer->setInterval(2000); // 2 seconds
+  // Compiles run in the background, so a short pause in typing is enough
+  data.compileTimer->setInterval(500);
 
   // Store editor pointer on timer to find it back
   data.compileTimer->setProperty("editor", QVariant::fromValue((void *)editor));
@@ -157,6 +172,7 @@ void ScriptEditorWindow::OnTabCloseRequested(int index) {
 
   if (!pathToRemove.empty()) {
     m_openFiles.erase(pathToRemove);
+    m_compileService->Forget(pathToRemove);
   }
 
   // Cleanup Tab Data
@@ -201,169 +217,92 @@ void ScriptEditorWindow::OnCompileTimerTimeout() {
   }
 }
 
-void ScriptEditorWindow::compileScript(CodeEditor *editor) {
-  namespace fs = std::filesystem;
-
-  if (!editor || !m_tabData.count(editor))
+void ScriptEditorWindow::OnSaveRequested() {
+  CodeEditor *editor = qobject_cast<CodeEditor *>(m_tabWidget->currentWidget());
+  if (!editor || !m_tabData.count(editor)) {
     return;
-
-  std::string path = m_tabData[editor].path;
-  std::string code = editor->toPlainText().toStdString();
-
-  LogConsole("--- Compiling: " + path + " ---");
-
-  auto errorCollector = std::make_shared<QErrorCollector>();
-  Tokenizer tokenizer(code, true, errorCollector);
-  tokenizer.Tokenize();
-  const auto &tokens = tokenizer.GetTokens();
-
-  // Check for lexer errors first
-  if (errorCollector->HasErrors()) {
-    for (const auto &err : errorCollector->GetErrors()) {
-      LogConsole("[" + err.GetSeverityString() + "] Line " +
-                 std::to_string(err.line) + ": " + err.message);
-    }
-    return; // Don't continue to parsing if there are lexer errors
   }
+  const std::string &path = m_tabData[editor].path;
 
-  // Parse the user script code (name validation is deferred)
-  Parser parser(tokens, errorCollector);
-  parser.RegisterKnownClasses(m_engineClassNames); // For IntelliSense hints
-  auto program = parser.Parse();
-
-  // Check for parse errors
-  if (errorCollector->HasErrors()) {
-    for (const auto &err : errorCollector->GetErrors()) {
-      LogConsole("[" + err.GetSeverityString() + "] Line " +
-                 std::to_string(err.line) + ": " + err.message);
-    }
+  std::ofstream file(path, std::ios::binary);
+  if (!file.is_open()) {
+    QMessageBox::warning(
+        this, "Error", "Could not save file: " + QString::fromStdString(path));
     return;
   }
+  file << editor->toPlainText().toStdString();
+  file.close();
+  LogConsole("Saved: " + path);
 
-  // === Two-Phase Name Validation ===
-  // Create QRunner with all engine classes registered first
-  auto context = std::make_shared<QContext>();
-  auto validationErrorCollector = std::make_shared<QErrorCollector>();
-  QRunner runner(context, validationErrorCollector);
-
-  // Phase 1: Register all engine classes
-  runner.RegisterClasses(m_enginePrograms);
-
-  // Phase 2: Parse and register ALL user scripts in the same folder
-  // This enables cross-references between user-defined classes
-  fs::path scriptPath(path);
-  fs::path contentDir = scriptPath.parent_path();
-
-  std::vector<std::shared_ptr<QProgram>> siblingPrograms;
-  if (fs::exists(contentDir) && fs::is_directory(contentDir)) {
-    for (const auto &entry : fs::directory_iterator(contentDir)) {
-      if (entry.is_regular_file() && entry.path().extension() == ".q") {
-        std::string siblingPath = entry.path().string();
-
-        // For the current file, use the already-parsed program
-        if (siblingPath == path) {
-          if (program) {
-            siblingPrograms.push_back(program);
-          }
-          continue;
-        }
-
-        // Parse sibling script
-        std::ifstream file(entry.path());
-        if (!file.is_open())
-          continue;
-
-        std::stringstream buffer;
-        buffer << file.rdbuf();
-        std::string siblingCode = buffer.str();
-
-        auto siblingErrorCollector = std::make_shared<QErrorCollector>();
-        Tokenizer siblingTokenizer(siblingCode, true, siblingErrorCollector);
-        siblingTokenizer.Tokenize();
-
-        if (!siblingErrorCollector->HasErrors()) {
-          Parser siblingParser(siblingTokenizer.GetTokens(),
-                               siblingErrorCollector);
-          siblingParser.RegisterKnownClasses(m_engineClassNames);
-          auto siblingProgram = siblingParser.Parse();
-
-          if (siblingProgram && !siblingErrorCollector->HasErrors()) {
-            siblingPrograms.push_back(siblingProgram);
-          }
-        }
-      }
-    }
+  // Changed method bodies are patched in place, other edits rebuild
+  if (!EngineGlobals::m_QDomain) {
+    return;
+  }
+  auto start = std::chrono::steady_clock::now();
+  bool reloaded = EngineGlobals::m_QDomain->ReloadScript(path);
+  double ms = std::chrono::duration<double, std::milli>(
+                  std::chrono::steady_clock::now() - start)
+                  .count();
+  if (reloaded) {
+    LogConsole("Reloaded in " + std::to_string(static_cast<int>(ms)) + " ms");
   } else {
-    // If we can't read the folder, just register the current program
-    if (program) {
-      siblingPrograms.push_back(program);
-    }
+    LogConsole("Reload failed, the game keeps running the previous code");
   }
+}
 
-  // Register all user programs
-  runner.RegisterClasses(siblingPrograms);
+void ScriptEditorWindow::compileScript(CodeEditor *editor) {
+  if (!editor || !m_tabData.count(editor))
+    return;
 
-  LogConsole("Registered " + std::to_string(siblingPrograms.size()) +
-             " user script(s) from content folder");
+  // Tokenize, parse and name validation run on the compile service's
+  // worker; OnAnalysisReady reports the result
+  m_compileService->Submit(m_tabData[editor].path, editor->toPlainText());
+}
 
-  // Phase 3: Validate name references in user script
-  bool namesValid = true;
-  if (program) {
-    namesValid = runner.EnsureNames(program);
-  }
+void ScriptEditorWindow::OnAnalysisReady(const QString &qpath) {
+  std::string path = qpath.toStdString();
+  auto analysis = m_compileService->GetAnalysis(path);
+  auto openIt = m_openFiles.find(path);
+  if (!analysis || openIt == m_openFiles.end())
+    return;
+  CodeEditor *editor =
+      qobject_cast<CodeEditor *>(m_tabWidget->widget(openIt->second));
+  if (!editor)
+    return;
 
-  // Report validation errors
-  if (!namesValid) {
-    for (const auto &err : validationErrorCollector->GetErrors()) {
-      LogConsole("[" + err.GetSeverityString() + "] " + err.message);
+  LogConsole("--- Compiled: " + path + " ---");
+  for (const auto &diag : analysis->diagnostics) {
+    if (diag.line > 0) {
+      LogConsole("[" + diag.severity + "] Line " + std::to_string(diag.line) +
+                 ": " + diag.message);
+    } else {
+      LogConsole("[" + diag.severity + "] " + diag.message);
     }
   }
+  if (analysis->scriptCount > 0) {
+    LogConsole("Registered " + std::to_string(analysis->scriptCount) +
+               " user script(s) from content folder");
+  }
 
   // Report final status
-  if (errorCollector->HasAnyIssues() || !namesValid) {
-    int totalErrors = errorCollector->GetErrorCount() +
-                      validationErrorCollector->GetErrorCount();
-    int totalWarnings = errorCollector->GetWarningCount() +
-                        validationErrorCollector->GetWarningCount();
-
-    if (totalErrors > 0) {
-      LogConsole("Compile failed with " + std::to_string(totalErrors) +
-                 " error(s)");
-    } else if (totalWarnings > 0) {
-      LogConsole("Compiled with " + std::to_string(totalWarnings) +
-                 " warning(s)");
-    }
+  std::string timing =
+      " (" + std::to_string(static_cast<int>(analysis->milliseconds)) + " ms)";
+  if (analysis->errorCount > 0) {
+    LogConsole("Compile failed with " + std::to_string(analysis->errorCount) +
+               " error(s)" + timing);
+  } else if (analysis->warningCount > 0) {
+    LogConsole("Compiled with " + std::to_string(analysis->warningCount) +
+               " warning(s)" + timing);
   } else {
-    LogConsole("Compiled OK");
+    LogConsole("Compiled OK" + timing);
   }
 
-  // On successful compile (no errors), extract class definitions for
-  // IntelliSense from ALL registered programs (current + siblings)
-  if (namesValid) {
-    for (const auto &prog : siblingPrograms) {
-      for (const auto &cls : prog->GetClasses()) {
-        QLangClassDef classDef;
-        classDef.name = QString::fromStdString(cls->GetName());
-        classDef.parentClass =
-            QString::fromStdString(cls->GetParentClassName());
-
-        // Add members
-        for (const auto &member : cls->GetMembers()) {
-          QString memberName = QString::fromStdString(member->GetName());
-          QString memberType = QString::fromStdString(member->GetTypeName());
-          classDef.members << memberName;
-          classDef.memberTypes[memberName] = memberType;
-        }
-
-        // Add methods
-        for (const auto &method : cls->GetMethods()) {
-          classDef.methods << QString::fromStdString(method->GetName());
-        }
-
-        // Register with this editor's symbol collector
-        editor->symbolCollector().registerExternalClass(classDef);
-      }
-    }
+  // Symbols and class definitions of this version, for IntelliSense
+  if (analysis->hasSymbols) {
+    editor->setCompiledSymbols(analysis->symbols, analysis->classNames);
+  }
+  for (const auto &classDef : analysis->classes) {
+    editor->symbolCollector().registerExternalClass(classDef);
   }
 }
 
@@ -486,6 +425,8 @@ void ScriptEditorWindow::loadEngineClasses() {
     }
   }
 
+  m_compileService->SetEngineClasses(m_enginePrograms, m_engineClassNames);
+
   // Summary
   LogConsole("=== Engine Classes Summary ===");
   LogConsole("Total engine classes: " +
@@ -15,6 +15,8 @@ class QProgram; // Forward declaration for engine programs
 
 namespace Quantum {
 
+class ScriptCompileService;
+
 class ScriptEditorWindow : public QMainWindow {
   Q_OBJECT
 
@@ -33,6 +35,8 @@ private slots:
   void OnCurrentTabChanged(int index);
   void OnTextChanged();
   void OnCompileTimerTimeout();
+  void OnSaveRequested();
+  void OnAnalysisReady(const QString &path);
 
 private:
   struct TabData {
@@ -59,6 +63,8 @@ private:
   std::vector<QLangClassDef> m_engineClassDefs;
   // Parsed engine programs (for deferred name validation)
   std::vector<std::shared_ptr<QProgram>> m_enginePrograms;
+  // Validates open scripts on a worker thread
+  ScriptCompileService *m_compileService;
 
   // Register engine classes with an editor's symbol collector
   void registerEngineClassesWithEditor(CodeEditor *editor);
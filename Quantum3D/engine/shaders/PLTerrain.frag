@@ -26,26 +26,25 @@ layout(set = 0, binding = 0) uniform UniformBufferObject {
 } ubo;
 
 // Layer textures (Set 1)
-// 4 layers - each layer has color, normal, specular, and layer map
+// 4 layers - each layer has color, normal and specular maps.
+// Binding 3 is the packed blend map: layer N weight is stored in channel N.
+// Bindings 7, 11 and 15 are kept in the layout but no longer sampled.
 layout(set = 1, binding = 0) uniform sampler2D layer0Color;
 layout(set = 1, binding = 1) uniform sampler2D layer0Normal;
 layout(set = 1, binding = 2) uniform sampler2D layer0Specular;
-layout(set = 1, binding = 3) uniform sampler2D layer0Map;
+layout(set = 1, binding = 3) uniform sampler2D blendMap;
 
 layout(set = 1, binding = 4) uniform sampler2D layer1Color;
 layout(set = 1, binding = 5) uniform sampler2D layer1Normal;
 layout(set = 1, binding = 6) uniform sampler2D layer1Specular;
-layout(set = 1, binding = 7) uniform sampler2D layer1Map;
 
 layout(set = 1, binding = 8) uniform sampler2D layer2Color;
 layout(set = 1, binding = 9) uniform sampler2D layer2Normal;
 layout(set = 1, binding = 10) uniform sampler2D layer2Specular;
-layout(set = 1, binding = 11) uniform sampler2D layer2Map;
 
 layout(set = 1, binding = 12) uniform sampler2D layer3Color;
 layout(set = 1, binding = 13) uniform sampler2D layer3Normal;
 layout(set = 1, binding = 14) uniform sampler2D layer3Specular;
-layout(set = 1, binding = 15) uniform sampler2D layer3Map;
 
 // Shadow maps
 layout(set = 0, binding = 1) uniform samplerCube shadowMap;
@@ -111,30 +110,33 @@ void main() {
     vec3 blendedColor = vec3(0.0);
     vec3 blendedNormal = vec3(0.0);
     float blendedSpecular = 0.0;
+
+    // One fetch for all four layer weights
+    vec4 weights = texture(blendMap, fragLayerUV);
     
     // Layer 0
-    float w0 = texture(layer0Map, fragLayerUV).r;
+    float w0 = weights.r;
     blendedColor += texture(layer0Color, fragTiledUV).rgb * w0;
     blendedNormal += (texture(layer0Normal, fragTiledUV).rgb * 2.0 - 1.0) * w0;
     blendedSpecular += texture(layer0Specular, fragTiledUV).r * w0;
     totalWeight += w0;
     
     // Layer 1
-    float w1 = texture(layer1Map, fragLayerUV).r;
+    float w1 = weights.g;
     blendedColor += texture(layer1Color, fragTiledUV).rgb * w1;
     blendedNormal += (texture(layer1Normal, fragTiledUV).rgb * 2.0 - 1.0) * w1;
     blendedSpecular += texture(layer1Specular, fragTiledUV).r * w1;
     totalWeight += w1;
     
     // Layer 2
-    float w2 = texture(layer2Map, fragLayerUV).r;
+    float w2 = weights.b;
     blendedColor += texture(layer2Color, fragTiledUV).rgb * w2;
     blendedNormal += (texture(layer2Normal, fragTiledUV).rgb * 2.0 - 1.0) * w2;
     blendedSpecular += texture(layer2Specular, fragTiledUV).r * w2;
     totalWeight += w2;
     
     // Layer 3
-    float w3 = texture(layer3Map, fragLayerUV).r;
+    float w3 = weights.a;
     blendedColor += texture(layer3Color, fragTiledUV).rgb * w3;
     blendedNormal += (texture(layer3Normal, fragTiledUV).rgb * 2.0 - 1.0) * w3;
     blendedSpecular += texture(layer3Specular, fragTiledUV).r * w3;
@@ -0,0 +1,193 @@
+#version 450
+
+// Inputs from vertex shader
+layout(location = 0) in vec3 fragWorldPos;
+layout(location = 1) in vec3 fragNormal;
+layout(location = 2) in vec2 fragTiledUV;
+layout(location = 3) in vec2 fragLayerUV;
+layout(location = 4) in vec3 fragTangent;
+layout(location = 5) in vec3 fragBitangent;
+layout(location = 6) in vec4 fragLightSpacePos;
+
+// Uniforms - MUST match PLPBR.frag UBO layout exactly
+layout(set = 0, binding = 0) uniform UniformBufferObject {
+    mat4 model;
+    mat4 view;
+    mat4 proj;
+    mat4 lightSpaceMatrix;
+    vec3 viewPos;
+    float time;
+    vec3 lightPos;
+    float clipPlaneDir;
+    vec3 lightColor;
+    float lightRange;
+    float lightType;  // 0 = Point, 1 = Directional, 2 = Spot
+    float _pad1, _pad2, _pad3;  // Padding for alignment
+} ubo;
+
+// Virtual texture (Set 1) - same layout as PLTerrain, only 0-2 are sampled.
+// The page table has one texel per finest page: atlas slot x/y, mip level of
+// the finest resident tile covering it, and a resident flag in alpha.
+layout(set = 1, binding = 0) uniform sampler2D albedoAtlas;
+layout(set = 1, binding = 1) uniform sampler2D normalAtlas;
+layout(set = 1, binding = 2) uniform sampler2D pageTable;
+
+// Must match TerrainTileCompositor
+const float TILE_SIZE = 128.0;
+const float TILE_BORDER = 4.0;
+const float TILE_STRIDE = TILE_SIZE + TILE_BORDER * 2.0;
+
+// Shadow maps
+layout(set = 0, binding = 1) uniform samplerCube shadowMap;
+layout(set = 0, binding = 2) uniform sampler2D dirShadowMap;
+
+// Output
+layout(location = 0) out vec4 outColor;
+
+// Calculate point shadow factor
+vec3 gridOffsets[20] = vec3[](
+   vec3(1, 1, 1), vec3(1, -1, 1), vec3(-1, -1, 1), vec3(-1, 1, 1), 
+   vec3(1, 1, -1), vec3(1, -1, -1), vec3(-1, -1, -1), vec3(-1, 1, -1),
+   vec3(1, 1, 0), vec3(1, -1, 0), vec3(-1, -1, 0), vec3(-1, 1, 0),
+   vec3(1, 0, 1), vec3(-1, 0, 1), vec3(1, 0, -1), vec3(-1, 0, -1),
+   vec3(0, 1, 1), vec3(0, -1, 1), vec3(0, -1, -1), vec3(0, 1, -1)
+);
+
+float calculatePointShadow(vec3 fragToLight, float currentDepth) {
+    float shadowFarPlane = ubo.lightRange > 0.0 ? ubo.lightRange : 100.0;
+    float normalizedCurrent = currentDepth / shadowFarPlane;
+    float bias = 0.0001;
+
+    if (normalizedCurrent > 1.0) return 1.0;
+
+    float viewDistance = length(ubo.viewPos - fragWorldPos);
+    float diskRadius = (1.0 + (viewDistance / shadowFarPlane)) / 50.0; 
+    
+    float shadow = 0.0;
+    for(int i = 0; i < 20; ++i) {
+        float closestDepth = texture(shadowMap, fragToLight + gridOffsets[i] * diskRadius).r;
+        if (normalizedCurrent - bias > closestDepth) {
+            shadow += 1.0;
+        }
+    }
+    
+    return 1.0 - (shadow / 20.0);
+}
+
+// Calculate directional shadow factor
+float calculateDirShadow(vec4 lightSpacePos) {
+    vec3 projCoords = lightSpacePos.xyz / lightSpacePos.w;
+    projCoords.x = projCoords.x * 0.5 + 0.5;
+    projCoords.y = projCoords.y * 0.5 + 0.5;
+
+    if (projCoords.x < 0.0 || projCoords.x > 1.0 ||
+        projCoords.y < 0.0 || projCoords.y > 1.0) {
+        return 1.0;
+    }
+
+    float currentDepth = projCoords.z;
+    float shadowMapDepth = texture(dirShadowMap, projCoords.xy).r;
+    float bias = 0.005;
+
+    if (currentDepth > shadowMapDepth + bias) {
+        return 0.0;
+    }
+    return 1.0;
+}
+
+// Translate terrain UV to atlas UV through the page table
+vec2 vtAtlasUV(vec2 uv, out bool resident) {
+    ivec2 pages = textureSize(pageTable, 0);
+    ivec2 page = clamp(ivec2(uv * vec2(pages)), ivec2(0), pages - 1);
+    vec4 entry = texelFetch(pageTable, page, 0) * 255.0;
+    resident = entry.a > 0.5;
+
+    // Position inside the resident tile (which may be a coarser mip)
+    float tilesAtMip = float(pages.x) / exp2(floor(entry.b + 0.5));
+    vec2 inTile = fract(clamp(uv, 0.0, 0.99999) * tilesAtMip);
+
+    vec2 texel = floor(entry.rg + 0.5) * TILE_STRIDE + TILE_BORDER + inTile * TILE_SIZE;
+    return texel / vec2(textureSize(albedoAtlas, 0));
+}
+
+void main() {
+    // Pre-composited layers: one albedo and one normal fetch per pixel
+    bool resident;
+    vec2 atlasUV = vtAtlasUV(fragLayerUV, resident);
+
+    vec3 blendedColor = vec3(1.0);
+    vec3 blendedNormal = vec3(0.0, 0.0, 1.0);
+    if (resident) {
+        blendedColor = texture(albedoAtlas, atlasUV).rgb;
+        blendedNormal = texture(normalAtlas, atlasUV).rgb * 2.0 - 1.0;
+    }
+
+    // Specular is not composited; matches the default layer specular
+    float blendedSpecular = 0.5;
+    
+    // Transform normal to world space using TBN matrix
+    vec3 N = normalize(fragNormal);
+    vec3 T = normalize(fragTangent - dot(fragTangent, N) * N);
+    vec3 B = normalize(fragBitangent);
+    mat3 TBN = mat3(T, B, N);
+    vec3 worldNormal = normalize(TBN * normalize(blendedNormal));
+    
+    // View direction
+    vec3 V = normalize(ubo.viewPos - fragWorldPos);
+    
+    // Calculate light direction based on light type
+    vec3 L;
+    float distance;
+    float attenuation;
+    float rangeFactor = 1.0;
+    
+    if (ubo.lightType < 0.5) {
+        // Point Light: lightPos is a position
+        L = normalize(ubo.lightPos - fragWorldPos);
+        distance = length(ubo.lightPos - fragWorldPos);
+        if (ubo.lightRange > 0.0) {
+            rangeFactor = max(0.0, 1.0 - distance / ubo.lightRange);
+        }
+        attenuation = 1.0 / (distance * distance + 0.001);
+    } else {
+        // Directional Light: lightPos IS the direction (negate for L)
+        L = -normalize(ubo.lightPos);
+        distance = 1.0;
+        attenuation = 1.0;
+    }
+    
+    vec3 H = normalize(V + L);
+    
+    // Diffuse
+    float NdotL = max(dot(worldNormal, L), 0.0);
+    vec3 diffuse = blendedColor * NdotL;
+    
+    // Specular (Blinn-Phong)
+    float NdotH = max(dot(worldNormal, H), 0.0);
+    float specPower = 32.0;
+    vec3 specular = vec3(blendedSpecular) * pow(NdotH, specPower);
+    
+    // Shadow
+    float shadow = 1.0;
+    if (ubo.lightType < 0.5) {
+        // Point Light Shadow
+        vec3 fragToLight = fragWorldPos - ubo.lightPos;
+        fragToLight.x = -fragToLight.x;
+        shadow = calculatePointShadow(fragToLight, distance);
+    } else {
+        // Directional Light Shadow
+        vec4 fragPosLightSpace = ubo.lightSpaceMatrix * vec4(fragWorldPos, 1.0);
+        shadow = calculateDirShadow(fragPosLightSpace);
+    }
+    
+    // Radiance
+    vec3 radiance = ubo.lightColor * attenuation * rangeFactor;
+    
+    // Ambient
+    vec3 ambient = blendedColor * 0.03;
+    
+    // Final color
+    vec3 finalColor = ambient + (diffuse + specular) * radiance * shadow;
+    
+    outColor = vec4(finalColor, 1.0);
+}
@@ -0,0 +1,230 @@
+#include "DynamicAABBTree.h"
+#include <cassert>
+
+namespace Quantum {
+
+// ========== Node Pool ==========
+
+int DynamicAABBTree::AllocateNode() {
+  if (m_FreeList == NullNode) {
+    m_Nodes.emplace_back();
+    m_Nodes.back().height = 0;
+    return static_cast<int>(m_Nodes.size()) - 1;
+  }
+
+  int id = m_FreeList;
+  m_FreeList = m_Nodes[id].parent;
+  m_Nodes[id] = Node();
+  m_Nodes[id].height = 0;
+  return id;
+}
+
+void DynamicAABBTree::FreeNode(int node) {
+  m_Nodes[node].parent = m_FreeList;
+  m_Nodes[node].height = -1;
+  m_Nodes[node].userData = nullptr;
+  m_FreeList = node;
+}
+
+void DynamicAABBTree::Clear() {
+  m_Nodes.clear();
+  m_Root = NullNode;
+  m_FreeList = NullNode;
+  m_ProxyCount = 0;
+}
+
+// ========== Proxies ==========
+
+int DynamicAABBTree::CreateProxy(const AABB &box, void *userData) {
+  int proxy = AllocateNode();
+  m_Nodes[proxy].box = {box.min - glm::vec3(Margin),
+                        box.max + glm::vec3(Margin)};
+  m_Nodes[proxy].userData = userData;
+  InsertLeaf(proxy);
+  ++m_ProxyCount;
+  return proxy;
+}
+
+void DynamicAABBTree::DestroyProxy(int proxy) {
+  assert(m_Nodes[proxy].IsLeaf());
+  RemoveLeaf(proxy);
+  FreeNode(proxy);
+  --m_ProxyCount;
+}
+
+bool DynamicAABBTree::MoveProxy(int proxy, const AABB &box) {
+  if (m_Nodes[proxy].box.Contains(box))
+    return false;
+
+  RemoveLeaf(proxy);
+  m_Nodes[proxy].box = {box.min - glm::vec3(Margin),
+                        box.max + glm::vec3(Margin)};
+  InsertLeaf(proxy);
+  return true;
+}
+
+// ========== Insertion / Removal ==========
+
+void DynamicAABBTree::InsertLeaf(int leaf) {
+  if (m_Root == NullNode) {
+    m_Root = leaf;
+    m_Nodes[leaf].parent = NullNode;
+    return;
+  }
+
+  // Descend towards the cheapest sibling (surface area heuristic)
+  const AABB leafBox = m_Nodes[leaf].box;
+  int index = m_Root;
+  while (!m_Nodes[index].IsLeaf()) {
+    const Node &node = m_Nodes[index];
+    float area = node.box.SurfaceArea();
+    float combinedArea = AABB::Merge(node.box, leafBox).SurfaceArea();
+
+    // Cost of making a new parent for this node and the leaf
+    float cost = 2.0f * combinedArea;
+    // Minimum cost of pushing the leaf further down
+    float inheritance = 2.0f * (combinedArea - area);
+
+    auto childCost = [&](int child) {
+      AABB merged = AABB::Merge(leafBox, m_Nodes[child].box);
+      if (m_Nodes[child].IsLeaf())
+        return merged.SurfaceArea() + inheritance;
+      return merged.SurfaceArea() - m_Nodes[child].box.SurfaceArea() +
+             inheritance;
+    };
+    float cost1 = childCost(node.child1);
+    float cost2 = childCost(node.child2);
+
+    if (cost < cost1 && cost < cost2)
+      break;
+    index = cost1 < cost2 ? node.child1 : node.child2;
+  }
+
+  int sibling = index;
+  int oldParent = m_Nodes[sibling].parent;
+  int newParent = AllocateNode();
+  m_Nodes[newParent].parent = oldParent;
+  m_Nodes[newParent].box = AABB::Merge(leafBox, m_Nodes[sibling].box);
+  m_Nodes[newParent].height = m_Nodes[sibling].height + 1;
+  m_Nodes[newParent].child1 = sibling;
+  m_Nodes[newParent].child2 = leaf;
+  m_Nodes[sibling].parent = newParent;
+  m_Nodes[leaf].parent = newParent;
+
+  if (oldParent != NullNode) {
+    if (m_Nodes[oldParent].child1 == sibling)
+      m_Nodes[oldParent].child1 = newParent;
+    else
+      m_Nodes[oldParent].child2 = newParent;
+  } else {
+    m_Root = newParent;
+  }
+
+  // Refit and rebalance ancestors
+  index = m_Nodes[leaf].parent;
+  while (index != NullNode) {
+    index = Balance(index);
+    Node &node = m_Nodes[index];
+    node.height =
+        1 + std::max(m_Nodes[node.child1].height, m_Nodes[node.child2].height);
+    node.box = AABB::Merge(m_Nodes[node.child1].box, m_Nodes[node.child2].box);
+    index = node.parent;
+  }
+}
+
+void DynamicAABBTree::RemoveLeaf(int leaf) {
+  if (leaf == m_Root) {
+    m_Root = NullNode;
+    return;
+  }
+
+  int parent = m_Nodes[leaf].parent;
+  int grandParent = m_Nodes[parent].parent;
+  int sibling = m_Nodes[parent].child1 == leaf ? m_Nodes[parent].child2
+                                               : m_Nodes[parent].child1;
+
+  if (grandParent != NullNode) {
+    // Replace the parent with the sibling
+    if (m_Nodes[grandParent].child1 == parent)
+      m_Nodes[grandParent].child1 = sibling;
+    else
+      m_Nodes[grandParent].child2 = sibling;
+    m_Nodes[sibling].parent = grandParent;
+    FreeNode(parent);
+
+    int index = grandParent;
+    while (index != NullNode) {
+      index = Balance(index);
+      Node &node = m_Nodes[index];
+      node.box =
+          AABB::Merge(m_Nodes[node.child1].box, m_Nodes[node.child2].box);
+      node.height = 1 + std::max(m_Nodes[node.child1].height,
+                                 m_Nodes[node.child2].height);
+      index = node.parent;
+    }
+  } else {
+    m_Root = sibling;
+    m_Nodes[sibling].parent = NullNode;
+    FreeNode(parent);
+  }
+}
+
+// ========== Balancing ==========
+
+// Rotate 'a' if one child is more than one level taller than the other.
+// Returns the index of the node now at a's position.
+int DynamicAABBTree::Balance(int iA) {
+  Node &A = m_Nodes[iA];
+  if (A.IsLeaf() || A.height < 2)
+    return iA;
+
+  int iB = A.child1;
+  int iC = A.child2;
+  int balance = m_Nodes[iC].height - m_Nodes[iB].height;
+
+  // Promote the taller child (iC if balance > 0, otherwise iB)
+  auto rotate = [&](int iUp, int iStay, bool upIsChild2) {
+    Node &up = m_Nodes[iUp];
+    int iF = up.child1;
+    int iG = up.child2;
+
+    // Swap A and up
+    up.child1 = iA;
+    up.parent = A.parent;
+    A.parent = iUp;
+
+    if (up.parent != NullNode) {
+      if (m_Nodes[up.parent].child1 == iA)
+        m_Nodes[up.parent].child1 = iUp;
+      else
+        m_Nodes[up.parent].child2 = iUp;
+    } else {
+      m_Root = iUp;
+    }
+
+    // Keep the taller grandchild under 'up', move the other under A
+    int iKeep = m_Nodes[iF].height > m_Nodes[iG].height ? iF : iG;
+    int iMove = iKeep == iF ? iG : iF;
+    up.child2 = iKeep;
+    if (upIsChild2)
+      A.child2 = iMove;
+    else
+      A.child1 = iMove;
+    m_Nodes[iMove].parent = iA;
+
+    A.box = AABB::Merge(m_Nodes[iStay].box, m_Nodes[iMove].box);
+    up.box = AABB::Merge(A.box, m_Nodes[iKeep].box);
+    A.height =
+        1 + std::max(m_Nodes[iStay].height, m_Nodes[iMove].height);
+    up.height = 1 + std::max(A.height, m_Nodes[iKeep].height);
+    return iUp;
+  };
+
+  if (balance > 1)
+    return rotate(iC, iB, true);
+  if (balance < -1)
+    return rotate(iB, iC, false);
+  return iA;
+}
+
+} // namespace Quantum
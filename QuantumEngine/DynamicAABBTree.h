@@ -0,0 +1,224 @@
+#pragma once
+#include "glm/glm.hpp"
+#include <algorithm>
+#include <vector>
+
+namespace Quantum {
+
+/// <summary>
+/// Axis aligned bounding box.
+/// </summary>
+struct AABB {
+  glm::vec3 min = glm::vec3(0.0f);
+  glm::vec3 max = glm::vec3(0.0f);
+
+  bool Overlaps(const AABB &other) const {
+    return min.x <= other.max.x && max.x >= other.min.x &&
+           min.y <= other.max.y && max.y >= other.min.y &&
+           min.z <= other.max.z && max.z >= other.min.z;
+  }
+
+  bool Contains(const AABB &other) const {
+    return min.x <= other.min.x && min.y <= other.min.y &&
+           min.z <= other.min.z && max.x >= other.max.x &&
+           max.y >= other.max.y && max.z >= other.max.z;
+  }
+
+  float SurfaceArea() const {
+    glm::vec3 d = max - min;
+    return 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
+  }
+
+  static AABB Merge(const AABB &a, const AABB &b) {
+    return {glm::min(a.min, b.min), glm::max(a.max, b.max)};
+  }
+
+  /// <summary>
+  /// Slab test. Returns true and the entry distance if the ray (unit or
+  /// non-unit direction, distances in units of 'dir') hits within maxT.
+  /// </summary>
+  bool RayIntersect(const glm::vec3 &origin, const glm::vec3 &invDir,
+                    float maxT, float &outT) const {
+    glm::vec3 t0 = (min - origin) * invDir;
+    glm::vec3 t1 = (max - origin) * invDir;
+    glm::vec3 tNear = glm::min(t0, t1);
+    glm::vec3 tFar = glm::max(t0, t1);
+    float enter = std::max(std::max(tNear.x, tNear.y), std::max(tNear.z, 0.0f));
+    float exit = std::min(std::min(tFar.x, tFar.y), std::min(tFar.z, maxT));
+    outT = enter;
+    return enter <= exit;
+  }
+};
+
+/// <summary>
+/// Incrementally maintained bounding volume hierarchy (dynamic AABB tree).
+/// Leaves store a "fat" box (tight box plus Margin) so small movements don't
+/// touch the tree; insertion picks the sibling with the lowest surface area
+/// cost and the tree is kept balanced with AVL-style rotations.
+/// Proxy ids are stable until DestroyProxy.
+/// </summary>
+class DynamicAABBTree {
+public:
+  static constexpr int NullNode = -1;
+  static constexpr float Margin = 0.1f;
+
+  DynamicAABBTree() = default;
+
+  int CreateProxy(const AABB &box, void *userData);
+  void DestroyProxy(int proxy);
+
+  /// <summary>
+  /// Update a proxy's box. Returns true if the leaf had to be reinserted
+  /// (the tight box left the fat box).
+  /// </summary>
+  bool MoveProxy(int proxy, const AABB &box);
+
+  void *GetUserData(int proxy) const { return m_Nodes[proxy].userData; }
+  const AABB &GetFatAABB(int proxy) const { return m_Nodes[proxy].box; }
+
+  int GetProxyCount() const { return m_ProxyCount; }
+  int GetHeight() const {
+    return m_Root == NullNode ? 0 : m_Nodes[m_Root].height;
+  }
+
+  void Clear();
+
+  /// <summary>
+  /// Visit every proxy whose fat box overlaps 'box'.
+  /// callback(int proxy) returns false to stop the query.
+  /// </summary>
+  template <typename Callback>
+  void Query(const AABB &box, Callback &&callback) const {
+    Traverse([&](const AABB &nodeBox) { return nodeBox.Overlaps(box); },
+             callback);
+  }
+
+  /// <summary>
+  /// Visit every proxy whose fat box is at least partially inside the six
+  /// planes (ax + by + cz + d >= 0 is inside).
+  /// </summary>
+  template <typename Callback>
+  void QueryPlanes(const glm::vec4 planes[6], Callback &&callback) const {
+    Traverse(
+        [&](const AABB &nodeBox) {
+          for (int i = 0; i < 6; ++i) {
+            // Corner furthest along the plane normal
+            glm::vec3 p(planes[i].x >= 0.0f ? nodeBox.max.x : nodeBox.min.x,
+                        planes[i].y >= 0.0f ? nodeBox.max.y : nodeBox.min.y,
+                        planes[i].z >= 0.0f ? nodeBox.max.z : nodeBox.min.z);
+            if (glm::dot(glm::vec3(planes[i]), p) + planes[i].w < 0.0f)
+              return false;
+          }
+          return true;
+        },
+        callback);
+  }
+
+  /// <summary>
+  /// Visit proxies whose fat box the ray origin + t * dir (0 <= t <= maxT)
+  /// crosses, nearest box first. callback(int proxy, float entryT) returns
+  /// the new maxT: return a hit distance to clip the ray, or the value passed
+  /// in to keep going. Subtrees beyond the clip distance are skipped.
+  /// </summary>
+  template <typename Callback>
+  void RayCast(const glm::vec3 &origin, const glm::vec3 &dir, float maxT,
+               Callback &&callback) const;
+
+private:
+  struct Node {
+    AABB box;
+    void *userData = nullptr;
+    int parent = NullNode; // Doubles as the free list link
+    int child1 = NullNode;
+    int child2 = NullNode;
+    int height = -1; // Leaf = 0, free = -1
+
+    bool IsLeaf() const { return child1 == NullNode; }
+  };
+
+  int AllocateNode();
+  void FreeNode(int node);
+  void InsertLeaf(int leaf);
+  void RemoveLeaf(int leaf);
+  int Balance(int node);
+
+  template <typename Test, typename Callback>
+  void Traverse(Test &&test, Callback &&callback) const {
+    if (m_Root == NullNode)
+      return;
+    std::vector<int> stack;
+    stack.reserve(64);
+    stack.push_back(m_Root);
+    while (!stack.empty()) {
+      int id = stack.back();
+      stack.pop_back();
+      const Node &node = m_Nodes[id];
+      if (!test(node.box))
+        continue;
+      if (node.IsLeaf()) {
+        if (!callback(id))
+          return;
+      } else {
+        stack.push_back(node.child1);
+        stack.push_back(node.child2);
+      }
+    }
+  }
+
+  std::vector<Node> m_Nodes;
+  int m_Root = NullNode;
+  int m_FreeList = NullNode;
+  int m_ProxyCount = 0;
+};
+
+template <typename Callback>
+void DynamicAABBTree::RayCast(const glm::vec3 &origin, const glm::vec3 &dir,
+                              float maxT, Callback &&callback) const {
+  if (m_Root == NullNode)
+    return;
+
+  const float big = 1e30f;
+  glm::vec3 invDir(dir.x != 0.0f ? 1.0f / dir.x : big,
+                   dir.y != 0.0f ? 1.0f / dir.y : big,
+                   dir.z != 0.0f ? 1.0f / dir.z : big);
+
+  // (entry distance, node) pairs; children are pushed far-first so the
+  // nearer one is popped next
+  std::vector<std::pair<float, int>> stack;
+  float t;
+  if (!m_Nodes[m_Root].box.RayIntersect(origin, invDir, maxT, t))
+    return;
+  stack.push_back({t, m_Root});
+
+  while (!stack.empty()) {
+    auto [entry, id] = stack.back();
+    stack.pop_back();
+    if (entry > maxT)
+      continue;
+
+    const Node &node = m_Nodes[id];
+    if (node.IsLeaf()) {
+      maxT = callback(id, entry);
+      continue;
+    }
+
+    float t1, t2;
+    bool hit1 = m_Nodes[node.child1].box.RayIntersect(origin, invDir, maxT, t1);
+    bool hit2 = m_Nodes[node.child2].box.RayIntersect(origin, invDir, maxT, t2);
+    if (hit1 && hit2) {
+      if (t1 < t2) {
+        stack.push_back({t2, node.child2});
+        stack.push_back({t1, node.child1});
+      } else {
+        stack.push_back({t1, node.child1});
+        stack.push_back({t2, node.child2});
+      }
+    } else if (hit1) {
+      stack.push_back({t1, node.child1});
+    } else if (hit2) {
+      stack.push_back({t2, node.child2});
+    }
+  }
+}
+
+} // namespace Quantum
@@ -3,6 +3,7 @@
 
 #include "Mesh3D.h"
 #include "QLangDomain.h"
+#include "SceneIndex.h"
 #include <algorithm>
 #include <cmath>
 #include <variant>
@@ -10,11 +11,8 @@
 namespace Quantum {
 
 GraphNode::GraphNode(const std::string &name)
-    : m_Name(name), m_LocalPosition(0.0f, 0.0f, 0.0f),
-      m_LocalRotation(1.0f) // Identity matrix
-      ,
-      m_LocalScale(1.0f, 1.0f, 1.0f), m_Parent(nullptr),
-      m_CachedWorldMatrix(1.0f), m_WorldMatrixDirty(true) {}
+    : m_Name(name), m_Transform(TransformHierarchy::Get().Create()),
+      m_Parent(nullptr) {}
 
 GraphNode::~GraphNode() {
   // Remove from parent
@@ -23,13 +21,44 @@ GraphNode::~GraphNode() {
   }
   // Clear children (they will handle their own cleanup)
   m_Children.clear();
+
+  if (m_SceneIndex) {
+    m_SceneIndex->OnNodeDestroyed(this);
+  }
+  TransformHierarchy::Get().Destroy(m_Transform);
+}
+
+void GraphNode::SetName(const std::string &name) {
+  std::string oldName = m_Name;
+  m_Name = name;
+  if (m_SceneIndex) {
+    m_SceneIndex->OnNodeRenamed(this, oldName);
+  }
+}
+
+// ========== Transform Getters ==========
+
+glm::vec3 GraphNode::GetLocalPosition() const {
+  return TransformHierarchy::Get().GetPosition(m_Transform);
+}
+
+glm::mat4 GraphNode::GetLocalRotation() const {
+  return glm::mat4_cast(GetLocalRotationQuat());
+}
+
+glm::quat GraphNode::GetLocalRotationQuat() const {
+  return TransformHierarchy::Get().GetRotation(m_Transform);
+}
+
+glm::vec3 GraphNode::GetLocalScale() const {
+  return TransformHierarchy::Get().GetScale(m_Transform);
 }
 
 // ========== Transform Setters ==========
 
 void GraphNode::SetLocalPosition(const glm::vec3 &position) {
-  m_LocalPosition = position;
-  InvalidateTransform();
+  TransformHierarchy::Get().SetPosition(m_Transform, position);
+  OnTransformChanged();
 }
 
 void GraphNode::SetLocalPosition(float x, float y, float z) {
@@ -37,13 +66,17 @@ void GraphNode::SetLocalPosition(float x, float y, float z) {
 }
 
 void GraphNode::SetLocalRotation(const glm::mat4 &rotation) {
-  m_LocalRotation = rotation;
-  InvalidateTransform();
+  SetLocalRotation(glm::normalize(glm::quat_cast(rotation)));
+}
+
+void GraphNode::SetLocalRotation(const glm::quat &rotation) {
+  TransformHierarchy::Get().SetRotation(m_Transform, rotation);
+  OnTransformChanged();
 }
 
 void GraphNode::SetLocalScale(const glm::vec3 &scale) {
-  m_LocalScale = scale;
-  InvalidateTransform();
+  TransformHierarchy::Get().SetScale(m_Transform, scale);
+  OnTransformChanged();
 }
 
 void GraphNode::SetLocalScale(float x, float y, float z) {
@@ -63,15 +96,12 @@ void GraphNode::SetLocalRotationEuler(float pitch, float yaw, float roll) {
       glm::rotate(glm::mat4(1.0f), pitch, glm::vec3(1.0f, 0.0f, 0.0f));
   glm::mat4 rotZ =
       glm::rotate(glm::mat4(1.0f), roll, glm::vec3(0.0f, 0.0f, 1.0f));
-  m_LocalRotation = rotY * rotX * rotZ;
-  InvalidateTransform();
+  SetLocalRotation(rotY * rotX * rotZ);
 }
 
 void GraphNode::SetLocalRotationAxisAngle(const glm::vec3 &axis,
                                           float angleRadians) {
-  m_LocalRotation =
-      glm::rotate(glm::mat4(1.0f), angleRadians, glm::normalize(axis));
-  InvalidateTransform();
+  SetLocalRotation(glm::angleAxis(angleRadians, glm::normalize(axis)));
 }
 
 glm::vec3 GraphNode::GetRotationEuler() const {
@@ -79,16 +109,17 @@ glm::vec3 GraphNode::GetRotationEuler() const {
   // Using YXZ order: Yaw(Y) -> Pitch(X) -> Roll(Z)
   // Matrix M = Ry * Rx * Rz
   glm::vec3 euler;
+  glm::mat3 rot = glm::mat3_cast(GetLocalRotationQuat());
 
-  float m21 = m_LocalRotation[2][1];
+  float m21 = rot[2][1];
   if (std::abs(m21) < 0.99999f) {
-    euler.x = -std::asin(m21);                                          // pitch
-    euler.y = std::atan2(m_LocalRotation[2][0], m_LocalRotation[2][2]); // yaw
-    euler.z = std::atan2(m_LocalRotation[0][1], m_LocalRotation[1][1]); // roll
+    euler.x = -std::asin(m21);                  // pitch
+    euler.y = std::atan2(rot[2][0], rot[2][2]); // yaw
+    euler.z = std::atan2(rot[0][1], rot[1][1]); // roll
   } else {
     // Gimbal lock
     euler.x = m21 < 0 ? glm::half_pi<float>() : -glm::half_pi<float>();
-    euler.y = std::atan2(-m_LocalRotation[0][2], m_LocalRotation[0][0]);
+    euler.y = std::atan2(-rot[0][2], rot[0][0]);
     euler.z = 0.0f;
   }
 
@@ -110,17 +141,14 @@ void GraphNode::LookAt(const glm::vec3 &eye, const glm::vec3 &target,
   glm::mat4 worldMatrix = glm::inverse(viewMatrix);
 
   // Extract translation (position)
-  m_LocalPosition = glm::vec3(worldMatrix[3]);
+  TransformHierarchy::Get().SetPosition(m_Transform,
+                                        glm::vec3(worldMatrix[3]));
 
   // Extract rotation (upper 3x3 of the world matrix)
-  m_LocalRotation = glm::mat4(1.0f);
-  for (int i = 0; i < 3; i++) {
-    for (int j = 0; j < 3; j++) {
-      m_LocalRotation[i][j] = worldMatrix[i][j];
-    }
-  }
+  TransformHierarchy::Get().SetRotation(
+      m_Transform, glm::normalize(glm::quat_cast(glm::mat3(worldMatrix))));
 
-  InvalidateTransform();
+  OnTransformChanged();
 }
 
 // ========== Transform Computation ==========
@@ -128,28 +156,14 @@ void GraphNode::LookAt(const glm::vec3 &eye, const glm::vec3 &target,
 glm::mat4 GraphNode::GetLocalMatrix() const {
   // For Vulkan/GLM: Model = Translation * Rotation * Scale
   // This order means: scale first, then rotate, then translate
-  glm::mat4 T = glm::translate(glm::mat4(1.0f), m_LocalPosition);
-  glm::mat4 S = glm::scale(glm::mat4(1.0f), m_LocalScale);
-
-  return T * m_LocalRotation * S;
+  return TransformHierarchy::Get().GetLocalMatrix(m_Transform);
 }
 
 glm::mat4 GraphNode::GetWorldMatrix() const {
-  if (m_WorldMatrixDirty) {
-    glm::mat4 localMatrix = GetLocalMatrix();
-
-    if (m_Parent) {
-      // World = Parent's World * Local
-      // This propagates transforms down the hierarchy
-      m_CachedWorldMatrix = m_Parent->GetWorldMatrix() * localMatrix;
-    } else {
-      m_CachedWorldMatrix = localMatrix;
-    }
-
-    m_WorldMatrixDirty = false;
-  }
-
-  return m_CachedWorldMatrix;
+  // World = Parent's World * Local. Usually already refreshed by the batched
+  // TransformHierarchy::UpdateWorldMatrices(); otherwise only this node's
+  // ancestor chain is recomputed.
+  return TransformHierarchy::Get().GetWorldMatrix(m_Transform);
 }
 
 glm::vec3 GraphNode::GetWorldPosition() const {
@@ -160,18 +174,11 @@ glm::vec3 GraphNode::GetWorldPosition() const {
 // ========== Transform Invalidation ==========
 
 void GraphNode::InvalidateTransform() {
-  m_WorldMatrixDirty = true;
-  InvalidateChildTransforms();
+  // Descendants notice through the parent's world version; no subtree walk
+  TransformHierarchy::Get().Invalidate(m_Transform);
   OnTransformChanged();
 }
 
-void GraphNode::InvalidateChildTransforms() {
-  for (auto &child : m_Children) {
-    child->m_WorldMatrixDirty = true;
-    child->InvalidateChildTransforms();
-  }
-}
-
 void GraphNode::OnTransformChanged() {
   // Virtual hook for derived classes
 }
@@ -216,7 +223,9 @@ void GraphNode::GetWorldBounds(glm::vec3 &min, glm::vec3 &max) const {
 
 void GraphNode::SetParent(GraphNode *parent) {
   m_Parent = parent;
-  InvalidateTransform();
+  TransformHierarchy::Get().SetParent(
+      m_Transform, parent ? parent->m_Transform : InvalidTransform);
+  OnTransformChanged();
 }
 
 void GraphNode::AddChild(std::shared_ptr<GraphNode> child) {
@@ -230,6 +239,10 @@ void GraphNode::AddChild(std::shared_ptr<GraphNode> child) {
 
   child->SetParent(this);
   m_Children.push_back(child);
+
+  if (m_SceneIndex) {
+    m_SceneIndex->OnNodeAttached(child.get());
+  }
 }
 
 void GraphNode::RemoveChild(GraphNode *child) {
@@ -242,6 +255,9 @@ void GraphNode::RemoveChild(GraphNode *child) {
                          });
 
   if (it != m_Children.end()) {
+    if (m_SceneIndex) {
+      m_SceneIndex->OnNodeDetached(child);
+    }
     (*it)->SetParent(nullptr);
     m_Children.erase(it);
   }
@@ -275,6 +291,9 @@ std::shared_ptr<GraphNode> GraphNode::FindChild(const std::string &name,
 void GraphNode::AddMesh(std::shared_ptr<Mesh3D> mesh) {
   if (mesh) {
     m_Meshes.push_back(mesh);
+    if (m_SceneIndex) {
+      m_SceneIndex->OnMeshesChanged(this);
+    }
   }
 }
 
@@ -288,10 +307,18 @@ void GraphNode::RemoveMesh(Mesh3D *mesh) {
 
   if (it != m_Meshes.end()) {
     m_Meshes.erase(it);
+    if (m_SceneIndex) {
+      m_SceneIndex->OnMeshesChanged(this);
+    }
   }
 }
 
-void GraphNode::ClearMeshes() { m_Meshes.clear(); }
+void GraphNode::ClearMeshes() {
+  m_Meshes.clear();
+  if (m_SceneIndex) {
+    m_SceneIndex->OnMeshesChanged(this);
+  }
+}
 
 void GraphNode::Turn(glm::vec3 rot) {
 
@@ -308,9 +335,8 @@ void GraphNode::Turn(glm::vec3 rot) {
 
   glm::mat4 rotm = rotY * rotX * rotZ;
 
-  m_LocalRotation = m_LocalRotation * rotm;
-
-  m_WorldMatrixDirty = true;
+  SetLocalRotation(GetLocalRotationQuat() *
+                   glm::normalize(glm::quat_cast(rotm)));
 }
 
 void GraphNode::AddScript(ScriptPair *cls) {
@@ -323,31 +349,38 @@ void GraphNode::AddScript(ScriptPair *cls) {
 
   m_QClasses.push_back(cls);
   cls->ClsInstance->SetPtrMember("NodePtr", (void *)this);
+  QLangDomain::BumpScriptGeneration();
 }
 
 void GraphNode::OnPlay() {
 
   for (auto cls : m_QClasses) {
+    if (cls) {
+      cls->CallPlay();
+    }
+  }
+}
 
-    cls->ClsProgram->CallMethod(cls->ClsInstance, "Play", {});
-
-    // QValue result = runner.CallMethod(node1, "Update", updateArgs);
-    // QLangDomain::m_QLang->RunMethod(cls, "OnPlay");
+void GraphNode::OnStop() {
+  for (auto cls : m_QClasses) {
+    if (cls) {
+      cls->CallStop();
+    }
   }
-  int b = 5;
 }
 
-void GraphNode::OnStop() {}
+void GraphNode::UpdateScripts(float dt) {
+  for (auto cls : m_QClasses) {
+    if (cls) {
+      cls->CallUpdate(dt);
+    }
+  }
+}
 
 void GraphNode::OnUpdate(float dt)
 
 {
-  // Update scripts
-  for (auto cls : m_QClasses) {
-    if (cls && cls->ClsProgram && cls->ClsInstance) {
-      cls->ClsProgram->CallMethod(cls->ClsInstance, "OnUpdate", {dt});
-    }
-  }
+  // Scripts are dispatched per class by SceneGraph (ScriptUpdateBatch)
 
   // Virtual OnUpdate for C++ derived classes (like TerrainNode)
   // This is where TerrainNode::OnUpdate gets called if this is a TerrainNode
@@ -387,9 +420,9 @@ void GraphNode::CopyTo(GraphNode *newNode) {
   if (!newNode)
     return;
 
-  newNode->SetLocalPosition(m_LocalPosition);
-  newNode->SetLocalRotation(m_LocalRotation);
-  newNode->SetLocalScale(m_LocalScale);
+  newNode->SetLocalPosition(GetLocalPosition());
+  newNode->SetLocalRotation(GetLocalRotationQuat());
+  newNode->SetLocalScale(GetLocalScale());
   newNode->SetSourcePath(m_SourcePath);
 
   // Copy Meshes
@@ -1,6 +1,8 @@
 #pragma once
 #include "glm/glm.hpp"
 #include "glm/gtc/matrix_transform.hpp"
+#include "glm/gtc/quaternion.hpp"
+#include "TransformHierarchy.h"
 #include <memory>
 #include <string>
 #include <vector>
@@ -15,10 +17,13 @@ namespace Quantum {
 class Mesh3D;
 
 class ScriptPair;
+class SceneIndex;
 
 /// <summary>
 /// A node in the scene graph hierarchy with transform properties.
 /// Supports parent-child relationships and computes world transforms.
+/// Transform data lives in the shared TransformHierarchy; the node only keeps
+/// a handle into it.
 /// </summary>
 class GraphNode {
 public:
@@ -27,17 +32,20 @@ public:
 
   // Name
   const std::string &GetName() const { return m_Name; }
-  void SetName(const std::string &name) { m_Name = name; }
+  void SetName(const std::string &name);
 
   // Transform getters
-  const glm::vec3 &GetLocalPosition() const { return m_LocalPosition; }
-  const glm::mat4 &GetLocalRotation() const { return m_LocalRotation; }
-  const glm::vec3 &GetLocalScale() const { return m_LocalScale; }
+  glm::vec3 GetLocalPosition() const;
+  glm::mat4 GetLocalRotation() const;
+  glm::quat GetLocalRotationQuat() const;
+  glm::vec3 GetLocalScale() const;
 
   // Transform setters
   void SetLocalPosition(const glm::vec3 &position);
   void SetLocalPosition(float x, float y, float z);
+  // Rotation matrices must be orthonormal (stored as a quaternion)
   void SetLocalRotation(const glm::mat4 &rotation);
+  void SetLocalRotation(const glm::quat &rotation);
   void SetLocalScale(const glm::vec3 &scale);
   void SetLocalScale(float x, float y, float z);
   void SetLocalScale(float uniformScale);
@@ -82,6 +90,11 @@ public:
   // Mark transform as dirty (forces recalculation)
   void InvalidateTransform();
 
+  TransformHandle GetTransformHandle() const { return m_Transform; }
+
+  // Index of the SceneGraph this node is attached to (null if detached)
+  SceneIndex *GetSceneIndex() const { return m_SceneIndex; }
+
   // Meshes (one per material typically)
   void AddMesh(std::shared_ptr<Mesh3D> mesh);
   void RemoveMesh(Mesh3D *mesh);
@@ -102,6 +115,9 @@ public:
   void OnStop();
   virtual void OnUpdate(float dt);
 
+  // Run OnUpdate of this node's scripts only (SceneGraph batches these)
+  void UpdateScripts(float dt);
+
   // Full hierarchical name (e.g., scene.node.Suzanne)
   std::string GetFullName() const;
   // Check if node has a script of a certain class name
@@ -122,20 +138,17 @@ protected:
   virtual void CopyTo(GraphNode *other);
 
 private:
+  friend class SceneIndex;
+
   std::string m_Name;
 
-  // Local transform components
-  glm::vec3 m_LocalPosition;
-  glm::mat4 m_LocalRotation; // Rotation as matrix for flexibility
-  glm::vec3 m_LocalScale;
+  // Local TRS and cached world matrix (owned by TransformHierarchy)
+  TransformHandle m_Transform;
 
   // Hierarchy
   GraphNode *m_Parent;
   std::vector<std::shared_ptr<GraphNode>> m_Children;
-
-  // Cached world matrix
-  mutable glm::mat4 m_CachedWorldMatrix;
-  mutable bool m_WorldMatrixDirty;
+  SceneIndex *m_SceneIndex = nullptr; // Set by SceneIndex on attach
 
   // Meshes attached to this node
   std::vector<std::shared_ptr<Mesh3D>> m_Meshes;
@@ -147,7 +160,6 @@ private:
   std::vector<ScriptPair *> m_QClasses;
 
   void SetParent(GraphNode *parent);
-  void InvalidateChildTransforms();
 };
 
 } // namespace Quantum
@@ -1,22 +1,37 @@
 #include "QLangDomain.h"
 #include <algorithm>
+#include <cstdlib>
+#include <execution>
 #include <iostream>
 #include <memory>
+#include <numeric>
+#include <unordered_map>
 #include <variant>
 #include <vector>
 
 #include "GraphNode.h"
 #include "Parser.h"
+#include "QCoroutineScheduler.h"
+#include "QProfiler.h"
+#include "SceneIndex.h"
 
 #include "QError.h"
 
 #include "Tokenizer.h"
 #include <filesystem>
+#include <fstream>
+#include <map>
+#include <set>
+
+#include "../QuantumEngine/include/nlohmann/json.hpp"
 
 // Global Funcs
 
+#include "QNativeBinding.h"
 #include <llvm/ExecutionEngine/MCJIT.h>
+#include <llvm/IR/Constants.h>
 #include <llvm/IR/DerivedTypes.h>
+#include <llvm/IR/IRBuilder.h>
 
 extern "C" void LV_GetNode(void *ptr) {
   std::cout << "[C++] TestNode called with pointer: " << ptr << std::endl;
@@ -33,19 +48,49 @@ extern "C" void LV_GetNode(void *ptr) {
   }
 }
 
-extern "C" void LV_Node_Turn(void *ptr, void *vec3) {
-  // Vec3 layout: X, Y, Z as consecutive floats (12 bytes total)
-  const float *v = static_cast<const float *>(vec3);
+// Same layout as the QLang Vec3 value struct (X, Y, Z as consecutive floats).
+// Natives receive script Vec3s by address.
+struct LV_Vec3 {
+  float X, Y, Z;
+};
+static_assert(sizeof(LV_Vec3) == 3 * sizeof(float), "Vec3 layout mismatch");
+
+// Node writes made during the parallel script phase are deferred to the
+// thread's command buffer (see Quantum::NodeCommandBuffer)
+extern "C" void LV_Node_Turn(Quantum::GraphNode *node, const LV_Vec3 &rot) {
+  glm::vec3 rotation(rot.X, rot.Y, rot.Z);
+  if (auto *commands = Quantum::NodeCommandBuffer::Current()) {
+    commands->Turn(node, rotation);
+    return;
+  }
+  node->Turn(rotation);
+}
 
-  // TODO: Apply rotation to the node pointed to by 'ptr'
-  // For now, extract the rotation values directly from memory
-  [[maybe_unused]] float x = v[0];
-  [[maybe_unused]] float y = v[1];
-  [[maybe_unused]] float z = v[2];
+extern "C" void LV_Node_GetPosition(Quantum::GraphNode *node, LV_Vec3 *out) {
+  glm::vec3 position = node->GetLocalPosition();
+  *out = {position.x, position.y, position.z};
+}
 
-  // Example: Cast ptr to GraphNode and apply rotation
-  auto *node = static_cast<Quantum::GraphNode *>(ptr);
-  node->Turn(glm::vec3(x, y, z));
+extern "C" void LV_Node_SetPosition(Quantum::GraphNode *node,
+                                    const LV_Vec3 &position) {
+  if (auto *commands = Quantum::NodeCommandBuffer::Current()) {
+    commands->SetPosition(node, {position.X, position.Y, position.Z});
+    return;
+  }
+  node->SetLocalPosition(position.X, position.Y, position.Z);
+}
+
+extern "C" int32_t LV_Node_CountOverlaps(Quantum::GraphNode *node,
+                                         float radius) {
+  // Nodes (other than this one) whose bounds touch a sphere around the node
+  if (!node || !node->GetSceneIndex())
+    return 0;
+
+  std::vector<Quantum::GraphNode *> hits;
+  node->GetSceneIndex()->QuerySphere(node->GetWorldPosition(), radius, hits);
+  return static_cast<int32_t>(
+      std::count_if(hits.begin(), hits.end(),
+                    [node](Quantum::GraphNode *hit) { return hit != node; }));
 }
 
 // Note: LLVMLinkInMCJIT() is called in QLVM::InitLLVM() - do NOT call it here
@@ -53,6 +98,7 @@ extern "C" void LV_Node_Turn(void *ptr, void *vec3) {
 // LLVM's static initialization order dependencies.
 
 QLangDomain *QLangDomain::m_QLang = nullptr;
+uint64_t QLangDomain::s_ScriptGeneration = 0;
 
 QLangDomain::QLangDomain(const std::string &projectPath) {
   m_QLang = this;
@@ -64,32 +110,72 @@ QLangDomain::QLangDomain(const std::string &projectPath) {
   m_Context = std::make_shared<QLVMContext>();
 
   m_Runner = std::make_shared<QJitRunner>(m_Context, errorCollector);
+  // Saved scripts are patched into the running program (see ReloadScript)
+  m_Runner->SetHotPatching(true);
   // QJitRunner runner(m_Context, errorCollector);
-  auto *testNodeType = llvm::FunctionType::get(
-      llvm::Type::getVoidTy(QLVM::GetContext()),
-      {llvm::PointerType::getUnqual(QLVM::GetContext())}, false);
-  m_Context->AddFunc("TestNode", (void *)LV_GetNode, testNodeType);
-
-  auto *nodeTurnType = llvm::FunctionType::get(
-      llvm::Type::getVoidTy(QLVM::GetContext()),
-      {llvm::PointerType::getUnqual(QLVM::GetContext()),
-       llvm::PointerType::getUnqual(QLVM::GetContext())},
-      false);
-  m_Context->AddFunc("Node_Turn", (void *)LV_Node_Turn, nodeTurnType);
+  // Signatures are derived from the C++ types, see QNativeBinding.h.
+  // threadSafe natives only read the scene or defer their writes, so scripts
+  // calling them may update in parallel (see ScriptUpdateBatch)
+  QBindNative(*m_Context, "TestNode", LV_GetNode);
+  QBindNative(*m_Context, "Node_Turn", LV_Node_Turn, {.threadSafe = true});
+  QBindNative(*m_Context, "Node_GetPosition", LV_Node_GetPosition,
+              {.threadSafe = true});
+  QBindNative(*m_Context, "Node_SetPosition", LV_Node_SetPosition,
+              {.threadSafe = true});
+  QBindNative(*m_Context, "Node_CountOverlaps", LV_Node_CountOverlaps,
+              {.readOnly = true, .threadSafe = true});
+
+  // Trivial math helpers are emitted as IR and inline into script code
+  QBindInline<float(float)>(*m_Context, "Math_Radians", [](llvm::Function *f) {
+    llvm::IRBuilder<> builder(
+        llvm::BasicBlock::Create(f->getContext(), "entry", f));
+    builder.CreateRet(builder.CreateFMul(
+        f->getArg(0),
+        llvm::ConstantFP::get(builder.getFloatTy(), 3.14159265358979 / 180.0)));
+  }, {.pure = true});
+  QBindInline<float(float)>(*m_Context, "Math_Degrees", [](llvm::Function *f) {
+    llvm::IRBuilder<> builder(
+        llvm::BasicBlock::Create(f->getContext(), "entry", f));
+    builder.CreateRet(builder.CreateFMul(
+        f->getArg(0),
+        llvm::ConstantFP::get(builder.getFloatTy(), 180.0 / 3.14159265358979)));
+  }, {.pure = true});
+  QBindInline<float(float, float, float)>(
+      *m_Context, "Math_Lerp",
+      [](llvm::Function *f) {
+        // a + (b - a) * t
+        llvm::IRBuilder<> builder(
+            llvm::BasicBlock::Create(f->getContext(), "entry", f));
+        llvm::Value *a = f->getArg(0);
+        llvm::Value *delta = builder.CreateFSub(f->getArg(1), a);
+        builder.CreateRet(
+            builder.CreateFAdd(a, builder.CreateFMul(delta, f->getArg(2))));
+      },
+      {.pure = true});
 
   m_Runner->SetBasePath("engine/qlang/classes");
+  QJitProgram::SetObjectCacheDirectory("engine/qlang/classes/objcache");
+  // Symbols of JIT code for Linux perf (QLANG_PERF=1)
+  if (const char *perf = std::getenv("QLANG_PERF")) {
+    QJitProgram::SetPerfOutput(std::string(perf) != "0");
+  }
 
-  std::cout << "[DEBUG] Building Vec3.q..." << std::endl;
-  m_Runner->BuildModule("engine/qlang/classes/Vec3.q");
-  std::cout << "[DEBUG] Vec3.q done" << std::endl;
-
-  std::cout << "[DEBUG] Building matrix.q..." << std::endl;
-  m_Runner->BuildModule("engine/qlang/classes/matrix.q");
-  std::cout << "[DEBUG] matrix.q done" << std::endl;
+  // Shipped builds run the scripts prebuilt by BuildScriptLibrary
+  // (QLANG_SCRIPT_LIBRARY=path); nothing is compiled then
+  if (const char *library = std::getenv("QLANG_SCRIPT_LIBRARY")) {
+    if (LoadScriptLibrary(library)) {
+      std::cout << "[DEBUG] QLangDomain constructor complete" << std::endl;
+      return;
+    }
+  }
 
-  std::cout << "[DEBUG] Building gamenode.q..." << std::endl;
-  m_Runner->BuildModule("engine/qlang/classes/gamenode.q");
-  std::cout << "[DEBUG] gamenode.q done" << std::endl;
+  // Library modules are independent apart from their imports; BuildModules
+  // orders them and compiles each wave across all cores
+  std::cout << "[DEBUG] Building engine modules..." << std::endl;
+  m_Runner->BuildModules({"engine/qlang/classes/Vec3.q",
+                          "engine/qlang/classes/matrix.q",
+                          "engine/qlang/classes/gamenode.q"});
+  std::cout << "[DEBUG] Engine modules done" << std::endl;
 
   std::cout << "[DEBUG] QLangDomain constructor complete" << std::endl;
 }
@@ -107,13 +193,199 @@ ScriptPair::ScriptPair() {
 }
 
 ScriptPair::~ScriptPair() {
+  CancelCoroutines();
   if (QLangDomain::m_QLang) {
     QLangDomain::m_QLang->UnregisterScript(this);
   }
 }
+
+void ScriptPair::Bind(std::shared_ptr<QJitProgram> program) {
+  // Suspended coroutines point into the old program's code
+  if (program != ClsProgram) {
+    CancelCoroutines();
+  }
+  ClsProgram = program;
+  PlayHandle = {};
+  UpdateHandle = {};
+  StopHandle = {};
+  if (!ClsProgram || !ClsInstance)
+    return;
+
+  // Methods with parameters are compiled under their mangled name
+  // (Method$type...), see QJitRunner::MangleMethodName
+  PlayHandle = ClsProgram->GetTypedMethodHandle<>(ClsInstance, "Play");
+  UpdateHandle =
+      ClsProgram->GetTypedMethodHandle<float>(ClsInstance, "OnUpdate$float32");
+  StopHandle = ClsProgram->GetTypedMethodHandle<>(ClsInstance, "OnStop");
+  QLangDomain::BumpScriptGeneration();
+}
+
+void ScriptPair::CallPlay() {
+  if (PlayHandle.IsValid()) {
+    PlayHandle();
+  } else if (ClsProgram && ClsInstance) {
+    ClsProgram->CallMethod(ClsInstance, "Play", {});
+  }
+}
+
+void ScriptPair::CallUpdate(float dt) {
+  if (UpdateHandle.IsValid()) {
+    UpdateHandle(dt);
+  } else if (ClsProgram && ClsInstance) {
+    ClsProgram->CallMethod(ClsInstance, "OnUpdate", {dt});
+  }
+}
+
+void ScriptPair::CallStop() {
+  if (StopHandle.IsValid()) {
+    StopHandle();
+  }
+  CancelCoroutines();
+}
+
+void ScriptPair::CancelCoroutines() {
+  if (ClsInstance) {
+    QCoroutineScheduler::Get().Cancel(ClsInstance->GetInstancePtr());
+  }
+}
+
+// NodeCommandBuffer Implementation
+
+static thread_local NodeCommandBuffer *s_CurrentCommands = nullptr;
+
+NodeCommandBuffer *NodeCommandBuffer::Current() { return s_CurrentCommands; }
+
+void NodeCommandBuffer::SetCurrent(NodeCommandBuffer *buffer) {
+  s_CurrentCommands = buffer;
+}
+
+void NodeCommandBuffer::Turn(GraphNode *node, const glm::vec3 &rotation) {
+  m_Commands.push_back({CommandKind::Turn, node, rotation});
+}
+
+void NodeCommandBuffer::SetPosition(GraphNode *node,
+                                    const glm::vec3 &position) {
+  m_Commands.push_back({CommandKind::SetPosition, node, position});
+}
+
+void NodeCommandBuffer::Apply() {
+  for (const Command &command : m_Commands) {
+    switch (command.kind) {
+    case CommandKind::Turn:
+      command.node->Turn(command.value);
+      break;
+    case CommandKind::SetPosition:
+      command.node->SetLocalPosition(command.value.x, command.value.y,
+                                     command.value.z);
+      break;
+    }
+  }
+  m_Commands.clear();
+}
+
+// ScriptUpdateBatch Implementation
+
+void ScriptUpdateBatch::Clear() {
+  m_Classes.clear();
+  m_ParallelItems.clear();
+  m_Commands.clear();
+  m_Unresolved.clear();
+  m_ScriptCount = 0;
+}
+
+void ScriptUpdateBatch::Build(const std::vector<GraphNode *> &nodes,
+                              bool parallel) {
+  Clear();
+
+  // One batch per OnUpdate function (i.e. per script class), in order of
+  // first appearance. Parallel-safe classes are flattened into one list so
+  // chunks stay even however the instances are spread over classes.
+  std::unordered_map<QTypedMethodHandle<float>::FnType, size_t> classIndex;
+  std::unordered_map<QTypedMethodHandle<float>::FnType, bool> parallelSafe;
+  for (GraphNode *node : nodes) {
+    for (ScriptPair *script : node->GetScripts()) {
+      if (!script || !script->ClsProgram || !script->ClsInstance)
+        continue;
+      ++m_ScriptCount;
+
+      if (!script->UpdateHandle.IsValid()) {
+        m_Unresolved.push_back(script);
+        continue;
+      }
+
+      auto fn = script->UpdateHandle.GetFunctionPtr();
+      if (parallel) {
+        auto [safeIt, first] = parallelSafe.try_emplace(fn, false);
+        if (first && QLangDomain::m_QLang) {
+          safeIt->second = QLangDomain::m_QLang->IsParallelSafe(
+              script->ClsInstance->GetClassName());
+        }
+        if (safeIt->second) {
+          m_ParallelItems.push_back({fn, script->UpdateHandle.GetThisPtr()});
+          continue;
+        }
+      }
+
+      auto [it, inserted] = classIndex.try_emplace(fn, m_Classes.size());
+      if (inserted) {
+        m_Classes.push_back({fn, {}});
+      }
+      m_Classes[it->second].instances.push_back(
+          script->UpdateHandle.GetThisPtr());
+    }
+  }
+}
+
+void ScriptUpdateBatch::Dispatch(float dt) {
+  if (!m_ParallelItems.empty()) {
+    const size_t count = m_ParallelItems.size();
+    m_Commands.resize((count + ParallelChunk - 1) / ParallelChunk);
+    std::vector<size_t> chunks(m_Commands.size());
+    std::iota(chunks.begin(), chunks.end(), size_t(0));
+    std::for_each(std::execution::par, chunks.begin(), chunks.end(),
+                  [this, dt, count](size_t chunk) {
+                    NodeCommandBuffer::SetCurrent(&m_Commands[chunk]);
+                    size_t begin = chunk * ParallelChunk;
+                    size_t end = std::min(begin + ParallelChunk, count);
+                    for (size_t i = begin; i < end; ++i) {
+                      m_ParallelItems[i].update(m_ParallelItems[i].instance,
+                                                dt);
+                    }
+                    NodeCommandBuffer::SetCurrent(nullptr);
+                  });
+
+    // Sync point: apply in chunk order, as if the scripts had run serially
+    for (auto &commands : m_Commands) {
+      commands.Apply();
+    }
+  }
+
+  for (const auto &batch : m_Classes) {
+    auto update = batch.update;
+    for (void *instance : batch.instances) {
+      update(instance, dt);
+    }
+  }
+  for (ScriptPair *script : m_Unresolved) {
+    script->CallUpdate(dt);
+  }
+}
 } // namespace Quantum
 
 Quantum::ScriptPair *QLangDomain::CompileScript(std::string path) {
+  // Prebuilt: the class is already in the library
+  if (m_Library) {
+    auto inst = m_Library->CreateClassInstance(GetFileStem(path));
+    if (!inst) {
+      std::cerr << "[ERROR] QLangDomain: Script not in the script library: "
+                << path << std::endl;
+      return nullptr;
+    }
+    Quantum::ScriptPair *res = new Quantum::ScriptPair;
+    res->ClsInstance = inst;
+    res->Bind(m_Library);
+    return res;
+  }
 
   // Use the master module architecture
   std::string className = m_Runner->CompileScriptIntoMaster(path);
@@ -142,7 +414,7 @@ Quantum::ScriptPair *QLangDomain::CompileScript(std::string path) {
   Quantum::ScriptPair *res = new Quantum::ScriptPair;
 
   res->ClsInstance = inst;
-  res->ClsProgram = prog;
+  res->Bind(prog);
 
   // IMPORTANT: Recompiling a script might have updated the master program.
   // We must update ALL active scripts to use the new master program so they
@@ -152,8 +424,63 @@ Quantum::ScriptPair *QLangDomain::CompileScript(std::string path) {
   return res;
 }
 
+bool QLangDomain::ReloadScript(const std::string &path) {
+  if (m_Library) {
+    std::cerr << "[ERROR] QLangDomain: Scripts of a script library cannot be "
+                 "reloaded"
+              << std::endl;
+    return false;
+  }
+
+  switch (m_Runner->PatchScript(path)) {
+  case QJitRunner::PatchResult::Unchanged:
+    return true;
+  case QJitRunner::PatchResult::Patched:
+    UpdateAllScripts();
+    return true;
+  case QJitRunner::PatchResult::Failed:
+    return false;
+  case QJitRunner::PatchResult::NeedsRebuild:
+    break;
+  }
+
+  if (m_Runner->CompileScriptIntoMaster(path).empty()) {
+    std::cerr << "[ERROR] QLangDomain: Failed to reload script: " << path
+              << std::endl;
+    return false;
+  }
+  UpdateAllScripts();
+  return true;
+}
+
+bool QLangDomain::BuildScriptLibrary(const std::vector<std::string> &scripts,
+                                     const std::string &libraryPath) {
+  // Scripts go into the master module as when they are played, the
+  // independent ones compiled in parallel
+  auto classNames = m_Runner->CompileScriptsIntoMaster(scripts);
+  for (size_t i = 0; i < scripts.size(); ++i) {
+    if (classNames[i].empty()) {
+      std::cerr << "[ERROR] QLangDomain: Failed to compile script: "
+                << scripts[i] << std::endl;
+      return false;
+    }
+  }
+  return m_Runner->CompileLibrary({}, libraryPath);
+}
+
+bool QLangDomain::LoadScriptLibrary(const std::string &libraryPath) {
+  // Natives are bound (constructor) before the library binds its imports
+  auto library = QJitProgram::LoadNativeLibrary(libraryPath);
+  if (!library)
+    return false;
+  m_Library = library;
+  QJitProgram::SetInstance(m_Library.get());
+  return true;
+}
+
 void QLangDomain::RegisterScript(Quantum::ScriptPair *script) {
   m_ActiveScripts.push_back(script);
+  BumpScriptGeneration();
 }
 
 void QLangDomain::UnregisterScript(Quantum::ScriptPair *script) {
@@ -161,6 +488,63 @@ void QLangDomain::UnregisterScript(Quantum::ScriptPair *script) {
   if (it != m_ActiveScripts.end()) {
     m_ActiveScripts.erase(it, m_ActiveScripts.end());
   }
+  BumpScriptGeneration();
+}
+
+bool QLangDomain::IsParallelSafe(const std::string &className) const {
+  return m_Runner && m_Runner->IsParallelSafe(className);
+}
+
+bool QLangDomain::WriteProfileJson(const std::string &path) const {
+  using json = nlohmann::json;
+
+  // Time of a script is the time of the lifecycle methods the engine calls
+  // (ScriptPair::Bind); the other methods are included in those, as profile
+  // times are inclusive
+  static const std::set<std::string> lifecycle = {"Play", "OnUpdate$float32",
+                                                  "OnStop"};
+
+  std::map<std::string, size_t> instances;
+  for (const auto *script : m_ActiveScripts) {
+    if (script && script->ClsInstance) {
+      ++instances[script->ClsInstance->GetClassName()];
+    }
+  }
+
+  std::map<std::string, json> scripts;
+  for (const auto &sample : QProfiler::Get().Snapshot()) {
+    json &script = scripts[sample.className];
+    if (script.is_null()) {
+      script = {{"class", sample.className},
+                {"instances", instances[sample.className]},
+                {"totalMs", 0.0},
+                {"methods", json::array()}};
+    }
+    if (lifecycle.count(sample.methodName)) {
+      script["totalMs"] = script["totalMs"].get<double>() + sample.totalMs;
+    }
+    script["methods"].push_back({{"name", sample.methodName},
+                                 {"calls", sample.calls},
+                                 {"totalMs", sample.totalMs},
+                                 {"averageUs", sample.AverageUs()}});
+  }
+
+  json sorted = json::array();
+  for (auto &entry : scripts) {
+    sorted.push_back(std::move(entry.second));
+  }
+  std::sort(sorted.begin(), sorted.end(), [](const json &a, const json &b) {
+    return a["totalMs"].get<double>() > b["totalMs"].get<double>();
+  });
+
+  std::ofstream file(path);
+  if (!file) {
+    std::cerr << "[ERROR] QLangDomain: Cannot write profile to " << path
+              << std::endl;
+    return false;
+  }
+  file << json{{"scripts", sorted}}.dump(2);
+  return true;
 }
 
 void QLangDomain::UpdateAllScripts() {
@@ -171,9 +555,47 @@ void QLangDomain::UpdateAllScripts() {
   std::cout << "[INFO] QLangDomain: Updating " << m_ActiveScripts.size()
             << " active scripts with new master program" << std::endl;
 
+  // Instances of classes whose members changed still have the old layout;
+  // move their state into fresh instances. All of them are created first, so
+  // scripts referring to each other are relinked to the migrated objects.
+  auto changedLayouts = m_Runner->TakeChangedLayouts();
+  std::vector<std::pair<Quantum::ScriptPair *,
+                        std::shared_ptr<QJClassInstance>>>
+      migrations;
+  std::unordered_map<const void *, void *> relocated;
+  for (auto script : m_ActiveScripts) {
+    if (!script || !script->ClsInstance ||
+        !changedLayouts.count(script->ClsInstance->GetClassName()))
+      continue;
+    auto migrated =
+        prog->CreateClassInstance(script->ClsInstance->GetClassName());
+    if (!migrated)
+      continue;
+    relocated[script->ClsInstance->GetInstancePtr()] =
+        migrated->GetInstancePtr();
+    migrations.emplace_back(script, migrated);
+  }
+  for (auto &[script, migrated] : migrations) {
+    migrated->CopyMembersFrom(*script->ClsInstance, changedLayouts, relocated);
+    script->CancelCoroutines(); // Their frames hold the old instance
+  }
+  // Scripts that keep their layout may refer to the old objects too
+  if (!changedLayouts.empty()) {
+    for (auto script : m_ActiveScripts) {
+      if (script && script->ClsInstance &&
+          !relocated.count(script->ClsInstance->GetInstancePtr())) {
+        script->ClsInstance->RelocateReferences(changedLayouts, relocated);
+      }
+    }
+  }
+  for (auto &[script, migrated] : migrations) {
+    script->ClsInstance = migrated;
+  }
+
+  // Handles point into the old program's code; resolve them again
   for (auto script : m_ActiveScripts) {
     if (script) {
-      script->ClsProgram = prog;
+      script->Bind(prog);
     }
   }
 }
@@ -21,8 +21,103 @@ public:
   std::shared_ptr<QJClassInstance> ClsInstance;
   std::shared_ptr<QJitProgram> ClsProgram;
 
+  // Lifecycle methods, resolved once per program by Bind()
+  QTypedMethodHandle<> PlayHandle;
+  QTypedMethodHandle<float> UpdateHandle;
+  QTypedMethodHandle<> StopHandle;
+
   ScriptPair();
   ~ScriptPair();
+
+  /// <summary>
+  /// Switch to 'program' and re-resolve the lifecycle handles against it.
+  /// Called on creation and whenever the master program is swapped.
+  /// </summary>
+  void Bind(std::shared_ptr<QJitProgram> program);
+
+  void CallPlay();
+  void CallUpdate(float dt);
+  void CallStop();
+
+  /// <summary>
+  /// Drop the instance's suspended coroutines (yield/wait), see
+  /// QCoroutineScheduler. Done on stop, rebind and destruction.
+  /// </summary>
+  void CancelCoroutines();
+};
+
+/// <summary>
+/// Node changes made by scripts in the parallel update phase. Natives that
+/// move nodes record into the calling thread's buffer (see Current) instead
+/// of writing the transform hierarchy, and ScriptUpdateBatch applies the
+/// buffers in a fixed order once every parallel script has run.
+/// </summary>
+class NodeCommandBuffer {
+public:
+  void Turn(GraphNode *node, const glm::vec3 &rotation);
+  void SetPosition(GraphNode *node, const glm::vec3 &position);
+
+  // Apply the commands in recording order, then clear the buffer
+  void Apply();
+  void Clear() { m_Commands.clear(); }
+  bool IsEmpty() const { return m_Commands.empty(); }
+
+  // Buffer of the calling thread; nullptr outside the parallel phase
+  static NodeCommandBuffer *Current();
+  static void SetCurrent(NodeCommandBuffer *buffer);
+
+private:
+  enum class CommandKind { Turn, SetPosition };
+  struct Command {
+    CommandKind kind;
+    GraphNode *node;
+    glm::vec3 value;
+  };
+
+  std::vector<Command> m_Commands;
+};
+
+/// <summary>
+/// Per-frame OnUpdate dispatch for a set of nodes. Scripts are grouped by
+/// their resolved OnUpdate function so each class runs as one tight loop of
+/// direct calls over its instances. Rebuild when the node set, the attached
+/// scripts or the program change (see QLangDomain::GetScriptGeneration).
+///
+/// With 'parallel' set, classes the compiler proved parallel-safe
+/// (QJitRunner::IsParallelSafe) run first, split across cores. They read the
+/// scene as it was when the phase started; their node changes are buffered
+/// per chunk and applied in chunk order, so the result does not depend on
+/// scheduling. Everything else then runs serially and sees those changes.
+/// </summary>
+class ScriptUpdateBatch {
+public:
+  void Build(const std::vector<GraphNode *> &nodes, bool parallel = false);
+  void Dispatch(float dt);
+  void Clear();
+
+  size_t GetScriptCount() const { return m_ScriptCount; }
+  size_t GetClassCount() const { return m_Classes.size(); }
+  size_t GetParallelCount() const { return m_ParallelItems.size(); }
+
+private:
+  struct ClassBatch {
+    QTypedMethodHandle<float>::FnType update = nullptr;
+    std::vector<void *> instances;
+  };
+
+  struct ParallelItem {
+    QTypedMethodHandle<float>::FnType update = nullptr;
+    void *instance = nullptr;
+  };
+
+  // Scripts per parallel chunk (and per command buffer)
+  static constexpr size_t ParallelChunk = 64;
+
+  std::vector<ClassBatch> m_Classes;
+  std::vector<ParallelItem> m_ParallelItems;
+  std::vector<NodeCommandBuffer> m_Commands; // One per parallel chunk
+  std::vector<ScriptPair *> m_Unresolved; // No typed handle: dynamic call
+  size_t m_ScriptCount = 0;
 };
 } // namespace Quantum
 
@@ -40,10 +135,40 @@ public:
   void UnregisterScript(Quantum::ScriptPair *script);
   void UpdateAllScripts();
 
+  // Apply an edited script to the running game: methods whose body changed
+  // are patched in place, anything else rebuilds the master program. Live
+  // instances of classes whose members changed are migrated (members with
+  // the same name and type keep their values). False on compile errors.
+  bool ReloadScript(const std::string &path);
+
+  // Shipping. BuildScriptLibrary compiles the scripts (with the engine
+  // modules) into one optimized native library; LoadScriptLibrary runs from
+  // such a library instead of the JIT: scripts are created from it without
+  // compiling anything, and cannot be reloaded.
+  bool BuildScriptLibrary(const std::vector<std::string> &scripts,
+                          const std::string &libraryPath);
+  bool LoadScriptLibrary(const std::string &libraryPath);
+
+  // Whether OnUpdate of the script class may run in the parallel phase
+  bool IsParallelSafe(const std::string &className) const;
+
+  // Per-script cost from QProfiler (instrumented scripts only) as JSON:
+  // each script class with its instance count, time in the lifecycle
+  // methods and every profiled method
+  bool WriteProfileJson(const std::string &path) const;
+
+  // Bumped whenever scripts are created, destroyed, attached or rebound;
+  // cached dispatch (ScriptUpdateBatch) compares against it
+  static uint64_t GetScriptGeneration() { return s_ScriptGeneration; }
+  static void BumpScriptGeneration() { ++s_ScriptGeneration; }
+
   static QLangDomain *m_QLang;
 
 private:
+  static uint64_t s_ScriptGeneration;
+
   std::vector<Quantum::ScriptPair *> m_ActiveScripts;
   std::shared_ptr<QLVMContext> m_Context;
   std::shared_ptr<QJitRunner> m_Runner;
+  std::shared_ptr<QJitProgram> m_Library; // Set when running prebuilt
 };
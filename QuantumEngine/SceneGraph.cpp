@@ -2,6 +2,9 @@
 #include "CameraNode.h"
 #include "LightNode.h"
 #include "Mesh3D.h"
+#include "QCoroutineScheduler.h"
+#include "QHeap.h"
+#include "QLangDomain.h"
 #include "TerrainNode.h"
 #include "glm/gtc/matrix_transform.hpp"
 #include "pch.h"
@@ -13,14 +16,61 @@
 
 namespace Quantum {
 
-SceneGraph::SceneGraph() { m_Root = std::make_shared<GraphNode>("Root"); }
+SceneGraph::SceneGraph() {
+  m_Root = std::make_shared<GraphNode>("Root");
+  m_Index.OnNodeAttached(m_Root.get());
+  m_ScriptBatch = std::make_unique<ScriptUpdateBatch>();
+}
 
 SceneGraph::~SceneGraph() { Clear(); }
 
+void SceneGraph::UpdateScripts(float dt) {
+  // Rebuild only when nodes were added/removed or scripts were attached,
+  // created, destroyed or rebound to a new program
+  uint64_t generation = QLangDomain::GetScriptGeneration();
+  uint64_t structure = m_Index.GetStructureVersion();
+  if (generation != m_ScriptBatchGeneration ||
+      structure != m_ScriptBatchStructure) {
+    std::vector<GraphNode *> nodes;
+    nodes.reserve(m_Index.GetNodeCount());
+    ForEveryNode([&nodes](GraphNode *node) { nodes.push_back(node); });
+    m_ScriptBatch->Build(nodes, m_ParallelScripts);
+    m_ScriptBatchGeneration = generation;
+    m_ScriptBatchStructure = structure;
+  }
+
+  // Parallel scripts query the index and world matrices; settle both up
+  // front so those reads do not refresh them lazily from several threads
+  if (m_ScriptBatch->GetParallelCount() > 0) {
+    m_Index.Refresh();
+  }
+
+  m_ScriptBatch->Dispatch(dt);
+
+  // Coroutines (yield/wait) that came due; idle ones cost nothing here
+  QCoroutineScheduler::Get().Tick(dt);
+}
+
+void SceneGraph::SetParallelScripts(bool enabled) {
+  if (enabled == m_ParallelScripts)
+    return;
+  m_ParallelScripts = enabled;
+  m_ScriptBatchGeneration = ~0ull; // Rebuild with the new split
+}
+
 void SceneGraph::Update(float dt) {
+  UpdateScripts(dt);
+
   if (m_Root) {
     m_Root->OnUpdate(dt);
   }
+
+  // Scripts may have moved nodes; settle world matrices and refit bounds
+  // once for the frame
+  m_Index.Refresh();
+
+  // No script code is running here: reclaim script garbage for the frame
+  QHeap::Get().EndFrame();
 }
 
 std::shared_ptr<GraphNode> SceneGraph::CreateNode(const std::string &name,
@@ -69,7 +119,16 @@ std::shared_ptr<GraphNode> SceneGraph::FindNode(const std::string &name) const {
     return current;
   }
 
-  // Fallback: recursive search by local name
+  // Fallback: search by local name via the index
+  const auto &matches = m_Index.FindByName(name);
+  if (matches.empty()) {
+    return nullptr;
+  }
+  if (matches.size() == 1) {
+    return GetShared(matches.front());
+  }
+
+  // Duplicate names: keep the depth-first "first match" of the tree walk
   if (m_Root->GetName() == name) {
     return m_Root;
   }
@@ -80,43 +139,27 @@ GraphNode *SceneGraph::FindNodeByPointer(void *ptr) const {
   if (!ptr)
     return nullptr;
   GraphNode *target = static_cast<GraphNode *>(ptr);
-  if (m_Root.get() == target)
-    return m_Root.get();
-
-  // Search entire tree for this pointer
-  GraphNode *found = nullptr;
-  // Use const_cast because ForEveryNode takes non-const callback but we are
-  // const
-  const_cast<SceneGraph *>(this)->ForEveryNode([&](GraphNode *node) {
-    if (node == target) {
-      found = node;
-    }
-  });
-  return found;
+  return m_Index.Contains(target) ? target : nullptr;
 }
 
-std::shared_ptr<GraphNode> SceneGraph::GetTerrainNode() const {
-  std::shared_ptr<GraphNode> found = nullptr;
-
-  std::function<void(std::shared_ptr<GraphNode>)> traverse =
-      [&](std::shared_ptr<GraphNode> node) {
-        if (!node || found)
-          return;
-
-        if (dynamic_cast<TerrainNode *>(node.get())) {
-          found = node;
-          return;
-        }
+std::shared_ptr<GraphNode> SceneGraph::GetShared(GraphNode *node) const {
+  if (!node)
+    return nullptr;
+  if (node == m_Root.get())
+    return m_Root;
 
-        for (const auto &child : node->GetChildren()) {
-          traverse(child);
-          if (found)
-            return;
-        }
-      };
+  GraphNode *parent = node->GetParent();
+  if (!parent)
+    return nullptr;
+  for (const auto &child : parent->GetChildren()) {
+    if (child.get() == node)
+      return child;
+  }
+  return nullptr;
+}
 
-  traverse(m_Root);
-  return found;
+std::shared_ptr<GraphNode> SceneGraph::GetTerrainNode() const {
+  return GetShared(m_Index.FindFirstOfType<TerrainNode>());
 }
 
 void SceneGraph::Clear() {
@@ -139,7 +182,7 @@ void SceneGraph::AddLight(std::shared_ptr<LightNode> light) {
   }
 }
 
-size_t SceneGraph::GetNodeCount() const { return CountNodes(m_Root.get()); }
+size_t SceneGraph::GetNodeCount() const { return m_Index.GetNodeCount(); }
 
 void SceneGraph::SetCurrentCamera(std::shared_ptr<CameraNode> camera) {
   m_CurrentCamera = camera;
@@ -149,17 +192,6 @@ std::shared_ptr<CameraNode> SceneGraph::GetCurrentCamera() const {
   return m_CurrentCamera;
 }
 
-size_t SceneGraph::CountNodes(GraphNode *node) const {
-  if (!node)
-    return 0;
-
-  size_t count = 1; // Count this node
-  for (const auto &child : node->GetChildren()) {
-    count += CountNodes(child.get());
-  }
-  return count;
-}
-
 glm::vec3 SceneGraph::GetLightPosition() const {
   if (!m_Lights.empty() && m_Lights[0]) {
     return m_Lights[0]->GetWorldPosition();
@@ -169,19 +201,22 @@ glm::vec3 SceneGraph::GetLightPosition() const {
 }
 
 size_t SceneGraph::GetTotalMeshCount() const {
-  size_t count = 0;
-  // Simple recursive helper (lambda not needed if we iterate directly,
-  // but recursion handles depth)
-  std::function<void(GraphNode *)> traverse = [&](GraphNode *node) {
-    if (!node)
-      return;
-    count += node->GetMeshCount();
-    for (const auto &child : node->GetChildren()) {
-      traverse(child.get());
-    }
-  };
-  traverse(m_Root.get());
-  return count;
+  return m_Index.GetMeshCount();
+}
+
+void SceneGraph::QueryBounds(const glm::vec3 &min, const glm::vec3 &max,
+                             std::vector<GraphNode *> &outNodes) {
+  m_Index.QueryBounds(min, max, outNodes);
+}
+
+void SceneGraph::QuerySphere(const glm::vec3 &center, float radius,
+                             std::vector<GraphNode *> &outNodes) {
+  m_Index.QuerySphere(center, radius, outNodes);
+}
+
+void SceneGraph::QueryFrustum(const glm::mat4 &viewProj,
+                              std::vector<GraphNode *> &outNodes) {
+  m_Index.QueryFrustum(viewProj, outNodes);
 }
 
 // =================================================================================================
@@ -219,55 +254,52 @@ std::shared_ptr<GraphNode> SceneGraph::SelectEntity(float mouseX, float mouseY,
   ray.origin = m_CurrentCamera->GetWorldPosition();
   ray.direction = ray_wor;
 
-  // 4. Cast Ray
+  // 4. Cast Ray: nearest-first through the index, triangles only for nodes
+  // whose bounds the ray enters before the closest hit so far
   float closestDistance = std::numeric_limits<float>::max();
-  std::shared_ptr<GraphNode> hitNode = nullptr;
-
-  CastRayRecursive(m_Root.get(), ray, closestDistance, hitNode);
-
-  return hitNode;
+  GraphNode *hitNode = nullptr;
+
+  m_Index.RayCast(ray.origin, ray.direction, closestDistance,
+                  [&](GraphNode *node, float entryT) {
+                    if (node != m_Root.get() &&
+                        IntersectNodeMeshes(node, ray, closestDistance)) {
+                      hitNode = node;
+                    }
+                    return closestDistance;
+                  });
+
+  return GetShared(hitNode);
 }
 
-void SceneGraph::CastRayRecursive(GraphNode *node, const Ray &ray,
-                                  float &closestDistance,
-                                  std::shared_ptr<GraphNode> &hitNode) {
-  if (!node)
-    return;
+bool SceneGraph::IntersectNodeMeshes(GraphNode *node, const Ray &ray,
+                                     float &closest) {
+  bool hit = false;
+  glm::mat4 model = node->GetWorldMatrix();
 
-  for (const auto &child : node->GetChildren()) {
-    if (!child)
+  for (const auto &mesh : node->GetMeshes()) {
+    if (!mesh)
       continue;
-
-    glm::mat4 model = child->GetWorldMatrix();
-    const auto &meshes = child->GetMeshes();
-
-    // Check meshes
-    for (const auto &mesh : meshes) {
-      if (!mesh)
-        continue;
-      const auto &vertices = mesh->GetVertices();
-      const auto &triangles = mesh->GetTriangles();
-
-      for (const auto &tri : triangles) {
-        glm::vec3 v0 =
-            glm::vec3(model * glm::vec4(vertices[tri.v0].position, 1.0f));
-        glm::vec3 v1 =
-            glm::vec3(model * glm::vec4(vertices[tri.v1].position, 1.0f));
-        glm::vec3 v2 =
-            glm::vec3(model * glm::vec4(vertices[tri.v2].position, 1.0f));
-
-        float t = 0.0f;
-        if (RayTriangleIntersection(ray, v0, v1, v2, t)) {
-          if (t > 0.0f && t < closestDistance) {
-            closestDistance = t;
-            hitNode = child;
-          }
+    const auto &vertices = mesh->GetVertices();
+    const auto &triangles = mesh->GetTriangles();
+
+    for (const auto &tri : triangles) {
+      glm::vec3 v0 =
+          glm::vec3(model * glm::vec4(vertices[tri.v0].position, 1.0f));
+      glm::vec3 v1 =
+          glm::vec3(model * glm::vec4(vertices[tri.v1].position, 1.0f));
+      glm::vec3 v2 =
+          glm::vec3(model * glm::vec4(vertices[tri.v2].position, 1.0f));
+
+      float t = 0.0f;
+      if (RayTriangleIntersection(ray, v0, v1, v2, t)) {
+        if (t > 0.0f && t < closest) {
+          closest = t;
+          hit = true;
         }
       }
     }
-
-    CastRayRecursive(child.get(), ray, closestDistance, hitNode);
   }
+  return hit;
 }
 
 bool SceneGraph::RayTriangleIntersection(const Ray &ray, const glm::vec3 &v0,
@@ -335,11 +367,14 @@ void SceneGraph::OnUpdate(float dt) {
   if (!m_Playing)
     return;
 
-  ForEveryNode([dt](Quantum::GraphNode *node) {
-    // std::cout << "Node: " << node->GetName() << std::endl;
-    // Do something with the node
-    node->OnUpdate(dt);
-  });
+  UpdateScripts(dt);
+
+  // C++ node logic; OnUpdate propagates to children itself
+  if (m_Root) {
+    m_Root->OnUpdate(dt);
+  }
+
+  m_Index.Refresh();
 }
 
 void SceneGraph::ForEveryNode(
@@ -1,5 +1,6 @@
 #pragma once
 #include "GraphNode.h"
+#include "SceneIndex.h"
 #include "glm/glm.hpp"
 #include <functional>
 
@@ -9,6 +10,7 @@ namespace Quantum {
 class Mesh3D;
 class CameraNode;
 class LightNode;
+class ScriptUpdateBatch;
 
 /// <summary>
 /// Manages a hierarchical scene graph of GraphNodes.
@@ -29,18 +31,32 @@ public:
   // Find a node by name (searches entire tree)
   std::shared_ptr<GraphNode> FindNode(const std::string &name) const;
 
-  // Find a node by pointer (searches entire tree)
+  // Find a node by pointer (O(1) index lookup)
   GraphNode *FindNodeByPointer(void *ptr) const;
 
   // Clear all nodes except root
   void Clear();
 
-  // Get total node count (including root)
+  // Get total node count (including root), cached by the index
   size_t GetNodeCount() const;
 
-  // Get total mesh count in the scene
+  // Get total mesh count in the scene, cached by the index
   size_t GetTotalMeshCount() const;
 
+  /// <summary>
+  /// Spatial/name/type index of every node under the root. Kept up to date
+  /// by GraphNode; bounds are refit once per frame by Update/OnUpdate.
+  /// </summary>
+  SceneIndex &GetIndex() { return m_Index; }
+
+  // Spatial queries (conservative, world space)
+  void QueryBounds(const glm::vec3 &min, const glm::vec3 &max,
+                   std::vector<GraphNode *> &outNodes);
+  void QuerySphere(const glm::vec3 &center, float radius,
+                   std::vector<GraphNode *> &outNodes);
+  void QueryFrustum(const glm::mat4 &viewProj,
+                    std::vector<GraphNode *> &outNodes);
+
   // Active camera
   void SetCurrentCamera(std::shared_ptr<CameraNode> camera);
   std::shared_ptr<CameraNode> GetCurrentCamera() const;
@@ -56,6 +72,16 @@ public:
   // Update Scene Logic
   void Update(float dt);
 
+  // Run OnUpdate of every script in the scene, batched per script class,
+  // then resume the script coroutines that are due
+  void UpdateScripts(float dt);
+
+  // Run parallel-safe script classes across cores (off by default). Such
+  // scripts see the scene as of the start of the update; see
+  // ScriptUpdateBatch for the ordering guarantees.
+  void SetParallelScripts(bool enabled);
+  bool GetParallelScripts() const { return m_ParallelScripts; }
+
   // Ray Casting
   struct Ray {
     glm::vec3 origin;
@@ -85,15 +111,23 @@ public:
 private:
   bool m_Playing = false;
 
+  // Declared before m_Root so it outlives every node during destruction
+  SceneIndex m_Index;
   std::shared_ptr<GraphNode> m_Root;
   std::shared_ptr<CameraNode> m_CurrentCamera;
   std::vector<std::shared_ptr<LightNode>> m_Lights;
 
-  size_t CountNodes(GraphNode *node) const;
+  // Cached script dispatch and the versions it was built from
+  std::unique_ptr<ScriptUpdateBatch> m_ScriptBatch;
+  uint64_t m_ScriptBatchGeneration = ~0ull;
+  uint64_t m_ScriptBatchStructure = ~0ull;
+  bool m_ParallelScripts = false;
+
+  // Owning pointer for an indexed node (looked up in its parent's children)
+  std::shared_ptr<GraphNode> GetShared(GraphNode *node) const;
 
-  // Helper for recursive ray casting
-  void CastRayRecursive(GraphNode *node, const Ray &ray, float &closestDistance,
-                        std::shared_ptr<GraphNode> &hitNode);
+  // Closest triangle hit of a node's meshes along the ray
+  bool IntersectNodeMeshes(GraphNode *node, const Ray &ray, float &closest);
 
   // Helper for ray-triangle intersection
   bool RayTriangleIntersection(const Ray &ray, const glm::vec3 &v0,
@@ -0,0 +1,221 @@
+#include "SceneIndex.h"
+#include "GraphNode.h"
+#include "Mesh3D.h"
+#include "TransformHierarchy.h"
+#include <algorithm>
+
+namespace Quantum {
+
+SceneIndex::~SceneIndex() {
+  // Nodes may outlive the index (e.g. held by the editor); detach them
+  for (auto &[node, entry] : m_Entries) {
+    node->m_SceneIndex = nullptr;
+  }
+}
+
+// ========== Registration ==========
+
+void SceneIndex::OnNodeAttached(GraphNode *node) {
+  if (!node)
+    return;
+  Register(node);
+  for (const auto &child : node->GetChildren()) {
+    OnNodeAttached(child.get());
+  }
+}
+
+void SceneIndex::OnNodeDetached(GraphNode *node) {
+  if (!node)
+    return;
+  for (const auto &child : node->GetChildren()) {
+    OnNodeDetached(child.get());
+  }
+  Unregister(node);
+}
+
+void SceneIndex::OnNodeDestroyed(GraphNode *node) { Unregister(node); }
+
+void SceneIndex::Register(GraphNode *node) {
+  if (m_Entries.count(node))
+    return;
+
+  // Bounds first: computing them may settle the world matrix (new version)
+  AABB bounds = ComputeBounds(node);
+
+  // Map entries keep their address, so the tree can point at this one
+  Entry &entry = m_Entries[node];
+  entry.node = node;
+  entry.bounds = bounds;
+  entry.type = std::type_index(typeid(*node));
+  entry.meshCount = node->GetMeshCount();
+  entry.worldVersion =
+      TransformHierarchy::Get().GetWorldVersion(node->GetTransformHandle());
+  entry.geometryVersion = GeometryVersion(node);
+  entry.proxy = m_Tree.CreateProxy(bounds, &entry);
+
+  m_ByName[node->GetName()].push_back(node);
+  m_ByType[entry.type].push_back(node);
+  m_MeshCount += entry.meshCount;
+  ++m_StructureVersion;
+  node->m_SceneIndex = this;
+}
+
+void SceneIndex::Unregister(GraphNode *node) {
+  auto it = m_Entries.find(node);
+  if (it == m_Entries.end())
+    return;
+
+  const Entry &entry = it->second;
+  m_Tree.DestroyProxy(entry.proxy);
+  RemoveFrom(m_ByName[node->GetName()], node);
+  RemoveFrom(m_ByType[entry.type], node);
+  m_MeshCount -= entry.meshCount;
+  m_Entries.erase(it);
+  ++m_StructureVersion;
+  node->m_SceneIndex = nullptr;
+}
+
+void SceneIndex::RemoveFrom(std::vector<GraphNode *> &list, GraphNode *node) {
+  auto it = std::find(list.begin(), list.end(), node);
+  if (it != list.end())
+    list.erase(it); // Keeps attachment order for FindByName
+}
+
+void SceneIndex::OnNodeRenamed(GraphNode *node, const std::string &oldName) {
+  if (!m_Entries.count(node))
+    return;
+  RemoveFrom(m_ByName[oldName], node);
+  m_ByName[node->GetName()].push_back(node);
+}
+
+void SceneIndex::OnMeshesChanged(GraphNode *node) {
+  auto it = m_Entries.find(node);
+  if (it == m_Entries.end())
+    return;
+
+  Entry &entry = it->second;
+  m_MeshCount = m_MeshCount - entry.meshCount + node->GetMeshCount();
+  entry.meshCount = node->GetMeshCount();
+  entry.geometryVersion = GeometryVersion(node);
+  entry.bounds = ComputeBounds(node);
+  m_Tree.MoveProxy(entry.proxy, entry.bounds);
+}
+
+// ========== Bounds ==========
+
+AABB SceneIndex::ComputeBounds(GraphNode *node) {
+  AABB box;
+  node->GetWorldBounds(box.min, box.max);
+  return box;
+}
+
+uint64_t SceneIndex::GeometryVersion(GraphNode *node) {
+  uint64_t version = 0;
+  for (const auto &mesh : node->GetMeshes()) {
+    if (mesh)
+      version += mesh->GetGeometryVersion();
+  }
+  return version;
+}
+
+void SceneIndex::Refresh() {
+  auto &transforms = TransformHierarchy::Get();
+  transforms.UpdateWorldMatrices();
+
+  // Linear scan over versions; only moved/edited nodes touch the tree
+  for (auto &[node, entry] : m_Entries) {
+    uint32_t worldVersion =
+        transforms.GetWorldVersion(node->GetTransformHandle());
+    uint64_t geometryVersion = GeometryVersion(node);
+    if (worldVersion == entry.worldVersion &&
+        geometryVersion == entry.geometryVersion)
+      continue;
+
+    entry.worldVersion = worldVersion;
+    entry.geometryVersion = geometryVersion;
+    entry.bounds = ComputeBounds(node);
+    m_Tree.MoveProxy(entry.proxy, entry.bounds);
+  }
+
+  m_LastChangeStamp = transforms.GetChangeStamp();
+}
+
+void SceneIndex::RefreshIfMoved() {
+  if (TransformHierarchy::Get().GetChangeStamp() != m_LastChangeStamp)
+    Refresh();
+}
+
+// ========== Lookups ==========
+
+const std::vector<GraphNode *> &
+SceneIndex::FindByName(const std::string &name) const {
+  static const std::vector<GraphNode *> empty;
+  auto it = m_ByName.find(name);
+  return it != m_ByName.end() ? it->second : empty;
+}
+
+const std::vector<GraphNode *> &
+SceneIndex::FindByType(std::type_index type) const {
+  static const std::vector<GraphNode *> empty;
+  auto it = m_ByType.find(type);
+  return it != m_ByType.end() ? it->second : empty;
+}
+
+// ========== Spatial Queries ==========
+
+void SceneIndex::QueryBounds(const glm::vec3 &min, const glm::vec3 &max,
+                             std::vector<GraphNode *> &outNodes) {
+  RefreshIfMoved();
+  AABB box{min, max};
+  m_Tree.Query(box, [&](int proxy) {
+    // The tree only proves an overlap with the fat box
+    const Entry &entry = GetEntry(proxy);
+    if (entry.bounds.Overlaps(box)) {
+      outNodes.push_back(entry.node);
+    }
+    return true;
+  });
+}
+
+void SceneIndex::QuerySphere(const glm::vec3 &center, float radius,
+                             std::vector<GraphNode *> &outNodes) {
+  RefreshIfMoved();
+  AABB box{center - glm::vec3(radius), center + glm::vec3(radius)};
+  float radiusSq = radius * radius;
+  m_Tree.Query(box, [&](int proxy) {
+    // Exact sphere vs box distance test on the node's own bounds
+    const Entry &entry = GetEntry(proxy);
+    glm::vec3 closest =
+        glm::clamp(center, entry.bounds.min, entry.bounds.max);
+    glm::vec3 d = closest - center;
+    if (glm::dot(d, d) <= radiusSq) {
+      outNodes.push_back(entry.node);
+    }
+    return true;
+  });
+}
+
+void SceneIndex::QueryFrustum(const glm::mat4 &viewProj,
+                              std::vector<GraphNode *> &outNodes) {
+  RefreshIfMoved();
+
+  // Gribb-Hartmann plane extraction (rows of the matrix)
+  glm::vec4 row0(viewProj[0][0], viewProj[1][0], viewProj[2][0],
+                 viewProj[3][0]);
+  glm::vec4 row1(viewProj[0][1], viewProj[1][1], viewProj[2][1],
+                 viewProj[3][1]);
+  glm::vec4 row2(viewProj[0][2], viewProj[1][2], viewProj[2][2],
+                 viewProj[3][2]);
+  glm::vec4 row3(viewProj[0][3], viewProj[1][3], viewProj[2][3],
+                 viewProj[3][3]);
+  glm::vec4 planes[6] = {row3 + row0, row3 - row0, row3 + row1,
+                         row3 - row1, row2, // Vulkan near plane is z = 0
+                         row3 - row2};
+
+  m_Tree.QueryPlanes(planes, [&](int proxy) {
+    outNodes.push_back(GetEntry(proxy).node);
+    return true;
+  });
+}
+
+} // namespace Quantum
@@ -0,0 +1,124 @@
+#pragma once
+#include "DynamicAABBTree.h"
+#include "glm/glm.hpp"
+#include <cstdint>
+#include <string>
+#include <typeindex>
+#include <unordered_map>
+#include <vector>
+
+namespace Quantum {
+
+class GraphNode;
+
+/// <summary>
+/// Incrementally maintained lookups for every node attached under a
+/// SceneGraph root: world bounds in a dynamic AABB tree, name and type
+/// indices, and cached node/mesh counts.
+///
+/// GraphNode reports structural changes (AddChild/RemoveChild, renames, mesh
+/// changes) as they happen. Transform and mesh geometry changes are picked up
+/// by Refresh(), which compares world/geometry versions and only refits the
+/// nodes that actually moved.
+/// </summary>
+class SceneIndex {
+public:
+  SceneIndex() = default;
+  ~SceneIndex();
+
+  SceneIndex(const SceneIndex &) = delete;
+  SceneIndex &operator=(const SceneIndex &) = delete;
+
+  // Notifications from GraphNode
+  void OnNodeAttached(GraphNode *node); // Registers the whole subtree
+  void OnNodeDetached(GraphNode *node); // Unregisters the whole subtree
+  void OnNodeDestroyed(GraphNode *node);
+  void OnNodeRenamed(GraphNode *node, const std::string &oldName);
+  void OnMeshesChanged(GraphNode *node);
+
+  /// <summary>
+  /// Refit bounds of nodes whose world transform or mesh geometry changed.
+  /// Settles pending transforms first. Called once per frame; queries in
+  /// between only refresh if a transform changed since.
+  /// </summary>
+  void Refresh();
+
+  bool Contains(const GraphNode *node) const {
+    return m_Entries.count(const_cast<GraphNode *>(node)) != 0;
+  }
+
+  size_t GetNodeCount() const { return m_Entries.size(); }
+
+  /// Bumped whenever a node is added to or removed from the index
+  uint64_t GetStructureVersion() const { return m_StructureVersion; }
+  size_t GetMeshCount() const { return m_MeshCount; }
+
+  /// All indexed nodes with this exact name (attachment order)
+  const std::vector<GraphNode *> &FindByName(const std::string &name) const;
+
+  /// All indexed nodes whose dynamic type is exactly 'type'
+  const std::vector<GraphNode *> &FindByType(std::type_index type) const;
+
+  template <typename T> T *FindFirstOfType() const {
+    const auto &nodes = FindByType(typeid(T));
+    return nodes.empty() ? nullptr : static_cast<T *>(nodes.front());
+  }
+
+  // Spatial queries (world space). Bounds and sphere queries test each
+  // candidate against its exact world bounds; frustum and ray queries are
+  // conservative (fat bounds).
+  void QueryBounds(const glm::vec3 &min, const glm::vec3 &max,
+                   std::vector<GraphNode *> &outNodes);
+  void QuerySphere(const glm::vec3 &center, float radius,
+                   std::vector<GraphNode *> &outNodes);
+  /// viewProj uses Vulkan clip space (0..1 depth)
+  void QueryFrustum(const glm::mat4 &viewProj,
+                    std::vector<GraphNode *> &outNodes);
+
+  /// <summary>
+  /// Nearest-first ray traversal. callback(GraphNode *, float entryT) returns
+  /// the new max distance (a hit distance, or the current one to continue).
+  /// </summary>
+  template <typename Callback>
+  void RayCast(const glm::vec3 &origin, const glm::vec3 &dir, float maxT,
+               Callback &&callback) {
+    RefreshIfMoved();
+    m_Tree.RayCast(origin, dir, maxT, [&](int proxy, float entryT) {
+      return callback(GetEntry(proxy).node, entryT);
+    });
+  }
+
+  int GetTreeHeight() const { return m_Tree.GetHeight(); }
+
+private:
+  // The tree's user data points at the node's entry
+  struct Entry {
+    GraphNode *node = nullptr;
+    AABB bounds; // Exact world bounds; the tree holds them fattened
+    int proxy = DynamicAABBTree::NullNode;
+    uint32_t worldVersion = 0;
+    uint64_t geometryVersion = 0;
+    size_t meshCount = 0;
+    std::type_index type = typeid(void);
+  };
+
+  const Entry &GetEntry(int proxy) const {
+    return *static_cast<const Entry *>(m_Tree.GetUserData(proxy));
+  }
+  void RefreshIfMoved();
+  void Register(GraphNode *node);
+  void Unregister(GraphNode *node);
+  static AABB ComputeBounds(GraphNode *node);
+  static uint64_t GeometryVersion(GraphNode *node);
+  static void RemoveFrom(std::vector<GraphNode *> &list, GraphNode *node);
+
+  DynamicAABBTree m_Tree;
+  std::unordered_map<GraphNode *, Entry> m_Entries;
+  std::unordered_map<std::string, std::vector<GraphNode *>> m_ByName;
+  std::unordered_map<std::type_index, std::vector<GraphNode *>> m_ByType;
+  size_t m_MeshCount = 0;
+  uint64_t m_StructureVersion = 0;
+  uint64_t m_LastChangeStamp = 0; // TransformHierarchy stamp at last Refresh
+};
+
+} // namespace Quantum
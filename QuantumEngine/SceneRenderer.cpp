@@ -10,6 +10,7 @@
 #include "RotateGizmo.h"
 #include "TerrainNode.h"
 #include "Texture2D.h"
+#include "TransformHierarchy.h"
 #include "TranslateGizmo.h"
 #include "VividApplication.h"
 #include "VividPipeline.h"
@@ -271,6 +272,13 @@ void SceneRenderer::Initialize() {
       "engine/shaders/PLTerrain.frag.spv", opaqueConfig,
       Vivid::PipelineType::Mesh3D);
 
+  // Virtual textured terrain: same layout, samples the tile atlases instead
+  // of blending layers per pixel (see TerrainNode::SetVirtualTextureEnabled)
+  RenderingPipelines::Get().RegisterPipeline(
+      "PLTerrainVT", "engine/shaders/PLTerrain.vert.spv",
+      "engine/shaders/PLTerrainVT.frag.spv", opaqueConfig,
+      Vivid::PipelineType::Mesh3D);
+
   // Set terrain descriptor layouts for RenderingPipelines
   std::vector<VkDescriptorSetLayout> terrainLayouts = {m_GlobalSetLayout,
                                                        m_TerrainSetLayout};
@@ -780,10 +788,30 @@ void SceneRenderer::ResizeUniformBuffers(size_t requiredDraws) {
 
 void SceneRenderer::RenderScene(VkCommandBuffer cmd, int width, int height,
                                 float time) {
+  // Refresh every moved transform in one depth-ordered pass so the per-node
+  // GetWorldMatrix() calls below are plain cache reads
+  TransformHierarchy::Get().UpdateWorldMatrices();
+  if (m_SceneGraph) {
+    // Editor-side moves (gizmo, inspector) also need their bounds refit
+    m_SceneGraph->GetIndex().Refresh();
+  }
+
   // Check and refresh any dirty terrain descriptors BEFORE command recording
   // This must happen before any command buffer recording starts
   if (m_SceneGraph && m_SceneGraph->GetRoot()) {
     CheckAndRefreshDirtyTerrains(m_SceneGraph->GetRoot());
+
+    // Stream virtual texture tiles for the camera used by RenderNode
+    auto camera = m_SceneGraph->GetCurrentCamera();
+    if (camera && width > 0 && height > 0) {
+      glm::mat4 view = camera->GetWorldMatrix();
+      glm::mat4 proj = glm::perspective(
+          glm::radians(45.0f), (float)width / (float)height, 0.1f, 100.0f);
+      proj[1][1] *= -1;
+      glm::vec3 cameraPos = glm::vec3(glm::inverse(view)[3]);
+      UpdateTerrainVirtualTextures(m_SceneGraph->GetRoot(), proj * view,
+                                   cameraPos);
+    }
   }
 
   // Reset draw indices at the start of the frame
@@ -1392,6 +1420,22 @@ void SceneRenderer::CheckAndRefreshDirtyTerrains(GraphNode *node) {
   }
 }
 
+void SceneRenderer::UpdateTerrainVirtualTextures(GraphNode *node,
+                                                 const glm::mat4 &viewProj,
+                                                 const glm::vec3 &cameraPos) {
+  if (!node)
+    return;
+
+  auto *terrainNode = dynamic_cast<TerrainNode *>(node);
+  if (terrainNode && terrainNode->IsVirtualTextureEnabled()) {
+    terrainNode->UpdateVirtualTexture(viewProj, cameraPos);
+  }
+
+  for (const auto &child : node->GetChildren()) {
+    UpdateTerrainVirtualTextures(child.get(), viewProj, cameraPos);
+  }
+}
+
 void SceneRenderer::CreateMaterialDescriptorSetsRecursive(GraphNode *node) {
   if (!node)
     return;
@@ -1426,6 +1470,9 @@ void SceneRenderer::CreateMaterialDescriptorSetsRecursive(GraphNode *node) {
       std::vector<VkDescriptorImageInfo> imageInfos(16);
       std::vector<VkWriteDescriptorSet> writes(16);
 
+      // All four layers share one packed blend map (one channel per layer)
+      auto blendMap = terrainNode->GetBlendMap();
+
       for (int layer = 0; layer < 4; layer++) {
         const auto &terrainLayer = terrainNode->GetLayer(layer);
 
@@ -1462,16 +1509,26 @@ void SceneRenderer::CreateMaterialDescriptorSetsRecursive(GraphNode *node) {
             terrainLayer.specularMap ? terrainLayer.specularMap->GetSampler()
                                      : m_DefaultTexture->GetSampler();
 
-        // Binding 3-7-11-15: Layer blend maps
+        // Binding 3-7-11-15: Packed blend map (shader reads binding 3 only)
         int mapIdx = layer * 4 + 3;
         imageInfos[mapIdx].imageLayout =
             VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-        imageInfos[mapIdx].imageView =
-            terrainLayer.layerMap ? terrainLayer.layerMap->GetImageView()
-                                  : m_DefaultTexture->GetImageView();
-        imageInfos[mapIdx].sampler = terrainLayer.layerMap
-                                         ? terrainLayer.layerMap->GetSampler()
-                                         : m_DefaultTexture->GetSampler();
+        imageInfos[mapIdx].imageView = blendMap
+                                           ? blendMap->GetImageView()
+                                           : m_DefaultTexture->GetImageView();
+        imageInfos[mapIdx].sampler =
+            blendMap ? blendMap->GetSampler() : m_DefaultTexture->GetSampler();
+      }
+
+      // Virtual texture mode: PLTerrainVT reads the albedo atlas (0), normal
+      // atlas (1) and page table (2); the remaining bindings stay valid
+      if (auto *vt = terrainNode->GetVirtualTexture()) {
+        std::shared_ptr<Vivid::Texture2D> vtTextures[3] = {
+            vt->GetAlbedoAtlas(), vt->GetNormalAtlas(), vt->GetPageTable()};
+        for (int i = 0; i < 3; i++) {
+          imageInfos[i].imageView = vtTextures[i]->GetImageView();
+          imageInfos[i].sampler = vtTextures[i]->GetSampler();
+        }
       }
 
       // Build write descriptor sets
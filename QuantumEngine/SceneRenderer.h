@@ -74,6 +74,10 @@ public:
   // Check for dirty terrain nodes and refresh their descriptors
   void CheckAndRefreshDirtyTerrains(GraphNode *node);
 
+  // Stream tiles for virtual textured terrains (render thread, per frame)
+  void UpdateTerrainVirtualTextures(GraphNode *node, const glm::mat4 &viewProj,
+                                    const glm::vec3 &cameraPos);
+
   // Shadow control
   bool IsShadowsEnabled() const { return m_ShadowsEnabled; }
   void SetShadowsEnabled(bool enabled) { m_ShadowsEnabled = enabled; }
@@ -166,7 +170,7 @@ public:
       return CastResult{false};
     }
 
-    // Use TerrainGizmo's Intersections instance for raycasting
+    // Height-field DDA on the terrain itself (O(cells crossed))
     return m_TerrainGizmo->RaycastTerrain(terrainNode, rayOrigin, rayDir);
   }
 
@@ -8,7 +8,6 @@
 namespace Quantum {
 
 TerrainGizmo::TerrainGizmo(Vivid::VividDevice *device) : m_Device(device) {
-  m_Intersections = std::make_unique<Intersections>();
   Initialize();
 }
 
@@ -117,23 +116,11 @@ void TerrainGizmo::SetSize(float size) {
 }
 
 void TerrainGizmo::UpdateToTerrain(TerrainNode *terrain) {
-  if (!terrain || !m_Mesh || !m_Intersections)
+  if (!terrain || !m_Mesh)
     return;
 
   // m_Scale = 1.0f; // Removed override
 
-  const auto &meshes = terrain->GetMeshes();
-  if (meshes.empty())
-    return;
-  auto terrainMesh = meshes[0];
-  if (!terrainMesh)
-    return;
-
-  // CRITICAL: Force cache rebuild to use latest terrain vertex data
-  // This ensures we're raycasting against the sculpted mesh, not cached old
-  // data
-  m_Intersections->InvalidateMesh(terrainMesh.get());
-
   // Get mutable access to gizmo vertices
   std::vector<Vertex3D> &verts =
       const_cast<std::vector<Vertex3D> &>(m_Mesh->GetVertices());
@@ -142,8 +129,6 @@ void TerrainGizmo::UpdateToTerrain(TerrainNode *terrain) {
   if (m_OriginalLocalXZ.size() != verts.size())
     return;
 
-  glm::mat4 terrainWorld = terrain->GetWorldMatrix();
-
   for (size_t i = 0; i < verts.size(); ++i) {
     Vertex3D &v = verts[i];
     const glm::vec2 &origXZ = m_OriginalLocalXZ[i];
@@ -153,14 +138,13 @@ void TerrainGizmo::UpdateToTerrain(TerrainNode *terrain) {
     float worldX = origXZ.x * m_Scale + m_Position.x;
     float worldZ = origXZ.y * m_Scale + m_Position.z;
 
-    // Ray origin: at world X,Z but Y=50 (above terrain)
+    // Ray origin: at world X,Z but Y=80 (above terrain)
     glm::vec3 rayOrigin = glm::vec3(worldX, 80.0f, worldZ);
-    // Ray direction: straight down (unnormalized, length 50)
-    glm::vec3 rayDir = glm::vec3(worldX, -500.0f, worldZ);
+    // Ray direction: straight down (unnormalized, length 500)
+    glm::vec3 rayDir = glm::vec3(0.0f, -500.0f, 0.0f);
 
-    // Raycast against the terrain mesh using GPU-accelerated intersection
-    CastResult hit = m_Intersections->CastMesh(terrainWorld, rayOrigin, rayDir,
-                                               terrainMesh.get());
+    // Height-field raycast: only walks the cells under this vertex
+    CastResult hit = terrain->Raycast(rayOrigin, rayDir);
 
     if (hit.Hit && hit.Distance < 500.0f) {
       // Set vertex Y to hit point Y + 0.01 offset
@@ -183,23 +167,12 @@ void TerrainGizmo::UpdateToTerrain(TerrainNode *terrain) {
 CastResult TerrainGizmo::RaycastTerrain(TerrainNode *terrain,
                                         const glm::vec3 &rayOrigin,
                                         const glm::vec3 &rayDir) {
-  if (!terrain || !m_Intersections) {
+  if (!terrain) {
     return CastResult{false};
   }
 
-  const auto &meshes = terrain->GetMeshes();
-  if (meshes.empty() || !meshes[0]) {
-    return CastResult{false};
-  }
-
-  auto terrainMesh = meshes[0];
-  glm::mat4 terrainWorld = terrain->GetWorldMatrix();
-
-  // Use a long ray direction for proper intersection distance
-  // glm::vec3 longDir = glm::normalize(rayDir) * 1000.0f;
-
-  return m_Intersections->CastMesh(terrainWorld, rayOrigin, rayDir,
-                                   terrainMesh.get());
+  // Grid DDA over the height field instead of testing every triangle
+  return terrain->Raycast(rayOrigin, rayDir);
 }
 
 void TerrainGizmo::Render(SceneRenderer *renderer, VkCommandBuffer cmd,
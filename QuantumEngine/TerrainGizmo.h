@@ -7,9 +7,6 @@
 #include <vector>
 #include <vulkan/vulkan.h>
 
-
-class Intersections;
-
 namespace Quantum {
 
 class SceneRenderer;
@@ -31,7 +28,7 @@ public:
   /// Update vertex heights to conform to terrain surface
   void UpdateToTerrain(TerrainNode *terrain);
 
-  /// Raycast against terrain mesh (used for mouse picking)
+  /// Raycast against terrain height field (used for mouse picking)
   CastResult RaycastTerrain(TerrainNode *terrain, const glm::vec3 &rayOrigin,
                             const glm::vec3 &rayDir);
 
@@ -49,9 +46,6 @@ private:
   // For dynamic updates
   bool m_NeedsTerrainUpdate = true;
 
-  // GPU-accelerated intersection testing
-  std::unique_ptr<Intersections> m_Intersections;
-
   // Original local vertex positions (so we can recalculate world positions
   // correctly)
   std::vector<glm::vec2> m_OriginalLocalXZ;
@@ -1,10 +1,19 @@
 #include "TerrainNode.h"
+#include "Intersections.h"
 #include "Material.h"
 #include "Mesh3D.h"
 #include "Texture2D.h"
+#include <algorithm>
+#include <cmath>
 #include <iostream>
+#include <limits>
 #include <vulkan/vulkan.h>
 
+#if defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define QUANTUM_TERRAIN_SSE2 1
+#endif
+
 namespace Quantum {
 
 // Helper to clamp int values
@@ -19,6 +28,9 @@ static int clampInt(int value, int minVal, int maxVal) {
 TerrainNode::TerrainNode(const std::string &name, float width, float depth,
                          int divisions, int layerCount)
     : GraphNode(name), m_Width(width), m_Depth(depth), m_Divisions(divisions),
+      // PLTerrain.frag blends from one packed map with a fixed 16-sampler
+      // set, which caps the node at 4 layers. The virtual texture compositor
+      // itself takes a blend page per 4 layers.
       m_LayerCount(clampInt(layerCount, 1, 4)) {
   m_Layers.resize(m_LayerCount);
   InitializeBlendMaps(); // Ensure blend data is ready
@@ -56,6 +68,17 @@ std::shared_ptr<GraphNode> TerrainNode::Clone() {
   for (int i = 0; i < m_LayerCount; ++i) {
     clone->m_Layers[i] = m_Layers[i];
   }
+
+  // Painted weights; the clone gets its own blend map, uploaded whole
+  clone->m_BlendData = m_BlendData;
+  clone->m_BlendDirty.Clear();
+  clone->m_BlendDirty.Add(0, 0, m_BlendMapSize - 1, m_BlendMapSize - 1);
+  if (m_Device) {
+    clone->m_Device = m_Device;
+    clone->m_BlendMap = std::make_shared<Vivid::Texture2D>(
+        m_Device, clone->m_BlendData.data(), m_BlendMapSize, m_BlendMapSize,
+        4, VK_FORMAT_R8G8B8A8_UNORM);
+  }
   return clone;
 }
 
@@ -123,10 +146,6 @@ void TerrainNode::CreateDefaultTextures(Vivid::VividDevice *device) {
   // Default white color for layers without textures
   unsigned char whiteColor[4] = {255, 255, 255, 255};
 
-  // Layer maps: layer 0 full strength, others zero
-  unsigned char fullStrength[4] = {255, 255, 255, 255};
-  unsigned char zeroStrength[4] = {0, 0, 0, 255};
-
   for (int i = 0; i < m_LayerCount; ++i) {
     // Color map: Layer 0 loads grid.png, others are white
     if (i == 0) {
@@ -153,20 +172,15 @@ void TerrainNode::CreateDefaultTextures(Vivid::VividDevice *device) {
     // Specular map: 0.5 grey for all layers
     m_Layers[i].specularMap =
         std::make_shared<Vivid::Texture2D>(device, defaultSpec, 1, 1, 4);
-
-    // Layer map: Initialize with BlendData (512x512)
-    // Note: InitializeBlendMaps() is called in constructor, so data is ready.
-    if (i < m_LayerBlendData.size()) {
-      m_Layers[i].layerMap =
-          std::make_shared<Vivid::Texture2D>(device, m_LayerBlendData[i].data(),
-                                             m_BlendMapSize, m_BlendMapSize, 4);
-    } else {
-      // Fallback (should not happen)
-      m_Layers[i].layerMap =
-          std::make_shared<Vivid::Texture2D>(device, zeroStrength, 1, 1, 4);
-    }
   }
 
+  // Packed blend map: one texture for all layers, UNORM so weights are linear.
+  // InitializeBlendMaps() is called in the constructor, so data is ready.
+  m_BlendMap = std::make_shared<Vivid::Texture2D>(
+      device, m_BlendData.data(), m_BlendMapSize, m_BlendMapSize, 4,
+      VK_FORMAT_R8G8B8A8_UNORM);
+  m_BlendDirty.Clear();
+
   // Set material to mesh
   if (HasMeshes()) {
     GetMeshes()[0]->SetMaterial(material);
@@ -218,36 +232,36 @@ void TerrainNode::ProcessPendingUpdates() {
 
   m_PendingUpdates.clear();
   m_DescriptorDirty = true;
+
+  // Tiles were composited from the old layer images
+  if (m_VirtualTexture) {
+    m_VTLayersDirty = true;
+  }
 }
 
-void TerrainNode::InitializeBlendMaps() {
-  m_LayerBlendData.resize(m_LayerCount);
-  m_LayerDirty.resize(m_LayerCount, false);
+void TerrainNode::DirtyRect::Add(int x0, int y0, int x1, int y1) {
+  if (IsEmpty()) {
+    minX = x0;
+    minY = y0;
+    maxX = x1;
+    maxY = y1;
+    return;
+  }
+  minX = std::min(minX, x0);
+  minY = std::min(minY, y0);
+  maxX = std::max(maxX, x1);
+  maxY = std::max(maxY, y1);
+}
 
+void TerrainNode::InitializeBlendMaps() {
   size_t dataSize = m_BlendMapSize * m_BlendMapSize * 4; // RGBA
 
-  for (int i = 0; i < m_LayerCount; ++i) {
-    m_LayerBlendData[i].resize(dataSize, 0);
-    // Initialize layer 0 to full strength (red channel = 255), others to 0
-    if (i == 0) {
-      for (size_t j = 0; j < dataSize; j += 4) {
-        m_LayerBlendData[i][j] = 255;     // R
-        m_LayerBlendData[i][j + 1] = 0;   // G
-        m_LayerBlendData[i][j + 2] = 0;   // B
-        m_LayerBlendData[i][j + 3] = 255; // A
-      }
-      m_LayerDirty[i] = true;
-    } else {
-      // Initialize others to 0 (R=0)
-      for (size_t j = 0; j < dataSize; j += 4) {
-        m_LayerBlendData[i][j] = 0;       // R
-        m_LayerBlendData[i][j + 1] = 0;   // G
-        m_LayerBlendData[i][j + 2] = 0;   // B
-        m_LayerBlendData[i][j + 3] = 255; // A
-      }
-      m_LayerDirty[i] = true;
-    }
+  // Layer 0 (R) at full strength, all other layers zero
+  m_BlendData.assign(dataSize, 0);
+  for (size_t j = 0; j < dataSize; j += 4) {
+    m_BlendData[j] = 255;
   }
+  m_BlendDirty.Add(0, 0, m_BlendMapSize - 1, m_BlendMapSize - 1);
 }
 
 void TerrainNode::OnUpdate(float dt) {
@@ -256,24 +270,65 @@ void TerrainNode::OnUpdate(float dt) {
 }
 
 void TerrainNode::UpdateGPUTextures() {
-  if (!m_AnyLayerDirty)
+  if (m_BlendDirty.IsEmpty() || !m_BlendMap)
     return; // Optimization: Skip if no changes
 
-  for (int i = 0; i < m_LayerCount; ++i) {
-    if (m_LayerDirty[i]) {
-      if (i < m_Layers.size() && m_Layers[i].layerMap) {
-        m_Layers[i].layerMap->SetPixels(m_LayerBlendData[i]);
-      }
-      m_LayerDirty[i] = false;
+  // Only the touched texels go through the staging buffer
+  m_BlendMap->SetPixelsRegion(m_BlendData.data(), m_BlendDirty.minX,
+                              m_BlendDirty.minY,
+                              m_BlendDirty.maxX - m_BlendDirty.minX + 1,
+                              m_BlendDirty.maxY - m_BlendDirty.minY + 1);
+  m_BlendDirty.Clear();
+}
+
+// Add 'amount' (0-255 scale) to one channel of a packed texel, then rescale so
+// that all channels sum to 255 again.
+static inline void BrushTexelScalar(unsigned char *texel, int channel,
+                                    float amount) {
+  float w[4];
+  for (int c = 0; c < 4; ++c) {
+    w[c] = static_cast<float>(texel[c]);
+  }
+  w[channel] = std::min(255.0f, w[channel] + amount);
+
+  float total = w[0] + w[1] + w[2] + w[3];
+  if (total > 0.1f) {
+    float scale = 255.0f / total;
+    for (int c = 0; c < 4; ++c) {
+      texel[c] = static_cast<unsigned char>(w[c] * scale);
     }
+  } else {
+    texel[channel] = static_cast<unsigned char>(w[channel]);
   }
-  m_AnyLayerDirty = false;
 }
 
+#ifdef QUANTUM_TERRAIN_SSE2
+static inline __m128 BrushTexelSSE(__m128 w, __m128 add) {
+  const __m128 max255 = _mm_set1_ps(255.0f);
+  w = _mm_min_ps(_mm_add_ps(w, add), max255);
+
+  // Horizontal sum broadcast to all lanes
+  __m128 sum = _mm_add_ps(w, _mm_shuffle_ps(w, w, _MM_SHUFFLE(2, 3, 0, 1)));
+  sum = _mm_add_ps(sum, _mm_shuffle_ps(sum, sum, _MM_SHUFFLE(1, 0, 3, 2)));
+
+  // 255 / sum via reciprocal + one Newton-Raphson step (no per-layer divide)
+  __m128 rcp = _mm_rcp_ps(sum);
+  rcp = _mm_sub_ps(_mm_add_ps(rcp, rcp), _mm_mul_ps(sum, _mm_mul_ps(rcp, rcp)));
+  __m128 scaled = _mm_min_ps(_mm_mul_ps(w, _mm_mul_ps(rcp, max255)), max255);
+
+  // Leave texels with no weight at all untouched by the normalize
+  __m128 valid = _mm_cmpgt_ps(sum, _mm_set1_ps(0.1f));
+  return _mm_or_ps(_mm_and_ps(valid, scaled), _mm_andnot_ps(valid, w));
+}
+#endif
+
 void TerrainNode::Paint(const glm::vec3 &hitPoint, int layerIndex, float radius,
                         float strength) {
-  if (layerIndex < 0 || layerIndex >= m_LayerCount)
+  if (layerIndex < 0 || layerIndex >= m_LayerCount) {
+    std::cerr << "[TerrainNode] Error: Invalid layer index " << layerIndex
+              << " for paint operation!" << std::endl;
     return;
+  }
 
   // Convert world hit point to UV space
   // Terrain is centered at (0,0,0)
@@ -285,80 +340,104 @@ void TerrainNode::Paint(const glm::vec3 &hitPoint, int layerIndex, float radius,
   // Convert UV to pixel coords
   int centerX = static_cast<int>(u * m_BlendMapSize);
   int centerY = static_cast<int>(v * m_BlendMapSize);
-  if (layerIndex < 0 || layerIndex >= m_LayerCount) {
-    std::cerr << "[TerrainNode] Error: Invalid layer index " << layerIndex
-              << " for paint operation!" << std::endl;
-    return;
-  }
-
-  if (layerIndex >= m_LayerBlendData.size()) {
-    std::cerr << "[TerrainNode] Error: Layer index " << layerIndex
-              << " exceeds BlendData size " << m_LayerBlendData.size()
-              << std::endl;
-    return;
-  }
 
   int pixelRadius = static_cast<int>((radius / m_Width) * m_BlendMapSize);
+  if (pixelRadius <= 0)
+    return;
 
   // Square of pixel radius for distance check
   int distSqLimit = pixelRadius * pixelRadius;
+  float invRadius = 1.0f / static_cast<float>(pixelRadius);
+  float amountScale = strength * 255.0f;
 
   int minX = std::max(0, centerX - pixelRadius);
   int maxX = std::min(m_BlendMapSize - 1, centerX + pixelRadius);
   int minY = std::max(0, centerY - pixelRadius);
   int maxY = std::min(m_BlendMapSize - 1, centerY + pixelRadius);
+  if (minX > maxX || minY > maxY)
+    return;
+
+#ifdef QUANTUM_TERRAIN_SSE2
+  // Channel mask selecting the painted layer within a texel
+  alignas(16) float channelBits[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+  channelBits[layerIndex] = 1.0f;
+  const __m128 channelMask = _mm_load_ps(channelBits);
+  const __m128 laneOffsets = _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f);
+  const __m128 limit = _mm_set1_ps(static_cast<float>(distSqLimit));
+  const __m128 zero = _mm_setzero_ps();
+  const __m128 one = _mm_set1_ps(1.0f);
+  const __m128i zeroi = _mm_setzero_si128();
+#endif
 
   for (int y = minY; y <= maxY; ++y) {
-    for (int x = minX; x <= maxX; ++x) {
-      int distSq =
-          (x - centerX) * (x - centerX) + (y - centerY) * (y - centerY);
-      if (distSq <= distSqLimit) {
-        // Calculate falloff (linear for now)
-        float currentDist = std::sqrt(static_cast<float>(distSq));
-        float falloff = 1.0f - (currentDist / pixelRadius);
-        // Apply curve? Smoothstep? For now just linear.
-        if (falloff < 0)
-          falloff = 0;
-
-        float weightChange = strength * falloff;
-
-        // Apply to target layer
-        size_t idx = (y * m_BlendMapSize + x) * 4;
-
-        // Current value (0-255)
-        float currentVal = m_LayerBlendData[layerIndex][idx];
-        float newVal = currentVal + weightChange * 255.0f;
-        newVal = std::min(255.0f, newVal);
-        m_LayerBlendData[layerIndex][idx] = static_cast<unsigned char>(newVal);
-        m_LayerDirty[layerIndex] = true;
-        m_AnyLayerDirty = true;
-
-        // Subtract from other layers proportionally or just radially
-        // To keep sum ~ 255.
-
-        // Simple strategy: reduce others by the amount we added * their
-        // relative contribution? Or just reduce them. To ensure conservation
-        // of 1.0 (255):
-        // 1. Calculate sum of ALL layers (using new target value)
-        // 2. Normalize.
-
-        float totalWeight = 0.0f;
-        for (int l = 0; l < m_LayerCount; ++l) {
-          totalWeight += m_LayerBlendData[l][idx];
-        }
-
-        if (totalWeight > 0.1f) {
-          for (int l = 0; l < m_LayerCount; ++l) {
-            float w = m_LayerBlendData[l][idx];
-            w = (w / totalWeight) * 255.0f;
-            m_LayerBlendData[l][idx] = static_cast<unsigned char>(w);
-            m_LayerDirty[l] = true;
-            m_AnyLayerDirty = true;
-          }
-        }
-      }
+    int dy = y - centerY;
+    unsigned char *row = &m_BlendData[(y * m_BlendMapSize + minX) * 4];
+    int count = maxX - minX + 1;
+    int i = 0;
+
+#ifdef QUANTUM_TERRAIN_SSE2
+    // Four texels (16 bytes) per iteration
+    const __m128 dy2 = _mm_set1_ps(static_cast<float>(dy * dy));
+    for (; i + 4 <= count; i += 4) {
+      __m128 dx = _mm_add_ps(
+          _mm_set1_ps(static_cast<float>(minX + i - centerX)), laneOffsets);
+      __m128 d2 = _mm_add_ps(_mm_mul_ps(dx, dx), dy2);
+      __m128 inside = _mm_cmple_ps(d2, limit);
+      if (_mm_movemask_ps(inside) == 0)
+        continue;
+
+      // Linear falloff
+      __m128 falloff =
+          _mm_max_ps(zero, _mm_sub_ps(one, _mm_mul_ps(_mm_sqrt_ps(d2),
+                                                      _mm_set1_ps(invRadius))));
+      alignas(16) float amount[4];
+      _mm_store_ps(amount, _mm_mul_ps(falloff, _mm_set1_ps(amountScale)));
+
+      __m128i px = _mm_loadu_si128(reinterpret_cast<__m128i *>(row + i * 4));
+      __m128i lo16 = _mm_unpacklo_epi8(px, zeroi);
+      __m128i hi16 = _mm_unpackhi_epi8(px, zeroi);
+      __m128 t0 = _mm_cvtepi32_ps(_mm_unpacklo_epi16(lo16, zeroi));
+      __m128 t1 = _mm_cvtepi32_ps(_mm_unpackhi_epi16(lo16, zeroi));
+      __m128 t2 = _mm_cvtepi32_ps(_mm_unpacklo_epi16(hi16, zeroi));
+      __m128 t3 = _mm_cvtepi32_ps(_mm_unpackhi_epi16(hi16, zeroi));
+
+      t0 = BrushTexelSSE(t0, _mm_mul_ps(channelMask, _mm_set1_ps(amount[0])));
+      t1 = BrushTexelSSE(t1, _mm_mul_ps(channelMask, _mm_set1_ps(amount[1])));
+      t2 = BrushTexelSSE(t2, _mm_mul_ps(channelMask, _mm_set1_ps(amount[2])));
+      t3 = BrushTexelSSE(t3, _mm_mul_ps(channelMask, _mm_set1_ps(amount[3])));
+
+      __m128i packed = _mm_packus_epi16(
+          _mm_packs_epi32(_mm_cvttps_epi32(t0), _mm_cvttps_epi32(t1)),
+          _mm_packs_epi32(_mm_cvttps_epi32(t2), _mm_cvttps_epi32(t3)));
+
+      // Texels outside the brush circle keep their original bytes
+      __m128i keep = _mm_castps_si128(inside);
+      __m128i result = _mm_or_si128(_mm_and_si128(keep, packed),
+                                    _mm_andnot_si128(keep, px));
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(row + i * 4), result);
+    }
+#endif
+
+    for (; i < count; ++i) {
+      int dx = minX + i - centerX;
+      int distSq = dx * dx + dy * dy;
+      if (distSq > distSqLimit)
+        continue;
+
+      // Calculate falloff (linear)
+      float falloff =
+          1.0f - std::sqrt(static_cast<float>(distSq)) * invRadius;
+      if (falloff < 0)
+        falloff = 0;
+
+      BrushTexelScalar(row + i * 4, layerIndex, falloff * amountScale);
     }
   }
+
+  m_BlendDirty.Add(minX, minY, maxX, maxY);
+  if (m_VirtualTexture) {
+    m_VTBlendDirty.Add(minX, minY, maxX, maxY);
+  }
 }
 
 void TerrainNode::Sculpt(const glm::vec3 &hitPoint, float radius,
@@ -453,7 +532,402 @@ void TerrainNode::Sculpt(const glm::vec3 &hitPoint, float radius,
 
     // Upload to GPU
     mesh->UpdateVertexBuffer();
+
+    // Keep raycast acceleration in sync with the new heights
+    UpdateHeightPyramid(minX, minY, maxX, maxY);
+    m_VTSculpted = true;
+  }
+}
+
+// Min/max height of the four corner vertices of a level 0 cell
+static glm::vec2 CellHeightRange(const std::vector<Vertex3D> &verts,
+                                 int divisions, int cx, int cz) {
+  int row = divisions + 1;
+  float h00 = verts[cz * row + cx].position.y;
+  float h10 = verts[cz * row + cx + 1].position.y;
+  float h01 = verts[(cz + 1) * row + cx].position.y;
+  float h11 = verts[(cz + 1) * row + cx + 1].position.y;
+  return glm::vec2(std::min(std::min(h00, h10), std::min(h01, h11)),
+                   std::max(std::max(h00, h10), std::max(h01, h11)));
+}
+
+// Combine the (up to) four children of a pyramid entry
+static glm::vec2 CombineChildren(const std::vector<glm::vec2> &child,
+                                 int childSize, int cx, int cz) {
+  glm::vec2 range(std::numeric_limits<float>::max(),
+                  std::numeric_limits<float>::lowest());
+  for (int z = cz * 2; z <= std::min(cz * 2 + 1, childSize - 1); ++z) {
+    for (int x = cx * 2; x <= std::min(cx * 2 + 1, childSize - 1); ++x) {
+      const glm::vec2 &c = child[z * childSize + x];
+      range.x = std::min(range.x, c.x);
+      range.y = std::max(range.y, c.y);
+    }
+  }
+  return range;
+}
+
+void TerrainNode::BuildHeightPyramid() {
+  m_HeightPyramid.clear();
+  if (!HasMeshes() || !GetMeshes()[0] || m_Divisions <= 0)
+    return;
+
+  auto mesh = GetMeshes()[0];
+  const auto &verts = mesh->GetVertices();
+  if (verts.size() < static_cast<size_t>((m_Divisions + 1) * (m_Divisions + 1)))
+    return;
+
+  HeightLevel base;
+  base.size = m_Divisions;
+  base.minMax.resize(base.size * base.size);
+  for (int z = 0; z < base.size; ++z) {
+    for (int x = 0; x < base.size; ++x) {
+      base.minMax[z * base.size + x] = CellHeightRange(verts, m_Divisions, x, z);
+    }
   }
+  m_HeightPyramid.push_back(std::move(base));
+
+  while (m_HeightPyramid.back().size > 1) {
+    const HeightLevel &child = m_HeightPyramid.back();
+    HeightLevel level;
+    level.size = (child.size + 1) / 2;
+    level.minMax.resize(level.size * level.size);
+    for (int z = 0; z < level.size; ++z) {
+      for (int x = 0; x < level.size; ++x) {
+        level.minMax[z * level.size + x] =
+            CombineChildren(child.minMax, child.size, x, z);
+      }
+    }
+    m_HeightPyramid.push_back(std::move(level));
+  }
+
+  m_HeightPyramidVersion = mesh->GetGeometryVersion();
+}
+
+void TerrainNode::UpdateHeightPyramid(int minX, int minZ, int maxX, int maxZ) {
+  if (m_HeightPyramid.empty() || !HasMeshes() || !GetMeshes()[0])
+    return; // Built lazily on the next raycast
+
+  auto mesh = GetMeshes()[0];
+  const auto &verts = mesh->GetVertices();
+
+  // A vertex touches the cells on either side of it
+  int x0 = clampInt(minX - 1, 0, m_Divisions - 1);
+  int z0 = clampInt(minZ - 1, 0, m_Divisions - 1);
+  int x1 = clampInt(maxX, 0, m_Divisions - 1);
+  int z1 = clampInt(maxZ, 0, m_Divisions - 1);
+
+  HeightLevel &base = m_HeightPyramid[0];
+  for (int z = z0; z <= z1; ++z) {
+    for (int x = x0; x <= x1; ++x) {
+      base.minMax[z * base.size + x] = CellHeightRange(verts, m_Divisions, x, z);
+    }
+  }
+
+  for (size_t l = 1; l < m_HeightPyramid.size(); ++l) {
+    const HeightLevel &child = m_HeightPyramid[l - 1];
+    HeightLevel &level = m_HeightPyramid[l];
+    x0 >>= 1;
+    z0 >>= 1;
+    x1 >>= 1;
+    z1 >>= 1;
+    for (int z = z0; z <= z1; ++z) {
+      for (int x = x0; x <= x1; ++x) {
+        level.minMax[z * level.size + x] =
+            CombineChildren(child.minMax, child.size, x, z);
+      }
+    }
+  }
+
+  m_HeightPyramidVersion = mesh->GetGeometryVersion();
+}
+
+// Two-sided Moller-Trumbore. Returns the ray parameter in outT.
+static bool RayTriangle(const glm::vec3 &o, const glm::vec3 &d,
+                        const glm::vec3 &v0, const glm::vec3 &v1,
+                        const glm::vec3 &v2, float &outT) {
+  const float epsilon = 1e-9f;
+  glm::vec3 edge1 = v1 - v0;
+  glm::vec3 edge2 = v2 - v0;
+  glm::vec3 h = glm::cross(d, edge2);
+  float a = glm::dot(edge1, h);
+  if (std::abs(a) < epsilon)
+    return false;
+
+  float f = 1.0f / a;
+  glm::vec3 s = o - v0;
+  float u = f * glm::dot(s, h);
+  if (u < 0.0f || u > 1.0f)
+    return false;
+  glm::vec3 q = glm::cross(s, edge1);
+  float v = f * glm::dot(d, q);
+  if (v < 0.0f || u + v > 1.0f)
+    return false;
+
+  outT = f * glm::dot(edge2, q);
+  return true;
+}
+
+CastResult TerrainNode::Raycast(const glm::vec3 &rayOrigin,
+                                const glm::vec3 &rayDir) {
+  CastResult result;
+  if (!HasMeshes() || !GetMeshes()[0] || m_Divisions <= 0)
+    return result;
+
+  auto mesh = GetMeshes()[0];
+  const auto &verts = mesh->GetVertices();
+  const int row = m_Divisions + 1;
+  if (verts.size() < static_cast<size_t>(row * row))
+    return result;
+
+  if (m_HeightPyramid.empty() ||
+      m_HeightPyramidVersion != mesh->GetGeometryVersion()) {
+    BuildHeightPyramid();
+    if (m_HeightPyramid.empty())
+      return result;
+  }
+
+  // Work in local space, then express x/z in grid cell units
+  glm::mat4 world = GetWorldMatrix();
+  glm::mat4 inverseModel = glm::inverse(world);
+  glm::vec3 o = glm::vec3(inverseModel * glm::vec4(rayOrigin, 1.0f));
+  glm::vec3 d = glm::vec3(inverseModel * glm::vec4(rayDir, 0.0f));
+
+  float cellW = m_Width / m_Divisions;
+  float cellD = m_Depth / m_Divisions;
+  float gox = (o.x + m_Width / 2.0f) / cellW;
+  float goz = (o.z + m_Depth / 2.0f) / cellD;
+  float gdx = d.x / cellW;
+  float gdz = d.z / cellD;
+
+  // Clip the segment [0,1] against the terrain bounds (slab test)
+  const glm::vec2 &rootRange = m_HeightPyramid.back().minMax[0];
+  float tEnter = 0.0f;
+  float tExit = 1.0f;
+  auto clipSlab = [&](float origin, float dir, float lo, float hi) {
+    if (std::abs(dir) < 1e-12f)
+      return origin >= lo && origin <= hi;
+    float ta = (lo - origin) / dir;
+    float tb = (hi - origin) / dir;
+    if (ta > tb)
+      std::swap(ta, tb);
+    tEnter = std::max(tEnter, ta);
+    tExit = std::min(tExit, tb);
+    return tEnter <= tExit;
+  };
+  if (!clipSlab(gox, gdx, 0.0f, static_cast<float>(m_Divisions)) ||
+      !clipSlab(goz, gdz, 0.0f, static_cast<float>(m_Divisions)) ||
+      !clipSlab(o.y, d.y, rootRange.x, rootRange.y)) {
+    return result;
+  }
+
+  const int topLevel = static_cast<int>(m_HeightPyramid.size()) - 1;
+  int level = m_UseHeightPyramid ? topLevel : 0;
+  float t = tEnter;
+
+  // Nudge along the ray so cells on a boundary resolve to the one entered
+  const float nudge = 1e-4f;
+  float stepX = gdx > 0.0f ? nudge : (gdx < 0.0f ? -nudge : 0.0f);
+  float stepZ = gdz > 0.0f ? nudge : (gdz < 0.0f ? -nudge : 0.0f);
+
+  const int maxSteps = 8 * (m_Divisions + 1) * (topLevel + 2);
+  for (int steps = 0; steps < maxSteps && t <= tExit; ++steps) {
+    const HeightLevel &lvl = m_HeightPyramid[level];
+    int cellSpan = 1 << level;
+
+    float gx = gox + gdx * t + stepX;
+    float gz = goz + gdz * t + stepZ;
+    int cx = clampInt(static_cast<int>(std::floor(gx)) >> level, 0,
+                      lvl.size - 1);
+    int cz = clampInt(static_cast<int>(std::floor(gz)) >> level, 0,
+                      lvl.size - 1);
+
+    // Parametric exit of this cell
+    float x0 = static_cast<float>(cx * cellSpan);
+    float x1 = static_cast<float>(std::min((cx + 1) * cellSpan, m_Divisions));
+    float z0 = static_cast<float>(cz * cellSpan);
+    float z1 = static_cast<float>(std::min((cz + 1) * cellSpan, m_Divisions));
+    float tCellExit = tExit;
+    if (gdx > 0.0f)
+      tCellExit = std::min(tCellExit, (x1 - gox) / gdx);
+    else if (gdx < 0.0f)
+      tCellExit = std::min(tCellExit, (x0 - gox) / gdx);
+    if (gdz > 0.0f)
+      tCellExit = std::min(tCellExit, (z1 - goz) / gdz);
+    else if (gdz < 0.0f)
+      tCellExit = std::min(tCellExit, (z0 - goz) / gdz);
+    if (tCellExit <= t)
+      tCellExit = std::min(t + 1e-6f, tExit); // Guarantee forward progress
+
+    // Lowest point of the ray inside this cell vs highest terrain point
+    float rayMinY = std::min(o.y + d.y * t, o.y + d.y * tCellExit);
+    const glm::vec2 &range = lvl.minMax[cz * lvl.size + cx];
+    if (rayMinY > range.y) {
+      // Entirely above: skip the cell and try a coarser level next
+      if (tCellExit >= tExit)
+        break;
+      t = tCellExit;
+      if (m_UseHeightPyramid && level < topLevel)
+        ++level;
+      continue;
+    }
+
+    if (level > 0) {
+      --level;
+      continue;
+    }
+
+    // Level 0: test the cell's two triangles (same split as the mesh)
+    const glm::vec3 &tl = verts[cz * row + cx].position;
+    const glm::vec3 &tr = verts[cz * row + cx + 1].position;
+    const glm::vec3 &bl = verts[(cz + 1) * row + cx].position;
+    const glm::vec3 &br = verts[(cz + 1) * row + cx + 1].position;
+
+    float bestT = std::numeric_limits<float>::max();
+    float triT;
+    if (RayTriangle(o, d, tl, bl, tr, triT) && triT > 0.0f && triT <= 1.0f)
+      bestT = std::min(bestT, triT);
+    if (RayTriangle(o, d, tr, bl, br, triT) && triT > 0.0f && triT <= 1.0f)
+      bestT = std::min(bestT, triT);
+
+    if (bestT != std::numeric_limits<float>::max()) {
+      glm::vec3 localHit = o + d * bestT;
+      result.Hit = true;
+      result.HitPoint = glm::vec3(world * glm::vec4(localHit, 1.0f));
+      result.Distance = glm::length(result.HitPoint - rayOrigin);
+      return result;
+    }
+
+    if (tCellExit >= tExit)
+      break;
+    t = tCellExit;
+  }
+
+  return result;
+}
+
+// ========== Virtual Texture ==========
+
+void TerrainNode::SetVirtualTextureEnabled(bool enabled) {
+  if (enabled == IsVirtualTextureEnabled())
+    return;
+  if (!m_Device) {
+    std::cerr << "[TerrainNode] Cannot toggle virtual texture before "
+                 "Initialize()"
+              << std::endl;
+    return;
+  }
+
+  // The current descriptor set may reference the atlases
+  vkDeviceWaitIdle(m_Device->GetDevice());
+
+  if (enabled) {
+    m_VirtualTexture = std::make_unique<TerrainVirtualTexture>(
+        m_Device, TerrainVirtualTexture::Settings());
+    LoadVirtualTextureLayers();
+    RefreshVirtualTextureExtent();
+    m_VirtualTexture->SetSource(SnapshotCompositeSource());
+    m_VTBlendDirty.Clear();
+  } else {
+    m_VirtualTexture.reset();
+    m_VTColorImages.clear();
+    m_VTNormalImages.clear();
+  }
+
+  if (HasMeshes() && GetMeshes()[0] && GetMeshes()[0]->GetMaterial()) {
+    GetMeshes()[0]->GetMaterial()->SetPipeline(enabled ? "PLTerrainVT"
+                                                       : "PLTerrain");
+  }
+  m_DescriptorDirty = true;
+}
+
+void TerrainNode::LoadVirtualTextureLayers() {
+  m_VTColorImages.clear();
+  m_VTNormalImages.clear();
+
+  for (int i = 0; i < m_LayerCount; ++i) {
+    const TerrainLayer &layer = m_Layers[i];
+
+    // Same fallbacks as CreateDefaultTextures: white color, flat normal
+    TerrainSourceImage color;
+    if (!layer.colorPath.empty())
+      color = TerrainSourceImage::Load(layer.colorPath);
+    if (!color.IsValid())
+      color = TerrainSourceImage::Solid(255, 255, 255, 255);
+
+    TerrainSourceImage normal;
+    if (!layer.normalPath.empty())
+      normal = TerrainSourceImage::Load(layer.normalPath);
+    if (!normal.IsValid())
+      normal = TerrainSourceImage::Solid(128, 128, 255, 255);
+
+    m_VTColorImages.push_back(
+        std::make_shared<const TerrainSourceImage>(std::move(color)));
+    m_VTNormalImages.push_back(
+        std::make_shared<const TerrainSourceImage>(std::move(normal)));
+  }
+}
+
+std::shared_ptr<const TerrainCompositeSource>
+TerrainNode::SnapshotCompositeSource() const {
+  auto source = std::make_shared<TerrainCompositeSource>();
+  source->color = m_VTColorImages;
+  source->normal = m_VTNormalImages;
+  source->blendPages = {m_BlendData};
+  source->blendMapSize = m_BlendMapSize;
+  return source;
+}
+
+void TerrainNode::RefreshVirtualTextureExtent() {
+  if (!m_VirtualTexture)
+    return;
+
+  float minY = 0.0f, maxY = 0.0f;
+  if (HasMeshes() && GetMeshes()[0]) {
+    auto mesh = GetMeshes()[0];
+    if (m_HeightPyramid.empty() ||
+        m_HeightPyramidVersion != mesh->GetGeometryVersion()) {
+      BuildHeightPyramid();
+    }
+    if (!m_HeightPyramid.empty()) {
+      const glm::vec2 &root = m_HeightPyramid.back().minMax[0];
+      minY = root.x;
+      maxY = root.y;
+    }
+  }
+  m_VirtualTexture->SetTerrainExtent(m_Width, m_Depth, minY, maxY);
+}
+
+void TerrainNode::UpdateVirtualTexture(const glm::mat4 &viewProj,
+                                       const glm::vec3 &cameraPos) {
+  if (!m_VirtualTexture)
+    return;
+
+  if (m_VTLayersDirty) {
+    LoadVirtualTextureLayers();
+    m_VirtualTexture->SetSource(SnapshotCompositeSource());
+    m_VTBlendDirty.Clear();
+    m_VTLayersDirty = false;
+  } else if (!m_VTBlendDirty.IsEmpty()) {
+    // One snapshot per frame no matter how many brush stamps landed
+    float inv = 1.0f / static_cast<float>(m_BlendMapSize);
+    glm::vec2 uvMin(m_VTBlendDirty.minX * inv, m_VTBlendDirty.minY * inv);
+    glm::vec2 uvMax((m_VTBlendDirty.maxX + 1) * inv,
+                    (m_VTBlendDirty.maxY + 1) * inv);
+    m_VirtualTexture->UpdateRegion(SnapshotCompositeSource(), uvMin, uvMax);
+    m_VTBlendDirty.Clear();
+  }
+
+  if (m_VTSculpted) {
+    RefreshVirtualTextureExtent();
+    m_VTSculpted = false;
+  }
+
+  // Tile selection works in terrain local space
+  glm::mat4 world = GetWorldMatrix();
+  glm::vec3 localCamera =
+      glm::vec3(glm::inverse(world) * glm::vec4(cameraPos, 1.0f));
+  m_VirtualTexture->Update(localCamera, viewProj * world);
+  m_VirtualTexture->ProcessCompletedTiles();
 }
 
 } // namespace Quantum
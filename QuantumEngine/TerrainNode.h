@@ -1,11 +1,15 @@
 #pragma once
 #include "GraphNode.h"
 #include "TerrainLayer.h"
+#include "TerrainVirtualTexture.h"
 #include "VividDevice.h"
+#include <memory>
 #include <mutex>
 #include <vector>
 #include <vulkan/vulkan.h>
 
+struct CastResult;
+
 namespace Quantum {
 
 /// <summary>
@@ -44,6 +48,11 @@ public:
   TerrainLayer &GetLayer(int index);
   const TerrainLayer &GetLayer(int index) const;
 
+  /// <summary>
+  /// Packed blend map shared by all layers (layer N weight in channel N).
+  /// </summary>
+  std::shared_ptr<Vivid::Texture2D> GetBlendMap() const { return m_BlendMap; }
+
   /// <summary>
   /// Set a layer texture at runtime by file path.
   /// </summary>
@@ -76,6 +85,43 @@ public:
   void Sculpt(const glm::vec3 &hitPoint, float radius, float strength);
   void OnUpdate(float dt) override; // Called each frame
 
+  /// <summary>
+  /// Raycast against the terrain height field.
+  /// The ray spans rayOrigin to rayOrigin + rayDir (world space), matching
+  /// Intersections::CastMesh. Cells are walked with a grid DDA and the
+  /// min/max height pyramid skips cells the ray passes over, so the cost is
+  /// O(cells crossed) rather than O(triangles).
+  /// </summary>
+  CastResult Raycast(const glm::vec3 &rayOrigin, const glm::vec3 &rayDir);
+
+  /// <summary>
+  /// Enable/disable empty-space skipping with the min/max pyramid.
+  /// When disabled, Raycast walks every level 0 cell along the ray.
+  /// </summary>
+  void SetUseHeightPyramid(bool use) { m_UseHeightPyramid = use; }
+  bool GetUseHeightPyramid() const { return m_UseHeightPyramid; }
+
+  /// <summary>
+  /// Switch between per-pixel layer blending (PLTerrain) and the virtual
+  /// texture path (PLTerrainVT), where the layers are pre-composited into
+  /// streamed tiles and the shader does a single albedo/normal fetch.
+  /// Requires Initialize() to have been called.
+  /// </summary>
+  void SetVirtualTextureEnabled(bool enabled);
+  bool IsVirtualTextureEnabled() const { return m_VirtualTexture != nullptr; }
+  TerrainVirtualTexture *GetVirtualTexture() const {
+    return m_VirtualTexture.get();
+  }
+
+  /// <summary>
+  /// Request the tiles visible from the camera and upload finished ones.
+  /// Called by the renderer once per frame on the render thread.
+  /// </summary>
+  /// <param name="viewProj">World space view-projection (Vulkan clip)</param>
+  /// <param name="cameraPos">World space camera position</param>
+  void UpdateVirtualTexture(const glm::mat4 &viewProj,
+                            const glm::vec3 &cameraPos);
+
 private:
   struct PendingTextureUpdate {
     int layer;
@@ -113,15 +159,51 @@ private:
   std::vector<PendingTextureUpdate> m_PendingUpdates;
   std::mutex m_UpdatesMutex;
 
-  // Local CPU copy of layer blend maps (R channel only technically needed, but
-  // likely stored as RGBA) Each vector corresponds to a layer (0-3)
-  std::vector<std::vector<unsigned char>> m_LayerBlendData;
-  std::vector<bool> m_LayerDirty; // Tracks if a layer needs GPU upload
-  bool m_AnyLayerDirty = false;   // Optimization: Quick check for updates
+  // Local CPU copy of the packed blend map (RGBA, one channel per layer).
+  // Channels always sum to ~255 for every texel.
+  std::vector<unsigned char> m_BlendData;
+  std::shared_ptr<Vivid::Texture2D> m_BlendMap;
   const int m_BlendMapSize = 512; // Resolution of blend maps
 
+  // Texel rect touched since the last GPU upload (inclusive bounds)
+  struct DirtyRect {
+    int minX = 0, minY = 0, maxX = -1, maxY = -1;
+    bool IsEmpty() const { return maxX < minX || maxY < minY; }
+    void Add(int x0, int y0, int x1, int y1);
+    void Clear() { *this = DirtyRect(); }
+  };
+  DirtyRect m_BlendDirty;
+
   void InitializeBlendMaps();
   void UpdateGPUTextures();
+
+  // Min/max height pyramid over grid cells. Level 0 holds one entry per cell
+  // (m_Divisions x m_Divisions); each level above halves the resolution.
+  struct HeightLevel {
+    int size = 0;
+    std::vector<glm::vec2> minMax; // x = min height, y = max height
+  };
+  std::vector<HeightLevel> m_HeightPyramid;
+  uint64_t m_HeightPyramidVersion = 0; // Mesh geometry version at build time
+  bool m_UseHeightPyramid = true;
+
+  void BuildHeightPyramid();
+  /// Refresh pyramid entries touching vertices [minX..maxX] x [minZ..maxZ]
+  void UpdateHeightPyramid(int minX, int minZ, int maxX, int maxZ);
+
+  // Virtual texture mode (null when disabled). Layer images are decoded once
+  // and shared by every source snapshot; blend map changes since the last
+  // snapshot are tracked separately from the GPU upload rect.
+  std::unique_ptr<TerrainVirtualTexture> m_VirtualTexture;
+  std::vector<std::shared_ptr<const TerrainSourceImage>> m_VTColorImages;
+  std::vector<std::shared_ptr<const TerrainSourceImage>> m_VTNormalImages;
+  DirtyRect m_VTBlendDirty;
+  bool m_VTLayersDirty = false;
+  bool m_VTSculpted = false;
+
+  void LoadVirtualTextureLayers();
+  std::shared_ptr<const TerrainCompositeSource> SnapshotCompositeSource() const;
+  void RefreshVirtualTextureExtent();
 };
 
 } // namespace Quantum
@@ -0,0 +1,629 @@
+#include "TerrainVirtualTexture.h"
+#include "Texture2D.h"
+#include "stb_image.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <deque>
+#include <iostream>
+#include <vulkan/vulkan.h>
+
+namespace Quantum {
+
+// ========== TerrainSourceImage ==========
+
+TerrainSourceImage TerrainSourceImage::Solid(unsigned char r, unsigned char g,
+                                             unsigned char b,
+                                             unsigned char a) {
+  unsigned char pixel[4] = {r, g, b, a};
+  return FromPixels(pixel, 1, 1);
+}
+
+TerrainSourceImage TerrainSourceImage::Load(const std::string &path) {
+  int width = 0, height = 0, channels = 0;
+  stbi_uc *pixels =
+      stbi_load(path.c_str(), &width, &height, &channels, STBI_rgb_alpha);
+  if (!pixels) {
+    std::cerr << "[TerrainVirtualTexture] Failed to load source image: "
+              << path << std::endl;
+    return TerrainSourceImage();
+  }
+
+  TerrainSourceImage image = FromPixels(pixels, width, height);
+  stbi_image_free(pixels);
+  return image;
+}
+
+TerrainSourceImage TerrainSourceImage::FromPixels(const unsigned char *pixels,
+                                                  int width, int height) {
+  TerrainSourceImage image;
+  if (!pixels || width <= 0 || height <= 0) {
+    return image;
+  }
+
+  Level base;
+  base.width = width;
+  base.height = height;
+  base.pixels.assign(pixels, pixels + static_cast<size_t>(width) * height * 4);
+  image.levels.push_back(std::move(base));
+  image.GenerateMips();
+  return image;
+}
+
+void TerrainSourceImage::GenerateMips() {
+  while (levels.back().width > 1 || levels.back().height > 1) {
+    const Level &src = levels.back();
+    Level dst;
+    dst.width = std::max(1, src.width / 2);
+    dst.height = std::max(1, src.height / 2);
+    dst.pixels.resize(static_cast<size_t>(dst.width) * dst.height * 4);
+
+    // 2x2 box filter (clamped for odd/1-pixel edges)
+    for (int y = 0; y < dst.height; ++y) {
+      int y0 = std::min(y * 2, src.height - 1);
+      int y1 = std::min(y * 2 + 1, src.height - 1);
+      for (int x = 0; x < dst.width; ++x) {
+        int x0 = std::min(x * 2, src.width - 1);
+        int x1 = std::min(x * 2 + 1, src.width - 1);
+        for (int c = 0; c < 4; ++c) {
+          int sum = src.pixels[(y0 * src.width + x0) * 4 + c] +
+                    src.pixels[(y0 * src.width + x1) * 4 + c] +
+                    src.pixels[(y1 * src.width + x0) * 4 + c] +
+                    src.pixels[(y1 * src.width + x1) * 4 + c];
+          dst.pixels[(y * dst.width + x) * 4 + c] =
+              static_cast<unsigned char>((sum + 2) / 4);
+        }
+      }
+    }
+    levels.push_back(std::move(dst));
+  }
+}
+
+glm::vec4 TerrainSourceImage::Sample(float u, float v,
+                                     float footprintUV) const {
+  if (levels.empty()) {
+    return glm::vec4(1.0f);
+  }
+
+  // Pick the level whose texel size matches the output footprint
+  float texels = footprintUV * static_cast<float>(levels[0].width);
+  int level = texels > 1.0f ? static_cast<int>(std::log2(texels)) : 0;
+  level = std::min(level, static_cast<int>(levels.size()) - 1);
+  const Level &lvl = levels[level];
+
+  // Wrap to [0,1) then bilinear filter with repeat addressing
+  u -= std::floor(u);
+  v -= std::floor(v);
+  float fx = u * lvl.width - 0.5f;
+  float fy = v * lvl.height - 0.5f;
+  float flx = std::floor(fx);
+  float fly = std::floor(fy);
+  float tx = fx - flx;
+  float ty = fy - fly;
+
+  auto wrap = [](int i, int n) { return ((i % n) + n) % n; };
+  int x0 = wrap(static_cast<int>(flx), lvl.width);
+  int x1 = wrap(static_cast<int>(flx) + 1, lvl.width);
+  int y0 = wrap(static_cast<int>(fly), lvl.height);
+  int y1 = wrap(static_cast<int>(fly) + 1, lvl.height);
+
+  auto texel = [&](int x, int y) {
+    const unsigned char *p = &lvl.pixels[(y * lvl.width + x) * 4];
+    return glm::vec4(p[0], p[1], p[2], p[3]);
+  };
+
+  glm::vec4 top = glm::mix(texel(x0, y0), texel(x1, y0), tx);
+  glm::vec4 bottom = glm::mix(texel(x0, y1), texel(x1, y1), tx);
+  return glm::mix(top, bottom, ty) / 255.0f;
+}
+
+// ========== TerrainTileCompositor ==========
+
+// Bilinear sample of one blend page with clamp addressing. Without any pages
+// layer 0 takes the full weight.
+static glm::vec4 SampleBlendPage(const TerrainCompositeSource &source,
+                                 size_t page, float u, float v) {
+  int size = source.blendMapSize;
+  if (size <= 0 || page >= source.blendPages.size() ||
+      source.blendPages[page].empty()) {
+    return page == 0 && source.blendPages.empty()
+               ? glm::vec4(1.0f, 0.0f, 0.0f, 0.0f)
+               : glm::vec4(0.0f);
+  }
+  const std::vector<unsigned char> &pixels = source.blendPages[page];
+
+  float fx = std::clamp(u, 0.0f, 1.0f) * size - 0.5f;
+  float fy = std::clamp(v, 0.0f, 1.0f) * size - 0.5f;
+  int x0 = std::clamp(static_cast<int>(std::floor(fx)), 0, size - 1);
+  int y0 = std::clamp(static_cast<int>(std::floor(fy)), 0, size - 1);
+  int x1 = std::min(x0 + 1, size - 1);
+  int y1 = std::min(y0 + 1, size - 1);
+  float tx = std::clamp(fx - std::floor(fx), 0.0f, 1.0f);
+  float ty = std::clamp(fy - std::floor(fy), 0.0f, 1.0f);
+
+  auto texel = [&](int x, int y) {
+    const unsigned char *p = &pixels[(y * size + x) * 4];
+    return glm::vec4(p[0], p[1], p[2], p[3]);
+  };
+
+  glm::vec4 top = glm::mix(texel(x0, y0), texel(x1, y0), tx);
+  glm::vec4 bottom = glm::mix(texel(x0, y1), texel(x1, y1), tx);
+  return glm::mix(top, bottom, ty) / 255.0f;
+}
+
+TerrainTileCompositor::Result
+TerrainTileCompositor::Composite(const TerrainCompositeSource &source,
+                                 const TerrainTileKey &key, int pagesPerSide) {
+  Result result;
+  result.key = key;
+  result.albedo.resize(TileStride * TileStride * 4);
+  result.normal.resize(TileStride * TileStride * 4);
+
+  // Size of one tile texel in terrain UV at this mip
+  const float texelUV = static_cast<float>(1 << key.mip) /
+                        static_cast<float>(pagesPerSide * TileSize);
+  const float footprint = texelUV * source.tilingFactor;
+  const int layerCount = static_cast<int>(
+      std::min(source.color.size(), source.normal.size()));
+
+  for (int j = 0; j < TileStride; ++j) {
+    float v = (key.y * TileSize + (j - TileBorder) + 0.5f) * texelUV;
+    for (int i = 0; i < TileStride; ++i) {
+      float u = (key.x * TileSize + (i - TileBorder) + 0.5f) * texelUV;
+
+      float tu = u * source.tilingFactor;
+      float tv = v * source.tilingFactor;
+
+      // Same weighting as PLTerrain.frag, over every layer: each blend page
+      // is sampled when its first layer is reached
+      glm::vec3 color(0.0f);
+      glm::vec3 normal(0.0f);
+      float totalWeight = 0.0f;
+      glm::vec4 weights(0.0f);
+      for (int l = 0; l < layerCount; ++l) {
+        if (l % 4 == 0)
+          weights = SampleBlendPage(source, l / 4, u, v);
+        float w = weights[l % 4];
+        if (w <= 0.0f)
+          continue;
+        color += glm::vec3(source.color[l]->Sample(tu, tv, footprint)) * w;
+        normal +=
+            (glm::vec3(source.normal[l]->Sample(tu, tv, footprint)) * 2.0f -
+             1.0f) *
+            w;
+        totalWeight += w;
+      }
+
+      if (totalWeight > 0.001f) {
+        color /= totalWeight;
+        normal /= totalWeight;
+      } else if (layerCount > 0) {
+        color = glm::vec3(source.color[0]->Sample(tu, tv, footprint));
+        normal =
+            glm::vec3(source.normal[0]->Sample(tu, tv, footprint)) * 2.0f -
+            1.0f;
+      } else {
+        color = glm::vec3(1.0f);
+        normal = glm::vec3(0.0f, 0.0f, 1.0f);
+      }
+
+      float len = glm::length(normal);
+      normal = len > 1e-6f ? normal / len : glm::vec3(0.0f, 0.0f, 1.0f);
+      normal = normal * 0.5f + 0.5f;
+
+      size_t idx = (static_cast<size_t>(j) * TileStride + i) * 4;
+      for (int c = 0; c < 3; ++c) {
+        result.albedo[idx + c] = static_cast<unsigned char>(
+            std::clamp(color[c], 0.0f, 1.0f) * 255.0f + 0.5f);
+        result.normal[idx + c] = static_cast<unsigned char>(
+            std::clamp(normal[c], 0.0f, 1.0f) * 255.0f + 0.5f);
+      }
+      result.albedo[idx + 3] = 255;
+      result.normal[idx + 3] = 255;
+    }
+  }
+
+  return result;
+}
+
+// ========== TerrainTilePool ==========
+
+TerrainTilePool::TerrainTilePool(int capacity) { Reset(capacity); }
+
+void TerrainTilePool::Reset(int capacity) {
+  m_Slots.assign(std::max(0, capacity), Slot());
+  m_LRU.clear();
+  m_Resident.clear();
+  m_FreeSlots.clear();
+  for (int i = capacity - 1; i >= 0; --i) {
+    m_FreeSlots.push_back(i);
+  }
+}
+
+int TerrainTilePool::Find(const TerrainTileKey &key) const {
+  auto it = m_Resident.find(key);
+  return it != m_Resident.end() ? it->second : -1;
+}
+
+void TerrainTilePool::Touch(int slot) {
+  if (slot < 0 || slot >= GetCapacity() || !m_Slots[slot].used ||
+      m_Slots[slot].pinned) {
+    return;
+  }
+  m_LRU.splice(m_LRU.end(), m_LRU, m_Slots[slot].lruIt);
+}
+
+int TerrainTilePool::Allocate(const TerrainTileKey &key, bool pinned,
+                              bool &outEvicted,
+                              TerrainTileKey &outEvictedKey) {
+  outEvicted = false;
+
+  int existing = Find(key);
+  if (existing >= 0) {
+    Touch(existing);
+    return existing;
+  }
+
+  int slot = -1;
+  if (!m_FreeSlots.empty()) {
+    slot = m_FreeSlots.back();
+    m_FreeSlots.pop_back();
+  } else if (!m_LRU.empty()) {
+    // Evict the least recently used tile (pinned tiles are never in the list)
+    slot = m_LRU.front();
+    m_LRU.pop_front();
+    outEvicted = true;
+    outEvictedKey = m_Slots[slot].key;
+    m_Resident.erase(outEvictedKey);
+  } else {
+    return -1;
+  }
+
+  Slot &s = m_Slots[slot];
+  s.key = key;
+  s.used = true;
+  s.pinned = pinned;
+  if (!pinned) {
+    s.lruIt = m_LRU.insert(m_LRU.end(), slot);
+  }
+  m_Resident[key] = slot;
+  return slot;
+}
+
+void TerrainTilePool::Release(const TerrainTileKey &key) {
+  int slot = Find(key);
+  if (slot < 0) {
+    return;
+  }
+  Slot &s = m_Slots[slot];
+  if (!s.pinned) {
+    m_LRU.erase(s.lruIt);
+  }
+  s = Slot();
+  m_Resident.erase(key);
+  m_FreeSlots.push_back(slot);
+}
+
+// ========== TerrainVirtualTexture ==========
+
+TerrainVirtualTexture::TerrainVirtualTexture(Vivid::VividDevice *device,
+                                             const Settings &settings)
+    : m_Device(device), m_Settings(settings) {
+  // Mip count: finest level down to a single tile covering the terrain
+  m_MipCount = 1;
+  while ((1 << (m_MipCount - 1)) < m_Settings.pagesPerSide) {
+    ++m_MipCount;
+  }
+
+  int capacity = m_Settings.atlasTilesPerSide * m_Settings.atlasTilesPerSide;
+  m_Pool.Reset(capacity);
+  m_SlotGeneration.assign(capacity, 0);
+
+  int atlasSize =
+      m_Settings.atlasTilesPerSide * TerrainTileCompositor::TileStride;
+  std::vector<unsigned char> blankAtlas(
+      static_cast<size_t>(atlasSize) * atlasSize * 4, 0);
+
+  // Albedo uses SRGB like the layer color maps; normals must stay UNORM
+  m_AlbedoAtlas = std::make_shared<Vivid::Texture2D>(
+      m_Device, blankAtlas.data(), atlasSize, atlasSize, 4);
+  m_NormalAtlas = std::make_shared<Vivid::Texture2D>(
+      m_Device, blankAtlas.data(), atlasSize, atlasSize, 4,
+      VK_FORMAT_R8G8B8A8_UNORM);
+
+  // Page table starts empty (alpha = 0 means not resident)
+  m_PageData.assign(static_cast<size_t>(m_Settings.pagesPerSide) *
+                        m_Settings.pagesPerSide * 4,
+                    0);
+  m_PageTable = std::make_shared<Vivid::Texture2D>(
+      m_Device, m_PageData.data(), m_Settings.pagesPerSide,
+      m_Settings.pagesPerSide, 4, VK_FORMAT_R8G8B8A8_UNORM);
+
+  std::cout << "[TerrainVirtualTexture] Created: " << m_Settings.pagesPerSide
+            << "x" << m_Settings.pagesPerSide << " pages, " << m_MipCount
+            << " mips, " << capacity << " atlas slots" << std::endl;
+}
+
+TerrainVirtualTexture::~TerrainVirtualTexture() {
+  // Futures from std::async block until their job finishes
+  m_Jobs.clear();
+}
+
+void TerrainVirtualTexture::SetTerrainExtent(float width, float depth,
+                                             float minY, float maxY) {
+  m_Width = width;
+  m_Depth = depth;
+  m_MinY = minY;
+  m_MaxY = maxY;
+}
+
+void TerrainVirtualTexture::SetSource(
+    std::shared_ptr<const TerrainCompositeSource> source) {
+  m_Source = std::move(source);
+
+  // Everything resident or in flight was built from the old source
+  ++m_SourceGeneration;
+  m_ReadyTiles.clear();
+}
+
+void TerrainVirtualTexture::UpdateRegion(
+    std::shared_ptr<const TerrainCompositeSource> source,
+    const glm::vec2 &uvMin, const glm::vec2 &uvMax) {
+  m_Source = std::move(source);
+
+  auto overlaps = [&](const TerrainTileKey &key) {
+    float tileUV = static_cast<float>(1 << key.mip) /
+                   static_cast<float>(m_Settings.pagesPerSide);
+    // A tile's border texels sample its neighbours, so it is stale when the
+    // region touches the tile grown by the border
+    float border = tileUV * TerrainTileCompositor::TileBorder /
+                   static_cast<float>(TerrainTileCompositor::TileSize);
+    float u0 = key.x * tileUV - border, v0 = key.y * tileUV - border;
+    float u1 = u0 + tileUV + border * 2.0f, v1 = v0 + tileUV + border * 2.0f;
+    return u0 <= uvMax.x && u1 >= uvMin.x && v0 <= uvMax.y && v1 >= uvMin.y;
+  };
+
+  for (int slot = 0; slot < m_Pool.GetCapacity(); ++slot) {
+    if (m_SlotGeneration[slot] != 0 && overlaps(m_Pool.GetKey(slot))) {
+      m_SlotGeneration[slot] = 0;
+    }
+  }
+  for (auto &job : m_Jobs) {
+    if (overlaps(job.key)) {
+      job.generation = 0; // Result will be discarded
+    }
+  }
+  m_ReadyTiles.erase(std::remove_if(m_ReadyTiles.begin(), m_ReadyTiles.end(),
+                                    [&](const auto &tile) {
+                                      return overlaps(tile.key);
+                                    }),
+                     m_ReadyTiles.end());
+}
+
+void TerrainVirtualTexture::GetTileBounds(const TerrainTileKey &key,
+                                          glm::vec3 &outMin,
+                                          glm::vec3 &outMax) const {
+  float tileUV = static_cast<float>(1 << key.mip) /
+                 static_cast<float>(m_Settings.pagesPerSide);
+  outMin = glm::vec3(-m_Width / 2.0f + key.x * tileUV * m_Width, m_MinY,
+                     -m_Depth / 2.0f + key.y * tileUV * m_Depth);
+  outMax = glm::vec3(outMin.x + tileUV * m_Width, m_MaxY,
+                     outMin.z + tileUV * m_Depth);
+}
+
+bool TerrainVirtualTexture::IsTileVisible(
+    const TerrainTileKey &key, const glm::mat4 &localViewProj) const {
+  glm::vec3 bmin, bmax;
+  GetTileBounds(key, bmin, bmax);
+
+  // Outside if all eight corners fail the same clip plane
+  int outside[6] = {0, 0, 0, 0, 0, 0};
+  for (int i = 0; i < 8; ++i) {
+    glm::vec4 corner((i & 1) ? bmax.x : bmin.x, (i & 2) ? bmax.y : bmin.y,
+                     (i & 4) ? bmax.z : bmin.z, 1.0f);
+    glm::vec4 clip = localViewProj * corner;
+    outside[0] += clip.x < -clip.w;
+    outside[1] += clip.x > clip.w;
+    outside[2] += clip.y < -clip.w;
+    outside[3] += clip.y > clip.w;
+    outside[4] += clip.z < 0.0f;
+    outside[5] += clip.z > clip.w;
+  }
+  for (int p = 0; p < 6; ++p) {
+    if (outside[p] == 8)
+      return false;
+  }
+  return true;
+}
+
+void TerrainVirtualTexture::CollectTiles(
+    const glm::vec3 &cameraLocalPos, const glm::mat4 &localViewProj,
+    std::vector<TerrainTileKey> &outTiles) const {
+  // Breadth-first from the coarsest tile so coarse fallbacks come first
+  std::deque<TerrainTileKey> queue;
+  queue.push_back({0, 0, m_MipCount - 1});
+
+  size_t budget = static_cast<size_t>(m_Pool.GetCapacity());
+  while (!queue.empty() && outTiles.size() < budget) {
+    TerrainTileKey key = queue.front();
+    queue.pop_front();
+
+    bool isRoot = key.mip == m_MipCount - 1;
+    if (!isRoot && !IsTileVisible(key, localViewProj))
+      continue;
+    outTiles.push_back(key);
+
+    if (key.mip == 0)
+      continue;
+
+    // Needed mip from the distance to the nearest point of the tile
+    glm::vec3 bmin, bmax;
+    GetTileBounds(key, bmin, bmax);
+    glm::vec3 nearest = glm::clamp(cameraLocalPos, bmin, bmax);
+    float dist = glm::length(cameraLocalPos - nearest);
+    int desiredMip = 0;
+    if (dist > m_Settings.mip0Distance) {
+      desiredMip = static_cast<int>(
+          std::ceil(std::log2(dist / m_Settings.mip0Distance)));
+    }
+
+    if (key.mip > desiredMip) {
+      for (int c = 0; c < 4; ++c) {
+        queue.push_back(
+            {key.x * 2 + (c & 1), key.y * 2 + (c >> 1), key.mip - 1});
+      }
+    }
+  }
+}
+
+bool TerrainVirtualTexture::IsJobPending(const TerrainTileKey &key) const {
+  for (const auto &job : m_Jobs) {
+    if (job.key == key && job.generation != 0)
+      return true;
+  }
+  for (const auto &tile : m_ReadyTiles) {
+    if (tile.key == key)
+      return true;
+  }
+  return false;
+}
+
+void TerrainVirtualTexture::RequestTile(const TerrainTileKey &key) {
+  if (!m_Source ||
+      static_cast<int>(m_Jobs.size()) >= m_Settings.maxJobsInFlight ||
+      IsJobPending(key)) {
+    return;
+  }
+
+  Job job;
+  job.key = key;
+  job.generation = m_SourceGeneration;
+  job.future = std::async(
+      std::launch::async,
+      [source = m_Source, key, pages = m_Settings.pagesPerSide]() {
+        return TerrainTileCompositor::Composite(*source, key, pages);
+      });
+  m_Jobs.push_back(std::move(job));
+}
+
+void TerrainVirtualTexture::Update(const glm::vec3 &cameraLocalPos,
+                                   const glm::mat4 &localViewProj) {
+  if (!m_Source)
+    return;
+
+  std::vector<TerrainTileKey> tiles;
+  CollectTiles(cameraLocalPos, localViewProj, tiles);
+
+  for (const auto &key : tiles) {
+    int slot = m_Pool.Find(key);
+    if (slot >= 0) {
+      m_Pool.Touch(slot);
+      if (m_SlotGeneration[slot] == m_SourceGeneration)
+        continue; // Resident and current
+    }
+    RequestTile(key);
+  }
+}
+
+void TerrainVirtualTexture::UploadTile(
+    const TerrainTileCompositor::Result &result) {
+  bool isRoot = result.key.mip == m_MipCount - 1;
+  bool evicted = false;
+  TerrainTileKey evictedKey;
+  int slot = m_Pool.Allocate(result.key, isRoot, evicted, evictedKey);
+  if (slot < 0)
+    return;
+
+  int stride = TerrainTileCompositor::TileStride;
+  int slotX = slot % m_Settings.atlasTilesPerSide;
+  int slotY = slot / m_Settings.atlasTilesPerSide;
+  m_AlbedoAtlas->WriteRegion(result.albedo.data(), slotX * stride,
+                             slotY * stride, stride, stride);
+  m_NormalAtlas->WriteRegion(result.normal.data(), slotX * stride,
+                             slotY * stride, stride, stride);
+  m_SlotGeneration[slot] = m_SourceGeneration;
+
+  if (evicted) {
+    RefreshPageTable(evictedKey);
+  }
+  RefreshPageTable(result.key);
+}
+
+void TerrainVirtualTexture::RefreshPageTable(const TerrainTileKey &key) {
+  int pages = m_Settings.pagesPerSide;
+  int span = 1 << key.mip;
+  int x0 = key.x * span, y0 = key.y * span;
+  int x1 = std::min(x0 + span, pages) - 1;
+  int y1 = std::min(y0 + span, pages) - 1;
+
+  for (int py = y0; py <= y1; ++py) {
+    for (int px = x0; px <= x1; ++px) {
+      unsigned char *entry = &m_PageData[(py * pages + px) * 4];
+      entry[0] = entry[1] = entry[2] = entry[3] = 0;
+
+      // Finest resident tile covering this page
+      for (int mip = 0; mip < m_MipCount; ++mip) {
+        int slot = m_Pool.Find({px >> mip, py >> mip, mip});
+        if (slot >= 0) {
+          entry[0] = static_cast<unsigned char>(
+              slot % m_Settings.atlasTilesPerSide);
+          entry[1] = static_cast<unsigned char>(
+              slot / m_Settings.atlasTilesPerSide);
+          entry[2] = static_cast<unsigned char>(mip);
+          entry[3] = 255;
+          break;
+        }
+      }
+    }
+  }
+
+  if (m_PageDirtyMaxX < m_PageDirtyMinX) {
+    m_PageDirtyMinX = x0;
+    m_PageDirtyMinY = y0;
+    m_PageDirtyMaxX = x1;
+    m_PageDirtyMaxY = y1;
+  } else {
+    m_PageDirtyMinX = std::min(m_PageDirtyMinX, x0);
+    m_PageDirtyMinY = std::min(m_PageDirtyMinY, y0);
+    m_PageDirtyMaxX = std::max(m_PageDirtyMaxX, x1);
+    m_PageDirtyMaxY = std::max(m_PageDirtyMaxY, y1);
+  }
+}
+
+void TerrainVirtualTexture::ProcessCompletedTiles() {
+  // Collect finished jobs without blocking
+  for (auto it = m_Jobs.begin(); it != m_Jobs.end();) {
+    if (it->future.wait_for(std::chrono::seconds(0)) !=
+        std::future_status::ready) {
+      ++it;
+      continue;
+    }
+    TerrainTileCompositor::Result result = it->future.get();
+    if (it->generation == m_SourceGeneration) {
+      m_ReadyTiles.push_back(std::move(result));
+    }
+    it = m_Jobs.erase(it);
+  }
+
+  // Coarse tiles first: they back the most pages
+  std::sort(m_ReadyTiles.begin(), m_ReadyTiles.end(),
+            [](const auto &a, const auto &b) { return a.key.mip > b.key.mip; });
+
+  int uploads = 0;
+  while (!m_ReadyTiles.empty() && uploads < m_Settings.maxUploadsPerFrame) {
+    UploadTile(m_ReadyTiles.front());
+    m_ReadyTiles.erase(m_ReadyTiles.begin());
+    ++uploads;
+  }
+
+  if (m_PageDirtyMaxX >= m_PageDirtyMinX) {
+    m_PageTable->SetPixelsRegion(m_PageData.data(), m_PageDirtyMinX,
+                                 m_PageDirtyMinY,
+                                 m_PageDirtyMaxX - m_PageDirtyMinX + 1,
+                                 m_PageDirtyMaxY - m_PageDirtyMinY + 1);
+    m_PageDirtyMinX = m_PageDirtyMinY = 0;
+    m_PageDirtyMaxX = m_PageDirtyMaxY = -1;
+  }
+}
+
+} // namespace Quantum
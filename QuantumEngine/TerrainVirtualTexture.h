@@ -0,0 +1,249 @@
+#pragma once
+#include "glm/glm.hpp"
+#include <cstdint>
+#include <future>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Vivid {
+class VividDevice;
+class Texture2D;
+} // namespace Vivid
+
+namespace Quantum {
+
+/// <summary>
+/// Identifies one virtual texture tile by its tile coordinates within a mip.
+/// Mip 0 is the finest level (pagesPerSide x pagesPerSide tiles); each mip
+/// above halves the tile count per side.
+/// </summary>
+struct TerrainTileKey {
+  int x = 0;
+  int y = 0;
+  int mip = 0;
+
+  bool operator==(const TerrainTileKey &other) const {
+    return x == other.x && y == other.y && mip == other.mip;
+  }
+};
+
+struct TerrainTileKeyHash {
+  size_t operator()(const TerrainTileKey &key) const {
+    return (static_cast<size_t>(key.mip) << 40) ^
+           (static_cast<size_t>(key.y) << 20) ^ static_cast<size_t>(key.x);
+  }
+};
+
+/// <summary>
+/// CPU-side RGBA8 image used as a compositing source, with a box-filtered
+/// mip chain so coarse tiles don't alias.
+/// </summary>
+struct TerrainSourceImage {
+  struct Level {
+    int width = 0;
+    int height = 0;
+    std::vector<unsigned char> pixels;
+  };
+  std::vector<Level> levels;
+
+  bool IsValid() const { return !levels.empty(); }
+
+  /// 1x1 image of a single color
+  static TerrainSourceImage Solid(unsigned char r, unsigned char g,
+                                  unsigned char b, unsigned char a);
+
+  /// Load from disk; returns an invalid image if loading fails
+  static TerrainSourceImage Load(const std::string &path);
+
+  /// Build from raw RGBA8 pixels
+  static TerrainSourceImage FromPixels(const unsigned char *pixels, int width,
+                                       int height);
+
+  /// Bilinear, wrapping sample returning 0-1 channels. 'footprintUV' is the
+  /// size of one output texel in this image's UV space and picks the mip.
+  glm::vec4 Sample(float u, float v, float footprintUV) const;
+
+private:
+  void GenerateMips();
+};
+
+/// <summary>
+/// Immutable inputs of a tile job: per-layer source images plus a snapshot of
+/// the packed blend pages. Each page is RGBA8 and holds four layer weights:
+/// layer N's weight is in channel N % 4 of page N / 4. Layer images are shared
+/// between snapshots so re-snapshotting after a paint only copies the pages.
+/// </summary>
+struct TerrainCompositeSource {
+  std::vector<std::shared_ptr<const TerrainSourceImage>> color;
+  std::vector<std::shared_ptr<const TerrainSourceImage>> normal;
+  std::vector<std::vector<unsigned char>> blendPages;
+  int blendMapSize = 0; // Width and height of every page
+  float tilingFactor = 16.0f; // Matches PLTerrain.vert
+};
+
+/// <summary>
+/// Blends the terrain layers into one albedo tile and one normal tile.
+/// Pure CPU work with no GPU state, so it runs on worker threads and can be
+/// exercised without a device.
+/// </summary>
+class TerrainTileCompositor {
+public:
+  static constexpr int TileSize = 128;  // Texels per tile edge
+  static constexpr int TileBorder = 4;  // Filter border on each side
+  static constexpr int TileStride = TileSize + TileBorder * 2;
+
+  struct Result {
+    TerrainTileKey key;
+    std::vector<unsigned char> albedo; // TileStride^2 RGBA8
+    std::vector<unsigned char> normal; // TileStride^2 RGBA8 (tangent space)
+  };
+
+  static Result Composite(const TerrainCompositeSource &source,
+                          const TerrainTileKey &key, int pagesPerSide);
+};
+
+/// <summary>
+/// Fixed number of atlas slots with least-recently-used eviction.
+/// </summary>
+class TerrainTilePool {
+public:
+  explicit TerrainTilePool(int capacity = 0);
+
+  void Reset(int capacity);
+
+  /// Slot holding 'key', or -1 if the tile is not resident
+  int Find(const TerrainTileKey &key) const;
+
+  /// Mark a slot as used this frame (moves it to the back of the LRU list)
+  void Touch(int slot);
+
+  /// Reserve a slot for 'key', evicting the least recently used unpinned tile
+  /// when the pool is full. Returns -1 if every slot is pinned.
+  int Allocate(const TerrainTileKey &key, bool pinned, bool &outEvicted,
+               TerrainTileKey &outEvictedKey);
+
+  void Release(const TerrainTileKey &key);
+
+  const TerrainTileKey &GetKey(int slot) const { return m_Slots[slot].key; }
+  int GetCapacity() const { return static_cast<int>(m_Slots.size()); }
+  int GetResidentCount() const { return static_cast<int>(m_Resident.size()); }
+
+private:
+  struct Slot {
+    TerrainTileKey key;
+    bool used = false;
+    bool pinned = false;
+    std::list<int>::iterator lruIt;
+  };
+
+  std::vector<Slot> m_Slots;
+  std::list<int> m_LRU; // Front = least recently used
+  std::vector<int> m_FreeSlots;
+  std::unordered_map<TerrainTileKey, int, TerrainTileKeyHash> m_Resident;
+};
+
+/// <summary>
+/// Virtual texture for a TerrainNode. Composited albedo/normal tiles are
+/// generated on demand for the visible part of the terrain at the mip it
+/// needs, stored in an atlas managed by an LRU pool, and located by the shader
+/// through a page table (one RGBA8 texel per finest page: atlas slot x/y,
+/// mip, resident flag).
+/// </summary>
+class TerrainVirtualTexture {
+public:
+  struct Settings {
+    int pagesPerSide = 64;      // Finest tiles per terrain edge
+    int atlasTilesPerSide = 16; // Atlas capacity = this squared
+    int maxJobsInFlight = 4;    // Concurrent compositing jobs
+    int maxUploadsPerFrame = 8; // Tiles uploaded per ProcessCompletedTiles
+    float mip0Distance = 20.0f; // World distance that still needs mip 0
+  };
+
+  TerrainVirtualTexture(Vivid::VividDevice *device, const Settings &settings);
+  ~TerrainVirtualTexture();
+
+  /// Terrain footprint in local space (centered on the origin, like
+  /// TerrainNode) and its vertical range, used for distance and culling.
+  void SetTerrainExtent(float width, float depth, float minY, float maxY);
+
+  /// Replace the compositing inputs. Every resident tile is recomposited.
+  void SetSource(std::shared_ptr<const TerrainCompositeSource> source);
+
+  /// Swap in a source that only differs inside a terrain UV rect (e.g. after
+  /// painting). Only tiles overlapping the rect are recomposited.
+  void UpdateRegion(std::shared_ptr<const TerrainCompositeSource> source,
+                    const glm::vec2 &uvMin, const glm::vec2 &uvMax);
+
+  /// Select the tiles the camera needs and queue compositing jobs for
+  /// missing ones. Camera position and view-projection are in terrain local
+  /// space (i.e. premultiplied by the terrain world matrix).
+  void Update(const glm::vec3 &cameraLocalPos, const glm::mat4 &localViewProj);
+
+  /// Upload finished tiles and page table changes. Render thread only.
+  void ProcessCompletedTiles();
+
+  std::shared_ptr<Vivid::Texture2D> GetAlbedoAtlas() const {
+    return m_AlbedoAtlas;
+  }
+  std::shared_ptr<Vivid::Texture2D> GetNormalAtlas() const {
+    return m_NormalAtlas;
+  }
+  std::shared_ptr<Vivid::Texture2D> GetPageTable() const {
+    return m_PageTable;
+  }
+
+  int GetMipCount() const { return m_MipCount; }
+  int GetResidentTileCount() const { return m_Pool.GetResidentCount(); }
+  int GetPendingJobCount() const { return static_cast<int>(m_Jobs.size()); }
+
+private:
+  struct Job {
+    TerrainTileKey key;
+    uint64_t generation = 0;
+    std::future<TerrainTileCompositor::Result> future;
+  };
+
+  void CollectTiles(const glm::vec3 &cameraLocalPos,
+                    const glm::mat4 &localViewProj,
+                    std::vector<TerrainTileKey> &outTiles) const;
+  void GetTileBounds(const TerrainTileKey &key, glm::vec3 &outMin,
+                     glm::vec3 &outMax) const;
+  bool IsTileVisible(const TerrainTileKey &key,
+                     const glm::mat4 &localViewProj) const;
+  bool IsJobPending(const TerrainTileKey &key) const;
+  void RequestTile(const TerrainTileKey &key);
+  void UploadTile(const TerrainTileCompositor::Result &result);
+  void RefreshPageTable(const TerrainTileKey &key);
+
+  Vivid::VividDevice *m_Device;
+  Settings m_Settings;
+  int m_MipCount = 1;
+
+  float m_Width = 1.0f;
+  float m_Depth = 1.0f;
+  float m_MinY = 0.0f;
+  float m_MaxY = 0.0f;
+
+  std::shared_ptr<const TerrainCompositeSource> m_Source;
+  uint64_t m_SourceGeneration = 1;
+
+  TerrainTilePool m_Pool;
+  std::vector<uint64_t> m_SlotGeneration; // Source generation per slot,
+                                          // 0 = stale (needs recomposite)
+  std::vector<Job> m_Jobs;
+  std::vector<TerrainTileCompositor::Result> m_ReadyTiles;
+
+  // CPU copy of the page table and the rect that needs uploading
+  std::vector<unsigned char> m_PageData;
+  int m_PageDirtyMinX = 0, m_PageDirtyMinY = 0;
+  int m_PageDirtyMaxX = -1, m_PageDirtyMaxY = -1;
+
+  std::shared_ptr<Vivid::Texture2D> m_AlbedoAtlas;
+  std::shared_ptr<Vivid::Texture2D> m_NormalAtlas;
+  std::shared_ptr<Vivid::Texture2D> m_PageTable;
+};
+
+} // namespace Quantum
@@ -259,4 +259,57 @@ void Texture2D::SetPixels(const std::vector<unsigned char> &pixels) {
                                      VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
 }
 
+void Texture2D::SetPixelsRegion(const unsigned char *pixels, int x, int y,
+                                int width, int height) {
+  // Checked before the region's start is computed inside 'pixels'
+  if (!pixels || width <= 0 || height <= 0 || x < 0 || y < 0 ||
+      x + width > m_Width || y + height > m_Height) {
+    return;
+  }
+  const size_t srcPitch = static_cast<size_t>(m_Width) * 4;
+  UploadRegion(pixels + static_cast<size_t>(y) * srcPitch + x * 4, srcPitch,
+               x, y, width, height);
+}
+
+void Texture2D::WriteRegion(const unsigned char *regionPixels, int x, int y,
+                            int width, int height) {
+  UploadRegion(regionPixels, static_cast<size_t>(width) * 4, x, y, width,
+               height);
+}
+
+void Texture2D::UploadRegion(const unsigned char *src, size_t srcPitch, int x,
+                             int y, int width, int height) {
+  if (m_TextureImage == VK_NULL_HANDLE || !src || width <= 0 || height <= 0 ||
+      x < 0 || y < 0 || x + width > m_Width || y + height > m_Height) {
+    return;
+  }
+
+  // Contiguous rows can be staged with a single copy
+  const size_t rowBytes = static_cast<size_t>(width) * 4;
+  VkDeviceSize regionSize = rowBytes * height;
+
+  // Owned by the device until the copy has run
+  auto stagingBuffer = std::make_shared<VividBuffer>(
+      m_DevicePtr, regionSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+      VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+          VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+
+  stagingBuffer->Map();
+  unsigned char *dst =
+      static_cast<unsigned char *>(stagingBuffer->GetMappedMemory());
+  if (rowBytes == srcPitch) {
+    memcpy(dst, src, static_cast<size_t>(regionSize));
+  } else {
+    for (int row = 0; row < height; ++row) {
+      memcpy(dst + row * rowBytes, src + row * srcPitch, rowBytes);
+    }
+  }
+  stagingBuffer->Unmap();
+
+  VkBuffer buffer = stagingBuffer->GetBuffer();
+  m_DevicePtr->CopyBufferToImageRegion(
+      buffer, m_TextureImage, x, y, static_cast<uint32_t>(width),
+      static_cast<uint32_t>(height), std::move(stagingBuffer));
+}
+
 } // namespace Vivid
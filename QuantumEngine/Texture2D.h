@@ -35,6 +35,15 @@ public:
   std::vector<unsigned char> GetPixels();
   void SetPixels(const std::vector<unsigned char> &pixels);
 
+  // Upload only a sub-rectangle. 'pixels' points at the full RGBA image
+  // (GetWidth() * GetHeight() * 4 bytes); only the given rect is staged.
+  void SetPixelsRegion(const unsigned char *pixels, int x, int y, int width,
+                       int height);
+
+  // Upload a tightly packed width * height RGBA block to (x, y).
+  void WriteRegion(const unsigned char *regionPixels, int x, int y, int width,
+                   int height);
+
   // Invalidate cached descriptor set (call when descriptor pool is
   // destroyed/recreated)
   void InvalidateDescriptorSet() { m_DescriptorSet = VK_NULL_HANDLE; }
@@ -45,6 +54,8 @@ private:
                                   int height, int channels);
   void CreateTextureImageView();
   void CreateTextureSampler();
+  void UploadRegion(const unsigned char *src, size_t srcPitch, int x, int y,
+                    int width, int height);
 
   VividDevice *m_DevicePtr;
 
@@ -0,0 +1,345 @@
+#include "TransformHierarchy.h"
+#include <algorithm>
+#include <execution>
+#include <numeric>
+
+#if defined(_M_X64) || defined(__SSE2__)
+#include <xmmintrin.h>
+#define QUANTUM_TRANSFORM_SSE 1
+#endif
+
+namespace Quantum {
+
+TransformHierarchy &TransformHierarchy::Get() {
+  // Never destroyed: GraphNodes held by other statics (the editor clipboard)
+  // may release their handles after function-local statics are gone
+  static TransformHierarchy *instance = new TransformHierarchy();
+  return *instance;
+}
+
+// ========== Handles ==========
+
+TransformHandle TransformHierarchy::Create() {
+  TransformHandle handle;
+  if (!m_FreeHandles.empty()) {
+    handle = m_FreeHandles.back();
+    m_FreeHandles.pop_back();
+  } else {
+    handle = static_cast<TransformHandle>(m_HandleToDense.size());
+    m_HandleToDense.push_back(0);
+  }
+
+  // New transforms are appended as roots; RebuildOrder sorts them in
+  uint32_t dense = static_cast<uint32_t>(m_DenseToHandle.size());
+  m_HandleToDense[handle] = dense;
+  m_Position.push_back(glm::vec3(0.0f));
+  m_Rotation.push_back(glm::quat(1.0f, 0.0f, 0.0f, 0.0f));
+  m_Scale.push_back(glm::vec3(1.0f));
+  m_Parent.push_back(-1);
+  m_World.push_back(glm::mat4(1.0f));
+  m_WorldVersion.push_back(0);
+  m_ParentVersion.push_back(0);
+  m_LocalDirty.push_back(1);
+  m_Alive.push_back(1);
+  m_DenseToHandle.push_back(handle);
+
+  m_OrderDirty = true;
+  m_HasChanges = true;
+  ++m_ChangeStamp;
+  return handle;
+}
+
+void TransformHierarchy::Destroy(TransformHandle handle) {
+  if (handle == InvalidTransform || handle >= m_HandleToDense.size())
+    return;
+
+  // The dense slot is compacted away by the next RebuildOrder. Its data
+  // stays readable until then for children that still point at it.
+  uint32_t dense = Dense(handle);
+  m_Alive[dense] = 0;
+  ++m_DeadCount;
+  m_FreeHandles.push_back(handle);
+  m_OrderDirty = true;
+  m_HasChanges = true;
+  ++m_ChangeStamp;
+}
+
+void TransformHierarchy::SetParent(TransformHandle handle,
+                                   TransformHandle parent) {
+  uint32_t dense = Dense(handle);
+  m_Parent[dense] =
+      parent == InvalidTransform ? -1 : static_cast<int32_t>(Dense(parent));
+  m_OrderDirty = true;
+  MarkDirty(dense);
+}
+
+// ========== Local TRS ==========
+
+glm::vec3 TransformHierarchy::GetPosition(TransformHandle handle) const {
+  return m_Position[Dense(handle)];
+}
+
+glm::quat TransformHierarchy::GetRotation(TransformHandle handle) const {
+  return m_Rotation[Dense(handle)];
+}
+
+glm::vec3 TransformHierarchy::GetScale(TransformHandle handle) const {
+  return m_Scale[Dense(handle)];
+}
+
+void TransformHierarchy::SetPosition(TransformHandle handle,
+                                     const glm::vec3 &position) {
+  uint32_t dense = Dense(handle);
+  m_Position[dense] = position;
+  MarkDirty(dense);
+}
+
+void TransformHierarchy::SetRotation(TransformHandle handle,
+                                     const glm::quat &rotation) {
+  uint32_t dense = Dense(handle);
+  m_Rotation[dense] = rotation;
+  MarkDirty(dense);
+}
+
+void TransformHierarchy::SetScale(TransformHandle handle,
+                                  const glm::vec3 &scale) {
+  uint32_t dense = Dense(handle);
+  m_Scale[dense] = scale;
+  MarkDirty(dense);
+}
+
+void TransformHierarchy::Invalidate(TransformHandle handle) {
+  MarkDirty(Dense(handle));
+}
+
+void TransformHierarchy::MarkDirty(uint32_t dense) {
+  m_LocalDirty[dense] = 1;
+  m_HasChanges = true;
+  ++m_ChangeStamp;
+}
+
+// ========== Matrix Math ==========
+
+// Model = Translation * Rotation * Scale, built directly from the quaternion
+static inline glm::mat4 ComposeTRS(const glm::vec3 &t, const glm::quat &r,
+                                   const glm::vec3 &s) {
+  glm::mat3 rot = glm::mat3_cast(r);
+  glm::mat4 m;
+  m[0] = glm::vec4(rot[0] * s.x, 0.0f);
+  m[1] = glm::vec4(rot[1] * s.y, 0.0f);
+  m[2] = glm::vec4(rot[2] * s.z, 0.0f);
+  m[3] = glm::vec4(t, 1.0f);
+  return m;
+}
+
+// out = a * b (column-major, same result as glm's operator*)
+static inline void MultiplyMat4(const glm::mat4 &a, const glm::mat4 &b,
+                                glm::mat4 &out) {
+#ifdef QUANTUM_TRANSFORM_SSE
+  const float *pa = &a[0][0];
+  const float *pb = &b[0][0];
+  float *po = &out[0][0];
+  __m128 a0 = _mm_loadu_ps(pa);
+  __m128 a1 = _mm_loadu_ps(pa + 4);
+  __m128 a2 = _mm_loadu_ps(pa + 8);
+  __m128 a3 = _mm_loadu_ps(pa + 12);
+  for (int c = 0; c < 4; ++c) {
+    __m128 r = _mm_mul_ps(a0, _mm_set1_ps(pb[c * 4 + 0]));
+    r = _mm_add_ps(r, _mm_mul_ps(a1, _mm_set1_ps(pb[c * 4 + 1])));
+    r = _mm_add_ps(r, _mm_mul_ps(a2, _mm_set1_ps(pb[c * 4 + 2])));
+    r = _mm_add_ps(r, _mm_mul_ps(a3, _mm_set1_ps(pb[c * 4 + 3])));
+    _mm_storeu_ps(po + c * 4, r);
+  }
+#else
+  out = a * b;
+#endif
+}
+
+glm::mat4 TransformHierarchy::GetLocalMatrix(TransformHandle handle) const {
+  uint32_t dense = Dense(handle);
+  return ComposeTRS(m_Position[dense], m_Rotation[dense], m_Scale[dense]);
+}
+
+// ========== World Matrices ==========
+
+bool TransformHierarchy::IsStale(uint32_t dense) const {
+  if (m_LocalDirty[dense])
+    return true;
+  int32_t parent = m_Parent[dense];
+  return parent >= 0 && m_ParentVersion[dense] != m_WorldVersion[parent];
+}
+
+void TransformHierarchy::Recompute(uint32_t dense) {
+  glm::mat4 local =
+      ComposeTRS(m_Position[dense], m_Rotation[dense], m_Scale[dense]);
+
+  int32_t parent = m_Parent[dense];
+  if (parent >= 0) {
+    MultiplyMat4(m_World[parent], local, m_World[dense]);
+    m_ParentVersion[dense] = m_WorldVersion[parent];
+  } else {
+    m_World[dense] = local;
+  }
+
+  ++m_WorldVersion[dense];
+  m_LocalDirty[dense] = 0;
+}
+
+void TransformHierarchy::EnsureUpToDate(uint32_t dense) {
+  int32_t parent = m_Parent[dense];
+  if (parent >= 0) {
+    EnsureUpToDate(static_cast<uint32_t>(parent));
+  }
+  if (IsStale(dense)) {
+    Recompute(dense);
+  }
+}
+
+glm::mat4 TransformHierarchy::GetWorldMatrix(TransformHandle handle) {
+  uint32_t dense = Dense(handle);
+
+  // Common case after the batched update: nothing has changed since
+  if (!m_HasChanges) {
+    return m_World[dense];
+  }
+
+  // Readers on several threads may share stale ancestors
+  std::lock_guard<std::mutex> lock(m_LazyMutex);
+  EnsureUpToDate(dense);
+  return m_World[dense];
+}
+
+void TransformHierarchy::UpdateRange(uint32_t begin, uint32_t end) {
+  for (uint32_t i = begin; i < end; ++i) {
+    if (IsStale(i)) {
+      Recompute(i);
+    }
+  }
+}
+
+void TransformHierarchy::UpdateWorldMatrices() {
+  if (!m_HasChanges)
+    return;
+
+  if (m_OrderDirty) {
+    RebuildOrder();
+  }
+
+  // Parents are finished before their level's children start; nodes within a
+  // level only write their own slot, so a level can be split freely.
+  for (size_t level = 0; level + 1 < m_LevelStart.size(); ++level) {
+    uint32_t begin = m_LevelStart[level];
+    uint32_t end = m_LevelStart[level + 1];
+
+    if (end - begin < m_ParallelThreshold) {
+      UpdateRange(begin, end);
+      continue;
+    }
+
+    const uint32_t chunk = 1024;
+    std::vector<uint32_t> chunkStarts;
+    for (uint32_t start = begin; start < end; start += chunk) {
+      chunkStarts.push_back(start);
+    }
+    std::for_each(std::execution::par, chunkStarts.begin(), chunkStarts.end(),
+                  [this, end, chunk](uint32_t start) {
+                    UpdateRange(start, std::min(start + chunk, end));
+                  });
+  }
+
+  m_HasChanges = false;
+}
+
+// ========== Depth Ordering ==========
+
+void TransformHierarchy::RebuildOrder() {
+  const uint32_t count = static_cast<uint32_t>(m_DenseToHandle.size());
+
+  // Depth of every live node (dead parents turn their children into roots)
+  std::vector<int32_t> depth(count, -1);
+  std::vector<uint32_t> stack;
+  for (uint32_t i = 0; i < count; ++i) {
+    if (!m_Alive[i] || depth[i] >= 0)
+      continue;
+
+    uint32_t node = i;
+    while (true) {
+      int32_t parent = m_Parent[node];
+      if (parent >= 0 && !m_Alive[parent]) {
+        m_Parent[node] = parent = -1;
+        m_LocalDirty[node] = 1;
+      }
+      if (parent < 0) {
+        depth[node] = 0;
+        break;
+      }
+      if (depth[parent] >= 0) {
+        depth[node] = depth[parent] + 1;
+        break;
+      }
+      stack.push_back(node);
+      node = static_cast<uint32_t>(parent);
+    }
+    while (!stack.empty()) {
+      uint32_t child = stack.back();
+      stack.pop_back();
+      depth[child] = depth[m_Parent[child]] + 1;
+    }
+  }
+
+  // Counting sort by depth (stable, so siblings keep their relative order)
+  int32_t maxDepth = -1;
+  for (uint32_t i = 0; i < count; ++i) {
+    maxDepth = std::max(maxDepth, depth[i]);
+  }
+  m_LevelStart.assign(static_cast<size_t>(maxDepth) + 2, 0);
+  for (uint32_t i = 0; i < count; ++i) {
+    if (depth[i] >= 0)
+      ++m_LevelStart[depth[i] + 1];
+  }
+  std::partial_sum(m_LevelStart.begin(), m_LevelStart.end(),
+                   m_LevelStart.begin());
+
+  std::vector<uint32_t> newIndex(count, 0);
+  std::vector<uint32_t> cursor(m_LevelStart.begin(), m_LevelStart.end() - 1);
+  for (uint32_t i = 0; i < count; ++i) {
+    if (depth[i] >= 0)
+      newIndex[i] = cursor[depth[i]]++;
+  }
+
+  const uint32_t liveCount = m_LevelStart.back();
+  auto permute = [&](auto &array) {
+    std::remove_reference_t<decltype(array)> sorted(liveCount);
+    for (uint32_t i = 0; i < count; ++i) {
+      if (depth[i] >= 0)
+        sorted[newIndex[i]] = array[i];
+    }
+    array.swap(sorted);
+  };
+
+  permute(m_Position);
+  permute(m_Rotation);
+  permute(m_Scale);
+  permute(m_World);
+  permute(m_WorldVersion);
+  permute(m_ParentVersion);
+  permute(m_LocalDirty);
+  permute(m_DenseToHandle);
+
+  std::vector<int32_t> parents(liveCount, -1);
+  for (uint32_t i = 0; i < count; ++i) {
+    if (depth[i] >= 0 && m_Parent[i] >= 0)
+      parents[newIndex[i]] = static_cast<int32_t>(newIndex[m_Parent[i]]);
+  }
+  m_Parent.swap(parents);
+
+  m_Alive.assign(liveCount, 1);
+  m_DeadCount = 0;
+  for (uint32_t i = 0; i < liveCount; ++i) {
+    m_HandleToDense[m_DenseToHandle[i]] = i;
+  }
+
+  m_OrderDirty = false;
+}
+
+} // namespace Quantum
@@ -0,0 +1,130 @@
+#pragma once
+#include "glm/glm.hpp"
+#include "glm/gtc/quaternion.hpp"
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace Quantum {
+
+using TransformHandle = uint32_t;
+constexpr TransformHandle InvalidTransform = 0xFFFFFFFFu;
+
+/// <summary>
+/// Singleton that owns the transforms of every GraphNode.
+/// Local TRS (quaternion rotation) and world matrices live in contiguous
+/// arrays sorted by hierarchy depth, so parents always come before their
+/// children. UpdateWorldMatrices() refreshes every stale world matrix in one
+/// linear pass; nodes within a depth level are independent and large levels
+/// are split across threads.
+///
+/// Staleness is tracked with versions instead of flags pushed down the tree:
+/// a node is stale if its local TRS changed or its parent's world version
+/// differs from the one it was last built from. Changing a transform is O(1)
+/// regardless of subtree size.
+///
+/// Usage: GraphNode creates/destroys its handle; everything else should go
+/// through the GraphNode API.
+/// </summary>
+class TransformHierarchy {
+public:
+  // Singleton access
+  static TransformHierarchy &Get();
+
+  // Delete copy/move
+  TransformHierarchy(const TransformHierarchy &) = delete;
+  TransformHierarchy &operator=(const TransformHierarchy &) = delete;
+
+  TransformHandle Create();
+  void Destroy(TransformHandle handle);
+
+  /// <summary>
+  /// Re-parent a transform (InvalidTransform makes it a root). The depth
+  /// order is rebuilt lazily on the next batched update.
+  /// </summary>
+  void SetParent(TransformHandle handle, TransformHandle parent);
+
+  // Local TRS
+  glm::vec3 GetPosition(TransformHandle handle) const;
+  glm::quat GetRotation(TransformHandle handle) const;
+  glm::vec3 GetScale(TransformHandle handle) const;
+  void SetPosition(TransformHandle handle, const glm::vec3 &position);
+  void SetRotation(TransformHandle handle, const glm::quat &rotation);
+  void SetScale(TransformHandle handle, const glm::vec3 &scale);
+
+  /// Mark a transform as changed without touching its TRS
+  void Invalidate(TransformHandle handle);
+
+  /// Local matrix (T * R * S)
+  glm::mat4 GetLocalMatrix(TransformHandle handle) const;
+
+  /// <summary>
+  /// World matrix of one transform. If anything changed since the last
+  /// batched update, only the chain from the root to this node is refreshed.
+  /// That refresh is serialized, so several threads may read world matrices
+  /// while no transform is being changed (the parallel script phase).
+  /// </summary>
+  glm::mat4 GetWorldMatrix(TransformHandle handle);
+
+  /// <summary>
+  /// Refresh every stale world matrix in depth order. Call once per frame
+  /// after gameplay/script updates and before rendering.
+  /// </summary>
+  void UpdateWorldMatrices();
+
+  /// Bumped whenever a transform is recomputed; compare to detect movement
+  uint32_t GetWorldVersion(TransformHandle handle) const {
+    return m_WorldVersion[Dense(handle)];
+  }
+
+  /// Bumped on every change (TRS, parent, create/destroy)
+  uint64_t GetChangeStamp() const { return m_ChangeStamp; }
+
+  size_t GetCount() const { return m_DenseToHandle.size() - m_DeadCount; }
+  size_t GetDepthLevelCount() const {
+    return m_LevelStart.empty() ? 0 : m_LevelStart.size() - 1;
+  }
+
+  /// Levels with at least this many nodes are updated in parallel
+  void SetParallelThreshold(size_t nodes) { m_ParallelThreshold = nodes; }
+
+private:
+  TransformHierarchy() = default;
+
+  uint32_t Dense(TransformHandle handle) const {
+    return m_HandleToDense[handle];
+  }
+  void MarkDirty(uint32_t dense);
+  bool IsStale(uint32_t dense) const;
+  void Recompute(uint32_t dense);
+  void EnsureUpToDate(uint32_t dense);
+  void UpdateRange(uint32_t begin, uint32_t end);
+  void RebuildOrder();
+
+  // Dense arrays, indexed together (sorted by depth after RebuildOrder)
+  std::vector<glm::vec3> m_Position;
+  std::vector<glm::quat> m_Rotation;
+  std::vector<glm::vec3> m_Scale;
+  std::vector<int32_t> m_Parent; // Dense index of parent, -1 = root
+  std::vector<glm::mat4> m_World;
+  std::vector<uint32_t> m_WorldVersion;  // Bumped on every recompute
+  std::vector<uint32_t> m_ParentVersion; // Parent version used last time
+  std::vector<uint8_t> m_LocalDirty;
+  std::vector<uint8_t> m_Alive;
+  std::vector<TransformHandle> m_DenseToHandle;
+
+  // Stable handles -> dense index
+  std::vector<uint32_t> m_HandleToDense;
+  std::vector<TransformHandle> m_FreeHandles;
+  size_t m_DeadCount = 0;
+
+  // m_LevelStart[d]..m_LevelStart[d + 1] is depth level d
+  std::vector<uint32_t> m_LevelStart;
+  bool m_OrderDirty = false;
+  bool m_HasChanges = false; // Anything stale since the last batched update
+  uint64_t m_ChangeStamp = 0;
+  size_t m_ParallelThreshold = 4096;
+  std::mutex m_LazyMutex; // GetWorldMatrix's refresh of stale chains
+};
+
+} // namespace Quantum
@@ -82,6 +82,8 @@ VividDevice::VividDevice(HWND hwnd, HINSTANCE hinstance, const char *title)
 #endif
 
 VividDevice::~VividDevice() {
+  vkDeviceWaitIdle(m_Device);
+  ReleaseFinishedUploads();
   vkDestroyCommandPool(m_Device, m_CommandPool, nullptr);
   vkDestroyDevice(m_Device, nullptr);
 
@@ -634,6 +636,91 @@ void VividDevice::CopyBufferToImage(VkBuffer buffer, VkImage image,
   EndSingleTimeCommands(commandBuffer);
 }
 
+void VividDevice::CopyBufferToImageRegion(VkBuffer buffer, VkImage image,
+                                          int32_t x, int32_t y, uint32_t width,
+                                          uint32_t height,
+                                          std::shared_ptr<void> staging) {
+  ReleaseFinishedUploads();
+
+  VkCommandBuffer commandBuffer = BeginSingleTimeCommands();
+
+  VkImageMemoryBarrier barrier{};
+  barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+  barrier.oldLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+  barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+  barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  barrier.image = image;
+  barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+  barrier.subresourceRange.baseMipLevel = 0;
+  barrier.subresourceRange.levelCount = 1;
+  barrier.subresourceRange.baseArrayLayer = 0;
+  barrier.subresourceRange.layerCount = 1;
+  barrier.srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
+  barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+
+  vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                       VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0,
+                       nullptr, 1, &barrier);
+
+  VkBufferImageCopy region{};
+  region.bufferOffset = 0;
+  region.bufferRowLength = 0;
+  region.bufferImageHeight = 0;
+  region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+  region.imageSubresource.mipLevel = 0;
+  region.imageSubresource.baseArrayLayer = 0;
+  region.imageSubresource.layerCount = 1;
+  region.imageOffset = {x, y, 0};
+  region.imageExtent = {width, height, 1};
+
+  vkCmdCopyBufferToImage(commandBuffer, buffer, image,
+                         VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+
+  barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+  barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+  barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+  barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+  vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                       VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0,
+                       nullptr, 1, &barrier);
+
+  vkEndCommandBuffer(commandBuffer);
+
+  // The barriers order this against the frames before and after it on the
+  // queue, so nothing has to wait here
+  VkFenceCreateInfo fenceInfo{};
+  fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+  VkFence fence;
+  if (vkCreateFence(m_Device, &fenceInfo, nullptr, &fence) != VK_SUCCESS) {
+    throw std::runtime_error("failed to create upload fence!");
+  }
+
+  VkSubmitInfo submitInfo{};
+  submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+  submitInfo.commandBufferCount = 1;
+  submitInfo.pCommandBuffers = &commandBuffer;
+
+  vkQueueSubmit(m_GraphicsQueue, 1, &submitInfo, fence);
+
+  m_PendingUploads.push_back({commandBuffer, fence, std::move(staging)});
+}
+
+void VividDevice::ReleaseFinishedUploads() {
+  auto finished = [this](PendingUpload &upload) {
+    if (vkGetFenceStatus(m_Device, upload.fence) != VK_SUCCESS) {
+      return false;
+    }
+    vkDestroyFence(m_Device, upload.fence, nullptr);
+    vkFreeCommandBuffers(m_Device, m_CommandPool, 1, &upload.commandBuffer);
+    return true;
+  };
+  m_PendingUploads.erase(std::remove_if(m_PendingUploads.begin(),
+                                        m_PendingUploads.end(), finished),
+                         m_PendingUploads.end());
+}
+
 VkImageView VividDevice::CreateImageView(VkImage image, VkFormat format) {
   // Determine correct aspect mask based on format
   VkImageAspectFlags aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
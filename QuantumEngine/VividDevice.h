@@ -1,6 +1,7 @@
 #pragma once
 
 #include "pch.h"
+#include <memory>
 #include <optional>
 #include <vector>
 
@@ -71,6 +72,15 @@ public:
                              VkImageLayout oldLayout, VkImageLayout newLayout);
   void CopyBufferToImage(VkBuffer buffer, VkImage image, uint32_t width,
                          uint32_t height);
+  // Copy a tightly packed buffer into a sub-rectangle of a sampled image.
+  // Layout transitions and the copy are recorded into a single submission
+  // that is not waited for; 'staging' (the buffer's owner) is kept alive
+  // until its fence signals.
+  void CopyBufferToImageRegion(VkBuffer buffer, VkImage image, int32_t x,
+                               int32_t y, uint32_t width, uint32_t height,
+                               std::shared_ptr<void> staging);
+  // Free the command buffers and staging of uploads the GPU has finished
+  void ReleaseFinishedUploads();
   void CopyImageToBuffer(VkImage image, VkBuffer buffer, uint32_t width,
                          uint32_t height);
   VkImageView CreateImageView(VkImage image, VkFormat format);
@@ -114,5 +124,13 @@ private:
   VkQueue m_GraphicsQueue;
   VkQueue m_PresentQueue;
   VkCommandPool m_CommandPool;
+
+  // Submissions of CopyBufferToImageRegion still in flight
+  struct PendingUpload {
+    VkCommandBuffer commandBuffer;
+    VkFence fence;
+    std::shared_ptr<void> staging;
+  };
+  std::vector<PendingUpload> m_PendingUploads;
 };
 } // namespace Vivid
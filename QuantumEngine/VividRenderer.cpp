@@ -88,6 +88,7 @@ bool VividRenderer::BeginFrameCommandBuffer() {
   // Wait for this frame's fence before reusing its resources
   vkWaitForFences(m_DevicePtr->GetDevice(), 1,
                   &m_InFlightFences[m_CurrentFrame], VK_TRUE, UINT64_MAX);
+  m_DevicePtr->ReleaseFinishedUploads();
 
   VkResult result = vkAcquireNextImageKHR(
       m_DevicePtr->GetDevice(), m_SwapChainPtr->GetSwapChain(), UINT64_MAX,